@@ -26,6 +26,7 @@
 
 #include <general-writer/general-writer.hpp>
 #include <general-writer/utf8-like-int-codec.h>
+#include <general-writer/gw-ring.hpp>
 
 #include <kfc/defs.h>
 
@@ -177,6 +178,44 @@ namespace ncbi
     }
 
 
+    bool GeneralWriter :: useSharedRing ( const std :: string & dir, size_t ring_size )
+    {
+        switch ( state )
+        {
+        case header_written:
+            break;
+        default:
+            throw "state violation switching to shared ring";
+        }
+
+        // only a pipe can be replaced
+        if ( out_fd < 0 || ring != 0 )
+            return false;
+
+        GWRing * r = GWRing :: create ( dir, ring_size );
+        if ( r == 0 )
+            return false;
+
+        size_t str_size = r -> path () . size ();
+        if ( str_size > 0x10000 )
+        {
+            delete r;
+            return false;
+        }
+
+        gwp_1string_evt_U16 hdr;
+        init ( hdr, 0, evt_use_ring );
+        set_size ( hdr, str_size );
+        write_event ( & hdr . dad, sizeof hdr );
+        internal_write ( r -> path () . data (), str_size );
+
+        // the announcement and everything before it go down the pipe
+        flush ();
+
+        ring = r;
+        return true;
+    }
+
     int GeneralWriter :: addTable ( const std :: string &table_name )
     {
         stream_state new_state = uninitialized;
@@ -820,6 +859,123 @@ namespace ncbi
         }
     }
 
+    template < class T > static
+    void encode_cell ( std :: vector < uint8_t > & out, const void * data, uint32_t elem_count )
+    {
+        if ( elem_count == 0 )
+            return;
+
+        const T * input = ( const T * ) data;
+
+        // reserve for the worst case encoding of every element
+        size_t marker = out . size ();
+        out . resize ( marker + ( size_t ) elem_count * ( sizeof ( T ) + 2 ) );
+
+        for ( uint32_t i = 0; i < elem_count; ++ i )
+        {
+            int num_writ = encode_int < T > ( input [ i ], & out [ marker ], out . data () + out . size () );
+            if ( num_writ <= 0 )
+                throw "error encoding integer data";
+            marker += num_writ;
+        }
+
+        out . resize ( marker );
+    }
+
+    void GeneralWriter :: writeBatch ( int stream_id, uint32_t elem_bits, const void *data,
+                                       const uint32_t *elem_counts, uint32_t cell_count )
+    {
+        switch ( state )
+        {
+        case opened:
+            break;
+        default:
+            throw "state violation writing column batch";
+        }
+
+        if ( stream_id <= 0 )
+            throw "Stream_id is not valid";
+        if ( stream_id > ( int ) streams.size () )
+            throw "Stream_id is out of bounds";
+
+        if ( cell_count == 0 )
+            return;
+        if ( cell_count > 0x10000 )
+            throw "too many cells in batch";
+
+        if ( elem_counts == 0 )
+            throw "Invalid elem_counts ptr";
+
+        const int_stream & s = streams [ stream_id - 1 ];
+
+        if ( elem_bits != s . elem_bits )
+            throw "Invalid elem_bits";
+
+        void ( * encode ) ( std :: vector < uint8_t > & out, const void * data, uint32_t elem_count ) = 0;
+        if ( ( s . flag_bits & 1 ) != 0 )
+        {
+            switch ( elem_bits )
+            {
+            case 16:
+                encode = encode_cell < uint16_t >;
+                break;
+            case 32:
+                encode = encode_cell < uint32_t >;
+                break;
+            case 64:
+                encode = encode_cell < uint64_t >;
+                break;
+            default:
+                throw "INTERNAL ERROR: corrupt element bits";
+            }
+        }
+
+        batch_lens . resize ( ( size_t ) cell_count * 6 );
+        batch_data . clear ();
+
+        const uint8_t * dp = ( const uint8_t * ) data;
+        size_t lens_marker = 0;
+
+        for ( uint32_t i = 0; i < cell_count; ++ i )
+        {
+            size_t num_bytes = ( ( size_t ) elem_bits * elem_counts [ i ] + 7 ) / 8;
+            if ( num_bytes != 0 && dp == 0 )
+                throw "Invalid data ptr";
+
+            size_t cell_size = num_bytes;
+            if ( encode != 0 )
+            {
+                size_t marker = batch_data . size ();
+                ( * encode ) ( batch_data, dp, elem_counts [ i ] );
+                cell_size = batch_data . size () - marker;
+            }
+            else if ( num_bytes != 0 )
+            {
+                batch_data . insert ( batch_data . end (), dp, dp + num_bytes );
+            }
+            dp += num_bytes;
+
+            if ( cell_size > 0xFFFFFFFF || batch_data . size () > 0xFFFFFFFF )
+                throw "cell batch exceeds maximum";
+
+            int num_writ = encode_int < uint32_t > ( ( uint32_t ) cell_size,
+                & batch_lens [ lens_marker ], batch_lens . data () + batch_lens . size () );
+            if ( num_writ <= 0 )
+                throw "error encoding cell size";
+            lens_marker += num_writ;
+        }
+
+        gwp_cell_batch_evt_v1 hdr;
+        init ( hdr, stream_id, evt_cell_batch );
+        set_cell_count ( hdr, cell_count );
+        set_lens_size ( hdr, ( uint32_t ) lens_marker );
+        set_data_size ( hdr, ( uint32_t ) batch_data . size () );
+        write_event ( & hdr . dad, sizeof hdr );
+        internal_write ( batch_lens . data (), lens_marker );
+        if ( ! batch_data . empty () )
+            internal_write ( batch_data . data (), batch_data . size () );
+    }
+
     void GeneralWriter :: nextRow ( int table_id )
     {
         switch ( state )
@@ -839,6 +995,30 @@ namespace ncbi
     }
 
 
+    void GeneralWriter :: nextRows ( int table_id, uint32_t nrows )
+    {
+        switch ( state )
+        {
+        case opened:
+            break;
+        default:
+            throw "state violation advancing nrows";
+        }
+
+        if ( table_id <= 0 || ( size_t ) table_id > tables.size () )
+            throw "Invalid table id";
+
+        if ( nrows == 0 )
+            return;
+        if ( nrows > 0x10000 )
+            throw "too many rows in commit";
+
+        gwp_next_rows_evt_v1 hdr;
+        init ( hdr, table_id, evt_next_rows );
+        set_nrows ( hdr, nrows );
+        write_event ( & hdr . dad, sizeof hdr );
+    }
+
     void GeneralWriter :: moveAhead ( int table_id, uint64_t nrows )
     {
         switch ( state )
@@ -1002,6 +1182,9 @@ namespace ncbi
         state = closed;
 
         flush ();
+
+        if ( ring != 0 )
+            ring -> close ();
     }
 
 
@@ -1016,6 +1199,7 @@ namespace ncbi
         , output_bsize ( 0 )
         , output_marker ( 0 )
         , out_fd ( -1 )
+        , ring ( 0 )
         , state ( uninitialized )
     {
         packing_buffer = new uint8_t [ bsize ];
@@ -1033,6 +1217,7 @@ namespace ncbi
         , output_bsize ( buffer_size )
         , output_marker ( 0 )
         , out_fd ( _out_fd )
+        , ring ( 0 )
         , state ( uninitialized )
     {
         packing_buffer = new uint8_t [ bsize ];
@@ -1050,11 +1235,13 @@ namespace ncbi
         {
         }
 
+        delete ring;
         delete [] output_buffer;
         delete [] packing_buffer;
 
         output_bsize = output_marker = 0;
         output_buffer = packing_buffer = 0;
+        ring = 0;
     }
 
     bool GeneralWriter :: int_stream :: operator < ( const int_stream &s ) const
@@ -1103,7 +1290,9 @@ namespace ncbi
 
     void GeneralWriter :: flush ()
     {
-        if ( out_fd < 0 )
+        if ( ring != 0 )
+            ring -> publish ();
+        else if ( out_fd < 0 )
             out . flush ();
         else
         {
@@ -1123,7 +1312,12 @@ namespace ncbi
 
     void GeneralWriter :: internal_write ( const void * data, size_t num_bytes )
     {
-        if ( out_fd < 0 )
+        if ( ring != 0 )
+        {
+            ring -> write ( data, num_bytes );
+            byte_count += num_bytes;
+        }
+        else if ( out_fd < 0 )
         {
             out.write ( ( const char * ) data, num_bytes );
             byte_count += num_bytes;
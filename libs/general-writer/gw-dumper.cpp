@@ -729,6 +729,109 @@ namespace gw_dump
         }
     }
 
+    /* dump_cell_batch
+     */
+    static
+    void dump_cell_batch ( FILE * in, const gwp_evt_hdr_v1 & e )
+    {
+        gwp_cell_batch_evt_v1 eh;
+        init ( eh, e );
+
+        size_t num_read = readFILE ( & eh . cell_count, sizeof eh - sizeof e, 1, in );
+        if ( num_read != 1 )
+            throw "failed to read cell-batch event";
+
+        check_cell_event ( eh );
+
+        auto const lens_size = ncbi :: lens_size ( eh );
+        auto lens_buffer = std::vector<uint8_t>(lens_size);
+        if (lens_size != readFILE(lens_buffer.data(), 1, lens_size, in))
+            throw "failed to read cell-batch sizes";
+
+        auto const data_size = ncbi :: data_size ( eh );
+        auto data_buffer = std::vector<uint8_t>(data_size);
+        if (data_size != readFILE(data_buffer.data(), 1, data_size, in))
+            throw "failed to read cell-batch data";
+
+        // the sizes must account for every byte of data
+        auto const cells = cell_count ( eh );
+        uint8_t const * start = lens_buffer.data();
+        uint8_t const * end = start + lens_size;
+        uint64_t total = 0;
+        for ( uint32_t i = 0; i < cells; ++ i )
+        {
+            uint32_t len;
+            int num_read = decode_uint32 ( start, end, & len );
+            if ( num_read <= 0 )
+                throw "corrupt cell-batch sizes";
+            start += num_read;
+            total += len;
+        }
+        if ( start != end || total != data_size )
+            throw "cell-batch sizes do not match data";
+
+        auto const columnId = id(eh.dad);
+        col_entry const &entry = col_entries[columnId - 1];
+
+        switch (display) {
+        case 1:
+            std :: cout
+                << event_num << ": cell-batch\n"
+                   "  stream_id = " << columnId << " ( " << tbl_entries[entry.table_id - 1].tbl_name << " . " << entry . spec << " )\n"
+                   "  elem_bits = " << entry . elem_bits << "\n"
+                   "  cell_count = " << cells << " ( " << data_size << " bytes" << ( ( entry . flag_bits & 1 ) != 0 ? " packed" : "" ) << " )\n"
+                ;
+            break;
+        case 2:
+            std::cout
+                << "{ \"event\": \"batch\""
+                   ", \"column-id\": " << columnId
+                << ", \"cells\": " << cells
+                << ", \"data\": \"<packed data>\""
+                   " }\n";
+            break;
+        }
+    }
+
+    /* dump_next_rows
+     */
+    static
+    void dump_next_rows ( FILE * in, const gwp_evt_hdr_v1 & e )
+    {
+        gwp_next_rows_evt_v1 eh;
+        init ( eh, e );
+
+        size_t num_read = readFILE ( & eh . nrows, sizeof eh - sizeof e, 1, in );
+        if ( num_read != 1 )
+            throw "failed to read next-rows event";
+
+        check_next_row ( eh . dad );
+
+        auto const tableId = id(eh.dad);
+        auto const nrows = get_nrows(eh);
+        tbl_entry & te = tbl_entries [ tableId - 1 ];
+
+        te . row_id += nrows;
+
+        switch (display) {
+        case 1:
+            std :: cout
+                << event_num << ": next-rows\n"
+                << "  table_id = " << tableId << " ( \"" << te . tbl_name << "\" )\n"
+                << "  nrows = " << nrows << '\n'
+                << "  row_id = " << te . row_id << '\n'
+                ;
+            break;
+        case 2:
+            std::cout
+                << "{ \"event\": \"next-rows\""
+                   ", \"table-id\": " << tableId
+                << ", \"rows\": " << nrows
+                << " }\n";
+            break;
+        }
+    }
+
     static char hex(uint8_t const x) {
         return x < 10 ? (x + '0') : ((x - 10 + 'A'));
     }
@@ -1880,6 +1983,9 @@ namespace gw_dump
             dump_progmsg < gw_evt_hdr_v1, gw_status_evt_v1 > ( in, e );
             break;
 
+        case evt_use_ring:
+            throw "stream continues in a shared ring; dump a pipe stream instead";
+
         default:
             throw "unrecognized event id";
         }
@@ -2002,6 +2108,17 @@ namespace gw_dump
             dump_progmsg < gwp_evt_hdr_v1, gwp_status_evt_v1 > ( in, e );
             break;
 
+        case evt_cell_batch:
+            dump_cell_batch ( in, e );
+            break;
+        case evt_next_rows:
+            dump_next_rows ( in, e );
+            break;
+
+        case evt_use_ring:
+            // the rest of the stream lives in shared memory, which is not followed here
+            throw "stream continues in a shared ring; dump a pipe stream instead";
+
         default:
             throw "unrecognized packed event id";
         }
@@ -0,0 +1,380 @@
+/*===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+*/
+
+/* gw-bench
+ *  compares per-cell framing ( write/nextRow ) with batched framing
+ *  ( writeBatch/nextRows ) on a synthetic short-read FASTQ stream.
+ *
+ *  usage: gw-bench [ spots [ read-length [ batch-size ] ] ]
+ *
+ *  for each framing, reports the time to produce the stream, its size,
+ *  and the time to walk its events the way general-loader dispatches them.
+ */
+
+#include <general-writer/general-writer.hpp>
+#include <general-writer/utf8-like-int-codec.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+
+#include <sys/time.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+using namespace std;
+
+namespace ncbi
+{
+    static
+    double now ()
+    {
+        struct timeval tv;
+        gettimeofday ( & tv, 0 );
+        return tv . tv_sec + tv . tv_usec / 1e6;
+    }
+
+    struct Spot
+    {
+        string name;
+        string read;
+        string qual;
+    };
+
+    static
+    void makeSpots ( vector < Spot > & spots, size_t count, size_t read_len )
+    {
+        static const char bases [] = "ACGT";
+        uint32_t seed = 12345;
+
+        spots . resize ( count );
+        for ( size_t i = 0; i < count; ++ i )
+        {
+            char name [ 64 ];
+            snprintf ( name, sizeof name, "A00123:8:H5KWLDSXX:1:%u:%u:%u",
+                       ( unsigned ) ( 1101 + i % 100 ), ( unsigned ) ( i % 30000 ), ( unsigned ) ( i % 4000 ) );
+            spots [ i ] . name = name;
+            spots [ i ] . read . resize ( read_len );
+            spots [ i ] . qual . resize ( read_len );
+            for ( size_t j = 0; j < read_len; ++ j )
+            {
+                seed = seed * 1103515245 + 12345;
+                spots [ i ] . read [ j ] = bases [ ( seed >> 16 ) & 3 ];
+                spots [ i ] . qual [ j ] = ( char ) ( 33 + 20 + ( ( seed >> 20 ) % 20 ) );
+            }
+        }
+    }
+
+    struct Columns
+    {
+        int table;
+        int name;
+        int read;
+        int qual;
+        int read_len;
+    };
+
+    static
+    Columns openStream ( GeneralWriter & gw )
+    {
+        gw . setRemotePath ( "gw-bench" );
+        gw . useSchema ( "gw-bench.vschema", "gw:bench:db" );
+        gw . setSoftwareName ( "gw-bench", "1.0.0" );
+
+        Columns c;
+        c . table = gw . addTable ( "SEQUENCE" );
+        c . name = gw . addColumn ( c . table, "NAME", 8 );
+        c . read = gw . addColumn ( c . table, "READ", 8 );
+        c . qual = gw . addColumn ( c . table, "QUALITY", 8 );
+        c . read_len = gw . addIntegerColumn ( c . table, "READ_LEN", 32 );
+        gw . open ();
+        return c;
+    }
+
+    static
+    void writePerCell ( int fd, const vector < Spot > & spots )
+    {
+        GeneralWriter gw ( fd, 1024 * 1024 );
+        Columns c = openStream ( gw );
+
+        for ( size_t i = 0; i < spots . size (); ++ i )
+        {
+            const Spot & s = spots [ i ];
+            uint32_t len = ( uint32_t ) s . read . size ();
+            gw . write ( c . name, 8, s . name . data (), ( uint32_t ) s . name . size () );
+            gw . write ( c . read, 8, s . read . data (), len );
+            gw . write ( c . qual, 8, s . qual . data (), len );
+            gw . write ( c . read_len, 32, & len, 1 );
+            gw . nextRow ( c . table );
+        }
+        gw . endStream ();
+    }
+
+    static
+    void writeBatched ( int fd, const vector < Spot > & spots, size_t batch_size )
+    {
+        GeneralWriter gw ( fd, 1024 * 1024 );
+        Columns c = openStream ( gw );
+
+        string names, reads, quals;
+        vector < uint32_t > name_lens, read_lens, ones;
+
+        for ( size_t first = 0; first < spots . size (); first += batch_size )
+        {
+            size_t last = first + batch_size;
+            if ( last > spots . size () )
+                last = spots . size ();
+
+            names . clear (); reads . clear (); quals . clear ();
+            name_lens . clear (); read_lens . clear (); ones . clear ();
+            for ( size_t i = first; i < last; ++ i )
+            {
+                const Spot & s = spots [ i ];
+                names += s . name;
+                reads += s . read;
+                quals += s . qual;
+                name_lens . push_back ( ( uint32_t ) s . name . size () );
+                read_lens . push_back ( ( uint32_t ) s . read . size () );
+                ones . push_back ( 1 );
+            }
+
+            uint32_t n = ( uint32_t ) ( last - first );
+            gw . writeBatch ( c . name, 8, names . data (), name_lens . data (), n );
+            gw . writeBatch ( c . read, 8, reads . data (), read_lens . data (), n );
+            gw . writeBatch ( c . qual, 8, quals . data (), read_lens . data (), n );
+            gw . writeBatch ( c . read_len, 32, read_lens . data (), ones . data (), n );
+            gw . nextRows ( c . table, n );
+        }
+        gw . endStream ();
+    }
+
+    /* walk
+     *  visits every event of a packed stream, touching cell data the way
+     *  the loader does, and returns the number of events seen
+     */
+    static
+    uint64_t walk ( const vector < uint8_t > & stream, uint64_t & checksum )
+    {
+        const uint8_t * p = stream . data ();
+        const uint8_t * end = p + stream . size ();
+
+        const gw_header_v1 * hdr = ( const gw_header_v1 * ) p;
+        p += hdr -> dad . hdr_size;
+
+        uint64_t events = 0;
+        while ( p < end )
+        {
+            gwp_evt_hdr_v1 eh;
+            memmove ( & eh, p, sizeof eh );
+            ++ events;
+
+            switch ( evt ( eh ) )
+            {
+            case evt_remote_path2:
+            case evt_new_table2:
+            {
+                gwp_1string_evt_U16_v1 e;
+                memmove ( & e, p, sizeof e );
+                p += sizeof e + size ( e );
+                break;
+            }
+            case evt_new_table:
+            {
+                gwp_1string_evt_v1 e;
+                memmove ( & e, p, sizeof e );
+                p += sizeof e + size ( e );
+                break;
+            }
+            case evt_use_schema2:
+            {
+                gwp_2string_evt_U16_v1 e;
+                memmove ( & e, p, sizeof e );
+                p += sizeof e + size1 ( e ) + size2 ( e );
+                break;
+            }
+            case evt_software_name:
+            {
+                gwp_2string_evt_v1 e;
+                memmove ( & e, p, sizeof e );
+                p += sizeof e + size1 ( e ) + size2 ( e );
+                break;
+            }
+            case evt_new_column:
+            {
+                gwp_column_evt_v1 e;
+                memmove ( & e, p, sizeof e );
+                p += sizeof e + name_size ( e );
+                break;
+            }
+            case evt_open_stream:
+            case evt_next_row:
+                p += sizeof eh;
+                break;
+            case evt_end_stream:
+                return events;
+            case evt_cell_data:
+            {
+                gwp_data_evt_v1 e;
+                memmove ( & e, p, sizeof e );
+                p += sizeof e;
+                checksum += p [ 0 ] + size ( e );
+                p += size ( e );
+                break;
+            }
+            case evt_cell_data2:
+            {
+                gwp_data_evt_U16_v1 e;
+                memmove ( & e, p, sizeof e );
+                p += sizeof e;
+                checksum += p [ 0 ] + size ( e );
+                p += size ( e );
+                break;
+            }
+            case evt_cell_batch:
+            {
+                gwp_cell_batch_evt_v1 e;
+                memmove ( & e, p, sizeof e );
+                p += sizeof e;
+
+                const uint8_t * lens = p;
+                const uint8_t * lens_end = p + lens_size ( e );
+                const uint8_t * data = lens_end;
+                uint32_t cells = cell_count ( e );
+                for ( uint32_t i = 0; i < cells; ++ i )
+                {
+                    uint32_t len;
+                    int num_read = decode_uint32 ( lens, lens_end, & len );
+                    if ( num_read <= 0 )
+                        throw "corrupt cell batch";
+                    lens += num_read;
+                    checksum += ( len != 0 ? data [ 0 ] : 0 ) + len;
+                    data += len;
+                }
+                p = lens_end + data_size ( e );
+                break;
+            }
+            case evt_next_rows:
+                p += sizeof ( gwp_next_rows_evt_v1 );
+                break;
+            default:
+                throw "unexpected event in benchmark stream";
+            }
+        }
+        throw "stream ended without end-stream event";
+    }
+
+    static
+    void readBack ( const char * path, vector < uint8_t > & stream )
+    {
+        FILE * f = fopen ( path, "rb" );
+        if ( f == 0 )
+            throw "failed to reopen benchmark stream";
+        fseek ( f, 0, SEEK_END );
+        stream . resize ( ftell ( f ) );
+        fseek ( f, 0, SEEK_SET );
+        if ( fread ( stream . data (), 1, stream . size (), f ) != stream . size () )
+        {
+            fclose ( f );
+            throw "failed to read benchmark stream";
+        }
+        fclose ( f );
+    }
+
+    static
+    void report ( const char * label, size_t spots, double write_secs, const vector < uint8_t > & stream )
+    {
+        uint64_t checksum = 0;
+        double start = now ();
+        uint64_t events = walk ( stream, checksum );
+        double walk_secs = now () - start;
+
+        cout << label
+             << ": " << stream . size () << " bytes, " << events << " events"
+             << ", write " << write_secs << " s ( " << ( spots / write_secs / 1e6 ) << " Mspots/s )"
+             << ", walk " << walk_secs << " s ( " << ( stream . size () / walk_secs / 1e6 ) << " MB/s )"
+             << " [" << checksum << "]\n";
+    }
+
+    static
+    void run ( size_t spot_count, size_t read_len, size_t batch_size )
+    {
+        vector < Spot > spots;
+        makeSpots ( spots, spot_count, read_len );
+
+        char path [] = "/tmp/gw-bench-XXXXXX";
+        int fd = mkstemp ( path );
+        if ( fd < 0 )
+            throw "failed to create temporary file";
+
+        vector < uint8_t > stream;
+
+        double start = now ();
+        writePerCell ( fd, spots );
+        double secs = now () - start;
+        readBack ( path, stream );
+        report ( "per-cell", spot_count, secs, stream );
+
+        if ( ftruncate ( fd, 0 ) != 0 || lseek ( fd, 0, SEEK_SET ) != 0 )
+            throw "failed to reset temporary file";
+
+        start = now ();
+        writeBatched ( fd, spots, batch_size );
+        secs = now () - start;
+        readBack ( path, stream );
+        report ( "batched ", spot_count, secs, stream );
+
+        close ( fd );
+        unlink ( path );
+    }
+}
+
+int main ( int argc, char * argv [] )
+{
+    size_t spots = argc > 1 ? strtoul ( argv [ 1 ], 0, 10 ) : 1000000;
+    size_t read_len = argc > 2 ? strtoul ( argv [ 2 ], 0, 10 ) : 150;
+    size_t batch_size = argc > 3 ? strtoul ( argv [ 3 ], 0, 10 ) : 1024;
+
+    if ( spots == 0 || read_len == 0 || batch_size == 0 || batch_size > 0x10000 )
+    {
+        cerr << "usage: " << argv [ 0 ] << " [ spots [ read-length [ batch-size <= 65536 ] ] ]\n";
+        return 1;
+    }
+
+    try
+    {
+        ncbi :: run ( spots, read_len, batch_size );
+    }
+    catch ( const char * x )
+    {
+        cerr << "ERROR: " << x << '\n';
+        return 1;
+    }
+
+    return 0;
+}
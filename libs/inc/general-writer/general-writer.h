@@ -80,6 +80,12 @@ enum gw_evt_id
     evt_logmsg,
     evt_progmsg,
 
+    /* BATCHED MESSAGES ( packed only ) */
+    evt_cell_batch,                       /* cells of one column, N rows */
+    evt_next_rows,                        /* commit N rows in one event  */
+
+    evt_use_ring,                         /* continue in shared ring     */
+
     evt_max_id                            /* must be last                */
 };
 
@@ -165,6 +171,40 @@ enum gw_evt_id
     follow with the bytes in path
       write ( path, strlen ( path ) );
 
+ 3. BATCHED CELLS [ PACKED ONLY ]
+    A producer with many short rows may stage the cells of a column for a
+    run of rows with a single "gwp_cell_batch_evt", followed by a single
+    "gwp_next_rows_evt" that commits the whole run.
+      GWP_SET_ID_EVT ( & evt.dad, column_id, evt_cell_batch );
+      evt.cell_count = number_of_cells - 1;
+      evt.lens_sz = bytes of packed length table;
+      evt.data_sz = bytes of concatenated cell data;
+    follow with the length table: the size in bytes of each cell as sent,
+    packed with encode_uint32 ()
+      write ( lens, lens_sz );
+    follow with the cell data, each cell starting on a byte boundary
+      write ( data, data_sz );
+    Integer columns use element packing within each cell.
+
+    Then, for the table owning the columns:
+      GWP_SET_ID_EVT ( & evt.dad, table_id, evt_next_rows );
+      evt.nrows = number_of_cells - 1;
+    Row i of the run receives cell i of every batch staged for the table.
+    Every staged batch must hold exactly nrows cells.
+
+  4. SWITCH TO SHARED RING [ OPTIONAL ]
+    A producer on the same host as the loader may move the rest of the
+    stream off the pipe and into a memory-mapped ring ( see gw-ring.hpp ).
+    Right after the stream header, send the path of the ring file:
+    in the not-packed case with "gw_1string_evt" plus alignment,
+      GW_SET_ID_EVT ( & evt.dad, 0, evt_use_ring );
+    in the packed case with "gwp_1string_evt_U16",
+      GWP_SET_ID_EVT ( & evt.dad, 0, evt_use_ring );
+      evt.sz = strlen ( path ) - 1;
+    follow with the bytes in path, then flush the pipe.
+    All subsequent events, through evt_end_stream, are written to the ring.
+    Nothing more is written to the pipe.
+
   MORE TO COME...
 
  */
@@ -429,6 +469,34 @@ struct gwp_data_evt_U16_v1
  /* uint8_t data [ sz+1 ]; * event data.                                      */
 };
 
+/* gwp_cell_batch_evt
+ *  event used to stage one column's cells for a run of rows
+ *
+ *  used for events:
+ *    { evt_cell_batch }
+ */
+struct gwp_cell_batch_evt_v1
+{
+    gwp_evt_hdr_v1 dad;   /* common header : id = column id                   */
+    uint16_t cell_count;  /* the number - 1 of cells in the batch             */
+    uint16_t lens_sz [ 2 ]; /* the size in bytes of the packed length table   */
+    uint16_t data_sz [ 2 ]; /* the size in bytes of all cell data             */
+ /* uint8_t lens [ lens_sz ]; * per-cell data sizes, packed with encode_uint32*
+    uint8_t data [ data_sz ]; * cell data, concatenated in row order          */
+};
+
+/* gwp_next_rows_evt
+ *  event used to commit a run of rows staged with evt_cell_batch
+ *
+ *  used for events:
+ *    { evt_next_rows }
+ */
+struct gwp_next_rows_evt_v1
+{
+    gwp_evt_hdr_v1 dad;   /* common header : id = table id                    */
+    uint16_t nrows;       /* the number - 1 of rows to commit                 */
+};
+
 struct gwp_add_mbr_evt_v1
 {
     gwp_evt_hdr_v1 dad;
@@ -968,6 +1036,75 @@ namespace ncbi
     { set_string_size ( self . sz, bytes ); }
 
 
+    // gwp_cell_batch_evt
+    inline void init ( :: gwp_cell_batch_evt_v1 & hdr, uint32_t id, gw_evt_id evt )
+    {
+        init ( hdr . dad, id, evt );
+        hdr . cell_count = 0;
+        memset ( & hdr . lens_sz, 0, sizeof hdr . lens_sz );
+        memset ( & hdr . data_sz, 0, sizeof hdr . data_sz );
+    }
+
+    inline void init ( :: gwp_cell_batch_evt_v1 & hdr, const :: gwp_evt_hdr_v1 & dad )
+    {
+        hdr . dad = dad;
+        hdr . cell_count = 0;
+        memset ( & hdr . lens_sz, 0, sizeof hdr . lens_sz );
+        memset ( & hdr . data_sz, 0, sizeof hdr . data_sz );
+    }
+
+    inline uint32_t cell_count ( const :: gwp_cell_batch_evt_v1 & self )
+    { return ( uint32_t ) self . cell_count + 1; }
+
+    inline void set_cell_count ( :: gwp_cell_batch_evt_v1 & self, uint32_t count )
+    { set_string_size ( self . cell_count, count ); }
+
+    inline uint32_t lens_size ( const :: gwp_cell_batch_evt_v1 & self )
+    {
+        uint32_t sz;
+        memmove ( & sz, & self . lens_sz, sizeof sz );
+        return sz;
+    }
+
+    inline void set_lens_size ( :: gwp_cell_batch_evt_v1 & self, uint32_t bytes )
+    {
+        assert ( bytes != 0 );
+        memmove ( & self . lens_sz, & bytes, sizeof self . lens_sz );
+    }
+
+    inline uint32_t data_size ( const :: gwp_cell_batch_evt_v1 & self )
+    {
+        uint32_t sz;
+        memmove ( & sz, & self . data_sz, sizeof sz );
+        return sz;
+    }
+
+    inline void set_data_size ( :: gwp_cell_batch_evt_v1 & self, uint32_t bytes )
+    {
+        memmove ( & self . data_sz, & bytes, sizeof self . data_sz );
+    }
+
+
+    // gwp_next_rows_evt
+    inline void init ( :: gwp_next_rows_evt_v1 & hdr, uint32_t id, gw_evt_id evt )
+    {
+        init ( hdr . dad, id, evt );
+        hdr . nrows = 0;
+    }
+
+    inline void init ( :: gwp_next_rows_evt_v1 & hdr, const :: gwp_evt_hdr_v1 & dad )
+    {
+        hdr . dad = dad;
+        hdr . nrows = 0;
+    }
+
+    inline uint32_t get_nrows ( const :: gwp_next_rows_evt_v1 & self )
+    { return ( uint32_t ) self . nrows + 1; }
+
+    inline void set_nrows ( :: gwp_next_rows_evt_v1 & self, uint32_t nrows )
+    { set_string_size ( self . nrows, nrows ); }
+
+
     // gwp_add_mbr_evt
     inline void init ( :: gwp_add_mbr_evt_v1 & hdr, uint32_t id, gw_evt_id evt )
     {
@@ -42,6 +42,8 @@
 
 namespace ncbi
 {
+    class GWRing;
+
 #if GW_CURRENT_VERSION <= 2
     typedef :: gwp_evt_hdr_v1 gwp_evt_hdr;
 #else
@@ -81,6 +83,12 @@ namespace ncbi
         int dbAddTable ( int db_id, const std :: string &mbr_name, 
                              const std :: string &tbl_name, uint8_t create_mode );
 
+        // move the stream from out_fd to a shared-memory ring created in dir
+        // ( see gw-ring.hpp ). must be the first call after construction.
+        // returns false and stays on the pipe if the ring cannot be created
+        bool useSharedRing ( const std :: string & dir = "/dev/shm",
+                             size_t ring_size = 64 * 1024 * 1024 );
+
         // ensure there are atleast one table and one column
         // set GeneralWriter to open state
         // write out open_stream event header
@@ -107,9 +115,18 @@ namespace ncbi
         // may be repeated as often as necessary to complete a single cell's data
         void write ( int stream_id, uint32_t elem_bits, const void *data, uint32_t elem_count );
 
+        // generate the cells of one column for the next cell_count rows
+        // cell i holds elem_counts [ i ] elements, starting on a byte
+        // boundary within data. cells are held by the loader until nextRows
+        void writeBatch ( int stream_id, uint32_t elem_bits, const void *data,
+                          const uint32_t *elem_counts, uint32_t cell_count );
+
         // commit and close current row, move to next row
         void nextRow ( int table_id );
 
+        // commit and close nrows rows, consuming the batches sent by writeBatch
+        void nextRows ( int table_id, uint32_t nrows );
+
         // commit and close current row, move ahead by nrows
         void moveAhead ( int table_id, uint64_t nrows );
 
@@ -180,12 +197,17 @@ namespace ncbi
 
         uint8_t * packing_buffer;
 
+        std :: vector < uint8_t > batch_lens;
+        std :: vector < uint8_t > batch_data;
+
         uint8_t * output_buffer;
         size_t output_bsize;
         size_t output_marker;
 
         int out_fd;
 
+        GWRing * ring;
+
         enum stream_state
         {
             uninitialized,
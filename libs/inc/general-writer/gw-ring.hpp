@@ -0,0 +1,366 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_gw_ring_
+#define _hpp_gw_ring_
+
+#include <atomic>
+#include <string>
+#include <new>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define GW_RING_SIGNATURE "NCBIgrng"
+
+namespace ncbi
+{
+    /* GWRing
+     *  single-producer, single-consumer byte ring in a memory-mapped file,
+     *  used in place of the pipe between a general-writer producer and
+     *  general-loader running on the same host.
+     *
+     *  the producer creates the ring and announces its path with an
+     *  evt_use_ring event on the pipe; everything after that event
+     *  travels through the ring. the loader attaches and unlinks the file.
+     *
+     *  the data area is mapped twice, back to back, so that any run of up
+     *  to "size" bytes is contiguous in memory and can be copied in or
+     *  read in place regardless of where the ring wraps.
+     *
+     *  errors are thrown as const char *, like GeneralWriter.
+     */
+    class GWRing
+    {
+    public:
+
+        // producer: create a new ring file under dir
+        // returns 0 if the ring cannot be set up, so the caller can stay on the pipe
+        static GWRing * create ( const std :: string & dir, size_t size )
+        {
+            size_t page = ( size_t ) sysconf ( _SC_PAGESIZE );
+            size_t ring_size = page;
+            while ( ring_size < size )
+                ring_size <<= 1;
+
+            std :: string tmpl = dir + "/gw-ring-XXXXXX";
+            int fd = mkstemp ( & tmpl [ 0 ] );
+            if ( fd < 0 )
+                return 0;
+
+            GWRing * self = 0;
+            if ( ftruncate ( fd, ( off_t ) ( page + ring_size ) ) == 0 )
+            {
+                self = map ( fd, tmpl, page, ring_size );
+                if ( self != 0 )
+                {
+                    Header * hdr = new ( self -> m_hdr ) Header;
+                    memmove ( hdr -> signature, GW_RING_SIGNATURE, sizeof hdr -> signature );
+                    hdr -> size = ring_size;
+                    hdr -> producer_pid = ( uint32_t ) getpid ();
+                    self -> m_producer = true;
+                }
+            }
+            :: close ( fd );
+
+            if ( self == 0 )
+                unlink ( tmpl . c_str () );
+            return self;
+        }
+
+        // consumer: map a ring made by create ()
+        static GWRing * attach ( const std :: string & path )
+        {
+            int fd = open ( path . c_str (), O_RDWR );
+            if ( fd < 0 )
+                throw "failed to open shared ring";
+
+            size_t page = ( size_t ) sysconf ( _SC_PAGESIZE );
+            Header probe;
+            ssize_t num_read = pread ( fd, & probe, sizeof probe . signature + sizeof probe . size, 0 );
+            if ( num_read != ( ssize_t ) ( sizeof probe . signature + sizeof probe . size ) ||
+                 memcmp ( probe . signature, GW_RING_SIGNATURE, sizeof probe . signature ) != 0 ||
+                 probe . size < page || ( probe . size & ( probe . size - 1 ) ) != 0 )
+            {
+                :: close ( fd );
+                throw "bad shared ring header";
+            }
+
+            GWRing * self = map ( fd, path, page, ( size_t ) probe . size );
+            :: close ( fd );
+            if ( self == 0 )
+                throw "failed to map shared ring";
+
+            self -> m_hdr -> consumer_pid = ( uint32_t ) getpid ();
+
+            // nobody else needs the name once both sides have it mapped
+            unlink ( path . c_str () );
+
+            return self;
+        }
+
+        ~ GWRing ()
+        {
+            if ( m_producer )
+            {
+                close ();
+                // in case the consumer never attached
+                unlink ( m_path . c_str () );
+            }
+            munmap ( m_data, 2 * m_size );
+            munmap ( m_hdr, m_page );
+        }
+
+        const std :: string & path () const { return m_path; }
+        size_t size () const { return m_size; }
+
+        ///// producer side /////
+
+        void write ( const void * data, size_t bytes )
+        {
+            const uint8_t * p = ( const uint8_t * ) data;
+            while ( bytes != 0 )
+            {
+                size_t space = m_size - ( size_t ) ( m_head - m_hdr -> tail . load ( std :: memory_order_acquire ) );
+                if ( space == 0 )
+                {
+                    publish ();
+                    waitForConsumer ();
+                    continue;
+                }
+
+                size_t to_write = bytes < space ? bytes : space;
+                memmove ( m_data + ( m_head & ( m_size - 1 ) ), p, to_write );
+                m_head += to_write;
+                p += to_write;
+                bytes -= to_write;
+
+                // keep the consumer fed without touching the shared line per call
+                if ( m_head - m_published >= m_size / 8 )
+                    publish ();
+            }
+            m_backoff = 0;
+        }
+
+        void publish ()
+        {
+            if ( m_head != m_published )
+            {
+                m_hdr -> head . store ( m_head, std :: memory_order_release );
+                m_published = m_head;
+            }
+        }
+
+        void close ()
+        {
+            publish ();
+            m_hdr -> closed . store ( 1, std :: memory_order_release );
+        }
+
+        ///// consumer side /////
+
+        // waits until "bytes" ( <= size () ) are readable and returns them in place
+        // the bytes stay valid until consume (); returns 0 at the end of the ring
+        const void * peek ( size_t bytes )
+        {
+            while ( true )
+            {
+                uint64_t head = m_hdr -> head . load ( std :: memory_order_acquire );
+                if ( head - m_tail >= bytes )
+                {
+                    m_backoff = 0;
+                    return m_data + ( m_tail & ( m_size - 1 ) );
+                }
+
+                // let the producer see everything consumed so far before waiting
+                release ();
+
+                if ( m_hdr -> closed . load ( std :: memory_order_acquire ) != 0 &&
+                     m_hdr -> head . load ( std :: memory_order_acquire ) - m_tail < bytes )
+                {
+                    return 0;
+                }
+                if ( ! alive ( m_hdr -> producer_pid ) )
+                    throw "general-writer producer went away";
+
+                pause ();
+            }
+        }
+
+        void consume ( size_t bytes )
+        {
+            m_tail += bytes;
+            if ( m_tail - m_released >= m_size / 8 )
+                release ();
+        }
+
+        // copy out any number of bytes; returns false at the end of the ring
+        bool read ( void * buffer, size_t bytes )
+        {
+            uint8_t * p = ( uint8_t * ) buffer;
+            while ( bytes != 0 )
+            {
+                size_t chunk = bytes < m_size / 2 ? bytes : m_size / 2;
+                const void * src = peek ( chunk );
+                if ( src == 0 )
+                    return false;
+                memmove ( p, src, chunk );
+                consume ( chunk );
+                p += chunk;
+                bytes -= chunk;
+            }
+            return true;
+        }
+
+    private:
+
+        struct Header
+        {
+            char signature [ 8 ];               // GW_RING_SIGNATURE
+            uint64_t size;                      // bytes in data area, a power of 2
+            uint32_t producer_pid;
+            uint32_t consumer_pid;              // 0 until the loader attaches
+
+            alignas ( 64 ) std :: atomic < uint64_t > head;   // total bytes published
+            alignas ( 64 ) std :: atomic < uint64_t > tail;   // total bytes consumed
+            alignas ( 64 ) std :: atomic < uint32_t > closed; // producer is done
+
+            Header () : size ( 0 ), producer_pid ( 0 ), consumer_pid ( 0 ), head ( 0 ), tail ( 0 ), closed ( 0 )
+            { memset ( signature, 0, sizeof signature ); }
+        };
+
+        static GWRing * map ( int fd, const std :: string & path, size_t page, size_t size )
+        {
+            if ( sizeof ( Header ) > page )
+                return 0;
+
+            void * hdr = mmap ( 0, page, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+            if ( hdr == MAP_FAILED )
+                return 0;
+
+            // reserve twice the span, then map the data area into both halves
+            uint8_t * data = ( uint8_t * ) mmap ( 0, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANON, -1, 0 );
+            if ( ( void * ) data == MAP_FAILED )
+            {
+                munmap ( hdr, page );
+                return 0;
+            }
+            if ( mmap ( data, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, ( off_t ) page ) == MAP_FAILED ||
+                 mmap ( data + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, ( off_t ) page ) == MAP_FAILED )
+            {
+                munmap ( data, 2 * size );
+                munmap ( hdr, page );
+                return 0;
+            }
+
+            return new GWRing ( path, ( Header * ) hdr, data, page, size );
+        }
+
+        GWRing ( const std :: string & path, Header * hdr, uint8_t * data, size_t page, size_t size )
+            : m_path ( path )
+            , m_hdr ( hdr )
+            , m_data ( data )
+            , m_page ( page )
+            , m_size ( size )
+            , m_head ( hdr -> head . load () )
+            , m_published ( m_head )
+            , m_tail ( hdr -> tail . load () )
+            , m_released ( m_tail )
+            , m_backoff ( 0 )
+            , m_producer ( false )
+        {
+        }
+
+        void release ()
+        {
+            if ( m_tail != m_released )
+            {
+                m_hdr -> tail . store ( m_tail, std :: memory_order_release );
+                m_released = m_tail;
+            }
+        }
+
+        void waitForConsumer ()
+        {
+            uint32_t consumer = m_hdr -> consumer_pid;
+            if ( consumer != 0 && ! alive ( consumer ) )
+                throw "general-loader went away";
+
+            // a loader that does not understand evt_use_ring never attaches
+            if ( consumer == 0 && m_backoff > 1000000 )
+                throw "general-loader did not attach to shared ring";
+
+            pause ();
+        }
+
+        static bool alive ( uint32_t pid )
+        {
+            return kill ( ( pid_t ) pid, 0 ) == 0 || errno != ESRCH;
+        }
+
+        // spin briefly, then yield, then sleep in 50us steps
+        void pause ()
+        {
+            ++ m_backoff;
+            if ( m_backoff < 64 )
+                return;
+            if ( m_backoff < 128 )
+            {
+                sched_yield ();
+                return;
+            }
+            struct timespec ts = { 0, 50000 };
+            nanosleep ( & ts, 0 );
+        }
+
+        GWRing ( const GWRing & );
+        GWRing & operator = ( const GWRing & );
+
+        std :: string m_path;
+        Header * m_hdr;
+        uint8_t * m_data;
+        size_t m_page;
+        size_t m_size;
+
+        uint64_t m_head;        // producer: bytes written
+        uint64_t m_published;   // producer: bytes visible to the consumer
+        uint64_t m_tail;        // consumer: bytes consumed
+        uint64_t m_released;    // consumer: bytes returned to the producer
+
+        uint64_t m_backoff;
+        bool m_producer;
+    };
+}
+
+#endif // _hpp_gw_ring_
@@ -0,0 +1,154 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/*
+    Benchmark of the fasterq-dump defline-formatter ( var_fmt.c )
+
+    Usage: bench-var-fmt [records, default 5000000]
+
+    Formats synthetic records with the default defline, the default
+    FASTQ-record ( defline + read + quality ) and a custom --seq-defline,
+    reports records per second for each of them.
+*/
+
+#include <kapp/main.h>
+#include <kapp/args.h>
+
+#include <klib/out.h>
+#include <klib/rc.h>
+#include <klib/text.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "var_fmt.h"
+#include "dflt_defline.h"
+
+const char UsageDefaultName[] = "bench-var-fmt";
+
+rc_t CC UsageSummary ( const char * progname ) {
+    return KOutMsg( "\nUsage:\n %s [records]\n\n", progname );
+}
+
+rc_t CC Usage ( const Args * args ) {
+    return UsageSummary( UsageDefaultName );
+}
+
+/* the same variables and indices as flex_printer.c uses */
+enum { sdi_acc, sdi_sn, sdi_sg, sdi_rd1, sdi_rd2, sdi_qa, sdi_count };
+enum { idi_si, idi_ri, idi_rl, idi_count };
+
+static struct vfmt_desc_list_t * make_vars( void ) {
+    struct vfmt_desc_list_t * res = vfmt_create_desc_list();
+    if ( NULL != res ) {
+        vfmt_add_str_to_desc_list( res, "$ac",  sdi_acc, 0xFF );
+        vfmt_add_str_to_desc_list( res, "$sn",  sdi_sn,  idi_si );
+        vfmt_add_str_to_desc_list( res, "$sg",  sdi_sg,  0xFF );
+        vfmt_add_str_to_desc_list( res, "$RD1", sdi_rd1, 0xFF );
+        vfmt_add_str_to_desc_list( res, "$RD2", sdi_rd2, 0xFF );
+        vfmt_add_str_to_desc_list( res, "$QA",  sdi_qa,  0xFF );
+        vfmt_add_int_to_desc_list( res, "$si",  idi_si );
+        vfmt_add_int_to_desc_list( res, "$ri",  idi_ri );
+        vfmt_add_int_to_desc_list( res, "$rl",  idi_rl );
+    }
+    return res;
+}
+
+static double seconds( void ) {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts . tv_sec + ts . tv_nsec * 1e-9;
+}
+
+static rc_t bench( const char * name, const char * fmt, const struct vfmt_desc_list_t * vars, uint64_t count ) {
+    rc_t rc = 0;
+    String FMT;
+    struct vfmt_t * vfmt;
+    StringInitCString( &FMT, fmt );
+    vfmt = vfmt_create( &FMT, vars );
+    if ( NULL == vfmt ) {
+        rc = RC( rcExe, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+    } else {
+        char read[ 151 ], qual[ 151 ];
+        String S[ sdi_count ];
+        const String * str_args[ sdi_count ];
+        uint64_t int_args[ idi_count ];
+        uint64_t row, total = 0;
+        uint32_t i;
+        double start;
+
+        for ( i = 0; i < sizeof read; ++i ) {
+            read[ i ] = "ACGT"[ ( i * 7 ) & 3 ];
+            qual[ i ] = ( char )( '!' + ( i % 41 ) );
+        }
+        StringInitCString( &S[ sdi_acc ], "SRR1234567" );
+        StringInitCString( &S[ sdi_sn ], "HWI-ST1234:8:1101:15589:2104" );
+        StringInitCString( &S[ sdi_sg ], "GROUP1" );
+        StringInit( &S[ sdi_rd1 ], read, sizeof read, sizeof read );
+        StringInit( &S[ sdi_rd2 ], read, sizeof read, sizeof read );
+        StringInit( &S[ sdi_qa ], qual, sizeof qual, sizeof qual );
+        for ( i = 0; i < sdi_count; ++i ) { str_args[ i ] = &S[ i ]; }
+
+        start = seconds();
+        for ( row = 1; row <= count; ++row ) {
+            SBuffer_t * t;
+            int_args[ idi_si ] = row;
+            int_args[ idi_ri ] = 1 + ( row & 1 );
+            int_args[ idi_rl ] = sizeof read;
+            t = vfmt_write_to_buffer( vfmt, str_args, sdi_count, int_args, idi_count );
+            if ( NULL != t ) { total += t -> S . len; }
+        }
+        {
+            double elapsed = seconds() - start;
+            rc = KOutMsg( "%-16s %-40s %8.2f M records/s ( %lu bytes )\n",
+                          name, fmt, ( double )count / elapsed / 1e6, total );
+        }
+        vfmt_release( vfmt );
+    }
+    return rc;
+}
+
+rc_t CC KMain( int argc, char *argv [] ) {
+    rc_t rc = 0;
+    uint64_t count = ( argc > 1 ) ? strtoull( argv[ 1 ], NULL, 10 ) : 5000000;
+    struct vfmt_desc_list_t * vars = make_vars();
+    if ( NULL == vars ) {
+        rc = RC( rcExe, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+    } else {
+        const char * dflt = dflt_seq_defline( true, true, true, false ); /* dflt_defline.c */
+        rc = bench( "default", dflt, vars, count );
+        if ( 0 == rc ) {
+            rc = bench( "default-record", "@$ac.$si/$ri $sn length=$rl\n$RD1\n+$ac.$si/$ri $sn length=$rl\n$QA\n",
+                        vars, count );
+        }
+        if ( 0 == rc ) {
+            rc = bench( "custom", "@$sn:$sg:$si:read=$ri:length=$rl", vars, count );
+        }
+        vfmt_release_desc_list( vars );
+    }
+    return rc;
+}
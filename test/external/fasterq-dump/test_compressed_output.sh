@@ -0,0 +1,85 @@
+# ================================================================
+#
+#   Test : compressed output
+#
+#   the flat table ERR3487613 is dumped with --fasta-unsorted,
+#   --split-3 and --split-spot to stdout: uncompressed, as gzip
+#   and as bgzf - the decompressed output has to be identical
+#   to the uncompressed one
+#
+# ================================================================
+
+set -e
+
+BINDIR="$1"
+
+FASTERQDUMP="${BINDIR}/fasterq-dump"
+if [[ ! -x $FASTERQDUMP ]]; then
+    echo "${FASTERQDUMP} not found - exiting..."
+    exit 3
+fi
+
+FLAT_TABLE_ACC="ERR3487613"
+if [[ ! -f $FLAT_TABLE_ACC ]]; then
+    echo "${FLAT_TABLE_ACC} not found here - exiting..."
+    exit 3
+fi
+
+PLAIN="${FLAT_TABLE_ACC}.compress_test.fasta"
+CMD="${FASTERQDUMP} ./${FLAT_TABLE_ACC} --fasta-unsorted -f -o ${PLAIN}"
+eval "${CMD}"
+
+for MODE in gzip bgzf; do
+    COMPRESSED="${PLAIN}.${MODE}.gz"
+    CMD="${FASTERQDUMP} ./${FLAT_TABLE_ACC} --fasta-unsorted -f --compress ${MODE} -o ${COMPRESSED}"
+    eval "${CMD}"
+    if ! gzip -dc "${COMPRESSED}" | cmp -s - "${PLAIN}"; then
+        echo "error: decompressed ${MODE}-output differs from uncompressed output"
+        exit 1
+    fi
+    echo "${MODE}-output ok"
+    rm -f "${COMPRESSED}"
+done
+
+#the FASTQ-modes are compressed in the final concatenation
+PLAIN_FQ="${FLAT_TABLE_ACC}.compress_test.fastq"
+CMD="${FASTERQDUMP} ./${FLAT_TABLE_ACC} --split-3 -f -o ${PLAIN_FQ}"
+eval "${CMD}"
+for MODE in gzip bgzf; do
+    COMPRESSED="${FLAT_TABLE_ACC}.compress_test.${MODE}.fastq.gz"
+    CMD="${FASTERQDUMP} ./${FLAT_TABLE_ACC} --split-3 -f --compress ${MODE} -o ${COMPRESSED}"
+    eval "${CMD}"
+    #'x.fastq' -> 'x_1.fastq', 'x.fastq.gz' -> 'x_1.fastq.gz'
+    for SUFFIX in "" "_1" "_2"; do
+        PLAIN_PART="${FLAT_TABLE_ACC}.compress_test${SUFFIX}.fastq"
+        COMPRESSED_PART="${FLAT_TABLE_ACC}.compress_test.${MODE}${SUFFIX}.fastq.gz"
+        if [[ -f "${PLAIN_PART}" ]]; then
+            if ! gzip -dc "${COMPRESSED_PART}" | cmp -s - "${PLAIN_PART}"; then
+                echo "error: decompressed ${MODE}-output of --split-3 differs for '${PLAIN_PART}'"
+                exit 1
+            fi
+        elif [[ -f "${COMPRESSED_PART}" ]]; then
+            echo "error: '${COMPRESSED_PART}' has no uncompressed counterpart"
+            exit 1
+        fi
+        rm -f "${COMPRESSED_PART}"
+    done
+    echo "${MODE}-output of --split-3 ok"
+
+    if ! eval "${FASTERQDUMP} ./${FLAT_TABLE_ACC} --split-spot --stdout --compress ${MODE}" | \
+        gzip -dc | cmp -s - <( eval "${FASTERQDUMP} ./${FLAT_TABLE_ACC} --split-spot --stdout" ); then
+        echo "error: decompressed ${MODE}-output of --split-spot --stdout differs"
+        exit 1
+    fi
+    echo "${MODE}-output of --split-spot --stdout ok"
+done
+rm -f "${FLAT_TABLE_ACC}".compress_test*.fastq
+
+#a compressed file cannot be appended to
+if eval "${FASTERQDUMP} ./${FLAT_TABLE_ACC} --fasta -f --append --compress gzip -o ${PLAIN}.gz"; then
+    echo "error: --compress should be rejected together with --append"
+    exit 1
+fi
+
+rm -f "${PLAIN}" "${PLAIN}.gz"
+echo "success testing compressed output"
@@ -0,0 +1,100 @@
+#!/bin/bash
+# ================================================================
+#
+#   Test : fastq-dump --threads
+#
+#   dumping chunks of spots on parallel threads has to produce
+#   the same files and the same report ( spots read/written,
+#   rejected by filters ) as dumping them on a single thread
+#
+#   the run is loaded by latf-load from a generated fastq-file,
+#   with enough spots to be split into several chunks
+#
+# ================================================================
+
+DIRTOTEST="$1"
+BINDIR="$2"
+
+FASTQDUMP="${DIRTOTEST}/fastq-dump"
+if [[ ! -x $FASTQDUMP ]]; then
+    echo "${FASTQDUMP} not found - exiting..."
+    exit 3
+fi
+
+LATFLOAD="${DIRTOTEST}/latf-load"
+if [[ ! -x $LATFLOAD ]]; then
+    LATFLOAD="${BINDIR}/latf-load"
+    if [[ ! -x $LATFLOAD ]]; then
+        echo "${LATFLOAD} not found - exiting(skipped)..."
+        exit 0
+    fi
+fi
+
+echo -e "\ntesting ${FASTQDUMP} --threads"
+
+TEMPDIR="actual"
+rm -rf $TEMPDIR
+mkdir -p $TEMPDIR
+
+#   paired spots of varying read length in 3 spot groups
+INPUT="${TEMPDIR}/input.fastq"
+awk 'BEGIN {
+    B = "ACGTACGTTGCATGCAACGTACGTTGCATGCAACGTACGTTGCATGCAACGTACGTTGCATGCAACGTACGTTGCA";
+    Q = "IIIIIHHHHHGGGGGFFFFFEEEEEDDDDDCCCCCBBBBBAAAAA@@@@@?????>>>>>";
+    split( "ACGT TTAG GGCC", G, " " );
+    for ( i = 1; i <= 100000; i++ ) {
+        l1 = 20 + i % 40;
+        l2 = 15 + ( i * 7 ) % 40;
+        g = G[ i % 3 + 1 ];
+        printf( "@R%d#%s/1\n%s\n+\n%s\n", i, g, substr( B, 1 + i % 3, l1 ), substr( Q, 1, l1 ) );
+        printf( "@R%d#%s/2\n%s\n+\n%s\n", i, g, substr( B, 1 + i % 5, l2 ), substr( Q, 1, l2 ) );
+    }
+}' > $INPUT
+
+RUN="${TEMPDIR}/run"
+CMD="${LATFLOAD} --quality PHRED_33 -o ${RUN} ${INPUT}"
+eval "${CMD}" > ${TEMPDIR}/load.stdout 2>&1
+if [ "$?" != "0" ]; then
+    echo "${CMD} FAILED"
+    cat ${TEMPDIR}/load.stdout
+    exit 1
+fi
+
+function run_test_threads() {
+    local test_id=$1
+    local test_args=$2
+    local t
+
+    for t in 1 4; do
+        local out="${TEMPDIR}/${test_id}.${t}"
+        mkdir -p $out
+        CMD="${FASTQDUMP} --threads ${t} ${test_args} -O ${out}/files ${RUN}"
+        eval "${CMD}" > ${out}/stdout 2>${out}/stderr
+        if [ "$?" != "0" ]; then
+            echo "${CMD} FAILED"
+            cat ${out}/stderr
+            exit 1
+        fi
+    done
+
+    diff -r "${TEMPDIR}/${test_id}.1" "${TEMPDIR}/${test_id}.4" > ${TEMPDIR}/${test_id}.diff
+    if [ "$?" != "0" ]; then
+        echo "fastq-dump ${test_args} ( ${test_id} ) FAILED, --threads 1 and 4 differ:"
+        head -n 20 ${TEMPDIR}/${test_id}.diff
+        exit 1
+    fi
+    echo "run_test_threads ${test_id} done"
+}
+
+run_test_threads 1.0 ""
+run_test_threads 1.1 "--split-spot"
+run_test_threads 1.2 "--split-files"
+run_test_threads 1.3 "--split-3"
+# filters report their rejected counts once, as on a single thread
+run_test_threads 2.0 "--split-spot -M 30"
+run_test_threads 2.1 "--split-files -M 30 --spot-group"
+run_test_threads 2.2 "--split-3 -M 30 --spot-group -N 1000 -X 90000"
+run_test_threads 3.0 "-Z --split-spot -M 30"
+
+rm -rf $TEMPDIR
+echo "fastq-dump --threads test done"
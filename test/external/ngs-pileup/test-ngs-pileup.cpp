@@ -106,6 +106,77 @@ FIXTURE_TEST_CASE ( SingleReference_Slice, NGSPileupFixture )
     REQUIRE_EQ ( expected, Run().substr(0, expected.size()) );
 }
 
+FIXTURE_TEST_CASE ( SingleReference_Slices_Threads, NGSPileupFixture )
+{   // output of several threads comes in the same order as of a single one
+    ps . AddInput ( "ERR247027" );
+    ps . AddReferenceSlice ( "AL844509.2", 1212492, 3 );
+    ps . AddReferenceSlice ( "AL844509.2", 0, 3000000 );
+    ps . AddReference ( "Pf3D7_14" );
+    string expected = Run ();
+
+    m_str . str ( string () );
+    ps . threads = 4;
+    REQUIRE_EQ ( expected, Run () );
+}
+
+FIXTURE_TEST_CASE ( SingleReference_OverlappingSlices, NGSPileupFixture )
+{   // no position is printed twice
+    ps . AddInput ( "ERR247027" );
+    ps . AddReferenceSlice ( "AL844509.2", 1212493, 3 );
+    ps . AddReferenceSlice ( "AL844509.2", 1212492, 2 );
+    string expected =
+        "AL844509.2\t1212494\t1\n"
+        "AL844509.2\t1212495\t1\n";
+    REQUIRE_EQ ( expected, Run().substr(0, expected.size()) );
+    REQUIRE_EQ ( string :: npos, m_str . str () . find ( expected, 1 ) );
+}
+
+FIXTURE_TEST_CASE ( Region_Slice, NGSPileupFixture )
+{
+    ps . AddInput ( "ERR247027" );
+    ps . AddRegion ( "AL844509.2:1212493-1212495" ); /* 1-based */
+    string expected =
+        "AL844509.2\t1212494\t1\n"
+        "AL844509.2\t1212495\t1\n";
+    REQUIRE_EQ ( expected, Run() );
+}
+
+FIXTURE_TEST_CASE ( Region_Parse, NGSPileupFixture )
+{
+    ps . AddRegion ( "Pf3D7_13" );
+    ps . AddRegion ( "HLA-A*01:01:01:01" );
+    ps . AddRegion ( "HLA-A*01:01:01:01:5-10" );
+    REQUIRE_EQ ( size_t ( 3 ), ps . references . size () );
+
+    REQUIRE ( ps . references [ 0 ] . m_full );
+    REQUIRE_EQ ( string ( "Pf3D7_13" ), ps . references [ 0 ] . m_name );
+
+    // a slice from 1 to the end of "HLA-A*01:01:01", unless there is a reference of the whole name
+    REQUIRE ( ! ps . references [ 1 ] . m_full );
+    REQUIRE_EQ ( string ( "HLA-A*01:01:01" ), ps . references [ 1 ] . m_name );
+    REQUIRE_EQ ( ( int64_t ) 0, ps . references [ 1 ] . m_firstPos );
+    REQUIRE_EQ ( ( int64_t ) -1, ps . references [ 1 ] . m_length );
+    REQUIRE_EQ ( string ( "HLA-A*01:01:01:01" ), ps . references [ 1 ] . m_region );
+
+    REQUIRE_EQ ( string ( "HLA-A*01:01:01:01" ), ps . references [ 2 ] . m_name );
+    REQUIRE_EQ ( ( int64_t ) 4, ps . references [ 2 ] . m_firstPos );
+    REQUIRE_EQ ( ( int64_t ) 6, ps . references [ 2 ] . m_length );
+
+    REQUIRE_THROW ( ps . AddRegion ( "Pf3D7_13:10-5" ) );
+}
+
+FIXTURE_TEST_CASE ( Region_WholeName, NGSPileupFixture )
+{   // "Pf3D7_13:1" is not a reference, "Pf3D7_13" from position 1 is
+    ps . AddInput ( "ERR247027" );
+    ps . AddRegion ( "Pf3D7_13:1" );
+    string expected = Run ();
+
+    m_str . str ( string () );
+    ps . references . clear ();
+    ps . AddReference ( "Pf3D7_13" );
+    REQUIRE_EQ ( expected, Run () );
+}
+
 #if 0
 FIXTURE_TEST_CASE ( MultipleReferences, NGSPileupFixture )
 {
@@ -53,6 +53,32 @@ function run_test_neg() {
 	echo run_test $test_id done
 }
 
+function run_test_threads() {
+	local test_id=$1
+	local test_args=$2
+
+	local output=actual/$test_id.stdout
+
+	${bin_dir}/${vdb_dump_binary} $test_args > $output.single 2>actual/$test_id.stderr
+	local res=$?
+	if [ "$res" != "0" ];
+		then echo "${vdb_dump_binary} $test_args ($test_name $test_id) FAILED, res=$res output=$output.single" && exit 1;
+	fi
+
+	${bin_dir}/${vdb_dump_binary} $test_args --threads 4 > $output 2>>actual/$test_id.stderr
+	res=$?
+	if [ "$res" != "0" ];
+		then echo "${vdb_dump_binary} $test_args --threads 4 ($test_name $test_id) FAILED, res=$res output=$output" && exit 1;
+	fi
+
+	diff $output.single $output >actual/$test_id.diff
+	res=$?
+	if [ "$res" != "0" ];
+		then echo "${vdb_dump_binary} $test_name ($test_id) FAILED, res=$res diff=$(cat actual/$test_id.diff)" && exit 1;
+	fi
+	echo run_test $test_id done
+}
+
 #TODO: fail if multiple tables and/or views are requested
 
 # output format
@@ -114,6 +140,11 @@ run_test "6.1" "data/ViewDatabase -T VIEW3"
 # 7.0 symbolic names for various platforms
 run_test "7.0" "input/platforms -C PLATFORM"
 
+# 8.x rows dumped on several threads come out the same as on one thread
+run_test_threads "8.0" "SRR056386 -R 1-10000 -C READ,NAME"
+run_test_threads "8.1" "SRR056386 -R 1-10000 -C READ,NAME -f json"
+run_test_threads "8.2" "SRR056386 -R 1-3000,5000-15000 -C READ -f csv"
+
 rm -rf actual
 # keep the test database for the other tests that might follow (e.g. Test_Vdb_dump_view-alias - see CMakeLists.txt)
 #rm -rf data
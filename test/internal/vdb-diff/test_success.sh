@@ -9,6 +9,18 @@ $BINDIR/vdb-copy $ACCESSION A1 -R 1-10
 $BINDIR/vdb-copy $ACCESSION A2 -R 1-10
 $BINDIR/${vdb_diff} A1 A2
 RESULT="$?"
+if [ $RESULT -eq 0 ]; then
+    $BINDIR/${vdb_diff} A1 A2 --blobs
+    RESULT="$?"
+fi
+if [ $RESULT -eq 0 ]; then
+    $BINDIR/${vdb_diff} A1 A2 --threads 4
+    RESULT="$?"
+fi
+if [ $RESULT -eq 0 ]; then
+    $BINDIR/${vdb_diff} A1 A2 --threads 4 -c
+    RESULT="$?"
+fi
 rm -rf A1 A2
 
 if [ $RESULT -eq 0 ]; then
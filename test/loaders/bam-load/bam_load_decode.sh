@@ -0,0 +1,81 @@
+#!/usr/bin/env bash
+
+# the goal of this test is to verify that bam-load produces the same
+# output when the records are decoded and compared to the reference on
+# the worker threads ( default ) as when this is done on the main thread
+# ( --serial-decode )
+#
+# the test uses the sam-factory-tool to produce a random SAM-file
+# and vdb-dump to compare the content of every table of both loads
+#
+
+set -e
+
+BINDIR="$1"
+REALDIR="$2"
+BAMLOAD="${BINDIR}/bam-load"
+VDBDUMP="${BINDIR}/vdb-dump"
+SAMFACTORY="${REALDIR}/sam-factory"
+
+for TOOL in $BAMLOAD $VDBDUMP $SAMFACTORY
+do
+    if [[ ! -x "$TOOL" ]]; then
+        echo "$TOOL - executable not found"
+        exit 3
+    fi
+done
+
+#------------------------------------------------------------
+#produce a random sam-file
+
+RNDSAM="rnd_sam_decode.SAM"
+RNDREF="rnd-ref-decode.fasta"
+
+rm -f "$RNDSAM" "$RNDREF"
+
+#two references, secondary alignments and unaligned reads, so that
+#every table of the cSRA-object has rows
+$SAMFACTORY << EOF2
+r:type=random,name=R1,length=6000
+r:type=random,name=R2,length=4000
+ref-out:$RNDREF
+sam-out:$RNDSAM
+p:name=A,repeat=2000
+p:name=A,repeat=2000
+p:name=B,ref=R2,repeat=1000
+p:name=B,ref=R2,repeat=1000
+s:name=B,ref=R2,repeat=1000
+u:name=U1,len=50
+u:name=U2,len=60
+EOF2
+
+if [[ ! -f "$RNDSAM" ]]; then
+    echo "$RNDSAM not produced"
+    exit 3
+fi
+
+#------------------------------------------------------------
+#load on the worker threads and on the main thread
+
+BATCHED="decode_batched"
+SERIAL="decode_serial"
+
+rm -rf $BATCHED $SERIAL
+VDB_CONFIG=`pwd` $BAMLOAD $RNDSAM --ref-file $RNDREF --output $BATCHED
+VDB_CONFIG=`pwd` $BAMLOAD $RNDSAM --ref-file $RNDREF --output $SERIAL --serial-decode
+
+#------------------------------------------------------------
+#compare the content of every table
+
+for TBL in SEQUENCE PRIMARY_ALIGNMENT SECONDARY_ALIGNMENT REFERENCE
+do
+    VDB_CONFIG=`pwd` $VDBDUMP -T $TBL ./$BATCHED > dump_batched.txt 2>/dev/null || true
+    VDB_CONFIG=`pwd` $VDBDUMP -T $TBL ./$SERIAL > dump_serial.txt 2>/dev/null || true
+    if ! cmp -s dump_batched.txt dump_serial.txt; then
+        echo "table $TBL differs between the batched and the serial decoding"
+        diff dump_batched.txt dump_serial.txt | head -20
+        exit 3
+    fi
+done
+
+rm -rf $BATCHED $SERIAL $RNDSAM $RNDREF dump_batched.txt dump_serial.txt
@@ -0,0 +1,326 @@
+/*===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ */
+
+/**
+* Differential tests of SAM2BAM_Parser_parse_fast against SAM2BAM_Parser_parse:
+* whatever the fast parser accepts must come out as the same BAM bytes,
+* whatever it does not accept must be left to the full parser without an error
+*/
+
+#include <ktst/unit_test.hpp>
+
+#include <klib/rc.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "sam.h"
+}
+
+using namespace std;
+
+TEST_SUITE(SamParseTestSuite);
+
+/* same as the lookup of bam.c, the names must be sorted */
+struct RefNameLookupContext {
+    char const *const *names;
+    unsigned count;
+    unsigned first;
+    unsigned last;
+    unsigned depth;
+};
+
+static bool Lookup(RefNameLookupContext *const self, int const ch, int32_t *const result, rc_t *const rc)
+{
+    if (ch < 0) {
+        *result = self->first;
+        if (self->depth == 0 || self->last <= self->first) {
+            *rc = RC(rcAlign, rcFile, rcReading, rcRow, rcInvalid);
+            return false;
+        }
+        self->depth = 0;
+    }
+    else {
+        unsigned const depth = self->depth++;
+        unsigned f = depth == 0 ? 0 : self->first;
+        unsigned e = depth == 0 ? self->count : self->last;
+        unsigned const save = e;
+
+        while (f < e) {
+            unsigned const m = ((e - f) >> 1) + f;
+            if (self->names[m][depth] < ch)
+                f = m + 1;
+            else
+                e = m;
+        }
+        if (f >= self->count || self->names[f][depth] != ch)
+            goto NOT_FOUND;
+
+        e = save;
+        self->first = f;
+        while (f < e) {
+            unsigned const m = ((e - f) >> 1) + f;
+            if (self->names[m][depth] <= ch)
+                f = m + 1;
+            else
+                e = m;
+        }
+        self->last = e;
+        if (self->first == self->last) {
+        NOT_FOUND:
+            *rc = RC(rcAlign, rcFile, rcReading, rcRow, rcInvalid);
+            return false;
+        }
+    }
+    return true;
+}
+
+static char const *const References[] = { "chr1", "chr10", "chr2", "chrX" };
+
+struct Parsed {
+    bool ok = false;
+    rc_t rc = 0;
+    int field = 0;
+    vector<uint8_t> bytes;
+};
+
+class SamParseFixture
+{
+public:
+    /* line is tab separated, split the way bam.c does */
+    Parsed Parse(string const &line, bool fast)
+    {
+        vector<char> data(line.begin(), line.end());
+        vector<unsigned> offsets;
+
+        data.push_back('\t');
+        for (size_t i = 0; i < data.size(); ++i) {
+            if (data[i] == '\t') {
+                data[i] = '\0';
+                offsets.push_back((unsigned)(i + 1));
+            }
+        }
+        RefNameLookupContext ctx = { References, sizeof(References) / sizeof(References[0]), 0, 0, 0 };
+        Parsed result;
+        SAM2BAM_Parser *const parser = (fast ? SAM2BAM_Parser_parse_fast : SAM2BAM_Parser_parse)
+            (data.data(), (unsigned)offsets.size(), offsets.data(), m_buffer, sizeof(m_buffer), Lookup, &ctx, &result.rc);
+        if (parser != NULL) {
+            result.ok = result.rc == 0;
+            result.field = parser->field;
+            if (result.ok)
+                result.bytes.assign((uint8_t const *)parser->rslt, (uint8_t const *)parser->rslt + parser->rslt_size);
+            if ((void *)parser->rslt != (void *)m_buffer)
+                free(parser->rslt);
+            free(parser);
+        }
+        return result;
+    }
+
+    /* the fast parser either agrees with the full parser or leaves the record to it */
+    bool Agrees(string const &line, bool *const fast_ok = NULL)
+    {
+        Parsed const fast = Parse(line, true);
+        if (fast_ok != NULL)
+            *fast_ok = fast.ok;
+        if (!fast.ok)
+            return fast.rc == 0;
+        Parsed const full = Parse(line, false);
+        return full.ok && full.field == fast.field && full.bytes == fast.bytes;
+    }
+
+    bool Fast(string const &line)
+    {
+        bool fast_ok = false;
+        return Agrees(line, &fast_ok) && fast_ok;
+    }
+
+    bool Fallback(string const &line)
+    {
+        bool fast_ok = true;
+        return Agrees(line, &fast_ok) && !fast_ok;
+    }
+
+    /* replaces field i of a tab separated line */
+    static string With(string const &line, unsigned i, string const &value)
+    {
+        size_t start = 0;
+        for (unsigned f = 0; f < i; ++f)
+            start = line.find('\t', start) + 1;
+        size_t const end = line.find('\t', start);
+        return line.substr(0, start) + value + (end == string::npos ? "" : line.substr(end));
+    }
+
+    static string const Record;
+
+private:
+    uint8_t m_buffer[64 * 1024];
+};
+
+string const SamParseFixture::Record = "r1\t99\tchr10\t1234\t60\t4M\t=\t1300\t70\tACGT\tIIII";
+
+FIXTURE_TEST_CASE(CommonRecord, SamParseFixture)
+{
+    REQUIRE(Fast(Record));
+    REQUIRE(Fast(Record + "\tNM:i:0\tMD:Z:4\tRG:Z:grp1"));
+    REQUIRE(Fast("SRR000001.1\t0\tchrX\t1\t0\t2S5M1I3M2D4M1N2M1P2=3X2H\tchr2\t1\t-2147483648\tACGTACGTACGTACGTACGTA\tIIIIIIIIIIIIIIIIIIIII"));
+    REQUIRE(Fast("r1\t65535\tchr1\t2147483648\t255\t268435455M\tchr1\t2147483648\t2147483647\tA\t!"));
+}
+
+FIXTURE_TEST_CASE(StarFields, SamParseFixture)
+{
+    REQUIRE(Fast(With(Record, 0, "*")));
+    REQUIRE(Fast(With(With(Record, 2, "*"), 6, "*")));
+    REQUIRE(Fast(With(Record, 2, "*")));
+    REQUIRE(Fast(With(Record, 5, "*")));
+    REQUIRE(Fast(With(Record, 6, "*")));
+    REQUIRE(Fast(With(Record, 10, "*")));
+    REQUIRE(Fast(With(With(Record, 9, "*"), 10, "*")));
+    REQUIRE(Fast("*\t4\t*\t0\t0\t*\t*\t0\t0\t*\t*"));
+}
+
+FIXTURE_TEST_CASE(EmptyFields, SamParseFixture)
+{
+    for (unsigned i = 0; i < 11; ++i)
+        REQUIRE(Agrees(With(Record, i, "")));
+    REQUIRE(Agrees(Record + "\t"));
+    REQUIRE(Agrees(Record + "\t\tNM:i:0"));
+    REQUIRE(Agrees("\t\t\t\t\t\t\t\t\t\t"));
+}
+
+FIXTURE_TEST_CASE(OddLengthSequence, SamParseFixture)
+{
+    REQUIRE(Fast(With(With(With(Record, 5, "1M"), 9, "A"), 10, "I")));
+    REQUIRE(Fast(With(With(With(Record, 5, "3M"), 9, "ACG"), 10, "III")));
+    REQUIRE(Fast(With(With(With(Record, 5, "5M"), 9, "acgtn"), 10, "*")));
+    REQUIRE(Fast(With(With(With(Record, 5, "7M"), 9, "NRYK=.M"), 10, "!#%')+-")));
+}
+
+FIXTURE_TEST_CASE(EveryTagType, SamParseFixture)
+{
+    static char const *const tags[] = {
+        "XA:A:c", "XA:A:~",
+        "NM:i:0", "XI:i:-1", "XI:i:127", "XI:i:-128", "XI:i:255", "XI:i:256", "XI:i:-32768", "XI:i:65535",
+        "XI:i:65536", "XI:i:2147483647", "XI:i:-2147483648",
+        "XF:f:1.5", "XF:f:-2e-3", "XF:f:0", "XF:f:3.4e38", "XF:f:1E+2",
+        "RG:Z:grp 1", "RG:Z:", "XZ:Z:!~",
+        "XH:H:0AFF", "XH:H:",
+        "XB:B:c,-128,127", "XB:B:C,0,255", "XB:B:s,-32768,32767", "XB:B:S,0,65535",
+        "XB:B:i,-2147483648,2147483647", "XB:B:I,0,4294967295", "XB:B:f,1.5,-2,0", "XB:B:C", "XB:B:i,-1",
+    };
+    string all = Record;
+    for (auto tag : tags) {
+        REQUIRE(Fast(Record + "\t" + tag));
+        all += "\t";
+        all += tag;
+    }
+    REQUIRE(Fast(all));
+}
+
+FIXTURE_TEST_CASE(FallbackInputs, SamParseFixture)
+{
+    /* signs, overflows and lookup misses are left to the full parser */
+    REQUIRE(Fallback(With(Record, 1, "+4")));
+    REQUIRE(Fallback(With(Record, 1, "65536")));
+    REQUIRE(Fallback(With(Record, 2, "chr3")));
+    REQUIRE(Fallback(With(Record, 3, "+1")));
+    REQUIRE(Fallback(With(Record, 3, "2147483649")));
+    REQUIRE(Fallback(With(Record, 4, "256")));
+    REQUIRE(Fallback(With(Record, 5, "M")));
+    REQUIRE(Fallback(With(Record, 5, "4Q")));
+    REQUIRE(Fallback(With(Record, 5, "268435456M")));
+    REQUIRE(Fallback(With(Record, 6, "chr9")));
+    REQUIRE(Fallback(With(Record, 8, "+5")));
+    REQUIRE(Fallback(With(Record, 8, "2147483648")));
+    REQUIRE(Fallback(With(Record, 9, "AC1T")));
+    REQUIRE(Fallback(With(Record, 10, "III")));
+    REQUIRE(Fallback(With(Record, 10, "II I")));
+    REQUIRE(Fallback(With(Record, 0, "@r1")));
+    REQUIRE(Fallback("r1\t0\tchr1\t1\t60\t4M\t=\t1\t0\tACGT"));
+
+    static char const *const tags[] = {
+        "XA:A:", "XA:A:cd", "AS:i:+3", "XX:i:2147483648", "XH:H:0A1", "XH:H:0a", "XF:f:", "XF:f:x", "XF:f:.5",
+        "XB:B:q,1", "XB:B:I,1,,2", "XB:B:I,1,", "XB:B:C,4294967296", "XB:B:s,+1",
+        "1X:i:1", "X:i:1", "XY", "XY:q:1",
+    };
+    for (auto tag : tags)
+        REQUIRE(Fallback(Record + "\t" + tag));
+}
+
+FIXTURE_TEST_CASE(Fuzzed, SamParseFixture)
+{
+    static char const *const qname[] = { "r1", "read/1", "*", "", "a@b", "x:y:z", "@bad", "r\x7f" };
+    static char const *const flag[] = { "0", "16", "65535", "65536", "+4", "-1", "1.0", "", "4x" };
+    static char const *const rname[] = { "chr1", "chr10", "chr2", "chrX", "*", "chr", "chr3", "", "*x", "chr1x", "=" };
+    static char const *const pos[] = { "1", "0", "", "100", "2147483648", "2147483649", "-1", "+1", "12a" };
+    static char const *const mapq[] = { "60", "255", "256", "", "0", "x" };
+    static char const *const cigar[] = { "10M", "*", "", "5S3M2I", "2=3X1P1H", "10M1D0N", "M", "3", "3Q", "268435455M", "1M*", "+3M" };
+    static char const *const rnext[] = { "*", "=", "chr2", "chr9", "", "=x" };
+    static char const *const tlen[] = { "0", "-100", "2147483647", "-2147483648", "2147483648", "+5", "", "-", "1e2" };
+    static char const *const tags[] = {
+        "NM:i:0", "NM:i:-5", "XA:A:c", "RG:Z:grp 1", "RG:Z:", "XH:H:0AFF", "XF:f:1.5", "XF:f:-2e-3", "XB:B:C,1,2,3",
+        "XB:B:i,-1,2", "XB:B:f,1.5,-2", "XB:B:c", "XB:B:C,4294967295", "", "XH:H:", "AS:i:+3", "XB:B:s,+1",
+        "XA:A:", "XA:A:cd", "XH:H:0A1", "XF:f:", "XF:f:x", "XB:B:I,1,,2", "XB:B:q,1", "1X:i:1", "XY", "XX:i:2147483648",
+    };
+    static char const bases[] = "ACGTNacgtn=.RYK1 ";
+    mt19937 rng(1);
+    auto pick = [&](auto const &values) -> string {
+        size_t const n = sizeof(values) / sizeof(values[0]);
+        return values[rng() % 8 != 0 ? rng() % 3 : rng() % n];
+    };
+    unsigned accepted = 0;
+
+    for (unsigned iter = 0; iter < 100000; ++iter) {
+        string line = pick(qname) + "\t" + pick(flag) + "\t" + pick(rname) + "\t" + pick(pos) + "\t" + pick(mapq)
+                    + "\t" + pick(cigar) + "\t" + pick(rnext) + "\t" + pick(pos) + "\t" + pick(tlen);
+        unsigned const len = rng() % 40;
+        string seq, qual;
+        for (unsigned i = 0; i < len; ++i) {
+            seq += bases[rng() % 8 != 0 ? rng() % 15 : rng() % (sizeof(bases) - 1)];
+            qual += (char)('!' + rng() % (rng() % 8 != 0 ? 94 : 96));
+        }
+        if (rng() % 8 == 0)
+            qual.resize(rng() % (len + 1));
+        line += "\t" + (seq.empty() ? string("*") : seq) + "\t" + (rng() % 4 == 0 ? string("*") : qual);
+        for (unsigned i = rng() % 4; i != 0; --i)
+            line += "\t" + pick(tags);
+
+        bool fast_ok = false;
+        if (!Agrees(line, &fast_ok))
+            FAIL(("parse_fast differs from parse: " + line).c_str());
+        accepted += fast_ok ? 1 : 0;
+    }
+    /* the common spellings are picked most of the time */
+    REQUIRE_GT(accepted, 10000u);
+}
+
+int main(int argc, char *argv[])
+{
+    return SamParseTestSuite(argc, argv);
+}
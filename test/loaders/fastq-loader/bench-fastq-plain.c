@@ -0,0 +1,160 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/*
+    Benchmark of the FASTQ loader's plain record parser ( fastq-reader.c )
+
+    Usage: bench-fastq-plain [size in MB, default 100] [file.fastq]
+
+    Without an input file a synthetic FASTQ with Casava 1.8 tag lines
+    is written to the current directory. The input is read with plain
+    records parsed bypassing the scanner and with the scanner/grammar
+    only, MB/s and records/s are reported for both.
+*/
+
+#include <kapp/main.h>
+#include <kapp/args.h>
+
+#include <klib/out.h>
+#include <klib/rc.h>
+#include <kfs/directory.h>
+#include <loader/common-reader.h>
+
+#include "fastq-parse.h"
+#include "fastq-reader.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+const char UsageDefaultName[] = "bench-fastq-plain";
+
+rc_t CC UsageSummary ( const char * progname ) {
+    return KOutMsg( "\nUsage:\n %s [size in MB] [file.fastq]\n\n", progname );
+}
+
+rc_t CC Usage ( const Args * args ) {
+    return UsageSummary( UsageDefaultName );
+}
+
+static double seconds( void ) {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts . tv_sec + ts . tv_nsec * 1e-9;
+}
+
+static rc_t make_input( const char * path, uint64_t size ) {
+    rc_t rc = 0;
+    FILE * f = fopen( path, "w" );
+    if ( NULL == f ) {
+        rc = RC( rcExe, rcFile, rcCreating, rcFile, rcUnknown );
+    } else {
+        uint64_t written = 0, row;
+        char read[ 151 ], qual[ 151 ];
+        uint32_t seed = 7, i;
+        read[ 150 ] = qual[ 150 ] = 0;
+        for ( row = 1; written < size; ++row ) {
+            int n;
+            for ( i = 0; i < 150; ++i ) {
+                seed = seed * 1103515245 + 12345;
+                read[ i ] = "ACGT"[ ( seed >> 16 ) & 3 ];
+                qual[ i ] = ( char )( '#' + ( ( seed >> 18 ) % 40 ) );
+            }
+            n = fprintf( f, "@HWI-ST1234:8:1101:%lu:%lu %d:N:0:ATCACG\n%s\n+\n%s\n",
+                         row % 20000, row / 20000, 1 + ( int )( row & 1 ), read, qual );
+            if ( n < 0 ) {
+                rc = RC( rcExe, rcFile, rcWriting, rcFile, rcUnknown );
+                break;
+            }
+            written += n;
+        }
+        fclose( f );
+    }
+    return rc;
+}
+
+static rc_t bench( const KDirectory * dir, const char * path, bool plain ) {
+    const ReaderFile * rf;
+    rc_t rc;
+    uint64_t file_size = 0;
+    FASTQ_plain_records = plain;
+    rc = KDirectoryFileSize( dir, &file_size, "%s", path );
+    if ( 0 == rc ) {
+        rc = FastqReaderFileMake( &rf, dir, path, FASTQphred33, 0, false, false );
+    }
+    if ( 0 == rc ) {
+        uint64_t records = 0, rejected = 0, bases = 0;
+        double start = seconds(), elapsed;
+        const Record * record;
+        while ( 0 == ( rc = ReaderFileGetRecord( rf, &record ) ) && NULL != record ) {
+            const Rejected * rej;
+            const Sequence * seq;
+            ++records;
+            if ( 0 == RecordGetRejected( record, &rej ) && NULL != rej ) {
+                ++rejected;
+                RejectedRelease( rej );
+            } else if ( 0 == RecordGetSequence( record, &seq ) && NULL != seq ) {
+                uint32_t length;
+                if ( 0 == SequenceGetReadLength( seq, &length ) ) { bases += length; }
+                SequenceRelease( seq );
+            }
+            RecordRelease( record );
+        }
+        elapsed = seconds() - start;
+        if ( 0 == rc ) {
+            rc = KOutMsg( "%-8s %8.1f MB/s %10.0f records/s ( %lu records, %lu rejected, %lu bases, %.2f s )\n",
+                          plain ? "plain" : "grammar", ( double )file_size / elapsed / ( 1024 * 1024 ),
+                          ( double )records / elapsed, records, rejected, bases, elapsed );
+        }
+        ReaderFileRelease( rf );
+    }
+    return rc;
+}
+
+rc_t CC KMain( int argc, char *argv [] ) {
+    rc_t rc;
+    uint64_t size = ( argc > 1 ) ? strtoull( argv[ 1 ], NULL, 10 ) : 100;
+    const char * path = ( argc > 2 ) ? argv[ 2 ] : "bench-fastq-plain.tmp.fastq";
+    KDirectory * dir;
+    rc = KDirectoryNativeDir( &dir );
+    if ( 0 == rc ) {
+        if ( argc <= 2 ) {
+            rc = make_input( path, size * 1024 * 1024 );
+        }
+        if ( 0 == rc ) {
+            rc = bench( dir, path, false );
+        }
+        if ( 0 == rc ) {
+            rc = bench( dir, path, true );
+        }
+        if ( argc <= 2 ) {
+            KDirectoryRemove( dir, true, "%s", path );
+        }
+        KDirectoryRelease( dir );
+    }
+    return rc;
+}
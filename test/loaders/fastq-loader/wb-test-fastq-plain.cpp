@@ -0,0 +1,455 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/**
+* Differential tests of the FASTQ loader's plain record parser:
+* every input is read with plain records parsed bypassing the scanner
+* and with the scanner/grammar only, both have to produce the same records
+*/
+#include <ktst/unit_test.hpp>
+#include <klib/rc.h>
+#include <loader/common-reader.h>
+#include <kfs/directory.h>
+
+#include "../../tools/loaders/fastq-loader/fastq-parse.h"
+#include "../../tools/loaders/fastq-loader/fastq-reader.h"
+
+#include <sysalloc.h>
+#include <stdlib.h>
+#include <cstring>
+#include <stdexcept>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+TEST_SUITE(FastqLoaderPlainTestSuite);
+
+struct ParseOptions
+{
+    enum FASTQQualityFormat qualityFormat;
+    int8_t defaultReadNumber;
+    bool ignoreSpotGroups;
+};
+
+static const ParseOptions AllOptions[] =
+{
+    { FASTQphred33,  0, false },
+    { FASTQphred33,  1, false },
+    { FASTQphred33,  2, false },
+    { FASTQphred33, -1, false },
+    { FASTQphred33,  0, true  },
+    { FASTQphred64,  0, false },
+    { FASTQphred64,  1, true  },
+    { FASTQlogodds,  0, false },
+    { FASTQlogodds, -1, true  },
+};
+
+/* tag lines of the layouts the plain parser handles, and of the ones it leaves to the grammar */
+static const char* TagLines[] =
+{
+    /* plain names */
+    "@SEQ_ID", "@123", "@a-b_c.d:e", "@name.1", "@a:b:c", "@x",
+    /* /N read numbers */
+    "@name/1", "@name/2", "@name/3", "@name/0", "@name/12", "@name/1 comment", "@name/2\tcomment",
+    "@name/", "@name/x", "@name/1/2",
+    /* spot groups */
+    "@name#ACGT", "@name#0", "@name#ACGT/1", "@name#ACGT/2", "@name#AC_GT-1/1", "@name#", "@name#ACGT/1 extra",
+    "@name#ACGT/1 1", "@name#ACGT/1 1 extra", "@name#ACGT/1 1:N",
+    /* Illumina coordinates */
+    "@HWI-ST1234:8:1101:1234:5678", "@HWUSI-EAS100R:6:73:941:1973#0/1", "@HWUSI-EAS100R:6:73:941:1973#0/2",
+    "@HWUSI-EAS499:1:3:9:1822#CAT/1", "@1:3:9:1822#CAT/1", "@HWI:1:2:3:4 comment", "@HWI:1:2:3:4 1",
+    "@HWI:1:2:3:4:5", "@HWI:1:2:3", "@HWI:1:2:3:4#ACGT", "@HWI:1:2:3:4/1 2:N:0:ACGT",
+    /* Casava 1.8 */
+    "@EAS139:136:FC706VJ:2:2104:15343:197393 1:Y:18:ATCACG",
+    "@EAS139:136:FC706VJ:2:2104:15343:197393 2:N:18:ATCACG",
+    "@EAS139:136:FC706VJ:2:2104:15343:197393 3:N:0:ATCACG",
+    "@EAS139:136:FC706VJ:2:2104:15343:197393 1:N:0:",
+    "@EAS139:136:FC706VJ:2:2104:15343:197393 1:N:0:1",
+    "@EAS139:136:FC706VJ:2:2104:15343:197393 1:N:0:0",
+    "@EAS139:136:FC706VJ:2:2104:15343:197393 1:N:0:ATCACG+GGTACA",
+    "@EAS139:136:FC706VJ:2:2104:15343:197393 1:N:0:atcNN.",
+    "@EAS139:136:FC706VJ:2:2104:15343:197393 1:N:0:ATCACG extra",
+    "@EAS139:136:FC706VJ:2:2104:15343:197393 1:N:0:ATCACG#x",
+    "@EAS139:136:FC706VJ:2:2104:15343:197393 1:N:0:T0123",
+    "@EAS139:136:FC706VJ:2:2104:15343:197393 1:N:0:T01AC",
+    "@EAS139:136:FC706VJ:2:2104:15343:197393 1:N:0",
+    "@EAS139:136:FC706VJ:2:2104:15343:197393 1:N",
+    "@EAS139:136:FC706VJ:2:2104:15343:197393 1",
+    "@EAS139:136:FC706VJ:2:2104:15343:197393 1:",
+    "@EAS139:136:FC706VJ:2:2104:15343:197393 1:N:x:ACGT",
+    "@EAS139:136:FC706VJ:2:2104:15343:197393 x:N:0:ACGT",
+    "@EAS139:136:FC706VJ:2:2104:15343:197393  1:N:0:ACGT",
+    "@EAS139:136:FC706VJ:2:2104:15343:197393\t1:N:0:ACGT",
+    "@EAS139:136:FC706VJ:2:2104:15343:197393#ACGT 1:N:0:ACGT",
+    /* SRR.spot */
+    "@SRR001666.1", "@SRR001666.1 071112_SLXA-EAS1_s_7:5:1:817:345 length=36", "@SRR001666.1.2", "@SRR001666.1.1",
+    "@SRR001666.1/1", "@SRR001666.1/2 extra", "@DRR1.2", "@ERR12.3/2", "@SRR1.", "@SRR.1", "@SRR1.2.x", "@SRR1.2:3",
+    "@XRR1.2",
+    /* left to the grammar */
+    "@name ", "@name\t", "@", "@ name", "@name:ACGT", "@m130404_014004_sidney_c100506902550000001823076808221337_s1_p0/103/0_100",
+    "@name/1:N", "@name|x", "@name=1", "@name 1:N:0:ACGT", "@name,1",
+};
+
+static const char* TagLineRecord = "\n" "GATTACANN\n" "+\n" "IIIIIIIII\n";
+
+/* whole records; the plain parser is to accept the first few only */
+static const char* Records[] =
+{
+    "@r1\nGATT\n+\n!''*\n",                /* qualities below phred64 */
+    "@r1\ngatt.n\n+r1\nIIIIII\n",          /* lower case bases, named '+' line */
+    "@r1\r\nGATT\r\n+\r\nIIII\r\n",        /* CRLF */
+    "@r1\nGATT\n+\nIIII\n\n\n",            /* empty lines following the record */
+    "@r1\nGATT\n+\nIIII",                  /* no end of line at the end of file */
+    "@r1\nGATT\n+\nII~~\n",                /* highest phred33 qualities */
+    "@r1\nGATT\n+\n;;;;\n",                /* lowest logodds qualities */
+    "@r1\nGA\nTT\n+\nIIII\n",              /* multi-line bases */
+    "@r1\nGATT\n+\nII\nII\n",              /* multi-line qualities */
+    "@r1\nGATT\n+\nIII\n",                 /* short qualities */
+    "@r1\nGATT\n+\nIIIII\n",               /* long qualities */
+    "@r1\nG^TT\n+\nIIII\n",                /* bad base */
+    "@r1\n\n+\n\n",                        /* no bases */
+    "@r1\nGATT\n\nIIII\n",                 /* no '+' line */
+    "@r1\nGATT\n-\nIIII\n",                /* bad '+' line */
+    "@r1\nGATT\n+\nII I\n",                /* space in qualities */
+    "@r1\nGATT\n+\n10 20 30 40\n",         /* numeric qualities */
+    "@r1\nT0123\n+\nIIII\n",               /* colorspace */
+    "@r1\nT0123\n+\n!IIII\n",              /* colorspace with a key quality */
+    ">r1\nGATT\n",                         /* FASTA */
+    ">r1\nGATT\n>r2\nACGT\n",
+    "@r1:GATT:IIII\n",                     /* inline read */
+    "@r1\nGATT\n+\nIIII\nx\n",             /* junk after a record */
+    "@r1\nGATT\n+\nIIII\n \n",             /* white space line after a record */
+    "@r1\nGATT\n+\nIIII\n\r\n",
+    "@r1\nGATT\n+\nIIII\r\r\n",
+    "@r1\nGATT\r\n+\nIIII\n",              /* mixed line ends */
+    "\n\n@r1\nGATT\n+\nIIII\n",            /* empty lines before the first record */
+    "@r1\nGATT\n+\nIIII\n@",               /* truncated next record */
+    "@r1\nGATT\n+\nIIII\n@r2\nGATT\n",
+    "@r1\nGATT\n+\nII\x7fI\n",             /* above the highest quality */
+    "@r1\nGATT\n+\nII\x80I\n",
+    "@r1\nGATT\n+\x01\nIIII\n",
+    "@r1\nGA\x00T\n+\nIIII\n",             /* 0 byte */
+};
+
+class PlainFixture
+{
+public:
+    PlainFixture() : wd(0)
+    {
+        if ( KDirectoryNativeDir ( & wd ) != 0 )
+            FAIL("KDirectoryNativeDir failed");
+    }
+    ~PlainFixture()
+    {
+        if ( ! filename.empty() )
+            KDirectoryRemove(wd, true, filename.c_str());
+        if ( KDirectoryRelease ( wd ) != 0 )
+            FAIL("KDirectoryRelease failed");
+        FASTQ_plain_records = true;
+    }
+
+    void CreateFile(const string& name, const string& contents)
+    {
+        filename = name;
+        ofstream f(filename.c_str(), ios::binary);
+        f.write(contents.data(), contents.size());
+        if (!f)
+            throw logic_error("CreateFile: write failed");
+    }
+
+    static string Text(const char* text, size_t length)
+    {
+        return length == 0 ? string() : string(text, length);
+    }
+
+    /* everything the loader takes from a record */
+    static string DescribeSequence(const Sequence* seq)
+    {
+        ostringstream out;
+        const char* text;
+        size_t length;
+        const int8_t* quality = 0;
+        uint8_t offset = 0;
+        int qualType = 0;
+        uint32_t readLength = 0;
+        rc_t rc;
+
+        if (SequenceGetSpotName(seq, &text, &length) != 0)
+            throw logic_error("SequenceGetSpotName failed");
+        out << "name=[" << Text(text, length) << "]";
+        if (SequenceGetSpotGroup(seq, &text, &length) != 0)
+            throw logic_error("SequenceGetSpotGroup failed");
+        out << " group=[" << Text(text, length) << "]";
+        out << " readnumber=" << (int)((const FastqSequence*)seq)->readnumber
+            << " first=" << SequenceIsFirst(seq)
+            << " second=" << SequenceIsSecond(seq)
+            << " paired=" << SequenceWasPaired(seq)
+            << " lowQuality=" << SequenceIsLowQuality(seq);
+
+        if (SequenceIsColorSpace(seq))
+        {
+            char key;
+            if (SequenceGetCSKey(seq, &key) != 0 || SequenceGetCSReadLength(seq, &readLength) != 0)
+                throw logic_error("SequenceGetCSReadLength failed");
+            vector<char> read(readLength + 1);
+            if (SequenceGetCSRead(seq, &read[0]) != 0)
+                throw logic_error("SequenceGetCSRead failed");
+            out << " cs=" << key << "[" << string(&read[0], readLength) << "]";
+            rc = SequenceGetCSQuality(seq, &quality, &offset, &qualType);
+        }
+        else
+        {
+            if (SequenceGetReadLength(seq, &readLength) != 0)
+                throw logic_error("SequenceGetReadLength failed");
+            vector<char> read(readLength + 1);
+            if (SequenceGetRead(seq, &read[0]) != 0)
+                throw logic_error("SequenceGetRead failed");
+            out << " read=[" << string(&read[0], readLength) << "]";
+            rc = SequenceGetQuality(seq, &quality, &offset, &qualType);
+        }
+        out << " quality=" << rc << ":" << (int)offset << "/" << qualType << "[";
+        for (uint32_t i = 0; rc == 0 && quality != 0 && i < readLength; ++i)
+            out << (int)quality[i] << " ";
+        out << "]";
+        return out.str();
+    }
+
+    /* all records of the file, one line per record */
+    string Load(const ParseOptions& opt, bool plain)
+    {
+        ostringstream out;
+        const ReaderFile* rf = 0;
+        FASTQ_plain_records = plain;
+        if (FastqReaderFileMake(&rf, wd, filename.c_str(), opt.qualityFormat, opt.defaultReadNumber, opt.ignoreSpotGroups, false) != 0)
+            throw logic_error("FastqReaderFileMake failed");
+        for (size_t n = 0; n < 1000000; ++n)
+        {
+            const Record* record = 0;
+            const Rejected* reject = 0;
+            const Sequence* seq = 0;
+            if (ReaderFileGetRecord(rf, &record) != 0)
+            {
+                out << "GetRecord failed\n";
+                break;
+            }
+            if (record == 0)
+                break;
+            if (RecordGetRejected(record, &reject) != 0)
+                throw logic_error("RecordGetRejected failed");
+            if (reject != 0)
+            {
+                const char* errorText;
+                uint64_t errorLine, column;
+                bool fatal;
+                const void* data;
+                size_t length;
+                if (RejectedGetError(reject, &errorText, &errorLine, &column, &fatal) != 0 ||
+                    RejectedGetData(reject, &data, &length) != 0)
+                    throw logic_error("RejectedGetError failed");
+                out << "rejected=[" << errorText << "] line=" << errorLine << " column=" << column << " fatal=" << fatal
+                    << " data=[" << Text((const char*)data, length) << "]\n";
+                RejectedRelease(reject);
+                RecordRelease(record);
+                if (fatal)
+                    break;
+                continue;
+            }
+            if (RecordGetSequence(record, &seq) != 0 || seq == 0)
+                throw logic_error("RecordGetSequence failed");
+            out << DescribeSequence(seq) << "\n";
+            SequenceRelease(seq);
+            RecordRelease(record);
+        }
+        ReaderFileRelease(rf);
+        return out.str();
+    }
+
+    /* the file has to be read the same way with and without plain records;
+       returns the number of differences, prints the first one */
+    size_t Compare(const string& name, const string& contents, const ParseOptions& opt)
+    {
+        CreateFile(name, contents);
+        string grammar = Load(opt, false);
+        string plain = Load(opt, true);
+        if (grammar == plain)
+            return 0;
+        cerr << "input " << opt.qualityFormat << "/" << (int)opt.defaultReadNumber << "/" << opt.ignoreSpotGroups
+             << ":\n" << contents.substr(0, 4096) << "\ngrammar:\n" << grammar.substr(0, 4096) << "\nplain:\n" << plain.substr(0, 4096) << "\n";
+        return 1;
+    }
+
+    size_t CompareAllOptions(const string& name, const string& contents)
+    {
+        size_t diffs = 0;
+        for (size_t i = 0; i < sizeof(AllOptions) / sizeof(AllOptions[0]); ++i)
+            diffs += Compare(name, contents, AllOptions[i]);
+        return diffs;
+    }
+
+    KDirectory* wd;
+    string filename;
+};
+
+static string Corpus()
+{
+    string corpus;
+    for (size_t i = 0; i < sizeof(TagLines) / sizeof(TagLines[0]); ++i)
+        corpus += string(TagLines[i]) + TagLineRecord;
+    return corpus;
+}
+
+FIXTURE_TEST_CASE(TagLinesEach, PlainFixture)
+{
+    size_t diffs = 0;
+    for (size_t i = 0; i < sizeof(TagLines) / sizeof(TagLines[0]); ++i)
+        diffs += CompareAllOptions(GetName(), string(TagLines[i]) + TagLineRecord);
+    REQUIRE_EQ(diffs, (size_t)0);
+}
+
+FIXTURE_TEST_CASE(TagLinesFollowedByPlainRecord, PlainFixture)
+{   /* the scanner's state left behind by a record parsed by the grammar and vice versa */
+    size_t diffs = 0;
+    for (size_t i = 0; i < sizeof(TagLines) / sizeof(TagLines[0]); ++i)
+    {
+        string record = string(TagLines[i]) + TagLineRecord;
+        diffs += CompareAllOptions(GetName(), "@p1\nACGT\n+\nIIII\n" + record + "@p2\nACGT\n+\nIIII\n" + record);
+    }
+    REQUIRE_EQ(diffs, (size_t)0);
+}
+
+FIXTURE_TEST_CASE(RecordsEach, PlainFixture)
+{
+    size_t diffs = 0;
+    for (size_t i = 0; i < sizeof(Records) / sizeof(Records[0]); ++i)
+    {
+        /* records with a 0 byte are not C strings */
+        string record = i + 1 == sizeof(Records) / sizeof(Records[0]) ? string("@r1\nGA\0T\n+\nIIII\n", 16) : string(Records[i]);
+        diffs += CompareAllOptions(GetName(), record);
+        diffs += CompareAllOptions(GetName(), "@p1\nACGT\n+\nIIII\n" + record + "@p2\nACGT\n+\nIIII\n");
+    }
+    REQUIRE_EQ(diffs, (size_t)0);
+}
+
+FIXTURE_TEST_CASE(WholeCorpus, PlainFixture)
+{   /* read numbers carry over from record to record */
+    string corpus = Corpus();
+    for (size_t i = 0; i < sizeof(Records) / sizeof(Records[0]) - 1; ++i)
+        corpus += Records[i];
+    REQUIRE_EQ(CompareAllOptions(GetName(), corpus), (size_t)0);
+}
+
+FIXTURE_TEST_CASE(CorpusCRLF, PlainFixture)
+{
+    string corpus = Corpus();
+    string crlf;
+    for (size_t i = 0; i < corpus.size(); ++i)
+    {
+        if (corpus[i] == '\n')
+            crlf += '\r';
+        crlf += corpus[i];
+    }
+    REQUIRE_EQ(CompareAllOptions(GetName(), crlf), (size_t)0);
+}
+
+FIXTURE_TEST_CASE(BlockBoundaries, PlainFixture)
+{   /* records crossing the loader's buffer and the scanner's 8K input blocks, a 0 byte in a later block */
+    string corpus;
+    mt19937 rnd(1);
+    for (size_t i = 0; corpus.size() < 64 * 1024; ++i)
+    {
+        size_t length = 1 + rnd() % 300;
+        string bases, qualities;
+        for (size_t j = 0; j < length; ++j)
+        {
+            bases += "ACGTN"[rnd() % 5];
+            qualities += char('@' + rnd() % 40);
+        }
+        corpus += string(TagLines[i % 30]) + "\n" + bases + "\n+\n" + qualities + "\n";
+    }
+    REQUIRE_EQ(CompareAllOptions(GetName(), corpus), (size_t)0);
+    corpus[40000] = 0;
+    REQUIRE_EQ(CompareAllOptions(GetName(), corpus), (size_t)0);
+}
+
+FIXTURE_TEST_CASE(Fuzzed, PlainFixture)
+{   /* mutations of the corpus: replaced, inserted and removed characters */
+    static const char chars[] = "@+\n\r \t:#/._-0123ACGTNacgtIi!~\x7f";
+    string corpus = Corpus();
+    mt19937 rnd(2);
+    size_t diffs = 0;
+    for (int i = 0; i < 300; ++i)
+    {
+        string input = corpus.substr(rnd() % corpus.size(), 2000 + rnd() % 2000);
+        for (int j = 1 + rnd() % 8; j > 0; --j)
+        {
+            size_t pos = rnd() % (input.size() + 1);
+            char ch = chars[rnd() % (sizeof(chars) - 1)];
+            switch (rnd() % 3)
+            {
+            case 0: if (pos < input.size()) input[pos] = ch; break;
+            case 1: input.insert(pos, 1, ch); break;
+            default: if (pos < input.size()) input.erase(pos, 1); break;
+            }
+        }
+        diffs += Compare(GetName(), input, AllOptions[i % (sizeof(AllOptions) / sizeof(AllOptions[0]))]);
+    }
+    REQUIRE_EQ(diffs, (size_t)0);
+}
+
+//////////////////////////////////////////// Main
+extern "C"
+{
+
+#include <kapp/args.h>
+#include <kfg/config.h>
+
+ver_t CC KAppVersion ( void )
+{
+    return 0x1000000;
+}
+rc_t CC UsageSummary (const char * progname)
+{
+    return 0;
+}
+
+rc_t CC Usage ( const Args * args )
+{
+    return 0;
+}
+
+const char UsageDefaultName[] = "wb-test-fastq-plain";
+
+rc_t CC KMain ( int argc, char *argv [] )
+{
+    KConfigDisableUserSettings();
+    rc_t rc=FastqLoaderPlainTestSuite(argc, argv);
+    return rc;
+}
+
+}
@@ -352,6 +352,32 @@ FIXTURE_TEST_CASE(ErrorLineNumber, LoaderFixture)
     REQUIRE_EQ(column, (uint64_t)49);
 }
 
+FIXTURE_TEST_CASE(ErrorAfterPlainRecords, LoaderFixture)
+{   // well formed records bypass the scanner, line numbers have to stay right
+    CreateFileGetRecord(GetName(),
+        "@SEQ_ID1\n" "GATT\n" "+\n" "!''*\n"
+        "@SEQ_ID2\n" "GATT\n" "+\n" "!''*\n"
+        "@SEQ_ID3\n" "G^ATT\n" "+\n" "!''*\n"
+        "@SEQ_ID4\n" "GATT\n" "+\n" "!''*\n");
+    REQUIRE(! GetRejected());
+    REQUIRE(GetRecord());
+    REQUIRE(! GetRejected());
+
+    REQUIRE(GetRecord());
+    REQUIRE(GetRejected());
+    REQUIRE_EQ(errorLine, (uint64_t)10);
+    REQUIRE_EQ(column, (uint64_t)1);
+
+    REQUIRE(GetRecord());
+    REQUIRE_NOT_NULL(record);
+    REQUIRE_RC(RecordGetSequence(record, &seq));
+    REQUIRE_RC(SequenceGetSpotName(seq, &name, &length));
+    REQUIRE_EQ(string("SEQ_ID4"), string(name, length));
+
+    REQUIRE(GetRecord());
+    REQUIRE_NULL(record);
+}
+
 //////////////////// tag line parsing
 #define TEST_TAGLINE(line)\
     CreateFileGetRecord(GetName(), line "\n" "GATT\n" "+\n" "!''*\n");\
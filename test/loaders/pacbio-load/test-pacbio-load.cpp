@@ -0,0 +1,279 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/**
+* Unit tests for the order in which pacbio-load loads its tables, and for the read-ahead of multipart-inputs
+*/
+
+#include <atomic>
+#include <cstring>
+
+// the loader has its own KMain
+#define KMain pacbio_load_KMain
+extern "C" {
+#include "pacbio-load.c"
+}
+#undef KMain
+
+#include <ktst/unit_test.hpp>
+
+#include <kfs/file.h>
+
+using namespace std;
+
+TEST_SUITE(PacbioLoadTestSuite);
+
+// what the tables would have loaded, the stubs below replace pl-sequence.c, pl-consensus.c etc.
+static atomic< int > loaded[ tab_count ];
+static atomic< int > loaded_before_consensus;   // passes or metrics that did not wait for consensus
+static atomic< bool > consensus_done;
+static rc_t consensus_rc;
+static rc_t sequence_rc;
+
+static rc_t stub_load( uint32_t tab )
+{
+    if ( ( tab == tab_passes || tab == tab_metrics ) && !consensus_done )
+        ++loaded_before_consensus;
+    ++loaded[ tab ];
+    switch ( tab )
+    {
+        case tab_sequence  : return sequence_rc;
+        case tab_consensus : consensus_done = true; return consensus_rc;
+    }
+    return 0;
+}
+
+extern "C"
+{
+    rc_t prepare_seq( VDatabase * database, seq_ctx * sctx, KDirectory * hdf5_src, ld_context *lctx ) { return 0; }
+    rc_t load_seq_src( seq_ctx * sctx, KDirectory * hdf5_src ) { return stub_load( tab_sequence ); }
+    rc_t finish_seq( seq_ctx * sctx ) { return 0; }
+    void seq_report_totals( ld_context *lctx ) {}
+
+    rc_t prepare_consensus( VDatabase * database, con_ctx * sctx, ld_context *lctx ) { return 0; }
+    rc_t load_consensus_src( con_ctx * sctx, KDirectory * hdf5_src ) { return stub_load( tab_consensus ); }
+    rc_t finish_consensus( con_ctx * sctx ) { return 0; }
+
+    rc_t prepare_passes( VDatabase * database, pas_ctx * sctx, ld_context *lctx ) { return 0; }
+    rc_t load_passes_src( pas_ctx * sctx, KDirectory * hdf5_src ) { return stub_load( tab_passes ); }
+    rc_t finish_passes( pas_ctx * sctx ) { return 0; }
+
+    rc_t prepare_metrics( VDatabase * database, met_ctx * sctx, ld_context *lctx ) { return 0; }
+    rc_t load_metrics_src( met_ctx * sctx, KDirectory * hdf5_src ) { return stub_load( tab_metrics ); }
+    rc_t finish_metrics( met_ctx * sctx ) { return 0; }
+
+    // every part opens, but there is no hdf5-file behind it
+    rc_t CC MakeHDF5RootDir ( KDirectory * self, KDirectory ** hdf5_dir, bool absolute, const char *path )
+    {
+        *hdf5_dir = NULL;
+        return 0;
+    }
+
+    rc_t CC MakeHDF5ArrayFile ( const KFile * self, KArrayFile ** f )
+    {
+        return RC( rcExe, rcFile, rcConstructing, rcFormat, rcUnsupported );
+    }
+}
+
+class LoadFixture
+{
+public:
+    LoadFixture()
+    : consensus_present( false )
+    {
+        memset( &ctx, 0, sizeof ctx );
+        memset( &dst, 0, sizeof dst );
+        for ( auto & l : loaded )
+            l = 0;
+        loaded_before_consensus = 0;
+        consensus_done = false;
+        consensus_rc = 0;
+        sequence_rc = 0;
+    }
+
+    rc_t LoadSrc( const char * tabs )
+    {
+        ctx.tabs = const_cast< char * >( tabs );
+        consensus_done = false;
+        return pacbio_load_src( &ctx, &dst, NULL, &consensus_present );
+    }
+
+    context ctx;
+    seq_con_pas_met dst;
+    bool consensus_present;
+};
+
+FIXTURE_TEST_CASE( Load_All, LoadFixture )
+{
+    REQUIRE_RC( LoadSrc( NULL ) );
+    REQUIRE( consensus_present );
+    for ( auto & l : loaded )
+        REQUIRE_EQ( 1, ( int )l );
+    REQUIRE_EQ( 0, ( int )loaded_before_consensus );
+}
+
+FIXTURE_TEST_CASE( Load_ConsensusMissing, LoadFixture )
+{
+    consensus_rc = RC( rcExe, rcTable, rcLoading, rcData, rcNotFound );
+    // a missing consensus-group is not an error...
+    REQUIRE_RC( LoadSrc( NULL ) );
+    // ...but then there are no passes and no metrics either
+    REQUIRE( !consensus_present );
+    REQUIRE_EQ( 1, ( int )loaded[ tab_sequence ] );
+    REQUIRE_EQ( 1, ( int )loaded[ tab_consensus ] );
+    REQUIRE_EQ( 0, ( int )loaded[ tab_passes ] );
+    REQUIRE_EQ( 0, ( int )loaded[ tab_metrics ] );
+}
+
+FIXTURE_TEST_CASE( Load_ConsensusFromEarlierPart, LoadFixture )
+{
+    REQUIRE_RC( LoadSrc( NULL ) );
+    consensus_rc = RC( rcExe, rcTable, rcLoading, rcData, rcNotFound );
+    REQUIRE_RC( LoadSrc( NULL ) );
+    REQUIRE( consensus_present );
+    REQUIRE_EQ( 2, ( int )loaded[ tab_passes ] );
+    REQUIRE_EQ( 2, ( int )loaded[ tab_metrics ] );
+    REQUIRE_EQ( 0, ( int )loaded_before_consensus );
+}
+
+FIXTURE_TEST_CASE( Load_ConsensusNotWanted, LoadFixture )
+{
+    REQUIRE_RC( LoadSrc( "SPM" ) );
+    REQUIRE( !consensus_present );
+    REQUIRE_EQ( 1, ( int )loaded[ tab_sequence ] );
+    REQUIRE_EQ( 0, ( int )loaded[ tab_consensus ] );
+    REQUIRE_EQ( 0, ( int )loaded[ tab_passes ] );
+    REQUIRE_EQ( 0, ( int )loaded[ tab_metrics ] );
+
+    // a consensus-group loaded from an earlier part is enough
+    consensus_present = true;
+    REQUIRE_RC( LoadSrc( "SPM" ) );
+    REQUIRE_EQ( 1, ( int )loaded[ tab_passes ] );
+    REQUIRE_EQ( 1, ( int )loaded[ tab_metrics ] );
+}
+
+FIXTURE_TEST_CASE( Load_SequenceOnly, LoadFixture )
+{
+    REQUIRE_RC( LoadSrc( "S" ) );
+    REQUIRE_EQ( 1, ( int )loaded[ tab_sequence ] );
+    REQUIRE_EQ( 0, ( int )loaded[ tab_consensus ] );
+    REQUIRE_EQ( 0, ( int )loaded[ tab_passes ] );
+    REQUIRE_EQ( 0, ( int )loaded[ tab_metrics ] );
+}
+
+FIXTURE_TEST_CASE( Load_SequenceFails, LoadFixture )
+{
+    sequence_rc = RC( rcExe, rcTable, rcLoading, rcData, rcInvalid );
+    REQUIRE_EQ( sequence_rc, LoadSrc( NULL ) );
+}
+
+FIXTURE_TEST_CASE( Load_Multipart, LoadFixture )
+{
+    KDirectory * wd;
+    REQUIRE_RC( KDirectoryNativeDir( &wd ) );
+    REQUIRE_RC( VNamelistMake( &ctx.src_paths, 3 ) );
+    REQUIRE_RC( VNamelistAppend( ctx.src_paths, "part1" ) );
+    REQUIRE_RC( VNamelistAppend( ctx.src_paths, "part2" ) );
+    REQUIRE_RC( VNamelistAppend( ctx.src_paths, "part3" ) );
+
+    ld_context lctx;
+    lctx_init( &lctx );
+    KDirectory * hdf5_src = NULL;
+    REQUIRE_RC( pacbio_load_multipart( &ctx, wd, NULL, &hdf5_src, &consensus_present, &lctx, 3 ) );
+    for ( auto & l : loaded )
+        REQUIRE_EQ( 3, ( int )l );
+
+    VNamelistRelease( ctx.src_paths );
+    KDirectoryRelease( wd );
+}
+
+class ReadAheadFixture
+{
+public:
+    ReadAheadFixture()
+    : wd( NULL ), path( "test-pacbio-load.read-ahead" ), size( 3 * PREFETCH_BLOCK_SIZE + 100 )
+    {
+        atomic32_set( &stop, 0 );
+        if ( KDirectoryNativeDir( &wd ) != 0 )
+            throw logic_error( "KDirectoryNativeDir failed" );
+        KFile * f;
+        if ( KDirectoryCreateFile( wd, &f, false, 0664, kcmInit, "%s", path ) != 0 )
+            throw logic_error( "KDirectoryCreateFile failed" );
+        if ( KFileSetSize( f, size ) != 0 )
+            throw logic_error( "KFileSetSize failed" );
+        KFileRelease( f );
+    }
+    ~ReadAheadFixture()
+    {
+        KDirectoryRemove( wd, true, "%s", path );
+        KDirectoryRelease( wd );
+    }
+
+    KDirectory * wd;
+    const char * path;
+    uint64_t size;
+    atomic32_t stop;
+};
+
+FIXTURE_TEST_CASE( ReadAhead_WholeFile, ReadAheadFixture )
+{
+    REQUIRE_EQ( size, pacbio_read_ahead( wd, path, PREFETCH_LIMIT, &stop ) );
+}
+
+FIXTURE_TEST_CASE( ReadAhead_Limit, ReadAheadFixture )
+{
+    // the limit does not have to be a multiple of the block-size
+    uint64_t const limit = PREFETCH_BLOCK_SIZE + 10;
+    REQUIRE_EQ( limit, pacbio_read_ahead( wd, path, limit, &stop ) );
+}
+
+FIXTURE_TEST_CASE( ReadAhead_Stopped, ReadAheadFixture )
+{
+    atomic32_set( &stop, 1 );
+    REQUIRE_EQ( ( uint64_t )0, pacbio_read_ahead( wd, path, PREFETCH_LIMIT, &stop ) );
+}
+
+FIXTURE_TEST_CASE( ReadAhead_NoFile, ReadAheadFixture )
+{
+    REQUIRE_EQ( ( uint64_t )0, pacbio_read_ahead( wd, "no-such-file", PREFETCH_LIMIT, &stop ) );
+}
+
+//////////////////////////////////////////// Main
+
+extern "C"
+{
+
+ver_t CC KAppVersion ( void )
+{
+    return 0x1000000;
+}
+
+rc_t CC KMain ( int argc, char *argv [] )
+{
+    return PacbioLoadTestSuite(argc, argv);
+}
+
+}
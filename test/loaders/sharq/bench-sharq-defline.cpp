@@ -0,0 +1,151 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/**
+* Benchmark of SHARQ defline parsing: hand-written scanners vs RE2
+*
+* Usage: bench-sharq-defline [count, default 1000000] [file ...]
+*
+* Input files are FASTQ (every 4th line is a defline) or lists of deflines,
+* at most count deflines are taken from each. Without input files
+* synthetic corpora are generated for the formats that have scanners.
+* Each corpus is parsed with and without the scanners, the deflines per second
+* and the number of reads parsed differently are reported.
+*/
+#include <cassert>
+#include "../../tools/loaders/sharq/fastq_utils.hpp"
+#include "../../tools/loaders/sharq/fastq_defline_parser.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+static vector<string> s_MakeCorpus(const string& type, size_t count)
+{
+    static const char hex[] = "0123456789abcdef";
+    static const char bases[] = "ACGT";
+    mt19937 rnd(7);
+    auto num = [&](unsigned max) { return to_string(rnd() % max); };
+    auto seq = [&](size_t len, const char* chars, size_t n) {
+        string s;
+        for (size_t i = 0; i < len; ++i)
+            s += chars[rnd() % n];
+        return s;
+    };
+    vector<string> corpus;
+    corpus.reserve(count);
+    const string barcode = seq(8, bases, 4) + "+" + seq(8, bases, 4);
+    for (size_t i = 0; i < count; ++i) {
+        if (type == "illuminaNew")
+            corpus.push_back("@A00123:8:H3KHJDRXX:" + num(4) + ":" + num(2700) + ":" + num(30000) + ":" + num(40000) + " " + (i % 2 ? "2" : "1") + ":N:0:" + barcode);
+        else if (type == "IlluminaOldColon")
+            corpus.push_back("@HWUSI-EAS100R:6:" + num(120) + ":" + num(2000) + ":" + num(2000) + "#0/" + (i % 2 ? "2" : "1"));
+        else if (type == "BgiNew")
+            corpus.push_back("@V300019058L" + num(4) + "C001R0" + to_string(10 + rnd() % 90) + to_string(1000000 + i) + " " + (i % 2 ? "2" : "1") + ":N:0:" + barcode);
+        else if (type == "BgiOld")
+            corpus.push_back("@V350012516L" + num(4) + "C001R0" + to_string(10 + rnd() % 90) + to_string(1000000 + i) + "/" + (i % 2 ? "2" : "1"));
+        else if (type == "Nanopore4")
+            corpus.push_back("@" + seq(8, hex, 16) + "-" + seq(4, hex, 16) + "-" + seq(4, hex, 16) + "-" + seq(4, hex, 16) + "-" + seq(12, hex, 16) +
+                " runid=" + seq(40, hex, 16) + " read=" + num(100000) + " ch=" + num(512) + " start_time=2021-05-05T10:11:12Z flow_cell_id=FAP12345 barcode=barcode0" + num(10));
+    }
+    return corpus;
+}
+
+static vector<string> s_ReadCorpus(const string& file_name, size_t count)
+{
+    vector<string> corpus;
+    ifstream f(file_name);
+    string line;
+    bool fastq = f.peek() == '@';
+    for (size_t n = 0; corpus.size() < count && getline(f, line); ++n) {
+        if (!fastq || n % 4 == 0)
+            corpus.push_back(line);
+    }
+    return corpus;
+}
+
+static double s_Parse(CDefLineParser& parser, const vector<string>& corpus, vector<CFastqRead>& reads)
+{
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < corpus.size(); ++i) {
+        try {
+            parser.Parse(corpus[i], reads[i]);
+        } catch (exception&) {
+        }
+    }
+    chrono::duration<double> t = chrono::steady_clock::now() - start;
+    return t.count();
+}
+
+static bool s_Same(const CFastqRead& a, const CFastqRead& b)
+{
+    return a.Spot() == b.Spot() && a.ReadNum() == b.ReadNum() && a.SpotGroup() == b.SpotGroup() &&
+        a.Suffix() == b.Suffix() && a.ReadFilter() == b.ReadFilter() &&
+        a.Channel() == b.Channel() && a.NanoporeReadNo() == b.NanoporeReadNo();
+}
+
+static void s_Bench(const string& name, const vector<string>& corpus)
+{
+    if (corpus.empty())
+        return;
+    CDefLineParser re2_parser;
+    for (auto& matcher : re2_parser.GetDeflineMatchers())
+        matcher->SetFastPath(false);
+    CDefLineParser fast_parser;
+    vector<CFastqRead> re2_reads(corpus.size());
+    vector<CFastqRead> fast_reads(corpus.size());
+
+    double t1 = s_Parse(re2_parser, corpus, re2_reads);
+    double t2 = s_Parse(fast_parser, corpus, fast_reads);
+
+    size_t diff = 0;
+    for (size_t i = 0; i < corpus.size(); ++i)
+        diff += !s_Same(re2_reads[i], fast_reads[i]);
+    double n = corpus.size() / 1e6;
+    string types;
+    for (const auto& t : fast_parser.AllDeflineTypes())
+        types += (types.empty() ? "" : ",") + t;
+    string note = diff ? ", " + to_string(diff) + " DIFFERENT" : "";
+    printf("%s (%s): %zu deflines, RE2 %.2f M/s, scanners %.2f M/s, x%.2f%s\n",
+        name.c_str(), types.c_str(), corpus.size(), n / t1, n / t2, t1 / t2, note.c_str());
+}
+
+int main(int argc, char* argv[])
+{
+    size_t count = argc > 1 ? stoul(argv[1]) : 1000000;
+    if (argc > 2) {
+        for (int i = 2; i < argc; ++i)
+            s_Bench(argv[i], s_ReadCorpus(argv[i], count));
+    } else {
+        for (const string type : { "illuminaNew", "IlluminaOldColon", "BgiNew", "BgiOld", "Nanopore4" })
+            s_Bench(type, s_MakeCorpus(type, count));
+    }
+    return 0;
+}
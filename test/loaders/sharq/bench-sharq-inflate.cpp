@@ -0,0 +1,168 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/**
+* Benchmark of SHARQ gzip input: bxzstr vs gz_inflate
+*
+* Usage: bench-sharq-inflate [size in MB, default 256] [threads, default 4] [file.gz ...]
+*
+* Without input files a synthetic FASTQ is written to the temp directory
+* as single-stream gzip, multi-member gzip and BGZF.
+* Each input is read line by line the way fastq_reader does and the
+* uncompressed MB/s is reported for both streams.
+*/
+#include "../../tools/loaders/sharq/bxzstr/bxzstr.hpp"
+#include "../../tools/loaders/sharq/gz_inflate.hpp"
+
+#include <zlib.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+static string s_MakeFastq(size_t size)
+{
+    static const char bases[] = "ACGT";
+    mt19937 rnd(7);
+    string out;
+    out.reserve(size + 1024);
+    for (size_t i = 0; out.size() < size; ++i) {
+        out += "@SRR000001." + to_string(i) + " HWI-ST1234:8:1101:" + to_string(rnd() % 20000) + ":" + to_string(rnd() % 200000) + " length=150\n";
+        for (int j = 0; j < 150; ++j)
+            out += bases[rnd() % 4];
+        out += "\n+\n";
+        for (int j = 0; j < 150; ++j)
+            out += char('#' + rnd() % 40 / (1 + rnd() % 4));
+        out += '\n';
+    }
+    return out;
+}
+
+// gzip member with an optional BGZF extra field
+static string s_Deflate(const char* data, size_t size, bool bgzf)
+{
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    deflateInit2(&zs, 6, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+    string body(deflateBound(&zs, size), '\0');
+    zs.next_in = (Bytef*)data;
+    zs.avail_in = size;
+    zs.next_out = (Bytef*)&body[0];
+    zs.avail_out = body.size();
+    deflate(&zs, Z_FINISH);
+    body.resize(body.size() - zs.avail_out);
+    deflateEnd(&zs);
+
+    string out;
+    if (bgzf) {
+        size_t bsize = 18 + body.size() + 8 - 1;
+        const char header[] = {'\x1f', '\x8b', 8, 4, 0, 0, 0, 0, 0, '\xff', 6, 0, 'B', 'C', 2, 0, char(bsize & 0xff), char(bsize >> 8)};
+        out.assign(header, sizeof(header));
+    } else {
+        const char header[] = {'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, 3};
+        out.assign(header, sizeof(header));
+    }
+    out += body;
+    uint32_t crc = crc32(0, (const Bytef*)data, size);
+    uint32_t isize = size;
+    out.append((const char*)&crc, 4);
+    out.append((const char*)&isize, 4);
+    return out;
+}
+
+static string s_Compress(const string& data, size_t member_size, bool bgzf)
+{
+    string out;
+    for (size_t pos = 0; pos < data.size(); pos += member_size)
+        out += s_Deflate(data.data() + pos, min(member_size, data.size() - pos), bgzf);
+    if (bgzf)
+        out += s_Deflate(nullptr, 0, true); // BGZF EOF marker
+    return out;
+}
+
+static void s_Write(const string& file_name, const string& data)
+{
+    ofstream f(file_name, ios::binary);
+    f.write(data.data(), data.size());
+}
+
+template<typename T>
+static pair<size_t, uint32_t> s_Read(T&& is)
+{
+    size_t bytes = 0;
+    uint32_t crc = crc32(0, nullptr, 0);
+    string line;
+    while (getline(is, line)) {
+        bytes += line.size() + 1;
+        crc = crc32(crc, (const Bytef*)line.data(), line.size());
+    }
+    return {bytes, crc};
+}
+
+static void s_Bench(const string& file_name, unsigned threads)
+{
+    auto start = chrono::steady_clock::now();
+    auto res1 = s_Read(bxz::ifstream(file_name, ios::in, 10 * 1024 * 1024));
+    chrono::duration<double> t1 = chrono::steady_clock::now() - start;
+
+    start = chrono::steady_clock::now();
+    auto res2 = s_Read(gz_istream(file_name, threads));
+    chrono::duration<double> t2 = chrono::steady_clock::now() - start;
+
+    double mb = res1.first / (1024. * 1024.);
+    printf("%s: %.0f MB, bxzstr %.1f MB/s, gz_inflate(%u) %.1f MB/s, x%.2f%s\n",
+        file_name.c_str(), mb, mb / t1.count(), threads, mb / t2.count(), t1.count() / t2.count(),
+        res1 == res2 ? "" : " MISMATCH");
+}
+
+int main(int argc, char* argv[])
+{
+    size_t size_mb = argc > 1 ? stoul(argv[1]) : 256;
+    unsigned threads = argc > 2 ? stoul(argv[2]) : 4;
+    vector<string> files;
+    vector<string> tmp_files;
+    for (int i = 3; i < argc; ++i)
+        files.push_back(argv[i]);
+
+    if (files.empty()) {
+        string dir = P_tmpdir;
+        string fastq = s_MakeFastq(size_mb * 1024 * 1024);
+        tmp_files = {dir + "/bench-sharq-single.fq.gz", dir + "/bench-sharq-members.fq.gz", dir + "/bench-sharq-bgzf.fq.gz"};
+        s_Write(tmp_files[0], s_Compress(fastq, fastq.size(), false));
+        s_Write(tmp_files[1], s_Compress(fastq, 4 * 1024 * 1024, false));
+        s_Write(tmp_files[2], s_Compress(fastq, 65280, true));
+        files = tmp_files;
+    }
+    for (const auto& f : files)
+        s_Bench(f, threads);
+    for (const auto& f : tmp_files)
+        remove(f.c_str());
+    return 0;
+}
@@ -83,7 +83,7 @@ if [ "$rc" != "$RC" ] ; then
 fi
 
 expected=$CASEID
-suffixes=('-sa-hot' '-sa-cold')
+suffixes=('-sa-hot' '-sa-cold' '-sa-cache' '-sa-spill')
 
 for suffix in "${suffixes[@]}"; do
     if [[ $expected == *"$suffix" ]]; then
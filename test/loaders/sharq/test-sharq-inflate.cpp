@@ -0,0 +1,205 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/**
+* Unit tests for SHARQ loader's multi-threaded gzip input
+*/
+
+#include "../../../tools/loaders/sharq/gz_inflate.hpp"
+
+#include <ktst/unit_test.hpp>
+
+#include <fstream>
+#include <random>
+
+using namespace std;
+
+TEST_SUITE(SharQInflateTestSuite);
+
+static const string TestFile = "./test-sharq-inflate.tmp.gz";
+
+static string s_MakeData(size_t size)
+{
+    static const char bases[] = "ACGT";
+    mt19937 rnd(11);
+    string out;
+    for (size_t i = 0; out.size() < size; ++i) {
+        out += "@read" + to_string(i) + "\n";
+        for (int j = 0; j < 100; ++j)
+            out += bases[rnd() % 4];
+        out += "\n+\n" + string(100, char('!' + i % 40)) + "\n";
+    }
+    return out;
+}
+
+// gzip member, BGZF block if bgzf is set
+static string s_Deflate(const char* data, size_t size, bool bgzf, int level = 6)
+{
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    deflateInit2(&zs, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+    string body(deflateBound(&zs, size), '\0');
+    zs.next_in = (Bytef*)data;
+    zs.avail_in = size;
+    zs.next_out = (Bytef*)&body[0];
+    zs.avail_out = body.size();
+    deflate(&zs, Z_FINISH);
+    body.resize(body.size() - zs.avail_out);
+    deflateEnd(&zs);
+
+    string out;
+    if (bgzf) {
+        size_t bsize = 18 + body.size() + 8 - 1;
+        const char header[] = {'\x1f', '\x8b', 8, 4, 0, 0, 0, 0, 0, '\xff', 6, 0, 'B', 'C', 2, 0, char(bsize & 0xff), char(bsize >> 8)};
+        out.assign(header, sizeof(header));
+    } else {
+        const char header[] = {'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, 3};
+        out.assign(header, sizeof(header));
+    }
+    out += body;
+    uint32_t crc = crc32(0, (const Bytef*)data, size);
+    uint32_t isize = size;
+    out.append((const char*)&crc, 4);
+    out.append((const char*)&isize, 4);
+    return out;
+}
+
+static string s_Compress(const string& data, size_t member_size, bool bgzf, int level = 6)
+{
+    string out;
+    for (size_t pos = 0; pos < data.size(); pos += member_size)
+        out += s_Deflate(data.data() + pos, min(member_size, data.size() - pos), bgzf, level);
+    if (bgzf)
+        out += s_Deflate(nullptr, 0, true); // BGZF EOF marker
+    return out;
+}
+
+static string s_Inflate(const string& gz, unsigned threads)
+{
+    {
+        ofstream f(TestFile, ios::binary);
+        f.write(gz.data(), gz.size());
+    }
+    string res;
+    {
+        gz_istream is(TestFile, threads);
+        string line;
+        while (getline(is, line))
+            res += line + '\n';
+    }
+    remove(TestFile.c_str());
+    return res;
+}
+
+class InflateFixture
+{
+public:
+    InflateFixture() : data(s_MakeData(6 * 1024 * 1024)) {}
+    const string data;
+};
+
+FIXTURE_TEST_CASE(SingleStream, InflateFixture)
+{
+    string gz = s_Compress(data, data.size(), false);
+    for (unsigned threads : {1, 4})
+        REQUIRE(s_Inflate(gz, threads) == data);
+}
+
+FIXTURE_TEST_CASE(MultiMember, InflateFixture)
+{
+    // members larger and smaller than a job
+    for (size_t member_size : {100 * 1000, 1500 * 1000}) {
+        string gz = s_Compress(data, member_size, false);
+        for (unsigned threads : {1, 4})
+            REQUIRE(s_Inflate(gz, threads) == data);
+    }
+}
+
+FIXTURE_TEST_CASE(Bgzf, InflateFixture)
+{
+    string gz = s_Compress(data, 65280, true);
+    for (unsigned threads : {1, 4})
+        REQUIRE(s_Inflate(gz, threads) == data);
+}
+
+FIXTURE_TEST_CASE(FalseMemberHeaders, InflateFixture)
+{
+    // stored members carry the data as is, so gzip headers in the data
+    // become false member candidates in the compressed stream
+    string fake(s_Deflate("x", 1, false));
+    string with_headers;
+    for (size_t pos = 0; pos < data.size(); pos += 50000)
+        with_headers += data.substr(pos, 50000) + fake;
+    string gz = s_Compress(with_headers, 2 * 1000 * 1000, false, 0);
+    for (unsigned threads : {1, 4}) {
+        string res;
+        {
+            ofstream f(TestFile, ios::binary);
+            f.write(gz.data(), gz.size());
+        }
+        {
+            gz_istream is(TestFile, threads);
+            res.assign(istreambuf_iterator<char>(is), istreambuf_iterator<char>());
+        }
+        remove(TestFile.c_str());
+        REQUIRE(res == with_headers);
+    }
+}
+
+FIXTURE_TEST_CASE(Truncated, InflateFixture)
+{
+    // the data inflated before the end of file is delivered
+    string gz = s_Compress(data, 100 * 1000, false);
+    gz.resize(gz.size() / 2);
+    string res = s_Inflate(gz, 4);
+    REQUIRE(!res.empty());
+    REQUIRE_LT(res.size(), data.size());
+    REQUIRE(data.compare(0, res.size(), res) == 0);
+}
+
+FIXTURE_TEST_CASE(ConsumerGone, InflateFixture)
+{
+    // the inflate threads stop when the stream is destroyed before the end
+    string gz = s_Compress(data, 65280, true);
+    {
+        ofstream f(TestFile, ios::binary);
+        f.write(gz.data(), gz.size());
+    }
+    {
+        gz_istream is(TestFile, 4);
+        string line;
+        REQUIRE(getline(is, line));
+        REQUIRE_EQ(line, string("@read0"));
+    }
+    remove(TestFile.c_str());
+}
+
+////////////////////////////////////////////
+
+int main (int argc, char *argv [])
+{
+    return SharQInflateTestSuite(argc, argv);
+}
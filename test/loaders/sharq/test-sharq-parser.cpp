@@ -44,6 +44,9 @@
 #include <cstring>
 #include <stdexcept>
 #include <list>
+#include <filesystem>
+#include <fstream>
+#include <random>
 
 using namespace std;
 
@@ -1222,6 +1225,288 @@ FIXTURE_TEST_CASE(illuminaOldBcOnly, LoaderFixture)
     REQUIRE(read.ReadNum().empty());
 }
 
+TEST_CASE(GzInflateMembers)
+{
+    // multi-member gzip file: each gzopen in append mode adds a member
+    const string file_name = "./actual/gz_inflate_members.fq.gz";
+    system("mkdir -p ./actual");
+    const size_t num_members = 5;
+    const size_t reads_per_member = 2000;
+    for (size_t m = 0; m < num_members; ++m) {
+        gzFile f = gzopen(file_name.c_str(), m == 0 ? "wb" : "ab");
+        THROW_ON_FALSE( f != nullptr );
+        for (size_t i = 0; i < reads_per_member; ++i) {
+            string defline = cSPOT1 + to_string(m * reads_per_member + i) + " 1:N:0:" + cSPOT_GROUP;
+            string read = _READ(defline, "ACGTACGTAC", "IIIIIIIIII");
+            gzwrite(f, read.data(), read.size());
+        }
+        gzclose(f);
+    }
+    for (unsigned threads : {0, 1, 4}) {
+        fastq_reader reader(file_name, s_OpenStream(file_name, 1024 * 1024, threads));
+        CFastqRead read;
+        size_t num_reads = 0;
+        while (reader.get_read(read)) {
+            REQUIRE_EQ(read.Spot(), cSPOT1 + to_string(num_reads));
+            ++num_reads;
+        }
+        REQUIRE_EQ(num_reads, num_members * reads_per_member);
+        REQUIRE(reader.is_compressed());
+    }
+    remove(file_name.c_str());
+}
+
+//////////////////// hand-written defline scanners vs RE2
+
+class DeflineScannerFixture
+{
+public:
+    DeflineScannerFixture()
+    {
+        for (auto& matcher : m_re2.GetDeflineMatchers())
+            matcher->SetFastPath(false);
+    }
+
+    static string Fields(CDefLineMatcher& matcher)
+    {
+        CFastqRead read;
+        try {
+            matcher.GetMatch(read);
+        } catch (fastq_error& e) {
+            return e.what();
+        }
+        return read.Spot() + "|" + read.ReadNum() + "|" + read.SpotGroup() + "|" + read.Suffix() + "|" +
+            read.Channel() + "|" + read.NanoporeReadNo() + "|" + to_string(read.ReadFilter());
+    }
+
+    // every matcher has to give the same answer with and without the scanners
+    void Compare(const string& defline)
+    {
+        auto& fast = m_fast.GetDeflineMatchers();
+        auto& re2 = m_re2.GetDeflineMatchers();
+        for (size_t i = 0; i < fast.size(); ++i) {
+            bool matched = fast[i]->Matches(defline);
+            if (matched != re2[i]->Matches(defline))
+                throw runtime_error(fast[i]->Defline() + ": match differs for '" + defline + "'");
+            if (matched && Fields(*fast[i]) != Fields(*re2[i]))
+                throw runtime_error(fast[i]->Defline() + ": " + Fields(*fast[i]) + " != " + Fields(*re2[i]) + " for '" + defline + "'");
+        }
+    }
+
+    // random edits with the characters the patterns care about
+    void CompareMutations(const string& defline, size_t count)
+    {
+        static const string chars = ":_-|#/\\. \t0123459NYOLCR@>+=abx";
+        for (size_t i = 0; i < count && !defline.empty(); ++i) {
+            string s = defline;
+            for (size_t edits = 1 + m_rnd() % 3; edits > 0; --edits) {
+                size_t pos = m_rnd() % s.size();
+                switch (m_rnd() % 3) {
+                case 0: s[pos] = chars[m_rnd() % chars.size()]; break;
+                case 1: s.insert(pos, 1, chars[m_rnd() % chars.size()]); break;
+                default: if (s.size() > 1) s.erase(pos, 1); break;
+                }
+            }
+            Compare(s);
+        }
+    }
+
+    CDefLineParser m_fast;
+    CDefLineParser m_re2;
+    mt19937 m_rnd{17};
+};
+
+FIXTURE_TEST_CASE(DeflineScanner, DeflineScannerFixture)
+{
+    const vector<string> deflines = {
+        "@M00730:68:000000000-A2307:1:1101:14701:1383 1:N:0:1",
+        "@HWI-ST808:130:H0B8YADXX:1:1101:1914:2223 1:N:0:NNNNNN-GGTCCA-AAAA",
+        "@HWI-M01380:63:000000000-A8KG4:1:1101:17932:1459 1:N:0:Alpha29 CTAGTACG|0|GTAAGGAG|0",
+        "@HWI-ST959:56:D0AW4ACXX:8:1101:1233:2026 2:N:0:",
+        "@HET-141-007:154:C391TACXX:6:1216:12924:76893 1:N:0",
+        "@DG7PMJN1:293:D12THACXX:2:1101:1161:1968_1:N:0:GATCAG",
+        "@M01321:49:000000000-A6HWP:1:1101:17736:2216_1:N:0:1/M01321:49:000000000-A6HWP:1:1101:17736:2216_2:N:0:1",
+        "@HS2000-1017_69:7:2203:18414:13643|2:N:O:GATCAG",
+        "@HWI:1:X:1:1101:1298:2061 1:N:0: AGCGATAG (barcode is discarded)",
+        "@HISEQ:258:C6E8AANXX:6:1101:1823:1979:CGAGCACA:1:N:0:CGAGCACA:NG:GT",
+        "@A:1:2:3:4:1:N:0:ACGT",
+        "@A_1_2_3.5_-4.25-1:Y:12ACGT\tx",
+        "@A:1:2:-3:4.5 :N:O:",
+        "@8:1101:1486:2141 1:N:0:/1",
+        "@HWUSI-EAS100R:6:73:941:1973#0/1",
+        "@HWUSI-EAS100R:6:73:941:1973_1#ACGT/2 extra",
+        "@R:1:2:3.5-4.5#0 /1",
+        "@R:1:2:3:40#AC/7/1",
+        "@R:1:2:3:12X",
+        "@R:1:2:3:4\\3",
+        "@V300019058_8BL1C001R0010000000 1:N:0:ATGGTAGG",
+        "@V300103666L2C001R0010000000:0:0:0:0 1:N:0:ATAGTCTC",
+        "@CL100159005L1C001R001_2 2:N:0:0",
+        "@CL100050407L1C001R001_1#224_1078_917/1 1       1",
+        "@V350012516L1C001R00100001492/1",
+        "@V300019058_8BL1C001R00112345678 1:N:0:ATGGTAG",
+        "@V300019058L1C001R0011234567890123",
+        "@V300019058L1C001R001_12#AB/3x/4",
+        "@0c5eb2c6-8e1c-4e4a-9d1d-6b6a4d8a3f2e runid=8e2a read=1234 ch=56 start_time=2020-01-01T00:00:00Z barcode=barcode01",
+        "@0c5eb2c6-8e1c-4e4a-9d1d-6b6a4d8a3f2e runid=8e2a read_12 ch_7 barcode=unclassified",
+        "@x0c5eb2c6-8e1c-4e4a-9d1d-6b6a4d8a3f2e_Basecall_2D_000_template",
+        "@a]",
+        "",
+        "@",
+        "@\xc3\xa9:1:2:3:4 1:N:0:A",
+    };
+    for (const auto& d : deflines) {
+        Compare(d);
+        CompareMutations(d, 200);
+    }
+
+    // every line of the test inputs, deflines or not
+    for (const string dir : { "./input", "../fastq-loader/input" }) {
+        for (const auto& entry : filesystem::directory_iterator(dir)) {
+            const auto ext = entry.path().extension();
+            if (ext == ".gz" || ext == ".bz2")
+                continue;
+            ifstream f(entry.path());
+            string line;
+            for (size_t n = 0; getline(f, line) && n < 1000; ++n) {
+                Compare(line);
+                CompareMutations(line, 5);
+            }
+        }
+    }
+}
+
+TEST_CASE(SimdKernels)
+{
+    // kernels against byte by byte references, lengths around the vector sizes
+    mt19937 rnd(36);
+    const string alphabet = string("ACGTNacgtn-.*@[`{ \t\n0123456789") + char(0x80) + char(0xff);
+    for (size_t len = 0; len < 300; len += (len < 70 ? 1 : 37)) {
+        for (int iter = 0; iter < 20; ++iter) {
+            string s(len, 'A');
+            for (auto& c : s) {
+                c = iter % 2 ? alphabet[rnd() % alphabet.size()] : char(rnd() % 256);
+                if (iter % 4 == 0)
+                    c = "ACGTacgt"[rnd() % 8];
+            }
+
+            uint8_t lo = 255, hi = 0;
+            sharq::simd::minmax(s.data(), s.size(), lo, hi);
+            uint8_t ref_lo = 255, ref_hi = 0;
+            for (uint8_t c : s) {
+                ref_lo = min(ref_lo, c);
+                ref_hi = max(ref_hi, c);
+            }
+            REQUIRE_EQ((int)lo, (int)ref_lo);
+            REQUIRE_EQ((int)hi, (int)ref_hi);
+            bool ref_in_range = all_of(s.begin(), s.end(), [](uint8_t c) { return c >= 33 && c <= 126; });
+            bool in_range = sharq::simd::in_range<33, 126>(s.data(), s.size());
+            REQUIRE_EQ(in_range, ref_in_range);
+
+            bool ref_alpha = all_of(s.begin(), s.end(), [](char c) { return isalpha(c) != 0; });
+            REQUIRE_EQ(sharq::simd::all_alpha(s.data(), s.size()), ref_alpha);
+
+            array<size_t, 256> counts = {0};
+            array<size_t, 256> ref_counts = {0};
+            sharq::simd::count_bytes(s.data(), s.size(), counts);
+            for (uint8_t c : s)
+                ++ref_counts[c];
+            REQUIRE(counts == ref_counts);
+        }
+    }
+
+    // numeric scores, either parsed the way stoi does or declined
+    const vector<string> scores = { "", "40 40 30", " 0  -5\t12\n", "-1", "999", "1000", "1 2x", "--1", "- 1", "+1", "1 -", "a" };
+    for (const auto& s : scores) {
+        vector<uint8_t> values;
+        bool parsed = sharq::simd::parse_scores(s.data(), s.size(), values);
+        vector<uint8_t> ref_values;
+        bool ref_parsed = true;
+        istringstream is(s);
+        string token;
+        while (ref_parsed && is >> token) {
+            ref_parsed = token.size() <= (token[0] == '-' ? 4u : 3u) && token.find_first_not_of("0123456789", token[0] == '-' ? 1 : 0) == string::npos && token != "-";
+            if (ref_parsed)
+                ref_values.push_back(stoi(token));
+        }
+        REQUIRE_EQ(parsed, ref_parsed);
+        if (parsed)
+            REQUIRE(values == ref_values);
+    }
+}
+
+TEST_CASE(PipelineStats)
+{
+    atomic<bool> cancelled{false};
+    const size_t count = 100000;
+    queue_t<size_t, 64> q("test_stats_queue", cancelled);
+    auto& stage = pipeline_stats.stage("test_stats_stage");
+    auto consumer = std::async(std::launch::async, [&]() {
+        size_t item, sum = 0;
+        while (q.dequeue(item)) {
+            stage.add();
+            sum += item;
+        }
+        return sum;
+    });
+    for (size_t i = 0; i < count; ++i)
+        q.enqueue(size_t(i));
+    q.close();
+    REQUIRE_EQ(consumer.get(), count * (count - 1) / 2);
+
+    json j;
+    pipeline_stats.snapshot(j);
+    const auto& jq = j["queues"]["test_stats_queue"];
+    REQUIRE_EQ((size_t)jq["enqueued"], count);
+    REQUIRE_EQ((size_t)jq["dequeued"], count);
+    REQUIRE_EQ((size_t)jq["depth"], (size_t)0);
+    REQUIRE_EQ((size_t)jq["capacity"], (size_t)64);
+    REQUIRE((size_t)jq["max_depth"] > 0);
+    REQUIRE((double)jq["producer_blocked"] >= 0);
+    REQUIRE((double)jq["consumer_starved"] >= 0);
+    REQUIRE_EQ((size_t)j["stages"]["test_stats_stage"]["items"], count);
+}
+
+TEST_CASE(DuplicateNameFinder)
+{
+    // names with duplicates, hits are all names so that false positives are covered
+    mt19937 rnd(38);
+    const size_t count = 300000;
+    vector<string> names;
+    str_sv_type vec;
+    {
+        auto bi = vec.get_back_inserter();
+        for (size_t i = 0; i < count; ++i) {
+            names.push_back("SRR" + to_string(rnd() % (count * 4)));
+            bi = names.back();
+        }
+    }
+    vector<size_t> expected;
+    {
+        set<string> seen;
+        for (size_t i = 0; i < count; ++i) {
+            if (!seen.insert(names[i]).second)
+                expected.push_back(i);
+        }
+    }
+    REQUIRE(!expected.empty());
+    for (unsigned threads : {1, 4}) {
+        duplicate_name_finder finder;
+        vector<size_t> dups;
+        size_t batch_start = 0;
+        for (size_t i = 0; i < count; ++i) {
+            finder.add(names[i], i);
+            if (finder.size() == 70000 || i + 1 == count) {
+                for (auto d : finder.resolve(vec, threads))
+                    dups.push_back(batch_start + d);
+                REQUIRE(finder.empty());
+                batch_start = i + 1;
+            }
+        }
+        REQUIRE(dups == expected);
+    }
+}
+
 ////////////////////////////////////////////
 
 int main (int argc, char *argv [])
@@ -0,0 +1,218 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/**
+* Unit tests for the shared-memory ring between SHARQ's writer and general-loader
+*/
+
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+
+using namespace std;
+
+// expects std names in scope, like in the loader
+#include "../../../tools/loaders/sharq/sra-tools/writer.hpp"
+
+#include <ktst/unit_test.hpp>
+
+TEST_SUITE(SharQRingTestSuite);
+
+// the smallest ring there is, one page, so that every test wraps around many times
+static const size_t RingSize = 4096;
+static const string RingDir = "/tmp";
+
+class RingFixture
+{
+public:
+    // the ring path from the use-ring event, which is the last thing written to the pipe
+    static string RingPath(const string & pipe)
+    {
+        auto const at = pipe.rfind(RingDir + "/gw-ring-");
+        if (at == string::npos)
+            return string();
+        return pipe.substr(at, RingDir.size() + 15);
+    }
+
+    // everything the consumer gets until the producer closes the ring
+    static void Drain(const string & path, string * out)
+    {
+        unique_ptr<ncbi::GWRing> ring(ncbi::GWRing::attach(path));
+        size_t size = 0;
+        while (true)
+        {
+            // sizes that do not divide the ring, to read across the wrap point
+            size = size % 1000 + 7;
+            auto p = (const char *)ring->peek(size);
+            if (p == nullptr)
+            {
+                // the tail is shorter than the last request
+                size = 1;
+                p = (const char *)ring->peek(size);
+                if (p == nullptr)
+                    break;
+            }
+            out->append(p, size);
+            ring->consume(size);
+        }
+    }
+
+    static void WriteEvents(Writer2 & w)
+    {
+        w.beginWriting();
+        for (unsigned i = 0; i < 2000; ++i)
+        {
+            // from nothing to more than the ring holds
+            w.logMessage(string(i * 37 % 9000, char('a' + i % 26)));
+            w.progressMessage(to_string(i));
+        }
+        w.endWriting();
+    }
+};
+
+FIXTURE_TEST_CASE(Ring_Loopback, RingFixture)
+{
+    ostringstream plain;
+    {
+        Writer2 w(plain);
+        WriteEvents(w);
+    }
+
+    ostringstream pipe;
+    string path;
+    string received;
+    thread reader;
+    {
+        Writer2 w(pipe);
+        REQUIRE(w.useSharedRing(RingDir, RingSize));
+        path = RingPath(pipe.str());
+        REQUIRE(!path.empty());
+        reader = thread(Drain, path, &received);
+        WriteEvents(w);
+        // closes the ring
+    }
+    reader.join();
+
+    // the pipe has the stream header and the use-ring event, the ring has the rest
+    size_t const useRingEvent = 8 + ((path.size() + 3) & ~size_t(3));
+    REQUIRE_LT(useRingEvent, pipe.str().size());
+    size_t const header = pipe.str().size() - useRingEvent;
+    REQUIRE_EQ(plain.str().substr(0, header), pipe.str().substr(0, header));
+    REQUIRE_EQ(plain.str().size() - header, received.size());
+    REQUIRE(plain.str().substr(header) == received);
+}
+
+FIXTURE_TEST_CASE(Ring_WriterClose, RingFixture)
+{
+    unique_ptr<ncbi::GWRing> producer(ncbi::GWRing::create(RingDir, RingSize));
+    REQUIRE(producer != nullptr);
+    unique_ptr<ncbi::GWRing> consumer(ncbi::GWRing::attach(producer->path()));
+
+    // move the ends close to the wrap point, then write across it
+    string const filler(RingSize - 10, 'x');
+    producer->write(filler.data(), filler.size());
+    producer->publish();
+    REQUIRE(consumer->peek(filler.size()) != nullptr);
+    consumer->consume(filler.size());
+
+    string const last = "across the end of the ring";
+    producer->write(last.data(), last.size());
+    producer->close();
+
+    // a closed ring still delivers what was written, then reports the end
+    REQUIRE(consumer->peek(last.size() + 1) == nullptr);
+    auto const p = (const char *)consumer->peek(last.size());
+    REQUIRE(p != nullptr);
+    REQUIRE_EQ(last, string(p, last.size()));
+    consumer->consume(last.size());
+    REQUIRE(consumer->peek(1) == nullptr);
+}
+
+FIXTURE_TEST_CASE(Ring_ReaderGoesAway, RingFixture)
+{
+    unique_ptr<ncbi::GWRing> producer(ncbi::GWRing::create(RingDir, RingSize));
+    REQUIRE(producer != nullptr);
+
+    pid_t const pid = fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0)
+    {
+        // attach, as general-loader does, and exit without reading
+        delete ncbi::GWRing::attach(producer->path());
+        _exit(0);
+    }
+    int status = 0;
+    REQUIRE_EQ(pid, waitpid(pid, &status, 0));
+
+    // more than fits: the producer must notice the consumer is gone instead of waiting for it
+    string const data(2 * RingSize, 'x');
+    REQUIRE_THROW(producer->write(data.data(), data.size()));
+}
+
+FIXTURE_TEST_CASE(Ring_WriterGoesAway, RingFixture)
+{
+    int fds[2];
+    REQUIRE_EQ(0, pipe(fds));
+
+    pid_t const pid = fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0)
+    {
+        // create, write a little and exit without closing the ring
+        close(fds[0]);
+        auto const ring = ncbi::GWRing::create(RingDir, RingSize);
+        if (ring == nullptr)
+            _exit(1);
+        ring->write("data", 4);
+        ring->publish();
+        if (write(fds[1], ring->path().data(), ring->path().size()) != (ssize_t)ring->path().size())
+            _exit(1);
+        _exit(0);
+    }
+    close(fds[1]);
+    char path[256];
+    auto const size = read(fds[0], path, sizeof(path));
+    close(fds[0]);
+    int status = 0;
+    REQUIRE_EQ(pid, waitpid(pid, &status, 0));
+    REQUIRE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    REQUIRE_GT(size, 0);
+
+    unique_ptr<ncbi::GWRing> consumer(ncbi::GWRing::attach(string(path, (size_t)size)));
+    REQUIRE(consumer->peek(4) != nullptr);
+    consumer->consume(4);
+    // the consumer must not wait forever for a producer that is gone
+    REQUIRE_THROW(consumer->peek(1));
+}
+
+int main (int argc, char *argv [])
+{
+    return SharQRingTestSuite(argc, argv);
+}
@@ -0,0 +1,120 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/**
+* Unit tests for SHARQ loader's spill file of cold reads
+*/
+
+#include "../../../tools/loaders/sharq/spot_spill.hpp"
+
+#include <ktst/unit_test.hpp>
+
+using namespace std;
+
+TEST_SUITE(SharQSpillTestSuite);
+
+static const string SpillPath = "./test-sharq-spill.tmp";
+
+TEST_CASE(FileRemovedOnOpen)
+{
+    spill_segment_t spill;
+    spill.open(SpillPath);
+    REQUIRE(spill.is_open());
+    // the file lives only as long as its descriptor
+    REQUIRE_NE(access(SpillPath.c_str(), F_OK), 0);
+    spill.close();
+    REQUIRE(!spill.is_open());
+}
+
+TEST_CASE(BytesWrittenBeforeFlush)
+{
+    spill_segment_t spill;
+    spill.open(SpillPath);
+    REQUIRE_EQ(spill.bytes_written(), 0lu);
+    spill.append("record");
+    // the block is not flushed yet, the record is still counted
+    REQUIRE_EQ(spill.bytes_written(), sizeof(uint32_t) + 6);
+}
+
+TEST_CASE(RecordsAcrossBlocks)
+{
+    spill_segment_t spill;
+    spill.open(SpillPath);
+    vector<string> records;
+    vector<uint64_t> locs;
+    // about 3 blocks
+    for (size_t i = 0; records.size() < 3 * 1024; ++i) {
+        records.push_back(string(1000 + i % 37, 'a' + i % 26) + to_string(i));
+        locs.push_back(spill.append(records.back()));
+    }
+    REQUIRE_GT(locs.back() >> spill_segment_t::SPILL_BLOCK_BITS, 1lu);
+
+    string record;
+    // random access to flushed and pending blocks
+    for (size_t i = records.size(); i-- > 0; ) {
+        spill.read(locs[i], record);
+        REQUIRE_EQ(record, records[i]);
+    }
+    size_t n = 0;
+    spill.for_each_record([&](const string& rec) {
+        REQUIRE_LT(n, records.size());
+        REQUIRE_EQ(rec, records[n]);
+        ++n;
+    });
+    REQUIRE_EQ(n, records.size());
+    // everything is flushed now
+    spill.read(locs.back(), record);
+    REQUIRE_EQ(record, records.back());
+}
+
+TEST_CASE(ReadRoundTrip)
+{
+    fastq_read read;
+    read.m_ReaderIdx = 3;
+    read.SetReadFilter(1);
+    read.SetReadNum(string("2"));
+    read.SetSpotGroup(string("GROUP"));
+    read.SetSequence("ACGTNACGT"); // odd length
+    read.SetQualScores({30, 31, 32, 33, 2, 35, 36, 37, 38});
+
+    string record, tmp;
+    spill_encode_read(read, record);
+    fastq_read out;
+    spill_decode_read(record, out, tmp);
+    REQUIRE_EQ(out.m_ReaderIdx, read.m_ReaderIdx);
+    REQUIRE_EQ((int)out.ReadFilter(), 1);
+    REQUIRE_EQ(out.ReadNum(), read.ReadNum());
+    REQUIRE_EQ(out.SpotGroup(), read.SpotGroup());
+    REQUIRE_EQ(out.Sequence(), read.Sequence());
+    REQUIRE(out.GetQualScores() == read.GetQualScores());
+}
+
+////////////////////////////////////////////
+
+int main (int argc, char *argv [])
+{
+    return SharQSpillTestSuite(argc, argv);
+}
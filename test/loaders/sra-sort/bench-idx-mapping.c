@@ -0,0 +1,179 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/*
+    Benchmark of sra-sort's id map sort ( idx-mapping.c )
+
+    Usage: bench-idx-mapping [entries in millions, default 16] [threads, default 4] [quota in MB]
+
+    Maps with dense, negative and spread old ids in random order are
+    sorted with KSORT and with IdxMappingSortOld, which takes the radix
+    sort with a scratch copy of at most what the quota leaves. Seconds,
+    entries/s and the peak RSS of the process after each sort are reported.
+*/
+
+#include <kapp/main.h>
+#include <kapp/args.h>
+
+#include <klib/out.h>
+#include <klib/rc.h>
+#include <klib/sort.h>
+
+#include "ctx.h"
+#include "caps.h"
+#include "mem.h"
+#include "except.h"
+#include "sra-sort.h"
+#include "idx-mapping.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+FILE_ENTRY ( bench-idx-mapping );
+
+const char UsageDefaultName[] = "bench-idx-mapping";
+
+rc_t CC UsageSummary ( const char * progname ) {
+    return KOutMsg( "\nUsage:\n %s [entries in millions] [threads] [quota in MB]\n\n", progname );
+}
+
+rc_t CC Usage ( const Args * args ) {
+    return UsageSummary( UsageDefaultName );
+}
+
+static double seconds( void ) {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts . tv_sec + ts . tv_nsec * 1e-9;
+}
+
+static long max_rss_mb( void ) {
+    struct rusage ru;
+    getrusage( RUSAGE_SELF, &ru );
+    return ru . ru_maxrss / 1024;
+}
+
+static const char * ids_name[] = { "dense", "negative", "spread" };
+
+static void make_map( IdxMapping * map, size_t count, int ids ) {
+    uint64_t seed = 88172645463325252ull;
+    size_t i;
+    for ( i = 0; i < count; ++i ) {
+        int64_t id = ( int64_t )i + 1;
+        if ( 1 == ids ) {
+            id -= ( int64_t )( count / 2 );
+        } else if ( 2 == ids ) {
+            id = id * 0x10001 + ( ( int64_t )1 << 40 );
+        }
+        map[ i ] . old_id = id;
+        map[ i ] . new_id = ( int64_t )i + 1;
+    }
+    for ( i = count - 1; i > 0; --i ) {
+        size_t j;
+        int64_t t;
+        seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+        j = seed % ( i + 1 );
+        t = map[ i ] . old_id; map[ i ] . old_id = map[ j ] . old_id; map[ j ] . old_id = t;
+    }
+}
+
+static bool is_sorted( const IdxMapping * map, size_t count ) {
+    size_t i;
+    for ( i = 1; i < count; ++i ) {
+        if ( map[ i - 1 ] . old_id > map[ i ] . old_id ) { return false; }
+    }
+    return true;
+}
+
+/* the fallback of IdxMappingSortOld */
+static void ksort_old( IdxMapping * self, size_t count ) {
+#define T( x ) ( ( const IdxMapping* ) ( x ) )
+#define SWAP( a, b, off, size ) KSORT_TSWAP ( IdxMapping, a, b )
+#define CMP( a, b ) \
+    ( ( T ( a ) -> old_id < T ( b ) -> old_id ) ? -1 : ( T ( a ) -> old_id > T ( b ) -> old_id ) )
+
+    KSORT ( self, count, sizeof * self, 0, sizeof * self );
+
+#undef CMP
+#undef SWAP
+#undef T
+}
+
+static rc_t report( const char * what, int ids, size_t count, double elapsed, bool sorted ) {
+    return KOutMsg( "%-6s %-8s %8.2f s %12.0f entries/s maxrss %6ld MB%s\n",
+                    what, ids_name[ ids ], elapsed, ( double )count / elapsed, max_rss_mb(),
+                    sorted ? "" : " NOT SORTED" );
+}
+
+rc_t CC KMain( int argc, char *argv [] ) {
+    rc_t rc = 0;
+    size_t count = ( size_t )( ( argc > 1 ) ? strtoull( argv[ 1 ], NULL, 10 ) : 16 ) * 1000 * 1000;
+    uint32_t threads = ( argc > 2 ) ? ( uint32_t )strtoul( argv[ 2 ], NULL, 10 ) : 4;
+    size_t quota = ( argc > 3 ) ? ( size_t )strtoull( argv[ 3 ], NULL, 10 ) * 1024 * 1024 : ( size_t )-1;
+    IdxMapping * map = malloc( sizeof map[ 0 ] * count );
+
+    DECLARE_CTX_INFO ();
+    Tool tool;
+    Caps caps;
+    ctx_t main_ctx = { & caps, NULL, & ctx_info };
+    const ctx_t * ctx = & main_ctx;
+
+    memset( &tool, 0, sizeof tool );
+    memset( &caps, 0, sizeof caps );
+    tool . max_copy_threads = threads;
+    caps . tool = &tool;
+
+    if ( NULL == map ) {
+        return RC( rcExe, rcMemory, rcAllocating, rcMemory, rcExhausted );
+    }
+    caps . mem = MemBankMake( ctx, quota );
+    rc = KOutMsg( "%zu entries ( %zu MB ), %u threads, maxrss %ld MB\n",
+                  count, ( sizeof map[ 0 ] * count ) >> 20, threads, max_rss_mb() );
+    {
+        int ids;
+        for ( ids = 0; 0 == rc && ids < 3; ++ids ) {
+            double start;
+
+            make_map( map, count, ids );
+            start = seconds();
+            ksort_old( map, count );
+            rc = report( "KSORT", ids, count, seconds() - start, is_sorted( map, count ) );
+
+            make_map( map, count, ids );
+            start = seconds();
+            IdxMappingSortOld( map, ctx, count );
+            if ( 0 == rc ) {
+                rc = ( FAILED() ) ? ctx -> rc : report( "radix", ids, count, seconds() - start, is_sorted( map, count ) );
+            }
+        }
+    }
+    MemBankRelease( caps . mem, ctx );
+    free( map );
+    return rc;
+}
@@ -0,0 +1,93 @@
+#!/usr/bin/env bash
+
+# the goal of this test is to verify that sra-sort produces the same
+# output when columns are copied concurrently ( --threads N ) as when
+# they are copied one after the other ( --threads 1 )
+#
+# the test uses the sam-factory-tool to produce a random cSRA-object
+# and vdb-dump to compare the content of every table of the sorted copies
+#
+
+set -e
+
+source ./check_bin_tools.sh $1 $3
+
+VDB_INCDIR="$2"
+VDBDUMP="${BINDIR}/vdb-dump"
+
+if [[ ! -x "$VDBDUMP" ]]; then
+    echo "$VDBDUMP - executable not found"
+    exit 3
+fi
+
+print_verbose "testing sra-sort with --threads"
+print_verbose "-------------------------------"
+
+#------------------------------------------------------------
+#create a tempp. config-file
+cat << EOF > tmp.kfg
+/vdb/schema/paths = "${VDB_INCDIR}"
+/LIBS/GUID = "8test003-6abf-47b2-bfd0-test-sra-sort"
+EOF
+
+#------------------------------------------------------------
+#produce a random sam-file
+
+RNDSAM="rnd_sam_threads.SAM"
+RNDREF="rnd-ref-threads.fasta"
+
+rm -f "$RNDSAM" "$RNDREF"
+
+#two references, secondary alignments and unaligned reads, so that
+#every table of the cSRA-object has rows
+$SAMFACTORY << EOF
+r:type=random,name=R1,length=6000
+r:type=random,name=R2,length=4000
+ref-out:$RNDREF
+sam-out:$RNDSAM
+p:name=A,repeat=2000
+p:name=A,repeat=2000
+p:name=B,ref=R2,repeat=1000
+p:name=B,ref=R2,repeat=1000
+s:name=B,ref=R2,repeat=1000
+u:name=U1,len=50
+u:name=U2,len=60
+EOF
+
+if [[ ! -f "$RNDSAM" ]]; then
+    echo "$RNDSAM not produced"
+    exit 3
+fi
+
+print_verbose "random SAM-file produced!"
+
+ORG_CSRA="org_csra_threads"
+
+source ./sam_to_csra.sh $RNDSAM $RNDREF $ORG_CSRA
+rm $RNDSAM $RNDREF
+
+#------------------------------------------------------------
+#sort on a single thread and on several threads
+
+SORTED_1="sorted_csra_1"
+SORTED_N="sorted_csra_n"
+
+VDB_CONFIG=`pwd` $SRASORT -f --threads 1 ./$ORG_CSRA ./$SORTED_1
+VDB_CONFIG=`pwd` $SRASORT -f --threads 4 ./$ORG_CSRA ./$SORTED_N
+
+#------------------------------------------------------------
+#compare the content of every table
+
+for TBL in SEQUENCE PRIMARY_ALIGNMENT SECONDARY_ALIGNMENT REFERENCE
+do
+    VDB_CONFIG=`pwd` $VDBDUMP -T $TBL ./$SORTED_1 > dump_1.txt 2>/dev/null || true
+    VDB_CONFIG=`pwd` $VDBDUMP -T $TBL ./$SORTED_N > dump_n.txt 2>/dev/null || true
+    if ! cmp -s dump_1.txt dump_n.txt; then
+        echo "table $TBL differs between --threads 1 and --threads 4"
+        diff dump_1.txt dump_n.txt | head -20
+        exit 3
+    fi
+    print_verbose "table $TBL is identical"
+done
+
+rm -rf "$ORG_CSRA" $SORTED_1 $SORTED_N dump_1.txt dump_n.txt tmp.kfg
@@ -0,0 +1,209 @@
+/*===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ */
+
+
+/**
+* Tests of the radix sort of IdxMappingSortOld/New against KSORT:
+* a MemBank quota below the size of the map makes it sort in buckets
+*/
+
+#include <ktst/unit_test.hpp>
+
+#include <klib/sort.h>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+extern "C" {
+#include "ctx.h"
+#include "caps.h"
+#include "mem.h"
+#include "except.h"
+#include "sra-sort.h"
+#include "idx-mapping.h"
+}
+
+using namespace std;
+
+TEST_SUITE(IdxMappingTestSuite);
+
+FILE_ENTRY ( test-idx-mapping );
+
+/* above RADIX_SORT_MIN_COUNT, with a scratch copy of less than half of it in the quota */
+static const size_t MAP_COUNT = 300 * 1000;
+static const size_t BUCKET_QUOTA = 2 * 1024 * 1024;
+
+enum Ids { ids_dense, ids_negative, ids_spread };
+
+static int64_t CC CmpOld ( const void *a, const void *b, void *data )
+{
+    const IdxMapping *ap = ( const IdxMapping* ) a;
+    const IdxMapping *bp = ( const IdxMapping* ) b;
+    return ap -> old_id < bp -> old_id ? -1 : ap -> old_id > bp -> old_id;
+}
+
+static int64_t CC CmpNew ( const void *a, const void *b, void *data )
+{
+    const IdxMapping *ap = ( const IdxMapping* ) a;
+    const IdxMapping *bp = ( const IdxMapping* ) b;
+    return ap -> new_id < bp -> new_id ? -1 : ap -> new_id > bp -> new_id;
+}
+
+class IdxMappingFixture
+{
+public:
+    IdxMappingFixture ()
+    {
+        DECLARE_CTX_INFO ();
+
+        memset ( & m_tool, 0, sizeof m_tool );
+        memset ( & m_caps, 0, sizeof m_caps );
+        m_tool . max_copy_threads = 4;
+        m_caps . tool = & m_tool;
+        m_info = ctx_info;
+        m_ctx . caps = & m_caps;
+        m_ctx . caller = NULL;
+        m_ctx . info = & m_info;
+        m_ctx . rc = 0;
+    }
+    ~IdxMappingFixture ()
+    {
+        if ( m_caps . mem != NULL )
+            MemBankRelease ( m_caps . mem, & m_ctx );
+    }
+
+    /* unique old and new ids in random order */
+    void MakeMap ( Ids ids )
+    {
+        mt19937_64 rng ( 20240501 );
+        m_map . resize ( MAP_COUNT );
+        for ( size_t i = 0; i < MAP_COUNT; ++ i )
+        {
+            int64_t id = ( int64_t ) i + 1;
+            switch ( ids )
+            {
+            case ids_dense:
+                break;
+            case ids_negative:
+                id -= ( int64_t ) ( MAP_COUNT / 2 );
+                break;
+            case ids_spread:
+                id = id * 0x10001 + ( ( int64_t ) 1 << 40 );
+                break;
+            }
+            m_map [ i ] . old_id = id;
+            m_map [ i ] . new_id = - id;
+        }
+        shuffle ( m_map . begin (), m_map . end (), rng );
+        for ( size_t i = 0; i < MAP_COUNT; ++ i )
+            swap ( m_map [ i ] . new_id, m_map [ rng () % MAP_COUNT ] . new_id );
+    }
+
+    bool SortsLikeKSort ( size_t quota, bool by_new )
+    {
+        const ctx_t *ctx = & m_ctx;
+        vector < IdxMapping > expected ( m_map );
+
+        m_caps . mem = MemBankMake ( ctx, quota );
+        ksort ( expected . data (), expected . size (), sizeof expected [ 0 ],
+                by_new ? CmpNew : CmpOld, NULL );
+        if ( by_new )
+            IdxMappingSortNew ( m_map . data (), ctx, m_map . size () );
+        else
+            IdxMappingSortOld ( m_map . data (), ctx, m_map . size () );
+        if ( FAILED () )
+            return false;
+
+        for ( size_t i = 0; i < m_map . size (); ++ i )
+        {
+            if ( m_map [ i ] . old_id != expected [ i ] . old_id ||
+                 m_map [ i ] . new_id != expected [ i ] . new_id )
+                return false;
+        }
+        return true;
+    }
+
+    Tool m_tool;
+    Caps m_caps;
+    ctx_info_t m_info;
+    ctx_t m_ctx;
+    vector < IdxMapping > m_map;
+};
+
+FIXTURE_TEST_CASE ( Buckets_Dense_Old, IdxMappingFixture )
+{
+    MakeMap ( ids_dense );
+    REQUIRE ( SortsLikeKSort ( BUCKET_QUOTA, false ) );
+}
+
+FIXTURE_TEST_CASE ( Buckets_Dense_New, IdxMappingFixture )
+{
+    MakeMap ( ids_dense );
+    REQUIRE ( SortsLikeKSort ( BUCKET_QUOTA, true ) );
+}
+
+FIXTURE_TEST_CASE ( Buckets_Negative_Old, IdxMappingFixture )
+{
+    MakeMap ( ids_negative );
+    REQUIRE ( SortsLikeKSort ( BUCKET_QUOTA, false ) );
+}
+
+FIXTURE_TEST_CASE ( Buckets_Negative_New, IdxMappingFixture )
+{
+    MakeMap ( ids_negative );
+    REQUIRE ( SortsLikeKSort ( BUCKET_QUOTA, true ) );
+}
+
+FIXTURE_TEST_CASE ( Buckets_Spread_Old, IdxMappingFixture )
+{
+    MakeMap ( ids_spread );
+    REQUIRE ( SortsLikeKSort ( BUCKET_QUOTA, false ) );
+}
+
+FIXTURE_TEST_CASE ( Buckets_Spread_New, IdxMappingFixture )
+{
+    MakeMap ( ids_spread );
+    REQUIRE ( SortsLikeKSort ( BUCKET_QUOTA, true ) );
+}
+
+FIXTURE_TEST_CASE ( Unlimited_Spread_Old, IdxMappingFixture )
+{   // the whole map in one scratch copy
+    MakeMap ( ids_spread );
+    REQUIRE ( SortsLikeKSort ( ( size_t ) -1, false ) );
+}
+
+FIXTURE_TEST_CASE ( Below_Radix_Count, IdxMappingFixture )
+{   // left to KSORT
+    MakeMap ( ids_negative );
+    m_map . resize ( 1000 );
+    REQUIRE ( SortsLikeKSort ( BUCKET_QUOTA, false ) );
+}
+
+int main(int argc, char *argv[])
+{
+    return IdxMappingTestSuite(argc, argv);
+}
@@ -38,6 +38,10 @@
 #include "copy_machine.h"
 #endif
 
+#ifndef _h_multi_writer_
+#include "multi_writer.h"
+#endif
+
 #ifndef _h_kfs_buffile_
 #include <kfs/buffile.h>
 #endif
@@ -148,6 +152,113 @@ static rc_t concat_execute_un_compressed_no_append( KDirectory * dir,
     return rc;
 }
 
+/* the part-files are read in chunks, every chunk is compressed independently
+   by the multi-writer: into a gzip-member or into BGZF-blocks */
+#define CONCAT_COMPRESS_CHUNK ( 1024 * 1024 )
+
+static rc_t concat_compress_this_file( KDirectory * dir,
+                    struct multi_writer_t * mw,
+                    const char * filename,
+                    char * chunk,
+                    size_t buf_size,
+                    struct bg_progress_t * progress ) {
+    const struct KFile * src;
+    rc_t rc = ft_make_buffered_for_read( dir, &src, filename, buf_size ); /* file_tools.c */
+    if ( 0 == rc ) {
+        uint64_t src_pos = 0;
+        size_t num_read = 1;
+        while ( 0 == rc && num_read > 0 ) {
+            rc = KFileReadAll( src, src_pos, chunk, CONCAT_COMPRESS_CHUNK, &num_read );
+            if ( 0 != rc ) {
+                ErrMsg( "concatenator.c concat_compress_this_file().KFileReadAll( '%s' at %lu ) -> %R",
+                        filename, src_pos, rc );
+            } else if ( num_read > 0 ) {
+                struct multi_writer_block_t * block = mw_get_empty_block( mw ); /* multi_writer.c */
+                if ( NULL == block ) {
+                    rc = RC( rcExe, rcFile, rcPacking, rcMemory, rcExhausted );
+                    ErrMsg( "concatenator.c concat_compress_this_file().mw_get_empty_block() -> %R", rc );
+                } else if ( !mw_append_block( block, chunk, num_read ) ) {
+                    mw_submit_block( mw, block ); /* hands the empty block back */
+                    rc = RC( rcExe, rcFile, rcPacking, rcBuffer, rcInsufficient );
+                    ErrMsg( "concatenator.c concat_compress_this_file().mw_append_block() -> %R", rc );
+                } else if ( !mw_submit_block( mw, block ) ) {
+                    rc = RC( rcExe, rcFile, rcPacking, rcTransfer, rcFailed );
+                    ErrMsg( "concatenator.c concat_compress_this_file().mw_submit_block() -> %R", rc );
+                } else {
+                    src_pos += num_read;
+                    bg_progress_update( progress, num_read ); /* progress_thread.c */
+                }
+            }
+        }
+        {
+            rc_t rc2 = ft_release_file( src, "concat_compress_this_file( '%s' )", filename );
+            rc = ( 0 == rc ) ? rc2 : rc;
+        }
+    }
+    if ( 0 == rc ) {
+        rc = KDirectoryRemove( dir, true, "%s", filename );
+        if ( 0 != rc ) {
+            ErrMsg( "concatenator.c concat_compress_this_file().KDirectoryRemove( '%s' ) -> %R", filename, rc );
+        }
+    }
+    return rc;
+}
+
+/* output_filename == NULL : the compressed data goes to stdout */
+rc_t concat_execute_compressed( KDirectory * dir,
+                    const char * output_filename,
+                    const struct VNamelist * files,
+                    size_t buf_size,
+                    struct bg_progress_t * progress,
+                    bool force,
+                    compress_t compress,
+                    uint32_t num_compressors ) {
+    uint32_t count;
+    rc_t rc = VNameListCount( files, &count );
+    if ( 0 != rc ) {
+        ErrMsg( "concatenator.c concat_execute_compressed().VNameListCount() -> %R", rc );
+    } else if ( count > 0 ) {
+        if ( NULL != output_filename && !force && ft_file_exists( dir, "%s", output_filename ) ) {
+            rc = RC( rcExe, rcFile, rcPacking, rcName, rcExists );
+            ErrMsg( "concat_execute_compressed() creating ouput-file '%s' -> %R", output_filename, rc );
+        } else {
+            char * chunk = malloc( CONCAT_COMPRESS_CHUNK );
+            if ( NULL == chunk ) {
+                rc = RC( rcExe, rcFile, rcPacking, rcMemory, rcExhausted );
+                ErrMsg( "concat_execute_compressed().malloc( %d ) -> %R", CONCAT_COMPRESS_CHUNK, rc );
+            } else {
+                /* a block has to be larger than the chunk appended to it */
+                struct multi_writer_t * mw = mw_create( dir, output_filename, buf_size,
+                                                        0, 0, CONCAT_COMPRESS_CHUNK + 1,
+                                                        compress, num_compressors ); /* multi_writer.c */
+                if ( NULL == mw ) {
+                    rc = RC( rcExe, rcFile, rcPacking, rcMemory, rcExhausted );
+                    StdErrMsg( "\n\tError: fasterq-dump cannot create this file: '%s'\n",
+                               NULL == output_filename ? "stdout" : output_filename );
+                } else {
+                    uint32_t idx;
+                    for ( idx = 0; 0 == rc && idx < count; ++idx ) {
+                        const char * filename;
+                        rc = VNameListGet( files, idx, &filename );
+                        if ( 0 != rc ) {
+                            ErrMsg( "concat_execute_compressed().VNameListGet( %u ) -> %R", idx, rc );
+                        } else {
+                            rc = concat_compress_this_file( dir, mw, filename, chunk, buf_size, progress );
+                        }
+                    }
+                    {
+                        /* waits for the compressors and the writer, reports their errors */
+                        rc_t rc2 = mw_release( mw ); /* multi_writer.c */
+                        rc = ( 0 == rc ) ? rc2 : rc;
+                    }
+                }
+                free( ( void * ) chunk );
+            }
+        }
+    }
+    return rc;
+}
+
 /* ---------------------------------------------------------------------------------- */
 
 /* used by temp_registry.c */
@@ -157,11 +268,17 @@ rc_t concat_execute( KDirectory * dir,
                     size_t buf_size,
                     struct bg_progress_t * progress,
                     bool force,
-                    bool append ) {
+                    bool append,
+                    compress_t compress,
+                    uint32_t num_compressors ) {
     uint32_t count;
     rc_t rc = VNameListCount( files, &count );
     if ( 0 != rc ) {
         ErrMsg( "concatenator.c execute_concat().VNameListCount() -> %R", rc );
+    } else if ( ct_none != compress ) {
+        /* appending to compressed output is rejected by tctx_encforce_constrains() */
+        rc = concat_execute_compressed( dir, output_filename, files, buf_size,
+                                        progress, force, compress, num_compressors );
     } else if ( count > 0 ) {
         uint32_t q_wait_time = 500;
         bool file_exists = ft_file_exists( dir, "%s", output_filename );
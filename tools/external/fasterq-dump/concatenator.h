@@ -57,7 +57,20 @@ rc_t concat_execute( KDirectory * dir,
                     size_t buf_size,
                     struct bg_progress_t * progress,
                     bool force,
-                    bool append );
+                    bool append,
+                    compress_t compress,
+                    uint32_t num_compressors );
+
+/* compresses the files in the order of the list into one output-file,
+   to stdout if output_filename is NULL, removes the files */
+rc_t concat_execute_compressed( KDirectory * dir,
+                    const char * output_filename,
+                    const struct VNamelist * files,
+                    size_t buf_size,
+                    struct bg_progress_t * progress,
+                    bool force,
+                    compress_t compress,
+                    uint32_t num_compressors );
 
 #ifdef __cplusplus
 }
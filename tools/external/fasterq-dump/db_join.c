@@ -2075,7 +2075,9 @@ rc_t dbj_create_unsorted_fasta( const dbj_unsorted_fasta_args_t * args ) {
                     args -> buf_size,
                     0,                          /* q_wait_time, if 0 --> use default = 5 ms */
                     args -> num_threads * 3,    /* q_num_blocks, if 0 use default = 8 */
-                    0 );                        /* q_block_size, if 0 use default = 4 MB */
+                    0,                          /* q_block_size, if 0 use default = 4 MB */
+                    args -> compress,           /* helper.h, ct_none for uncompressed output */
+                    args -> num_threads );      /* num_compressors */
             if ( NULL != multi_writer ) {
                 struct bg_progress_t * progress = NULL;
                 struct filter_2na_t * filter = hlp_make_2na_filter( args -> join_options -> filter_bases ); /* helper.c */
@@ -2145,7 +2147,10 @@ rc_t dbj_create_unsorted_fasta( const dbj_unsorted_fasta_args_t * args ) {
                 }
                 hlp_release_2na_filter( filter ); /* helper.c */
                 bg_progress_release( progress ); /* progress_thread.c ( ignores NULL ) */
-                mw_release( multi_writer ); /* ( ignores NULL ) */ 
+                {
+                    rc_t rc2 = mw_release( multi_writer ); /* ( ignores NULL ) */
+                    if ( 0 == rc ) { rc = rc2; }
+                }
 
             } /* if ( NULL != multi-writer )*/
         } /*  if ( 0 == rc ) && seq_req_count > 0 ) */
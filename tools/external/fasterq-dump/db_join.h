@@ -98,6 +98,7 @@ typedef struct dbj_unsorted_fasta_args_t {
     size_t buf_size;                        /* size of buffer-file for output-writing */
     uint32_t num_threads;                   /* how many threads to use */
     uint64_t row_limit;
+    compress_t compress;                    /* helper.h, compress the output-file */
     bool show_progress;                     /* display progressbar */
     bool force;                             /* overwrite output-file if it exists */
     bool only_unaligned;                    /* process only un-aligned reads */
@@ -226,6 +226,14 @@ static const char * check_usage[] = { "switch to control:",
                                       NULL };
 #define OPTION_CHECK            "size-check"
 
+static const char * compress_usage[] = { "compress the output ( not with --append ):",
+                                         "none (default), ",
+                                         "gzip=concatenated gzip-members, ",
+                                         "bgzf=blocked gzip ( like BAM ), ",
+                                         "not for --fasta-ref-tbl, --fasta-concat-all, --ref-report",
+                                         NULL };
+#define OPTION_COMPRESS         "compress"
+
 static const char * disk_limit_out_usage[] = { "explicitly set disk-limit", NULL };
 #define OPTION_DISK_LIMIT_OUT   "disk-limit"
 
@@ -277,6 +285,7 @@ OptDef ToolOptions[] = {
     { OPTION_DISK_LIMIT_OUT,NULL,               NULL, disk_limit_out_usage, 1, true,   false },
     { OPTION_DISK_LIMIT_TMP,NULL,               NULL, disk_limit_tmp_usage, 1, true,   false },
     { OPTION_CHECK,         NULL,               NULL, check_usage,          1, true,   false },
+    { OPTION_COMPRESS,      NULL,               NULL, compress_usage,       1, true,   false },
     { OPTION_NGC,           NULL,               NULL, ngc_usage,            1, true,   false }
 };
 
@@ -442,6 +451,12 @@ static rc_t main_get_user_input( tool_ctx_t * tool_ctx, const Args * args ) {
         ErrMsg( "invalid check-mode -> %R", rc );
     }
 
+    tool_ctx -> compress = hlp_get_compress_t( ahlp_get_str_option( args, OPTION_COMPRESS, NULL ) );
+    if ( 0 == rc && ct_unknown == tool_ctx -> compress ) {
+        rc = RC( rcExe, rcFile, rcPacking, rcName, rcUnknown  );
+        ErrMsg( "invalid compression -> %R", rc );
+    }
+
     tool_ctx -> requested_seq_tbl_name = ahlp_get_str_option( args, OPTION_TABLE, NULL );
     tool_ctx -> append = ahlp_get_bool_option( args, OPTION_APPEND );
     tool_ctx -> use_stdout = ahlp_get_bool_option( args, OPTION_STDOUT );
@@ -635,7 +650,9 @@ static rc_t main_produce_final_db_output( const tool_ctx_t * tool_ctx ) {
         if ( tool_ctx -> use_stdout ) {
             rc = temp_registry_to_stdout( registry,
                                           tool_ctx -> dir,
-                                          tool_ctx -> buf_size ); /* temp_registry.c */
+                                          tool_ctx -> buf_size,
+                                          tool_ctx -> compress,
+                                          tool_ctx -> num_threads ); /* temp_registry.c */
         } else {
             rc = temp_registry_merge( registry,
                               tool_ctx -> dir,
@@ -643,7 +660,9 @@ static rc_t main_produce_final_db_output( const tool_ctx_t * tool_ctx ) {
                               tool_ctx -> buf_size,
                               tool_ctx -> show_progress,
                               tool_ctx -> force,
-                              tool_ctx -> append ); /* temp_registry.c */
+                              tool_ctx -> append,
+                              tool_ctx -> compress,
+                              tool_ctx -> num_threads ); /* temp_registry.c */
         }
     }
 
@@ -678,6 +697,7 @@ static rc_t main_process_csra_fasta_unsorted( const tool_ctx_t * tool_ctx ) {
     args . buf_size = tool_ctx -> buf_size;
     args . num_threads = tool_ctx -> num_threads;
     args . row_limit = tool_ctx -> row_limit;
+    args . compress = tool_ctx -> compress;
     args . show_progress = tool_ctx -> show_progress;
     args . force = tool_ctx -> force;
     args . only_unaligned = tool_ctx -> only_unaligned;
@@ -757,7 +777,9 @@ static rc_t main_process_table_in_seq_order( const tool_ctx_t * tool_ctx, const
         if ( tool_ctx -> use_stdout ) {
             rc = temp_registry_to_stdout( registry,
                                         tool_ctx -> dir,
-                                        tool_ctx -> buf_size ); /* temp_registry.c */
+                                        tool_ctx -> buf_size,
+                                        tool_ctx -> compress,
+                                        tool_ctx -> num_threads ); /* temp_registry.c */
         } else {
             rc = temp_registry_merge( registry,
                             tool_ctx -> dir,
@@ -765,7 +787,9 @@ static rc_t main_process_table_in_seq_order( const tool_ctx_t * tool_ctx, const
                             tool_ctx -> buf_size,
                             tool_ctx -> show_progress,
                             tool_ctx -> force,
-                            tool_ctx -> append ); /* temp_registry.c */
+                            tool_ctx -> append,
+                            tool_ctx -> compress,
+                            tool_ctx -> num_threads ); /* temp_registry.c */
         }
     }
 
@@ -801,6 +825,7 @@ static rc_t main_process_table_fasta_unsorted( const tool_ctx_t * tool_ctx, cons
     args . show_progress = tool_ctx -> show_progress;
     args . force = tool_ctx -> force;
     args . row_limit = tool_ctx -> row_limit;
+    args . compress = tool_ctx -> compress;
 
     rc = execute_unsorted_fasta_tbl_join( &args ); /* tbl_join.c */
 
@@ -146,9 +146,9 @@ void flp_release( struct flp_t * self ) {
         release_SBuffer( &( self -> transaction_buffer ) );
         if ( NULL != self -> multi_writer && NULL != self -> block ) {
             if ( !mw_submit_block( self -> multi_writer, self -> block ) ) {
-                /* TBD: cannot submit last block to multi-writer */
-                self -> block = NULL;
+                ErrMsg( "flp_release() cannot submit last block to multi-writer" );
             }
+            self -> block = NULL;
         }
         if ( NULL != self -> file_args ) {  VectorWhack ( &self -> printers, flp_release_fwrap, NULL ); }
         if ( NULL != self -> string_data[ sdi_acc ] ) StringWhack( self -> string_data[ 0 ] );
@@ -362,6 +362,7 @@ static rc_t flp_submit_to_buffer( struct flp_t * self, SBuffer_t * t ) {
             if ( !mw_append_block( self -> block, t -> S. addr, t -> S . len ) ) {
                 /* block was not big enough to hold the new data : */
                 if ( !mw_submit_block( self -> multi_writer, self -> block ) ) {
+                    self -> block = NULL;
                     rc = RC( rcApp, rcNoTarg, rcConstructing, rcParam, rcInvalid );
                     ErrMsg( "flex_submit() cannot submit block to multi-writer -> %R", rc );
                 } else {
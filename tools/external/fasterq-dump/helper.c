@@ -288,6 +288,55 @@ const char * hlp_check_mode_2_string( check_mode_t cm ) {
 
 /* -------------------------------------------------------------------------------- */
 
+static compress_t compress_cmp( const String * Compress, const char * test, compress_t test_ct ) {
+    String STestCompress;
+    StringInitCString( &STestCompress, test );
+    if ( 0 == StringCaseCompare ( Compress, &STestCompress ) )  {
+        return test_ct;
+    }
+    return ct_unknown;
+}
+
+compress_t hlp_get_compress_t( const char * compress ) {
+    compress_t res = ct_none;
+    if ( NULL != compress ) {
+        String Compress;
+        StringInitCString( &Compress, compress );
+
+        res = compress_cmp( &Compress, "none", ct_none );
+        if ( ct_unknown == res ) {
+            res = compress_cmp( &Compress, "gzip", ct_gzip );
+        }
+        if ( ct_unknown == res ) {
+            res = compress_cmp( &Compress, "bgzf", ct_bgzf );
+        }
+    }
+    return res;
+}
+
+static const char * CT_UNKNOWN    = "unknown";
+static const char * CT_NONE       = "none";
+static const char * CT_GZIP       = "gzip";
+static const char * CT_BGZF       = "bgzf";
+
+const char * hlp_compress_2_string( compress_t ct ) {
+    const char * res = CT_UNKNOWN;
+    switch ( ct ) {
+        case ct_unknown     : res = CT_UNKNOWN; break;
+        case ct_none        : res = CT_NONE; break;
+        case ct_gzip        : res = CT_GZIP; break;
+        case ct_bgzf        : res = CT_BGZF; break;
+    }
+    return res;
+}
+
+const char * hlp_compress_ext( compress_t ct ) {
+    if ( ct_gzip == ct || ct_bgzf == ct ) return ".gz";
+    return "";
+}
+
+/* -------------------------------------------------------------------------------- */
+
 static atomic32_t quit_flag;
 
 rc_t hlp_get_quitting( void ) {
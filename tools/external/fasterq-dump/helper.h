@@ -142,6 +142,19 @@ const char * hlp_check_mode_2_string( check_mode_t cm );
 
 /* -------------------------------------------------------------------------------- */
 
+typedef enum compress_t {
+    ct_unknown, ct_none, ct_gzip, ct_bgzf
+    } compress_t;
+
+compress_t hlp_get_compress_t( const char * compress );
+
+const char * hlp_compress_2_string( compress_t ct );
+
+/* file-extension to be appended to a generated output-filename, "" for ct_none */
+const char * hlp_compress_ext( compress_t ct );
+
+/* -------------------------------------------------------------------------------- */
+
 rc_t CC Quitting(); /* to avoid including kapp/main.h */
 rc_t hlp_get_quitting( void );
 void hlp_set_quitting( void );
@@ -53,11 +53,22 @@
 #include <kproc/timeout.h>
 #endif
 
+#ifndef _h_kproc_lock_
+#include <kproc/lock.h>
+#endif
+
+#include <zlib.h>
+
 typedef struct multi_writer_block_t
 {
     char * data;
     size_t len;
     size_t available;
+    char * cdata;           /* the compressed data, written instead of data if compressing */
+    size_t clen;
+    size_t cavailable;
+    uint64_t seq_nr;        /* order of submission, compressed blocks are written in this order */
+    rc_t rc;                /* set by a compressor that failed, the writer stops at this block */
 } multi_writer_block_t;
 
 static multi_writer_block_t * mw_create_block( size_t size ) {
@@ -79,6 +90,7 @@ static multi_writer_block_t * mw_create_block( size_t size ) {
 static void mw_release_block( multi_writer_block_t * self ) {
     if ( NULL != self ) {
         free( ( void * ) self -> data );
+        free( ( void * ) self -> cdata );
         free( ( void * ) self );
     }
 }
@@ -156,6 +168,99 @@ static rc_t mw_push( KQueue * q, const void * item, uint32_t wait_time ) {
     return rc;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+
+#define BGZF_MAX_INPUT 0xff00
+#define BGZF_MAX_BLOCK 0x10000
+#define BGZF_HDR_SIZE 18
+#define BGZF_FTR_SIZE 8
+
+static const uint8_t bgzf_hdr[ BGZF_HDR_SIZE ] = {
+    0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00, 'B', 'C', 0x02, 0x00, 0x00, 0x00 };
+
+/* the empty block that marks the end of a BGZF-file */
+static const uint8_t bgzf_eof[ 28 ] = {
+    0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00, 'B', 'C', 0x02, 0x00,
+    0x1b, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+static void mw_put_u32( uint8_t * dst, uint32_t value ) {
+    dst[ 0 ] = value & 0xff;
+    dst[ 1 ] = ( value >> 8 ) & 0xff;
+    dst[ 2 ] = ( value >> 16 ) & 0xff;
+    dst[ 3 ] = ( value >> 24 ) & 0xff;
+}
+
+/* window_bits = 15 + 16 : gzip-member, window_bits = -15 : raw deflate ( BGZF ) */
+static rc_t mw_deflate( const char * src, size_t src_len, uint8_t * dst, size_t dst_size,
+                        int window_bits, size_t * dst_len ) {
+    rc_t rc = 0;
+    z_stream zs;
+    memset( &zs, 0, sizeof zs );
+    if ( Z_OK != deflateInit2( &zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY ) ) {
+        rc = RC( rcExe, rcFile, rcPacking, rcMemory, rcExhausted );
+        ErrMsg( "multi_writer.c mw_deflate().deflateInit2() -> %R", rc );
+    } else {
+        zs . next_in = ( Bytef * )src;
+        zs . avail_in = ( uInt )src_len;
+        zs . next_out = ( Bytef * )dst;
+        zs . avail_out = ( uInt )dst_size;
+        if ( Z_STREAM_END != deflate( &zs, Z_FINISH ) ) {
+            rc = RC( rcExe, rcFile, rcPacking, rcBuffer, rcInsufficient );
+            ErrMsg( "multi_writer.c mw_deflate().deflate() -> %R", rc );
+        } else {
+            *dst_len = zs . total_out;
+        }
+        deflateEnd( &zs );
+    }
+    return rc;
+}
+
+static rc_t mw_compress_block( multi_writer_block_t * self, compress_t compress ) {
+    rc_t rc = 0;
+    size_t num_chunks = ( self -> len / BGZF_MAX_INPUT ) + 1;
+    /* enough for incompressible data, including the gzip-header/trailer of each chunk */
+    size_t needed = compressBound( self -> len ) + ( num_chunks * 64 );
+    self -> clen = 0;
+    if ( needed > self -> cavailable ) {
+        free( ( void * ) self -> cdata );
+        self -> cdata = malloc( needed );
+        self -> cavailable = ( NULL != self -> cdata ) ? needed : 0;
+    }
+    if ( NULL == self -> cdata ) {
+        rc = RC( rcExe, rcFile, rcPacking, rcMemory, rcExhausted );
+        ErrMsg( "multi_writer.c mw_compress_block().malloc( %lu ) -> %R", needed, rc );
+    } else if ( 0 == self -> len ) {
+        /* nothing to compress */
+    } else if ( ct_gzip == compress ) {
+        /* one independent gzip-member per block, concatenated members are a valid gzip-file */
+        rc = mw_deflate( self -> data, self -> len, ( uint8_t * )self -> cdata, self -> cavailable,
+                         15 + 16, &( self -> clen ) );
+    } else {
+        /* BGZF: gzip-members of at most 64k each, the block-size is stored in the 'BC' extra-field */
+        size_t pos = 0;
+        while ( 0 == rc && pos < self -> len ) {
+            size_t chunk = self -> len - pos;
+            uint8_t * dst = ( uint8_t * )( self -> cdata + self -> clen );
+            size_t deflated;
+            if ( chunk > BGZF_MAX_INPUT ) { chunk = BGZF_MAX_INPUT; }
+            memmove( dst, bgzf_hdr, BGZF_HDR_SIZE );
+            rc = mw_deflate( self -> data + pos, chunk, dst + BGZF_HDR_SIZE,
+                             BGZF_MAX_BLOCK - BGZF_HDR_SIZE - BGZF_FTR_SIZE, -15, &deflated );
+            if ( 0 == rc ) {
+                size_t bsize = BGZF_HDR_SIZE + deflated + BGZF_FTR_SIZE;
+                uLong crc = crc32( crc32( 0L, Z_NULL, 0 ), ( const Bytef * )( self -> data + pos ), ( uInt )chunk );
+                dst[ 16 ] = ( bsize - 1 ) & 0xff;
+                dst[ 17 ] = ( ( bsize - 1 ) >> 8 ) & 0xff;
+                mw_put_u32( dst + BGZF_HDR_SIZE + deflated, ( uint32_t )crc );
+                mw_put_u32( dst + BGZF_HDR_SIZE + deflated + 4, ( uint32_t )chunk );
+                self -> clen += bsize;
+                pos += chunk;
+            }
+        }
+    }
+    return rc;
+}
+
 typedef struct multi_writer_t {
     KFile * f;                          /* the file we are writing into, used by the writer-thread */
     uint64_t pos;                       /* the file-position for the writer-thread */
@@ -163,6 +268,15 @@ typedef struct multi_writer_t {
     KQueue * empty_q;                   /* pre-allocated blocks to write to, client gets from it, thread puts to into it */
     KQueue * write_q;                   /* blocks to write, thread gets from it, client puts to into it */
     uint32_t q_wait_time;
+    compress_t compress;                /* ct_none: blocks go directly into the write_q */
+    KQueue * compress_q;                /* blocks to compress, compressor-threads get from it, client puts into it */
+    KThread ** compressors;             /* the threads that compress blocks */
+    uint32_t num_compressors;
+    KLock * seq_lock;                   /* protects next_submit */
+    uint64_t next_submit;               /* sequence-number for the next submitted block */
+    uint64_t next_write;                /* sequence-number of the next block to be written */
+    multi_writer_block_t ** pending;    /* compressed blocks that arrived out of order */
+    uint32_t num_pending;
 } multi_writer_t;
 
 static rc_t mw_get_block( KQueue * q, uint32_t timeout, multi_writer_block_t ** block ) {
@@ -231,9 +345,30 @@ static rc_t mw_empty_a_queue( KQueue * q, uint32_t timeout ) {
     return rc;
 }
 
-void mw_release( struct multi_writer_t * self ) {
+rc_t mw_release( struct multi_writer_t * self ) {
+    rc_t res = 0;
     if ( NULL != self ) {
         rc_t rc;
+        /* the compressor-threads have to finish first, they feed the write_q */
+        if ( NULL != self -> compressors ) {
+            uint32_t i;
+            if ( NULL != self -> compress_q ) {
+                rc = KQueueSeal ( self -> compress_q );
+                if ( 0 != rc ) {
+                    ErrMsg( "multi_writer.c mw_release().KQueueSeal( compress_q ) -> %R", rc );
+                }
+            }
+            for ( i = 0; i < self -> num_compressors; ++i ) {
+                if ( NULL != self -> compressors[ i ] ) {
+                    rc_t status = 0;
+                    rc = KThreadWait ( self -> compressors[ i ], &status );
+                    if ( 0 == res ) { res = ( 0 != rc ) ? rc : status; }
+                    KThreadRelease ( self -> compressors[ i ] );
+                }
+            }
+            free( ( void * ) self -> compressors );
+        }
+
         /* first we have to wait for the thread to finish */
         if ( NULL != self -> thread ) {
             if ( NULL != self -> write_q ) {
@@ -242,7 +377,12 @@ void mw_release( struct multi_writer_t * self ) {
                     ErrMsg( "copy_machine.c release_multi_writer.KQueueSeal() -> %R", rc );
                 }
             }
-            KThreadWait ( self -> thread, &rc );
+            {
+                rc_t status = 0;
+                rc = KThreadWait ( self -> thread, &status );
+                if ( 0 == res ) { res = ( 0 != rc ) ? rc : status; }
+            }
+            KThreadRelease ( self -> thread );
         }
 
         if ( NULL != self -> empty_q ) {
@@ -261,10 +401,104 @@ void mw_release( struct multi_writer_t * self ) {
                 ErrMsg( "copy_machine.c release_multi_writer.KQueueRelease().2 -> %R", rc );
             }
         }
+        if ( NULL != self -> compress_q ) {
+            mw_empty_a_queue( self -> compress_q, self -> q_wait_time );
+            rc = KQueueRelease ( self -> compress_q );
+            if ( 0 != rc ) {
+                ErrMsg( "multi_writer.c mw_release().KQueueRelease( compress_q ) -> %R", rc );
+            }
+        }
+        if ( NULL != self -> pending ) {
+            /* only left over if the writer-thread stopped because of an error */
+            uint32_t i;
+            for ( i = 0; i < self -> num_pending; ++i ) {
+                mw_release_block( self -> pending[ i ] );
+            }
+            free( ( void * ) self -> pending );
+        }
+        if ( NULL != self -> seq_lock ) { KLockRelease( self -> seq_lock ); }
 
         if ( NULL != self -> f ) { ft_release_file( self -> f, "copy_machine.c release_multi_writer()" ); }
         free( ( void * ) self );
     }
+    return res;
+}
+
+static rc_t mw_write_block( multi_writer_t * self, multi_writer_block_t * block ) {
+    rc_t rc = block -> rc;   /* a block that failed to compress stops the writer */
+    const char * data = ( ct_none == self -> compress ) ? block -> data : block -> cdata;
+    size_t len = ( ct_none == self -> compress ) ? block -> len : block -> clen;
+    if ( 0 != rc ) {
+        /* nothing to write, the output would miss this block */
+    } else if ( NULL != self -> f ) {
+        /* we have a file to write to... */
+        if ( NULL != data && len > 0 ) {
+            size_t num_written;
+            rc = KFileWrite( self -> f, self -> pos, data, len, &num_written );
+            if ( 0 == rc ) { self -> pos += num_written;  }
+        }
+    } else {
+        /* no file to print into, write to stdout! */
+        rc = KOutMsg( "%.*s", len, data );
+    }
+    if ( 0 == rc ) {
+        /* put the block back into the empty-q */
+        rc = mw_push ( self -> empty_q, block, self -> q_wait_time ); /* above */
+    } else {
+        /* something went wrong with writing the block into the dst-file !!!
+           possibly we are running out of space to write... */
+
+        /* put the block back into the empty-q, the error is what the writer returns */
+        rc_t rc1 = mw_push ( self -> empty_q, block, self -> q_wait_time ); /* above */
+        if ( 0 != rc1 ) {
+            mw_release_block( block );
+        }
+
+        /* we are done ... seal the empty_q ( that will tell the reader to stop... */
+        {
+            rc_t rc2 = KQueueSeal ( self -> empty_q );
+            if ( 0 != rc2 ) {
+                ErrMsg( "copy_machine.c multi_writer_thread().KQueueSeal() -> %R", rc2 );
+                rc = ( 0 == rc ) ? rc2 : rc;
+            }
+        }
+    }
+    return rc;
+}
+
+/* compressed blocks arrive in the order the compressors finish them,
+   park them until all blocks submitted before them have been written */
+static rc_t mw_write_in_order( multi_writer_t * self, multi_writer_block_t * block ) {
+    rc_t rc = 0;
+    self -> pending[ block -> seq_nr % self -> num_pending ] = block;
+    while ( 0 == rc ) {
+        uint32_t idx = self -> next_write % self -> num_pending;
+        block = self -> pending[ idx ];
+        if ( NULL == block || block -> seq_nr != self -> next_write ) {
+            break;
+        }
+        self -> pending[ idx ] = NULL;
+        self -> next_write++;
+        rc = mw_write_block( self, block );
+    }
+    return rc;
+}
+
+static rc_t mw_write_eof( multi_writer_t * self ) {
+    rc_t rc = 0;
+    if ( ct_bgzf == self -> compress ) {
+        if ( NULL != self -> f ) {
+            size_t num_written;
+            rc = KFileWrite( self -> f, self -> pos, bgzf_eof, sizeof bgzf_eof, &num_written );
+            if ( 0 == rc ) { self -> pos += num_written;  }
+        } else {
+            rc = KOutMsg( "%.*s", sizeof bgzf_eof, bgzf_eof );
+        }
+        if ( 0 != rc ) {
+            ErrMsg( "multi_writer.c mw_write_eof() -> %R", rc );
+        }
+    }
+    return rc;
 }
 
 static rc_t CC mw_thread( const KThread * thread, void *data ) {
@@ -282,43 +516,16 @@ static rc_t CC mw_thread( const KThread * thread, void *data ) {
             rc = KQueuePop ( self -> write_q, ( void ** )&block, &tm );
             if ( 0 == rc ) {
                 /* we got a block to write out of the to_write_q */
-
-                if ( NULL != self -> f ) {
-                    /* we have a file to write to... */
-                    if ( NULL != block -> data && block -> len > 0 ) {
-                        size_t num_written;
-                        rc = KFileWrite( self -> f, self -> pos,
-                                        block -> data, block -> len, &num_written );
-                        if ( 0 == rc ) { self -> pos += num_written;  }
-                    }
+                if ( ct_none == self -> compress ) {
+                    rc = mw_write_block( self, block );
                 } else {
-                    /* no file to print into, write to stdout! */
-                    rc = KOutMsg( "%.*s", block -> len, block -> data );
-                }
-                if ( 0 == rc ) {
-                    /* put the block back into the empty-q */
-                    rc = mw_push ( self -> empty_q, block, self -> q_wait_time ); /* above */
-                } else {
-                    /* something went wrong with writing the block into the dst-file !!!
-                       possibly we are running out of space to write... */
-
-                    /* put the block back into the empty-q */
-                    rc = mw_push ( self -> empty_q, block, self -> q_wait_time ); /* above */
-
-                    /* we are done ... seal the empty_q ( that will tell the reader to stop... */
-                    {
-                        rc_t rc2 = KQueueSeal ( self -> empty_q );
-                        if ( 0 != rc2 ) {
-                            ErrMsg( "copy_machine.c multi_writer_thread().KQueueSeal() -> %R", rc2 );
-                            rc = ( 0 == rc ) ? rc2 : rc;
-                        }
-                    }
+                    rc = mw_write_in_order( self, block );
                 }
             } else {
                 if ( rcDone == GetRCState( rc ) && ( enum RCObject )rcData == GetRCObject( rc ) ) {
                     /* the to_write_q has been sealed, we are done! */
                     done = true;
-                    rc = 0;
+                    rc = mw_write_eof( self );
                 } else if ( rcExhausted == GetRCState( rc ) && ( enum RCObject )rcTimeout == GetRCObject( rc ) ) {
                     /* the to_write_q is still active, but so far nothing to write in it, try again */
                     rc = 0;
@@ -329,6 +536,44 @@ static rc_t CC mw_thread( const KThread * thread, void *data ) {
     return rc;
 }
 
+static rc_t CC mw_compress_thread( const KThread * thread, void *data ) {
+    rc_t rc = 0;
+    rc_t compress_rc = 0;
+    multi_writer_t * self = data;
+    bool done = false;
+    while( 0 == rc && !done ) {
+        /* as long as the compress_q is not sealed */
+        struct timeout_t tm;
+        rc = TimeoutInit ( &tm, self -> q_wait_time );
+        if ( 0 != rc ) {
+            ErrMsg( "multi_writer.c mw_compress_thread().TimeoutInit() -> %R", rc );
+        } else {
+            multi_writer_block_t * block;
+            rc = KQueuePop ( self -> compress_q, ( void ** )&block, &tm );
+            if ( 0 == rc ) {
+                block -> rc = mw_compress_block( block, self -> compress );
+                if ( 0 != block -> rc ) {
+                    /* pass the block on, the writer stops when its turn comes,
+                       keep running so that the clients are not blocked on a full compress_q */
+                    compress_rc = ( 0 == compress_rc ) ? block -> rc : compress_rc;
+                    hlp_set_quitting();
+                }
+                rc = mw_push( self -> write_q, block, self -> q_wait_time );
+            } else {
+                if ( rcDone == GetRCState( rc ) && ( enum RCObject )rcData == GetRCObject( rc ) ) {
+                    /* the compress_q has been sealed, we are done! */
+                    done = true;
+                    rc = 0;
+                } else if ( rcExhausted == GetRCState( rc ) && ( enum RCObject )rcTimeout == GetRCObject( rc ) ) {
+                    /* the compress_q is still active, but so far nothing in it, try again */
+                    rc = 0;
+                }
+            }
+        }
+    }
+    return ( 0 == rc ) ? compress_rc : rc;
+}
+
 #define N_MULTI_WRITER_BLOCKS 16
 #define MULTI_WRITER_BLOCK_SIZE ( 4 * 1024 * 1024 )
 #define MULTI_WRITER_WAIT 5
@@ -346,24 +591,69 @@ static rc_t mw_create_file( multi_writer_t * self, KDirectory * dir, const char
     return rc;
 }
 
+static rc_t mw_start_compressors( multi_writer_t * self, uint32_t num_blocks, uint32_t num_compressors ) {
+    rc_t rc = KLockMake( &( self -> seq_lock ) );
+    if ( 0 != rc ) {
+        ErrMsg( "mw_create().KLockMake() -> %R", rc );
+    } else {
+        rc = KQueueMake( &( self -> compress_q ), num_blocks );
+        if ( 0 != rc ) {
+            ErrMsg( "mw_create().KQueueMake( compress_q ) -> %R", rc );
+        }
+    }
+    if ( 0 == rc ) {
+        /* there are never more blocks in flight than num_blocks */
+        self -> pending = calloc( num_blocks, sizeof self -> pending[ 0 ] );
+        self -> compressors = calloc( num_compressors, sizeof self -> compressors[ 0 ] );
+        if ( NULL == self -> pending || NULL == self -> compressors ) {
+            rc = RC( rcExe, rcFile, rcPacking, rcMemory, rcExhausted );
+            ErrMsg( "mw_create().calloc() -> %R", rc );
+        } else {
+            uint32_t i;
+            self -> num_pending = num_blocks;
+            for ( i = 0; 0 == rc && i < num_compressors; ++i ) {
+                rc = hlp_make_thread( &( self -> compressors[ i ] ), mw_compress_thread,
+                                      self, THREAD_DFLT_STACK_SIZE );
+                if ( 0 != rc ) {
+                    ErrMsg( "mw_create().helper_make_thread( compressor-thread #%u ) -> %R", i, rc );
+                } else {
+                    self -> num_compressors = i + 1;
+                }
+            }
+        }
+    }
+    return rc;
+}
+
 struct multi_writer_t * mw_create( KDirectory * dir,
                     const char * filename,
                     size_t buf_size,
                     uint32_t q_wait_time,
                     uint32_t q_num_blocks,
-                    size_t q_block_size  ) {
+                    size_t q_block_size,
+                    compress_t compress,
+                    uint32_t num_compressors ) {
     uint32_t wait_time = ( 0 == q_wait_time ) ? MULTI_WRITER_WAIT : q_wait_time;
     uint32_t num_blocks = ( 0 == q_num_blocks ) ? N_MULTI_WRITER_BLOCKS : q_num_blocks;
     uint32_t block_size = ( 0 == q_block_size ) ? MULTI_WRITER_BLOCK_SIZE : q_block_size;
     multi_writer_t * res = calloc( 1, sizeof * res );
     if ( NULL != res ) {
         rc_t rc = 0;
+        res -> compress = ( ct_gzip == compress || ct_bgzf == compress ) ? compress : ct_none;
         if ( NULL != filename ) {
             rc = mw_create_file( res, dir, filename, buf_size );
             if ( 0 != rc ) {
                 mw_release( res );
                 res = NULL;
             }
+        } else if ( ct_none != res -> compress ) {
+            /* compressed data is binary, it cannot go through KOutMsg() */
+            rc = KFileMakeStdOut( &( res -> f ) );
+            if ( 0 != rc ) {
+                ErrMsg( "mw_create().KFileMakeStdOut() -> %R", rc );
+                mw_release( res );
+                res = NULL;
+            }
         }
         if ( 0 == rc ) {
             /* create the empty queue */
@@ -385,6 +675,10 @@ struct multi_writer_t * mw_create( KDirectory * dir,
                 if ( 0 == rc ) {
                     rc = KQueueMake( &( res -> write_q ), num_blocks );
                 }
+                if ( 0 == rc && ct_none != res -> compress ) {
+                    rc = mw_start_compressors( res, num_blocks,
+                                               ( 0 == num_compressors ) ? 1 : num_compressors );
+                }
                 if ( 0 != rc ) {
                     mw_release( res );
                     res = NULL;
@@ -420,7 +714,31 @@ struct multi_writer_block_t * mw_get_empty_block( struct multi_writer_t * self )
 bool mw_submit_block( struct multi_writer_t * self, struct multi_writer_block_t * block ) {
     bool res = false;
     if ( NULL != self && NULL != block ) {
-        rc_t rc =  mw_push( self -> write_q, block, self -> q_wait_time );
+        rc_t rc;
+        if ( ct_none == self -> compress ) {
+            rc = mw_push( self -> write_q, block, self -> q_wait_time );
+        } else {
+            /* the sequence-number restores the submission-order after the compressors,
+               it is taken back if the push fails: the writer would wait for it forever.
+               the push does not block, the compress_q has room for all blocks */
+            rc = KLockAcquire( self -> seq_lock );
+            if ( 0 == rc ) {
+                block -> seq_nr = self -> next_submit++;
+                rc = mw_push( self -> compress_q, block, self -> q_wait_time );
+                if ( 0 != rc ) {
+                    self -> next_submit--;
+                }
+                KLockUnlock( self -> seq_lock );
+            }
+        }
+        if ( 0 != rc ) {
+            /* the block goes back to the empty-q, a client waiting for one is not left hanging */
+            ErrMsg( "multi_writer.c mw_submit_block() -> %R", rc );
+            block -> len = 0;
+            if ( 0 != mw_push( self -> empty_q, block, self -> q_wait_time ) ) {
+                mw_release_block( block );
+            }
+        }
         res = ( 0 == rc );
     }
     return res;
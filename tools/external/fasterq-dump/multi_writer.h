@@ -39,6 +39,10 @@ extern "C" {
 #include <kfs/directory.h>
 #endif
 
+#ifndef _h_helper_
+#include "helper.h"     /* compress_t */
+#endif
+
 struct multi_writer_block_t;
 
 bool mw_append_block( struct multi_writer_block_t * self, const char * data, size_t len );
@@ -47,17 +51,24 @@ bool mw_expand_block( struct multi_writer_block_t * self, size_t size );
 
 struct multi_writer_t;
 
+/* with compress != ct_none every submitted block is compressed by one of
+   num_compressors threads into independent gzip-members or BGZF-blocks,
+   the compressed blocks are written in the order they were submitted */
 struct multi_writer_t * mw_create( KDirectory * dir,
                                     const char * filename,
                                     size_t buf_size,
                                     uint32_t q_wait_time,
                                     uint32_t q_num_blocks,
-                                    size_t q_block_size  );
+                                    size_t q_block_size,
+                                    compress_t compress,
+                                    uint32_t num_compressors );
 
-void mw_release( struct multi_writer_t * self );
+/* returns the error of the writer- or a compressor-thread, if any */
+rc_t mw_release( struct multi_writer_t * self );
 
 struct multi_writer_block_t * mw_get_empty_block( struct multi_writer_t * self );
 
+/* the block is handed over to the multi-writer, even if false is returned */
 bool mw_submit_block( struct multi_writer_t * self, struct multi_writer_block_t * block );
 
 #ifdef __cplusplus
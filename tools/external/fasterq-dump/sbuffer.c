@@ -154,8 +154,16 @@ rc_t split_filename_insert_idx( SBuffer_t * dst, size_t dst_size,
         rc = hlp_split_string_r( &S_in, &S_name, &S_ext, '.' ); /* helper.c */
         if ( 0 == rc ) {
             /* we found a dot to split the filename! */
-            rc = make_and_print_to_SBuffer( dst, dst_size, "%S_%u.%S",
-                        &S_name, idx, &S_ext ); /* helper.c */
+            String S_base, S_ext2;
+            if ( 0 == string_cmp( S_ext . addr, S_ext . size, "gz", 2, 3 ) &&
+                 0 == hlp_split_string_r( &S_name, &S_base, &S_ext2, '.' ) ) {
+                /* compressed output: 'name.fastq.gz' -> 'name_1.fastq.gz' */
+                rc = make_and_print_to_SBuffer( dst, dst_size, "%S_%u.%S.%S",
+                            &S_base, idx, &S_ext2, &S_ext ); /* helper.c */
+            } else {
+                rc = make_and_print_to_SBuffer( dst, dst_size, "%S_%u.%S",
+                            &S_name, idx, &S_ext ); /* helper.c */
+            }
         } else {
             /* we did not find a dot to split the filename! */
             rc = make_and_print_to_SBuffer( dst, dst_size, "%s_%u.fastq",
@@ -1216,7 +1216,9 @@ rc_t execute_unsorted_fasta_tbl_join( const execute_fasta_tbl_join_args_t * args
                     args -> buf_size,
                     0,                          /* q_wait_time, if 0 --> use default = 5 ms */
                     args -> num_threads * 3,    /* q_num_blocks, if 0 use default = 8 */
-                    0 );                        /* q_block_size, if 0 use default = 4 MB */
+                    0,                          /* q_block_size, if 0 use default = 4 MB */
+                    args -> compress,           /* helper.h, ct_none for uncompressed output */
+                    args -> num_threads );      /* num_compressors */
             if ( NULL != multi_writer ) {
                 /* create a 2na-base-filter ( if filterbases were given, by default not ) */
                 struct filter_2na_t * filter = hlp_make_2na_filter( args -> join_options -> filter_bases );
@@ -1273,7 +1275,10 @@ rc_t execute_unsorted_fasta_tbl_join( const execute_fasta_tbl_join_args_t * args
                 rc = join_the_threads_and_collect_status( &threads, args -> stats ); /* releases jtd! */
                 bg_progress_release( progress ); /* progress_thread.c ( ignores NULL ) */
                 hlp_release_2na_filter( filter );
-                mw_release( multi_writer ); /* ( ignores NULL ) */ 
+                {
+                    rc_t rc2 = mw_release( multi_writer ); /* ( ignores NULL ) */
+                    if ( 0 == rc ) { rc = rc2; }
+                }
             } /* if ( NULL != multi_writer )*/
         } /* if ( extract_sra_row_count() && row_count > 0 )*/
     } /* if ( KOutMsg(...) ) */
@@ -97,6 +97,7 @@ typedef struct execute_fasta_tbl_join_args_t {
     size_t buf_size;
     uint32_t num_threads;
     uint64_t row_limit;
+    compress_t compress;                    /* helper.h */
     bool show_progress;
     bool force;
 } execute_fasta_tbl_join_args_t;
@@ -171,6 +171,8 @@ typedef struct cmn_merge_t {
     struct bg_progress_t * progress;
     bool force;
     bool append;
+    compress_t compress;
+    uint32_t num_compressors;   /* per merge-thread */
 } cmn_merge_t;
 
 /* the data specific to one merge-thread */
@@ -201,7 +203,9 @@ static rc_t CC merge_thread_func( const KThread *self, void *data ) {
             merge_thread_data -> cmn -> buf_size,
             merge_thread_data -> cmn -> progress,
             merge_thread_data -> cmn -> force,
-            merge_thread_data -> cmn -> append );
+            merge_thread_data -> cmn -> append,
+            merge_thread_data -> cmn -> compress,
+            merge_thread_data -> cmn -> num_compressors ); /* concatenator.c */
         release_SBuffer( &s_filename );
     }
     return rc;
@@ -215,7 +219,9 @@ rc_t temp_registry_merge( temp_registry_t * self,
                           size_t buf_size,
                           bool show_progress,
                           bool force,
-                          bool append ) {
+                          bool append,
+                          compress_t compress,
+                          uint32_t num_threads ) {
     rc_t rc = 0;
     if ( NULL == self ) {
         rc = RC( rcVDB, rcNoTarg, rcConstructing, rcSelf, rcNull );
@@ -240,8 +246,20 @@ rc_t temp_registry_merge( temp_registry_t * self,
             uint32_t end = start + length;
             uint32_t idx;
             Vector thread_data_vec;
-            cmn_merge_t cmn = { dir, base_output_filename, buf_size, progress, force, append };
-            
+            cmn_merge_t cmn = { dir, base_output_filename, buf_size, progress, force, append,
+                                compress, 1 };
+
+            /* the merge-threads run in parallel: they share the compressor-threads */
+            {
+                uint32_t num_lists = 0;
+                for ( idx = start; idx < end; ++idx ) {
+                    if ( NULL != VectorGet( &( self -> lists ), idx ) ) { num_lists++; }
+                }
+                if ( num_lists > 0 && num_threads > num_lists ) {
+                    cmn . num_compressors = num_threads / num_lists;
+                }
+            }
+
             /* we create a thread for each item in self->lists */
             VectorInit( &thread_data_vec, 0, length );
             for ( idx = start; rc == 0 && idx < end; ++idx ) {
@@ -328,8 +346,22 @@ typedef struct print_to_stdout_ctx_t
 {
     KDirectory * dir;
     size_t buf_size;
+    compress_t compress;
+    uint32_t num_compressors;
+    rc_t rc;
 } print_to_stdout_ctx_t;
 
+/* compressed output cannot be printed via KOutMsg(), the multi-writer writes it to stdout */
+static void CC on_compress_to_stdout( void * item, void * data ) {
+    VNamelist * l = ( VNamelist * )item;
+    print_to_stdout_ctx_t * c = ( print_to_stdout_ctx_t * )data;
+    if ( NULL != l && 0 == c -> rc ) {
+        VNamelistReorder ( l, false );
+        c -> rc = concat_execute_compressed( c -> dir, NULL, l, c -> buf_size, NULL,
+                                             false, c -> compress, c -> num_compressors ); /* concatenator.c */
+    }
+}
+
 static void CC on_print_to_stdout( void * item, void * data ) {
     const VNamelist * l = ( const VNamelist * )item;
     if ( NULL != l ) {
@@ -371,7 +403,9 @@ static void CC on_print_to_stdout( void * item, void * data ) {
 
 rc_t temp_registry_to_stdout( temp_registry_t * self,
                               KDirectory * dir,
-                              size_t buf_size ) {
+                              size_t buf_size,
+                              compress_t compress,
+                              uint32_t num_threads ) {
     rc_t rc = 0;
     if ( NULL == self ) {
         rc = RC( rcVDB, rcNoTarg, rcConstructing, rcSelf, rcNull );
@@ -381,8 +415,16 @@ rc_t temp_registry_to_stdout( temp_registry_t * self,
         print_to_stdout_ctx_t c;
         c . dir = dir;
         c . buf_size = buf_size;
+        c . compress = compress;
+        c . num_compressors = ( 0 == num_threads ) ? 1 : num_threads;
+        c . rc = 0;
 
-        VectorForEach ( &( self -> lists ), false, on_print_to_stdout, &c );
+        if ( ct_none != compress ) {
+            VectorForEach ( &( self -> lists ), false, on_compress_to_stdout, &c );
+            rc = c . rc;
+        } else {
+            VectorForEach ( &( self -> lists ), false, on_print_to_stdout, &c );
+        }
     }
     return rc;
 }
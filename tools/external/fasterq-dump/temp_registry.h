@@ -60,11 +60,16 @@ rc_t temp_registry_merge( struct temp_registry_t * self,
                           size_t buf_size,
                           bool show_progress,
                           bool force,
-                          bool append );
+                          bool append,
+                          compress_t compress,
+                          uint32_t num_threads );
 
+/* with compress != ct_none the output is compressed by num_threads compressor-threads */
 rc_t temp_registry_to_stdout( struct temp_registry_t * self,
                               KDirectory * dir,
-                              size_t buf_size );
+                              size_t buf_size,
+                              compress_t compress,
+                              uint32_t num_threads );
 
 #ifdef __cplusplus
 }
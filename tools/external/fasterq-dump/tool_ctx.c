@@ -119,6 +119,9 @@ static rc_t tctx_print( const tool_ctx_t * tool_ctx ) {
     if ( 0 == rc ) {
         rc = KOutMsg( "check-mode   : %s\n", hlp_check_mode_2_string( tool_ctx -> check_mode ) );
     }
+    if ( 0 == rc ) {
+        rc = KOutMsg( "compress     : %s\n", hlp_compress_2_string( tool_ctx -> compress ) );
+    }
     if ( 0 == rc ) {
         rc = KOutMsg( "output-file  : '%s'\n",
                     NULL != tool_ctx -> output_filename ? tool_ctx -> output_filename : "-" );
@@ -303,7 +306,27 @@ static rc_t tctx_encforce_constrains( tool_ctx_t * tool_ctx ) {
         tool_ctx -> only_aligned = false;
         tool_ctx -> only_unaligned = false;
     }
-    if ( ignore_stdout ) {
+    if ( ct_none != tool_ctx -> compress ) {
+        switch( tool_ctx -> fmt ) {
+            /* the reference-modes print directly, they do not go through a multi-writer */
+            case ft_fasta_ref_tbl   :
+            case ft_fasta_concat    :
+            case ft_ref_report      : rc = RC( rcExe, rcFile, rcPacking, rcFormat, rcUnsupported );
+                                      ErrMsg( "compressed output requested ( %s ),",
+                                              hlp_compress_2_string( tool_ctx -> compress ) );
+                                      ErrMsg( "but it is not supported with ( %s ) -> %R",
+                                              hlp_fmt_2_string( tool_ctx -> fmt ), rc );
+                                      break;
+            default : break;
+        }
+        /* the multi-writer creates the output-file, it cannot append to a compressed one */
+        if ( 0 == rc && tool_ctx -> append ) {
+            rc = RC( rcExe, rcFile, rcPacking, rcMode, rcUnsupported );
+            ErrMsg( "compressed output requested ( %s ) together with --append -> %R",
+                    hlp_compress_2_string( tool_ctx -> compress ), rc );
+        }
+    }
+    if ( 0 == rc && ignore_stdout ) {
         rc = RC( rcExe, rcFile, rcPacking, rcName, rcExists );
         ErrMsg( "directing output to stdout requested." );
         ErrMsg( "but requested mode ( %s ) would produce multiple files", hlp_fmt_2_string( tool_ctx -> fmt ) );
@@ -383,9 +406,10 @@ static rc_t tctx_make_output_filename_from_accession( tool_ctx_t * tool_ctx, boo
                                 true /* absolute */,
                                 &( tool_ctx -> dflt_output[ 0 ] ),
                                 sizeof tool_ctx -> dflt_output,
-                                "%s%s",
+                                "%s%s%s",
                                 tool_ctx -> accession_short,
-                                hlp_out_ext( fasta ) /* helper.c */ );
+                                hlp_out_ext( fasta ), /* helper.c */
+                                hlp_compress_ext( tool_ctx -> compress ) /* helper.c */ );
     if ( 0 != rc ) {
         ErrMsg( "tool_ctx_make_output_filename_from_accession.KDirectoryResolvePath() -> %R", rc );
     } else {
@@ -401,10 +425,11 @@ static rc_t tctx_make_output_filename_from_dir_and_accession( tool_ctx_t * tool_
                                 true /* absolute */,
                                 &( tool_ctx -> dflt_output[ 0 ] ),
                                 sizeof tool_ctx -> dflt_output,
-                                es ? "%s%s%s" : "%s/%s%s",
+                                es ? "%s%s%s%s" : "%s/%s%s%s",
                                 tool_ctx -> output_dirname,
                                 tool_ctx -> accession_short,
-                                hlp_out_ext( fasta ) /* helper.c */ );
+                                hlp_out_ext( fasta ), /* helper.c */
+                                hlp_compress_ext( tool_ctx -> compress ) /* helper.c */ );
     if ( 0 != rc ) {
         ErrMsg( "tool_ctx_make_output_filename_from_dir_and_accession.KDirectoryResolvePath() -> %R", rc );
     } else {
@@ -93,6 +93,7 @@ typedef struct tool_ctx_t {
 
     format_t fmt; /* helper.h */
     check_mode_t check_mode; /* helper.h */
+    compress_t compress; /* helper.h */
 
     bool force, show_progress, show_details, append, use_stdout, split_file;
     bool only_unaligned, only_aligned;
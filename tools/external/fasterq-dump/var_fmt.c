@@ -34,10 +34,6 @@
 #include "err_msg.h"
 #endif
 
-#ifndef _h_klib_printf_
-#include <klib/printf.h>
-#endif
-
 /* ============================================================================================================= */
 typedef enum vfmt_type_t { vft_literal, vft_str, vft_int } vfmt_type_t;
 /* ============================================================================================================= */
@@ -214,87 +210,109 @@ static vfmt_entry_t * vfmt_clone_entry( const vfmt_entry_t * src ) {
     return res;
 }
 
-static void vfmt_copy_String_to_buffer( SBuffer_t *buffer, const String * src ) {
-    if ( NULL != src && NULL != buffer ) {
-        uint32_t i = 0;
-        String * dst = &( buffer -> S );
-        char * dst_addr = ( char * )( dst -> addr );
-        while ( i < src -> len && dst -> len < buffer -> buffer_size ) {
-            dst_addr [ dst -> len ] = src -> addr[ i++ ];
-            dst -> len += 1;
-        }
-    }
-}
-
-static void vfmt_copy_int_to_buffer( SBuffer_t *buffer, uint64_t value ) {
-    char temp[ 21 ];
-    size_t temp_written;
-    rc_t rc = string_printf ( temp, sizeof temp, &temp_written, "%lu", value );
-    if ( 0 == rc ) {
-        String S;
-        StringInitCString( &S, temp );
-        vfmt_copy_String_to_buffer( buffer, &S );
-    }
-}
-
-static void vfmt_copy_int_entry_to_buffer( const vfmt_entry_t * self, SBuffer_t *buffer,
-                                           const uint64_t * args, size_t args_len ) {
-    if ( NULL != args && self -> idx < args_len ) {
-        vfmt_copy_int_to_buffer( buffer, args[ self -> idx ] );
+/* ============================================================================================================= */
+/* private: the compiled form of the elements, a flat array walked once per record */
+
+/* literals up to this length are stored inside the slot and copied with one fixed-width copy */
+#define VFMT_SHORT_LITERAL 16
+/* the write-buffer has always this many bytes left, so that the fixed-width copy cannot overrun it */
+#define VFMT_SLACK VFMT_SHORT_LITERAL
+/* the length of max_uint64_t as string */
+#define VFMT_MAX_INT_LEN 20
+
+typedef struct vfmt_slot_t {
+    vfmt_type_t type;
+    uint8_t idx;                            /* which str/int-arg to use here */
+    uint8_t idx2;                           /* the alternative idx, for vft_str and client gives a NULL */
+    uint32_t len;                           /* length of the literal */
+    const char * addr;                      /* literal longer than VFMT_SHORT_LITERAL, points into the entry */
+    char lit[ VFMT_SHORT_LITERAL ];         /* short literal, zero-padded */
+} vfmt_slot_t;
+
+static const char vfmt_digit_pairs[ 201 ] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/* writes the decimal representation of value to dst, two digits per step, returns the number of chars */
+static size_t vfmt_write_int( char * dst, uint64_t value ) {
+    char temp[ VFMT_MAX_INT_LEN ];
+    char * p = temp + sizeof temp;
+    size_t len;
+    while ( value >= 100 ) {
+        uint32_t pair = ( uint32_t )( value % 100 );
+        value /= 100;
+        p -= 2;
+        memcpy( p, &( vfmt_digit_pairs[ pair * 2 ] ), 2 );
+    }
+    if ( value >= 10 ) {
+        p -= 2;
+        memcpy( p, &( vfmt_digit_pairs[ value * 2 ] ), 2 );
+    } else {
+        *( --p ) = ( char )( '0' + value );
     }
+    len = ( temp + sizeof temp ) - p;
+    memcpy( dst, p, len );
+    return len;
 }
 
-/*we need both: str-args AND int-args, because of the alternative idx-usage */
-static void vfmt_copy_str_entry_to_buffer( const vfmt_entry_t * self, SBuffer_t *buffer,
-                                         const String ** str_args, size_t str_args_len,
-                                         const uint64_t * int_args, size_t int_args_len ) {
+/* the string to use for a vft_str-slot, NULL if the alternative int has to be used ( or nothing at all ) */
+static const String * vfmt_slot_string( const vfmt_slot_t * self, const String ** str_args, size_t str_args_len ) {
     if ( NULL != str_args && self -> idx < str_args_len ) {
         const String * src = str_args[ self -> idx ];
         if ( NULL != src && NULL != src -> addr ) {
-            /* we have a string to use */
-            if ( self -> idx2 == 0xFF ) {
-                /* there is no alternative -> print the string even if len == 0 */
-                vfmt_copy_String_to_buffer( buffer, src );
-            } else {
-                if ( src -> len > 0 ) {
-                    /* there is an alternative, but we have a valid string to print */
-                    vfmt_copy_String_to_buffer( buffer, src );
-                } else if ( NULL != int_args && self -> idx2 < int_args_len ) {
-                    /* there is an alternative - and we have an empty string -  */
-                    vfmt_copy_int_to_buffer( buffer, int_args[ self -> idx2 ] );
-                }
-            }
-        } else if ( NULL != int_args && self -> idx2 < int_args_len ) {
-            /* the string-source is NULL, and we have an alternative to use */
-            vfmt_copy_int_to_buffer( buffer, int_args[ self -> idx2 ] );
+            /* without alternative the string is printed even if len == 0 */
+            if ( 0xFF == self -> idx2 || src -> len > 0 ) { return src; }
         }
-    } else if ( NULL != int_args && self -> idx2 < int_args_len ) {
-        /* there is not even a array of strings, and we have an alternative to use */
-        vfmt_copy_int_to_buffer( buffer, int_args[ self -> idx2 ] );
     }
+    return NULL;
 }
 
-static void vfmt_copy_entry_to_buffer( const vfmt_entry_t * self, SBuffer_t * dst,
-                               const String ** str_args, size_t str_args_len,
-                               const uint64_t * int_args, size_t int_args_len ) {
-    if ( NULL != self && NULL != dst ) {
-        switch ( self -> type ) {
-            /* we enter a string literal */
-            case vft_literal : vfmt_copy_String_to_buffer( dst, self -> literal );
-            break;
-            
-            /* we enter a string argument ( supply the int-vector too, because of the alternative! ) */
-            case vft_str    : vfmt_copy_str_entry_to_buffer( self, dst,
-                                                            str_args, str_args_len,
-                                                            int_args, int_args_len );
-            break;
-            
-            /* we enter a int argument */
-            case vft_int    : vfmt_copy_int_entry_to_buffer( self, dst, int_args, int_args_len ); break;
+/* writes one record, the caller has made sure that dst is big enough ( see vfmt_calc_buffer_size ) */
+static size_t vfmt_write_slots( const vfmt_slot_t * slots, uint32_t num_slots, char * dst,
+                                const String ** str_args, size_t str_args_len,
+                                const uint64_t * int_args, size_t int_args_len ) {
+    char * p = dst;
+    uint32_t i;
+    for ( i = 0; i < num_slots; ++i ) {
+        const vfmt_slot_t * slot = &( slots[ i ] );
+        switch ( slot -> type ) {
+            case vft_literal : if ( slot -> len <= VFMT_SHORT_LITERAL ) {
+                                    memcpy( p, slot -> lit, VFMT_SHORT_LITERAL );
+                                } else {
+                                    memcpy( p, slot -> addr, slot -> len );
+                                }
+                                p += slot -> len;
+                                break;
+
+            /* a string argument ( with the int-args, because of the alternative! ) */
+            case vft_str    : {
+                                const String * src = vfmt_slot_string( slot, str_args, str_args_len );
+                                if ( NULL != src ) {
+                                    memcpy( p, src -> addr, src -> len );
+                                    p += src -> len;
+                                } else if ( NULL != int_args && slot -> idx2 < int_args_len ) {
+                                    p += vfmt_write_int( p, int_args[ slot -> idx2 ] );
+                                }
+                              }
+                              break;
+
+            case vft_int    : if ( NULL != int_args && slot -> idx < int_args_len ) {
+                                    p += vfmt_write_int( p, int_args[ slot -> idx ] );
+                                }
+                                break;
         }
     }
+    return p - dst;
 }
-                               
+
 /* releases an element, data-pointer to match VectorWhack-callback */
 static void vfmt_destroy_entry( void * self, void * data ) {
     if ( NULL != self ) {
@@ -307,6 +325,8 @@ static void vfmt_destroy_entry( void * self, void * data ) {
 /* ============================================================================================================= */
 typedef struct vfmt_t {
     Vector elements;        /* the elements are pointers to var_fmt_entry_t - structs */
+    vfmt_slot_t * slots;    /* the elements compiled into a flat array, rebuilt by vfmt_append() */
+    uint32_t num_slots;
     size_t fixed_len;       /* sum of all literal elements + sum of dflt-len of int-elements */
     SBuffer_t buffer;       /* internal buffer to print into */
 } vfmt_t;
@@ -347,15 +367,49 @@ static size_t vfmt_calc_fixed_len( Vector * v ) {
         const vfmt_entry_t * entry = VectorGet ( v, i );
         switch( entry -> type ) {
             case vft_literal: res += entry -> literal -> len; break;
-            case vft_int    : res += 20; break;     /* the length of max_uint64_t as string */
+            case vft_int    : res += VFMT_MAX_INT_LEN; break;
             case vft_str    : break;    /* we do not know yet... */
         }
     }
     return res;
 }
 
-static void vfmt_append( struct vfmt_t * self,  const String * fmt,
+/* translate the elements-vector into the flat slot-array used for printing */
+static rc_t vfmt_compile( vfmt_t * self ) {
+    rc_t rc = 0;
+    const Vector * v = &( self -> elements );
+    uint32_t i, l = VectorLength( v );
+    vfmt_slot_t * slots = calloc( l + 1, sizeof * slots );
+    if ( NULL == slots ) {
+        rc = RC( rcVDB, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+    } else {
+        uint32_t n = 0;
+        for ( i = VectorStart( v ); i < l; ++i ) {
+            const vfmt_entry_t * entry = VectorGet( v, i );
+            if ( NULL != entry ) {
+                vfmt_slot_t * slot = &( slots[ n++ ] );
+                slot -> type = entry -> type;
+                slot -> idx = entry -> idx;
+                slot -> idx2 = entry -> idx2;
+                if ( vft_literal == entry -> type ) {
+                    slot -> len = entry -> literal -> len;
+                    slot -> addr = entry -> literal -> addr;
+                    if ( slot -> len <= VFMT_SHORT_LITERAL ) {
+                        memcpy( slot -> lit, slot -> addr, slot -> len );
+                    }
+                }
+            }
+        }
+        free( ( void * ) self -> slots );
+        self -> slots = slots;
+        self -> num_slots = n;
+    }
+    return rc;
+}
+
+static rc_t vfmt_append( struct vfmt_t * self,  const String * fmt,
                          const struct vfmt_desc_list_t * vars ) {
+    rc_t rc = 0;
     if ( NULL != self && NULL != fmt ) {
         uint32_t i;
         String temp = { fmt -> addr, 0, 0 };
@@ -374,19 +428,25 @@ static void vfmt_append( struct vfmt_t * self,  const String * fmt,
         if ( !vfmt_find_desc_and_add_if_found( self, &temp, vars ) ) {
             vfmt_append_entry( self, vfmt_create_entry_literal( temp . addr, temp . len ) );
         }
-        /* calculate new fixed-len, and adjust print-buffer */
-        self -> fixed_len = vfmt_calc_fixed_len( &( self -> elements ) );
-        increase_SBuffer_to( &( self -> buffer ), ( self -> fixed_len * 4 ) );
+        /* compile the elements, calculate new fixed-len, and adjust print-buffer */
+        rc = vfmt_compile( self );
+        if ( 0 == rc ) {
+            self -> fixed_len = vfmt_calc_fixed_len( &( self -> elements ) );
+            increase_SBuffer_to( &( self -> buffer ), ( self -> fixed_len * 4 ) );
+        }
     }
+    return rc;
 }
 
-static void vfmt_append_str( struct vfmt_t * self,  const char * fmt,
+static rc_t vfmt_append_str( struct vfmt_t * self,  const char * fmt,
                              const struct vfmt_desc_list_t * vars ) {
+    rc_t rc = 0;
     if ( NULL != self && NULL != fmt ) {
         String FMT;
         StringInitCString( &FMT, fmt );
-        vfmt_append( self, &FMT, vars );
+        rc = vfmt_append( self, &FMT, vars );
     }
+    return rc;
 }
 
 /* create an empty var-print struct, to be added into later */
@@ -402,16 +462,18 @@ static struct vfmt_t * vfmt_create_by_size( size_t buffer_size ) {
 /* create a var-print struct and fill it with var_fmt_t - elements */
 struct vfmt_t * vfmt_create( const String * fmt, const struct vfmt_desc_list_t * vars ) {
     vfmt_t * self = vfmt_create_by_size( 2048 );
-    if ( NULL != self ) {
-        vfmt_append( self, fmt, vars );
+    if ( NULL != self && 0 != vfmt_append( self, fmt, vars ) ) {
+        vfmt_release( self );
+        self = NULL;
     }
     return self;
 }
 
 static struct vfmt_t * vfmt_create_from_str( const char * fmt, const struct vfmt_desc_list_t * vars ) {
     vfmt_t * self = vfmt_create_by_size( 2048 );
-    if ( NULL != self ) {
-        vfmt_append_str( self, fmt, vars );
+    if ( NULL != self && 0 != vfmt_append_str( self, fmt, vars ) ) {
+        vfmt_release( self );
+        self = NULL;
     }
     return self;
 }
@@ -420,6 +482,7 @@ static struct vfmt_t * vfmt_create_from_str( const char * fmt, const struct vfmt
 void vfmt_release( struct vfmt_t * self ) {
     if ( NULL != self ) {
         VectorWhack ( &( self -> elements ), vfmt_destroy_entry, NULL );
+        free( ( void * ) self -> slots );
         release_SBuffer( &( self -> buffer ) );
         free( ( void * ) self );
     }
@@ -429,22 +492,13 @@ static size_t vfmt_calc_buffer_size( const struct vfmt_t * self,
                     const String ** str_args, size_t str_args_len ) {
     size_t res = 0;
     if ( NULL != self ) {
-        const Vector * v = &( self -> elements );
-        uint32_t i, l = VectorLength( v );
+        uint32_t i;
         res = self -> fixed_len;
-        for ( i = VectorStart( v ); i < l; ++i ) {
-            const vfmt_entry_t * entry = VectorGet( v, i );
-            if ( NULL != entry ) {
-                if ( vft_str == entry -> type ) {
-                    if ( entry -> idx < str_args_len ) {
-                        const String * S = str_args[ entry -> idx ];
-                        if ( NULL != S ) {
-                            if ( NULL != S -> addr ) {
-                                res += S -> len;
-                            }
-                        }
-                    }
-                }
+        for ( i = 0; i < self -> num_slots; ++i ) {
+            const vfmt_slot_t * slot = &( self -> slots[ i ] );
+            if ( vft_str == slot -> type ) {
+                const String * S = vfmt_slot_string( slot, str_args, str_args_len );
+                res += ( NULL != S ) ? S -> len : VFMT_MAX_INT_LEN;
             }
         }
     }
@@ -461,21 +515,15 @@ SBuffer_t * vfmt_write_to_buffer( struct vfmt_t * self,
         size_t needed = vfmt_calc_buffer_size( self, str_args, str_args_len ); /* above */
         if ( needed > 0 )
         {
-            rc_t rc = increase_SBuffer_to( &( self -> buffer ), needed ); /* does nothing if not neccessary */
+            /* does nothing if not neccessary */
+            rc_t rc = increase_SBuffer_to( &( self -> buffer ), needed + VFMT_SLACK );
             if ( 0 == rc )
             {
-                SBuffer_t * dst = &( self -> buffer );
-                self -> buffer . S . len = 0;
-                self -> buffer . S . size = 0;
-
-                const Vector * v = &( self -> elements );
-                uint32_t i, l = VectorLength( v );
-                for ( i = VectorStart( v ); i < l; ++i ) {
-                    const vfmt_entry_t * entry = VectorGet( v, i );
-                    vfmt_copy_entry_to_buffer( entry, dst,
+                size_t len = vfmt_write_slots( self -> slots, self -> num_slots,
+                                               ( char * )( self -> buffer . S . addr ),
                                                str_args, str_args_len, int_args, int_args_len );
-                }
-                self -> buffer . S . size = self -> buffer . S . len;
+                self -> buffer . S . len = ( uint32_t )len;
+                self -> buffer . S . size = len;
                 res = &( self -> buffer );
             }
         }
@@ -39,6 +39,7 @@
 #include <string.h>
 
 #include <iostream>
+#include <cstdlib>
 
 #define OPTION_NGC "ngc"
 #define ALIAS_NGC  NULL
@@ -51,11 +52,19 @@ const char * ref_usage[] = { "Filter by position on genome.",
                              "(ex: \"chr1\" or \"1\").",
                              "\"from\" and \"to\" are 1-based coordinates",
                              NULL };
-                             
+
+#define OPTION_THREADS "threads"
+#define ALIAS_THREADS  "e"
+#define DEFAULT_THREADS 4
+static const char * threads_usage[] = { "how many threads to use (dflt=4),",
+                                        "references are piled up in parallel, the output stays in order",
+                                        NULL };
+
 OptDef options[] =
 {   /*name,           alias,         hfkt, usage-help,    maxcount, needs value, required */
     { OPTION_REF,     ALIAS_REF,     NULL, ref_usage,     0,        true,        false },
     { OPTION_NGC,     ALIAS_NGC,     NULL, ngc_usage,     0,        true,        false },
+    { OPTION_THREADS, ALIAS_THREADS, NULL, threads_usage, 1,        true,        false },
 };
 
 
@@ -98,7 +107,9 @@ rc_t CC Usage ( const Args * args )
         const char *param = NULL;
         if (alias != NULL) {
             if (strcmp(alias, ALIAS_REF) == 0)
-                param = "region";
+                param = "name[:from-to]";
+            else if (strcmp(alias, ALIAS_THREADS) == 0)
+                param = "count";
         }
         else if (strcmp(opt->name, OPTION_NGC) == 0)
             param = "PATH";
@@ -129,18 +140,27 @@ rc_t CC KMain( int argc, char *argv [] )
             void const *value = NULL;
 
             rc = ArgsOptionCount ( args, OPTION_REF, &pcount );
-            if ( pcount > 1 )
+            for ( uint32_t i = 0; i < pcount; ++ i )
             {
-                throw ngs :: ErrorMsg ( "multiple positions are not supported at this point" );
+                rc = ArgsOptionValue ( args, OPTION_REF, i, & value );
+                if ( rc != 0 )
+                {
+                    throw ngs :: ErrorMsg ( "ArgsOptionValue (" OPTION_REF ") failed" );
+                }
+                settings . AddRegion ( static_cast <char const*> (value) );
             }
+
+            settings . threads = DEFAULT_THREADS;
+            rc = ArgsOptionCount ( args, OPTION_THREADS, &pcount );
             if ( pcount == 1 )
             {
-                rc = ArgsOptionValue ( args, OPTION_REF, 0, & value );
+                rc = ArgsOptionValue ( args, OPTION_THREADS, 0, & value );
                 if ( rc != 0 )
                 {
-                    throw ngs :: ErrorMsg ( "ArgsOptionValue (" OPTION_REF ") failed" );
+                    throw ngs :: ErrorMsg ( "ArgsOptionValue (" OPTION_THREADS ") failed" );
                 }
-                settings . AddReference ( static_cast <char const*> (value) );
+                int threads = atoi ( static_cast <char const*> (value) );
+                settings . threads = threads > 0 ? threads : 1;
             }
             
 /* OPTION_NGC */
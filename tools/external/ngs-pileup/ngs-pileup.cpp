@@ -27,44 +27,113 @@
 #include "ngs-pileup.hpp"
 
 #include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 #include <ngs/ncbi/NGS.hpp>
+#include <ngs/ErrorMsg.hpp>
 #include <ngs/ReadCollection.hpp>
 #include <ngs/PileupIterator.hpp>
 
 using namespace std;
 
+/* references and slices are split into chunks of this many positions,
+   a chunk is the unit of work of a pileup thread */
+static const int64_t PileupChunkSize = 1024 * 1024;
+
+/* output is collected in memory and written in blocks of about this size */
+static const size_t OutputBufferSize = 4 * 1024 * 1024;
+
+static
+void AppendPosition ( string & out, uint64_t value )
+{
+    char buf [ 32 ];
+    char * p = buf + sizeof buf;
+    do
+    {
+        * -- p = char ( '0' + value % 10 );
+        value /= 10;
+    }
+    while ( value != 0 );
+    out . append ( p, buf + sizeof buf - p );
+}
+
+/* one set of open read collections, ngs objects are not to be shared between threads */
+class NGS_Pileup::Collections : public vector < ngs :: ReadCollection >
+{
+public:
+    Collections ( const Settings :: Inputs & p_inputs )
+    {
+        for ( Settings :: Inputs :: const_iterator i = p_inputs . begin(); i != p_inputs . end (); ++i )
+        {
+            push_back ( ncbi :: NGS :: openReadCollection ( *i ) );
+        }
+    }
+};
+
+struct NGS_Pileup::Chunk
+{
+    size_t  m_reference;
+    int64_t m_first;
+    int64_t m_count;
+};
+
 struct NGS_Pileup::TargetReference
 {
-    typedef pair < int64_t, int64_t >       Slice;
+    typedef pair < int64_t, int64_t >       Slice; /* 0-based first, length */
     typedef vector < Slice >                Slices;
-    typedef vector < ngs :: Reference >     Targets;
+    typedef pair < size_t, string >         Target; /* input, common name */
+    typedef vector < Target >               Targets;
     typedef vector < ngs :: PileupIterator> Pileups;
 
     string  m_canonicalName;
+    int64_t m_length;
     Slices  m_slices;
     Targets m_targets;
-    Pileups m_pileups;
     bool    m_complete;
 
-    TargetReference ( ngs :: Reference p_ref )
-    : m_canonicalName ( p_ref . getCanonicalName() ), m_complete ( true )
-    {
-        AddReference ( p_ref );
-    }
-    TargetReference ( ngs :: Reference p_ref,
-                      int64_t p_first,
-                      int64_t p_last )
-    : m_canonicalName ( p_ref . getCanonicalName() ), m_complete ( false )
+    TargetReference ( const string & p_canonicalName, int64_t p_length )
+    : m_canonicalName ( p_canonicalName ), m_length ( p_length ), m_complete ( false )
     {
-        AddReference ( p_ref );
     }
     ~TargetReference ()
     {
     }
 
-    void AddSlice ( int64_t p_first, int64_t p_last )
+    /* the slices are kept sorted and without overlaps, so that no position is printed twice */
+    void AddSlice ( int64_t p_first, int64_t p_length )
     {
+        if ( m_complete )
+        {
+            return;
+        }
+        int64_t first = max ( p_first, int64_t ( 0 ) );
+        int64_t end = p_length < 0 ? m_length : min ( p_first + p_length, m_length );
+        if ( first >= end )
+        {
+            return;
+        }
+        m_slices . push_back ( Slice ( first, end - first ) );
+        sort ( m_slices . begin (), m_slices . end () );
+
+        Slices merged;
+        for ( Slices :: const_iterator i = m_slices . begin (); i != m_slices . end (); ++i )
+        {
+            if ( ! merged . empty () && i -> first <= merged . back () . first + merged . back () . second )
+            {
+                int64_t mergedEnd = max ( merged . back () . first + merged . back () . second, i -> first + i -> second );
+                merged . back () . second = mergedEnd - merged . back () . first;
+            }
+            else
+            {
+                merged . push_back ( * i );
+            }
+        }
+        m_slices . swap ( merged );
     }
     void MakeComplete ()
     {
@@ -72,27 +141,42 @@ struct NGS_Pileup::TargetReference
         m_slices . clear();
     }
 
-    void AddReference ( ngs :: Reference p_ref )
+    void AddReference ( size_t p_input, const string & p_commonName )
     {
-        m_targets. push_back ( p_ref );
+        m_targets . push_back ( Target ( p_input, p_commonName ) );
     }
 
-    void Process ( ostream& out )
+    void MakeChunks ( size_t p_self, Chunks & p_chunks ) const
     {
-        int64_t firstPos = 0;
-        int64_t lastPos = m_targets . front () . getLength () - 1;
+        if ( m_complete )
+        {
+            AddChunks ( p_self, 0, m_length, p_chunks );
+        }
+        else
+        {
+            for ( Slices :: const_iterator i = m_slices . begin (); i != m_slices . end (); ++i )
+            {
+                AddChunks ( p_self, i -> first, i -> second, p_chunks );
+            }
+        }
+    }
 
-        // create pileup iterators
-        for ( Targets::iterator i = m_targets.begin(); i != m_targets.end(); ++i )
+    void Process ( Collections & p_cols, int64_t p_first, int64_t p_count, string & out ) const
+    {
+        // create pileup iterators over the slice of every target
+        Pileups pileups;
+        for ( Targets::const_iterator i = m_targets.begin(); i != m_targets.end(); ++i )
         {
-            m_pileups . push_back ( i -> getPileups ( ngs::Alignment::all ) );
+            ngs :: Reference ref = p_cols [ i -> first ] . getReference ( i -> second );
+            pileups . push_back ( ref . getPileupSlice ( p_first, p_count, ngs::Alignment::all ) );
         }
 
-        int64_t curPos = firstPos;
+        int64_t curPos = p_first;
+        int64_t lastPos = p_first + p_count - 1;
         while ( curPos <= lastPos )
         {
             uint32_t total_depth = 0;
-            for ( Pileups :: iterator i = m_pileups . begin (); i != m_pileups. end (); ++i )
+            for ( Pileups :: iterator i = pileups . begin (); i != pileups. end (); ++i )
             {
                 bool next = i -> nextPileup ();
                 assert ( next );
@@ -102,33 +186,51 @@ struct NGS_Pileup::TargetReference
 
             if ( total_depth > 0 )
             {
-                out << m_canonicalName
-                    << '\t' << ( curPos + 1 ) // convert to 1-based position to emulate samtools
-                    << '\t' << total_depth
-                    << endl;
+                out . append ( m_canonicalName );
+                out . push_back ( '\t' );
+                AppendPosition ( out, curPos + 1 ); // convert to 1-based position to emulate samtools
+                out . push_back ( '\t' );
+                AppendPosition ( out, total_depth );
+                out . push_back ( '\n' );
             }
 
             ++ curPos;
         }
     }
+
+private:
+    static void AddChunks ( size_t p_self, int64_t p_first, int64_t p_count, Chunks & p_chunks )
+    {
+        while ( p_count > 0 )
+        {
+            Chunk chunk;
+            chunk . m_reference = p_self;
+            chunk . m_first = p_first;
+            chunk . m_count = min ( p_count, PileupChunkSize );
+            p_chunks . push_back ( chunk );
+            p_first += chunk . m_count;
+            p_count -= chunk . m_count;
+        }
+    }
 };
 
 class NGS_Pileup::TargetReferences : public vector < TargetReference >
 {
 public :
-    void AddComplete ( ngs :: Reference ref )
+    TargetReference & Add ( const string & p_canonicalName, int64_t p_length, size_t p_input, const string & p_commonName )
     {
-        string name = ref . getCanonicalName ();
         for ( iterator i = begin(); i != end (); ++ i )
         {
-            if ( i -> m_canonicalName == name )
+            if ( i -> m_canonicalName == p_canonicalName )
             {
-                i -> AddReference ( ref );
-                return;
+                i -> AddReference ( p_input, p_commonName );
+                return * i;
             }
         }
         // not found - add new reference
-        push_back ( TargetReference ( ref ) );
+        push_back ( TargetReference ( p_canonicalName, p_length ) );
+        back () . AddReference ( p_input, p_commonName );
+        return back ();
     }
 };
 
@@ -137,14 +239,28 @@ NGS_Pileup::NGS_Pileup ( const Settings& p_settings )
 {
 }
 
+/* a reference of one of the inputs */
+struct InputReference
+{
+    size_t  m_input;
+    string  m_canonicalName;
+    string  m_commonName;
+    int64_t m_length;
+};
+typedef vector < InputReference > InputReferences;
+
+static
+bool MatchReference ( const string & requested, const InputReference & ref )
+{
+    return requested == ref . m_canonicalName || requested == ref . m_commonName;
+}
+
 static
-bool FindReference ( const NGS_Pileup :: Settings :: References & requested, const ngs :: Reference & ref )
+bool MatchAnyReference ( const string & requested, const InputReferences & refs )
 {
-    for ( NGS_Pileup :: Settings :: References :: const_iterator i = requested . begin();
-          i != requested . end ();
-          ++i )
+    for ( InputReferences :: const_iterator i = refs . begin (); i != refs . end (); ++i )
     {
-        if ( i->m_name == ref . getCanonicalName () || i->m_name == ref . getCommonName () )
+        if ( MatchReference ( requested, * i ) )
         {
             return true;
         }
@@ -157,35 +273,200 @@ NGS_Pileup::Run () const
 {
     TargetReferences references;
 
-    // build the set of target references
-    for ( Settings :: Inputs :: const_iterator i = m_settings . inputs . begin();
-          i != m_settings . inputs . end ();
-          ++i )
+    // build the set of target references and their slices
     {
-        ngs :: ReadCollection col = ncbi :: NGS :: openReadCollection ( *i );
-        ngs :: ReferenceIterator refIt = col . getReferences ();
-        while ( refIt . nextReference () )
+        InputReferences refs;
         {
-            if ( m_settings . references . empty () ) // all references requested
+            Collections cols ( m_settings . inputs );
+            for ( size_t input = 0; input != cols . size (); ++ input )
             {
-                /* need to create a Reference object that is not attached to the iterator, so as
-                    it is not invalidated on the next call to refIt.NextReference() */
-                references . AddComplete ( col . getReference ( refIt. getCommonName () ) );
+                ngs :: ReferenceIterator refIt = cols [ input ] . getReferences ();
+                while ( refIt . nextReference () )
+                {
+                    InputReference ref;
+                    ref . m_input = input;
+                    ref . m_canonicalName = refIt . getCanonicalName ();
+                    ref . m_commonName = refIt . getCommonName ();
+                    ref . m_length = refIt . getLength ();
+                    refs . push_back ( ref );
+                }
             }
-            else if ( FindReference ( m_settings . references, refIt ) )
+        }
+
+        // a region that is the name of a reference is not a slice of another one
+        Settings :: References requested;
+        for ( Settings :: References :: const_iterator i = m_settings . references . begin();
+              i != m_settings . references . end ();
+              ++i )
+        {
+            if ( ! i -> m_region . empty () && MatchAnyReference ( i -> m_region, refs ) )
+            {
+                requested . push_back ( Settings :: ReferenceSlice ( i -> m_region ) );
+            }
+            else
             {
-                //TODO: handle slices
-                references . AddComplete ( col . getReference ( refIt. getCommonName () ) );
+                requested . push_back ( * i );
+            }
+        }
+
+        for ( InputReferences :: const_iterator ref = refs . begin (); ref != refs . end (); ++ref )
+        {
+            if ( requested . empty () ) // all references requested
+            {
+                references . Add ( ref -> m_canonicalName, ref -> m_length, ref -> m_input, ref -> m_commonName ) . MakeComplete ();
+                continue;
+            }
+
+            TargetReference * target = 0;
+            for ( Settings :: References :: const_iterator i = requested . begin(); i != requested . end (); ++i )
+            {
+                if ( MatchReference ( i -> m_name, * ref ) )
+                {
+                    if ( target == 0 )
+                    {
+                        target = & references . Add ( ref -> m_canonicalName, ref -> m_length, ref -> m_input, ref -> m_commonName );
+                    }
+                    if ( i -> m_full )
+                    {
+                        target -> MakeComplete ();
+                    }
+                    else
+                    {
+                        target -> AddSlice ( i -> m_firstPos, i -> m_length );
+                    }
+                }
             }
         }
     }
 
+    Chunks chunks;
+    for ( size_t i = 0; i != references . size (); ++i )
+    {
+        references [ i ] . MakeChunks ( i, chunks );
+    }
+
     ostream & out ( m_settings . output != (ostream*)0 ? * m_settings . output : cout );
 
-    // walk the references and output pileups
-    for ( TargetReferences :: iterator i = references . begin(); i != references . end (); ++i )
+    if ( m_settings . threads > 1 && chunks . size () > 1 )
+    {
+        RunParallel ( references, chunks, out );
+    }
+    else
     {
-        i -> Process ( out );
+        // walk the references and output pileups
+        Collections cols ( m_settings . inputs );
+        string buf;
+        for ( Chunks :: const_iterator i = chunks . begin(); i != chunks . end (); ++i )
+        {
+            references [ i -> m_reference ] . Process ( cols, i -> m_first, i -> m_count, buf );
+            if ( buf . size () >= OutputBufferSize )
+            {
+                out . write ( buf . data (), buf . size () );
+                buf . clear ();
+            }
+        }
+        out . write ( buf . data (), buf . size () );
+    }
+    out . flush ();
+}
+
+/* chunks are claimed by the threads in order and may complete in any order,
+   the calling thread writes them out in order; threads do not run more than
+   a few chunks ahead of the output to keep the memory bounded */
+void
+NGS_Pileup::RunParallel ( const TargetReferences & references, const Chunks & chunks, ostream & out ) const
+{
+    const size_t threadCount = min ( size_t ( m_settings . threads ), chunks . size () );
+    const size_t ahead = threadCount * 2;
+
+    mutex lock;
+    condition_variable changed;
+    vector < string > results ( chunks . size () );
+    vector < bool > done ( chunks . size (), false );
+    size_t claimed = 0;
+    size_t written = 0;
+    exception_ptr error;
+
+    auto worker = [ & ] ()
+    {
+        try
+        {
+            Collections cols ( m_settings . inputs );
+            string buf;
+            for ( ;; )
+            {
+                size_t idx;
+                {
+                    unique_lock < mutex > guard ( lock );
+                    changed . wait ( guard, [ & ] { return error || claimed == chunks . size () || claimed < written + ahead; } );
+                    if ( error || claimed == chunks . size () )
+                    {
+                        return;
+                    }
+                    idx = claimed ++;
+                }
+
+                const Chunk & chunk = chunks [ idx ];
+                buf . clear ();
+                references [ chunk . m_reference ] . Process ( cols, chunk . m_first, chunk . m_count, buf );
+
+                unique_lock < mutex > guard ( lock );
+                results [ idx ] . swap ( buf );
+                done [ idx ] = true;
+                changed . notify_all ();
+            }
+        }
+        catch ( ... )
+        {
+            unique_lock < mutex > guard ( lock );
+            if ( ! error )
+            {
+                error = current_exception ();
+            }
+            changed . notify_all ();
+        }
+    };
+
+    vector < thread > threads;
+    for ( size_t i = 0; i != threadCount; ++i )
+    {
+        threads . push_back ( thread ( worker ) );
+    }
+
+    string buf;
+    string pending;
+    while ( written != chunks . size () )
+    {
+        {
+            unique_lock < mutex > guard ( lock );
+            changed . wait ( guard, [ & ] { return error || done [ written ]; } );
+            if ( error )
+            {
+                break;
+            }
+            buf . swap ( results [ written ] );
+            ++ written;
+            changed . notify_all ();
+        }
+
+        pending . append ( buf );
+        buf . clear ();
+        if ( pending . size () >= OutputBufferSize )
+        {
+            out . write ( pending . data (), pending . size () );
+            pending . clear ();
+        }
+    }
+    out . write ( pending . data (), pending . size () );
+
+    for ( vector < thread > :: iterator i = threads . begin (); i != threads . end (); ++i )
+    {
+        i -> join ();
+    }
+
+    if ( error )
+    {
+        rethrow_exception ( error );
     }
 }
 
@@ -200,8 +481,43 @@ NGS_Pileup::Settings::AddReference ( const string& commonOrCanonicalName )
 void
 NGS_Pileup::Settings::AddReferenceSlice ( const string& commonOrCanonicalName,
                                         int64_t firstPos,
-                                        int64_t lastPos )
+                                        int64_t length )
 {
-    references . push_back ( ReferenceSlice ( commonOrCanonicalName, firstPos, lastPos ) );
+    references . push_back ( ReferenceSlice ( commonOrCanonicalName, firstPos, length ) );
 }
 
+void
+NGS_Pileup::Settings::AddRegion ( const string& region )
+{
+    // only the last ':' can start a valid "from" or "from-to"
+    string::size_type colon = region . rfind ( ':' );
+    if ( colon != string::npos && colon > 0 && colon + 1 < region . size () )
+    {
+        const char * start = region . c_str () + colon + 1;
+        char * end;
+        long long from = strtoll ( start, & end, 10 );
+        if ( end != start && from > 0 )
+        {
+            if ( * end == 0 )
+            {
+                references . push_back ( ReferenceSlice ( region . substr ( 0, colon ), from - 1, -1, region ) );
+                return;
+            }
+            if ( * end == '-' )
+            {
+                start = end + 1;
+                long long to = strtoll ( start, & end, 10 );
+                if ( end != start && * end == 0 )
+                {
+                    if ( to < from )
+                    {
+                        throw ngs :: ErrorMsg ( "invalid region: " + region );
+                    }
+                    references . push_back ( ReferenceSlice ( region . substr ( 0, colon ), from - 1, to - from + 1, region ) );
+                    return;
+                }
+            }
+        }
+    }
+    AddReference ( region );
+}
@@ -29,6 +29,7 @@
 
 #include <klib/defs.h>
 
+#include <iosfwd>
 #include <string>
 #include <vector>
 
@@ -47,31 +48,43 @@ public:
             ReferenceSlice( const std::string& p_name ) /* entire reference */
             :   m_name ( p_name ), 
                 m_firstPos ( 0 ),
-                m_lastPos ( 0 ),
+                m_length ( 0 ),
                 m_full ( true )
             {
             }
             ReferenceSlice( const std::string& p_name, 
                             int64_t p_firstPos, 
-                            int64_t p_lastPos )
+                            int64_t p_length,
+                            const std::string& p_region = std::string () )
             :   m_name ( p_name ), 
                 m_firstPos ( p_firstPos ),
-                m_lastPos ( p_lastPos ),
-                m_full ( false )
+                m_length ( p_length ),
+                m_full ( false ),
+                m_region ( p_region )
             {
             }
             
             std::string m_name;
-            int64_t     m_firstPos; 
-            int64_t     m_lastPos;
+            int64_t     m_firstPos; /* 0-based */
+            int64_t     m_length;   /* < 0 : up to the end of the reference */
             bool        m_full;
+            std::string m_region;   /* as given: a reference of this name is requested entirely */
         };
         
+        Settings ()
+        :   output ( 0 ),
+            threads ( 1 )
+        {
+        }
+        
         void AddInput ( const std::string& accession ) { inputs . push_back ( accession ); }
         void AddReference ( const std::string& commonOrCanonicalName );
         void AddReferenceSlice ( const std::string& commonOrCanonicalName, 
                                  int64_t firstPos, 
-                                 int64_t lastPos );
+                                 int64_t length );
+        /* "name", "name:from" or "name:from-to", from and to are 1-based and inclusive;
+           a name may contain ':', a reference named like the whole region is taken entirely */
+        void AddRegion ( const std::string& region );
                                  
                                  
         typedef std::vector < std::string > Inputs;
@@ -80,6 +93,7 @@ public:
         Inputs inputs;
         std::ostream* output;
         References references;
+        unsigned threads; /* references and slices are piled up in parallel, output stays in order */
     };
     
 public:
@@ -90,6 +104,11 @@ public:
 private:
     struct TargetReference;
     class TargetReferences;
+    class Collections;
+    struct Chunk;
+    typedef std::vector < Chunk > Chunks;
+    
+    void RunParallel ( const TargetReferences& references, const Chunks& chunks, std::ostream& out ) const;
     
     Settings            m_settings;
 };
@@ -30,6 +30,7 @@
 #include <kfs/buffile.h>
 #include <kfs/gzip.h>
 #include <kfs/bzip.h>
+#include <kproc/lock.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -65,6 +66,14 @@ typedef struct SRASplitterFile_struct {
     uint64_t spot_qty;
 } SRASplitterFile;
 
+/* list of keys to construct a path */
+typedef struct SRASplitterPath_struct {
+    int path_tail; /* count of elements in path array */
+    int path_len; /* cumulative length of path in array */
+    const char* path[DUMPER_MAX_TREE_DEPTH];
+    char key_buf[DUMPER_MAX_TREE_DEPTH * (DUMPER_MAX_KEY_LENGTH + 3) + 10];
+} SRASplitterPath;
+
 typedef struct SRASplitterFiler_struct {
     /* TBD - reorder structure to avoid premature ageing of compiler and CPU */
     char* prefix;
@@ -78,12 +87,11 @@ typedef struct SRASplitterFiler_struct {
 
     /* TBD - this should be a BSTree */
     SLList files;
+    /* guards files while chunks are dumped in parallel */
+    KLock* files_lock;
 
-    /* list of keys to construct a path */
-    int path_tail; /* count of elements in path array */
-    int path_len; /* cumulative length of path in array */
-    const char* path[DUMPER_MAX_TREE_DEPTH];
-    char key_buf[DUMPER_MAX_TREE_DEPTH * (DUMPER_MAX_KEY_LENGTH + 3) + 10];
+    /* path of splitters not attached to a chunk */
+    SRASplitterPath path;
     /* holds opened files */
     SRASplitterFile* open[DUMPER_MAX_OPEN_FILES];
     /* keep track of number of spots written to file */
@@ -138,6 +146,7 @@ void SRASplitterFiler_Release(void)
     if( g_filer != NULL ) {
         SLListWhack(&g_filer->files, SRASplitterFiler_WhackFile, &g_filer->keep_empty);
         KFileRelease(g_filer->kf_stdout);
+        KLockRelease(g_filer->files_lock);
         KDirectoryRelease(g_filer->dir);
         free(g_filer->prefix);
         free(g_filer);
@@ -158,12 +167,12 @@ void SRASplitterFactory_FilerReport(uint64_t* total, uint64_t* biggest_file)
 }
 
 static
-rc_t SRASplitterFiler_PushKey(const char* key)
+rc_t SRASplitterFiler_PushKey(SRASplitterPath* p, const char* key)
 {
     if( g_filer == NULL || key == NULL ) {
         return RC(rcExe, rcFile, rcAttaching, rcParam, rcNull);
     }
-    if( g_filer->path_tail == sizeof(g_filer->path) - 1 ) {
+    if( p->path_tail == sizeof(p->path) - 1 ) {
         return RC(rcExe, rcFile, rcAttaching, rcDirEntry, rcTooLong);
     }
     if( g_filer->key_as_dir ) {
@@ -172,18 +181,18 @@ rc_t SRASplitterFiler_PushKey(const char* key)
             ++key;
         }
     }
-    g_filer->path[g_filer->path_tail++] = key;
-    g_filer->path_len += strlen(key) + 1;
+    p->path[p->path_tail++] = key;
+    p->path_len += strlen(key) + 1;
     return 0;
 }
 
 static
-rc_t SRASplitterFiler_PopKey(void)
+rc_t SRASplitterFiler_PopKey(SRASplitterPath* p)
 {
-    if( g_filer->path_tail == 0 ) {
+    if( p->path_tail == 0 ) {
         return RC(rcExe, rcFile, rcDetaching, rcDirEntry, rcTooShort);
     }
-    g_filer->path_len -= strlen(g_filer->path[--g_filer->path_tail]) + 1;
+    p->path_len -= strlen(p->path[--p->path_tail]) + 1;
     return 0;
 }
 
@@ -292,14 +301,19 @@ rc_t SRASplitterFiler_OpenFile(SRASplitterFile* file, bool initial)
     return rc;
 }
 
+typedef struct SRASplitterFiler_FindByKey_struct {
+    const char* key;
+    SRASplitterFile* file;
+} SRASplitterFiler_FindByKey;
+
 static
 bool CC SRASplitterFiler_GetCurrFile_FindByKey( SLNode *node, void *data )
 {
-    SRASplitterFile** d = (SRASplitterFile**)data;
+    SRASplitterFiler_FindByKey* d = (SRASplitterFiler_FindByKey*)data;
     SRASplitterFile* file = (SRASplitterFile*)node;
 
-    if( strcmp(file->key, g_filer->key_buf) == 0 ) {
-        *d = file;
+    if( strcmp(file->key, d->key) == 0 ) {
+        d->file = file;
         return true;
     }
     return false;
@@ -325,13 +339,15 @@ rc_t SRASplitterFiler_FixFSName(const char* name, char** fname)
     return 0;
 }
 
+/* open is false for chunks: files are only registered here and get opened
+   by the thread writing the chunks out */
 static
-rc_t SRASplitterFiler_GetCurrFile(const SRASplitterFile** out_file)
+rc_t SRASplitterFiler_GetCurrFile(SRASplitterPath* p, bool open, const SRASplitterFile** out_file)
 {
     rc_t rc = 0;
     int i;
-    char* key = g_filer->key_buf; /* shortcut */
-    SRASplitterFile* file = NULL;
+    char* key = p->key_buf; /* shortcut */
+    SRASplitterFiler_FindByKey found;
 
     if( out_file == NULL ) {
         return RC(rcExe, rcFile, rcOpening, rcParam, rcInvalid);
@@ -343,24 +359,27 @@ rc_t SRASplitterFiler_GetCurrFile(const SRASplitterFile** out_file)
            otherwise key will be prefix_path[i](_path[i+1]..)_?suffix
          */
         key[0] = '\0';
-        for(i = 0; i < g_filer->path_tail; i++ ) {
-            if( g_filer->path[i][0] == '\0' ) {
+        for(i = 0; i < p->path_tail; i++ ) {
+            if( p->path[i][0] == '\0' ) {
                 continue;
             }
             if( g_filer->key_as_dir ) {
                 if( i != 0 ) {
                     strcat(key, "/");
                 }
-                strcat(key, g_filer->path[i]);
+                strcat(key, p->path[i]);
             } else {
-                if( i != 0 && isalnum(g_filer->path[i][0]) ) {
+                if( i != 0 && isalnum(p->path[i][0]) ) {
                     strcat(key, "_");
                 }
-                strcat(key, g_filer->path[i]);
+                strcat(key, p->path[i]);
             }
         }
     }
-    if( !SLListDoUntil( &g_filer->files, SRASplitterFiler_GetCurrFile_FindByKey, &file ) ) {
+    found.key = key;
+    found.file = NULL;
+    if( !SLListDoUntil( &g_filer->files, SRASplitterFiler_GetCurrFile_FindByKey, &found ) ) {
+        SRASplitterFile* file = NULL;
         SRA_DUMP_DBG(5, ("New file: '%s'\n", key));
         file = calloc(1, sizeof(*file));
         key = string_dup(key, string_size(key));
@@ -372,10 +391,10 @@ rc_t SRASplitterFiler_GetCurrFile(const SRASplitterFile** out_file)
             file->key = key;
             if( g_filer->key_as_dir ) {
                 KDirectory* sub = g_filer->dir;
-                for(i = 0; rc == 0 && i < (g_filer->path_tail - 1); i++ ) {
-                    if( g_filer->path[i][0] != '\0' ) {
+                for(i = 0; rc == 0 && i < (p->path_tail - 1); i++ ) {
+                    if( p->path[i][0] != '\0' ) {
                         char* ndir = NULL;
-                        if( (rc = SRASplitterFiler_FixFSName(g_filer->path[i], &ndir)) == 0 ) {
+                        if( (rc = SRASplitterFiler_FixFSName(p->path[i], &ndir)) == 0 ) {
                             if( (rc = KDirectoryCreateDir(sub, 0775, kcmCreate, "%s", ndir)) == 0 ||
                                 (GetRCObject(rc) == ( enum RCObject )rcDirectory && GetRCState(rc) == rcExists) ) {
                                 if( (rc = KDirectoryOpenDirUpdate(sub, &file->dir, true, "%s", ndir)) == 0 ) {
@@ -387,22 +406,25 @@ rc_t SRASplitterFiler_GetCurrFile(const SRASplitterFile** out_file)
                         }
                     }
                 }
-                rc = SRASplitterFiler_FixFSName(&file->key[strlen(file->key) - strlen(g_filer->path[g_filer->path_tail - 1])], &file->name);
+                rc = SRASplitterFiler_FixFSName(&file->key[strlen(file->key) - strlen(p->path[p->path_tail - 1])], &file->name);
             } else {
                 file->dir = g_filer->dir;
                 rc = SRASplitterFiler_FixFSName(file->key, &file->name);
             }
-            if( rc == 0 && (rc = SRASplitterFiler_OpenFile(file, true)) == 0 ) {
+            if( rc == 0 && (!open || (rc = SRASplitterFiler_OpenFile(file, true)) == 0) ) {
                 SLListPushTail(&g_filer->files, &file->dad);
+                found.file = file;
             } else {
                 SRASplitterFiler_WhackFile(&file->dad, &g_filer->keep_empty);
             }
         }
     } else {
-        SRA_DUMP_DBG(5, ("Curr file key '%s': '%s'\n", key, file->name));
-        rc = SRASplitterFiler_OpenFile(file, false);
+        SRA_DUMP_DBG(5, ("Curr file key '%s': '%s'\n", key, found.file->name));
+        if( open ) {
+            rc = SRASplitterFiler_OpenFile(found.file, false);
+        }
     }
-    *out_file = rc ? NULL : file;
+    *out_file = rc ? NULL : found.file;
     return rc;
 }
 
@@ -413,13 +435,13 @@ rc_t SRASplitterFactory_FilerPrefix(const char* prefix)
     if( g_filer == NULL ) {
         rc = RC(rcExe, rcFile, rcUpdating, rcSelf, rcNotOpen);
     } else if( prefix == NULL || strcmp(prefix, g_filer->prefix) != 0 ) {
-        if( (rc = SRASplitterFiler_PopKey()) == 0 ) {
+        if( (rc = SRASplitterFiler_PopKey(&g_filer->path)) == 0 ) {
             free(g_filer->prefix);
             g_filer->prefix = prefix ? string_dup(prefix, string_size(prefix)) : string_dup("", 1);
             if( g_filer->prefix == NULL ) {
                 rc = RC(rcExe, rcFile, rcConstructing, rcMemory, rcExhausted);
             } else {
-                rc = SRASplitterFiler_PushKey(g_filer->prefix);
+                rc = SRASplitterFiler_PushKey(&g_filer->path, g_filer->prefix);
             }
         }
     }
@@ -445,7 +467,8 @@ rc_t SRASplitterFactory_FilerInit(bool to_stdout, bool gzip, bool bzip2, bool ke
         SLListInit(&g_filer->files);
         /* push empty prefix */
         g_filer->prefix = string_dup("", 1);
-        if( (rc = SRASplitterFiler_PushKey(g_filer->prefix)) == 0 &&
+        if( (rc = SRASplitterFiler_PushKey(&g_filer->path, g_filer->prefix)) == 0 &&
+            (rc = KLockMake(&g_filer->files_lock)) == 0 &&
             (rc = KDirectoryNativeDir(&g_filer->dir)) == 0 ) {
             if( to_stdout ) {
                 if( (rc = KFileMakeStdOut(&g_filer->kf_stdout)) == 0 ) {
@@ -497,12 +520,152 @@ rc_t SRASplitterFactory_FilerInit(bool to_stdout, bool gzip, bool bzip2, bool ke
         }
     }
     if( rc != 0 ) {
-        SRASplitterFiler_PopKey();
+        SRASplitterFiler_PopKey(&g_filer->path);
         SRASplitterFiler_Release();
     }
     return rc;
 }
 
+/* ### Chunks of spots dumped on parallel threads ##################################################### */
+
+struct SRASplitterChunk {
+    /* chunks are filled on different threads, each has its own path */
+    SRASplitterPath path;
+    /* output kept until chunk is written: SRASplitterChunk_Rec followed by data */
+    KDataBuffer out;
+    uint64_t out_size;
+};
+
+typedef struct SRASplitterChunk_Rec_struct {
+    SRASplitterFile* file;
+    spotid_t spot;
+    size_t size;
+} SRASplitterChunk_Rec;
+
+rc_t SRASplitterChunk_Make(SRASplitterChunk** self)
+{
+    rc_t rc = 0;
+    SRASplitterChunk* obj = NULL;
+
+    if( self == NULL ) {
+        rc = RC(rcExe, rcFile, rcConstructing, rcParam, rcNull);
+    } else if( g_filer == NULL ) {
+        rc = RC(rcExe, rcFile, rcConstructing, rcSelf, rcNotOpen);
+    } else if( (obj = calloc(1, sizeof(*obj))) == NULL ) {
+        rc = RC(rcExe, rcFile, rcConstructing, rcMemory, rcExhausted);
+    } else if( (rc = KDataBufferMakeBytes(&obj->out, 0)) != 0 ) {
+        free(obj);
+        obj = NULL;
+    } else {
+        /* start from prefix */
+        memmove(&obj->path, &g_filer->path, sizeof(obj->path));
+    }
+    if( self != NULL ) {
+        *self = obj;
+    }
+    return rc;
+}
+
+void SRASplitterChunk_Release(SRASplitterChunk* self)
+{
+    if( self != NULL ) {
+        KDataBufferWhack(&self->out);
+        free(self);
+    }
+}
+
+static
+rc_t SRASplitterChunk_Append(SRASplitterChunk* self, const SRASplitterFile* file,
+                             spotid_t spot, const void* buf, size_t size)
+{
+    rc_t rc = 0;
+    SRASplitterChunk_Rec rec;
+    uint64_t need = self->out_size + sizeof(rec) + size;
+
+    if( need > self->out.elem_count ) {
+        uint64_t grow = self->out.elem_count * 2;
+        if( (rc = KDataBufferResize(&self->out, need > grow ? need : grow)) != 0 ) {
+            return rc;
+        }
+    }
+    rec.file = (SRASplitterFile*)file;
+    rec.spot = spot;
+    rec.size = size;
+    memmove((uint8_t*)self->out.base + self->out_size, &rec, sizeof(rec));
+    if( size > 0 ) {
+        memmove((uint8_t*)self->out.base + self->out_size + sizeof(rec), buf, size);
+    }
+    self->out_size = need;
+    return rc;
+}
+
+rc_t SRASplitterChunk_Detach(SRASplitterChunk* self, KDataBuffer* data)
+{
+    rc_t rc = 0;
+
+    if( self == NULL || data == NULL ) {
+        rc = RC(rcExe, rcFile, rcDetaching, rcParam, rcNull);
+    } else if( (rc = KDataBufferResize(&self->out, self->out_size)) == 0 ) {
+        *data = self->out;
+        self->out_size = 0;
+        if( (rc = KDataBufferMakeBytes(&self->out, 0)) != 0 ) {
+            memset(&self->out, 0, sizeof(self->out));
+        }
+    }
+    return rc;
+}
+
+static
+rc_t SRASplitterFiler_Write(SRASplitterFile* f, spotid_t spot, const void* buf, size_t size)
+{
+    rc_t rc = 0;
+
+    if ( buf != NULL && size > 0 )
+    {
+        size_t writ = 0;
+        rc = KFileWrite( f->file, f->pos, buf, size, &writ );
+        if ( rc == 0 )
+        {
+            f->pos += writ;
+            if ( f->curr_spot != spot && spot != 0 )
+            {
+                 f->curr_spot = spot;
+                 f->spot_qty = f->spot_qty + 1;
+            }
+            if ( g_filer->curr_spot != spot && spot != 0 )
+            {
+                g_filer->curr_spot = spot;
+                g_filer->spot_qty = g_filer->spot_qty + 1;
+            }
+        }
+    }
+    return rc;
+}
+
+rc_t SRASplitterFiler_WriteChunk(const KDataBuffer* data)
+{
+    rc_t rc = 0;
+    const uint8_t* p = NULL;
+    const uint8_t* end = NULL;
+
+    if( data == NULL ) {
+        return RC(rcExe, rcFile, rcWriting, rcParam, rcNull);
+    }
+    p = data->base;
+    end = p + KDataBufferBytes(data);
+    while( rc == 0 && p < end ) {
+        SRASplitterChunk_Rec rec;
+        memmove(&rec, p, sizeof(rec));
+        p += sizeof(rec);
+        /* files of chunks are created on first write, opened==0 until then */
+        if( (rc = SRASplitterFiler_OpenFile(rec.file, rec.file->opened == 0)) == 0 ) {
+            rc = SRASplitterFiler_Write(rec.file, rec.spot, p, rec.size);
+        }
+        p += rec.size;
+    }
+    return rc;
+}
+
 /* ### Base splitter code ##################################################### */
 
 /* used to detect correct object pointers */
@@ -530,8 +693,11 @@ struct SRASplitter {
     SRASplitter_GetKeySet_Func* GetKeySet;
     SRASplitter_Dump_Func* Dump;
     SRASplitter_Release_Func* Release;
+    SRASplitter_Merge_Func* Merge;
     BSTree children;
     SRASplitter_Child* last_found;
+    /* NULL if output goes directly to files */
+    SRASplitterChunk* chunk;
 };
 
 struct SRASplitter_Child {
@@ -620,6 +786,15 @@ int64_t CC SRASplitter_Child_Find(const void* item, const BSTNode* node)
     return strcmp(key, n->key);
 }
 
+static
+rc_t SRASplitter_ResolveSelf(const SRASplitter* self, enum RCContext ctx, SRASplitter** resolved);
+
+static /* not virtual, self is direct pointer to base type here !!! */
+SRASplitterPath* SRASplitter_Path(SRASplitter* self)
+{
+    return self->chunk != NULL ? &self->chunk->path : &g_filer->path;
+}
+
 static /* not virtual, self is direct pointer to base type here !!! */
 rc_t SRASplitter_FindNextSplitter(SRASplitter* self, const char* key)
 {
@@ -631,7 +806,11 @@ rc_t SRASplitter_FindNextSplitter(SRASplitter* self, const char* key)
             /* create new child using next factory in chain */
             const SRASplitter* splitter = NULL;
             SRA_DUMP_DBG(5, ("New splitter on key '%s'\n", key));
-            if( (rc = SRASplitterFactory_NewObj(self->next_fact, &splitter)) == 0 ) {
+            SRASplitter* sp = NULL;
+            if( (rc = SRASplitterFactory_NewObj(self->next_fact, &splitter)) == 0 &&
+                (rc = SRASplitter_ResolveSelf(splitter, rcConstructing, &sp)) == 0 ) {
+                /* whole tree writes to same chunk */
+                sp->chunk = self->chunk;
                 if( (rc = SRASplitter_Child_MakeSplitter(&self->last_found, key, splitter)) == 0 ) {
                     if( (rc = BSTreeInsertUnique(&self->children, &self->last_found->node, NULL, SRASplitter_Child_Cmp)) != 0 ) {
                         SRASplitter_Child_Whack(&self->last_found->node, NULL);
@@ -657,7 +836,17 @@ rc_t SRASplitter_FindNextFile(SRASplitter* self, const char* key)
             /* create new child using global filer */
             const SRASplitterFile* file = NULL;
             SRA_DUMP_DBG(5, ("New file on key '%s'\n", key));
-            if( (rc = SRASplitterFiler_GetCurrFile(&file)) == 0 ) {
+            if( self->chunk == NULL ) {
+                rc = SRASplitterFiler_GetCurrFile(&g_filer->path, true, &file);
+            } else if( (rc = KLockAcquire(g_filer->files_lock)) == 0 ) {
+                rc = SRASplitterFiler_GetCurrFile(&self->chunk->path, false, &file);
+                KLockUnlock(g_filer->files_lock);
+                if( rc == 0 ) {
+                    /* empty record: file is created even if nothing is written to it */
+                    rc = SRASplitterChunk_Append(self->chunk, file, 0, NULL, 0);
+                }
+            }
+            if( rc == 0 ) {
                 if( (rc = SRASplitter_Child_MakeFile(&self->last_found, key, file)) == 0 ) {
                     if( (rc = BSTreeInsertUnique(&self->children, &self->last_found->node, NULL, SRASplitter_Child_Cmp)) != 0 ) {
                         SRASplitter_Child_Whack(&self->last_found->node, NULL);
@@ -667,7 +856,7 @@ rc_t SRASplitter_FindNextFile(SRASplitter* self, const char* key)
             }
         }
     }
-    if( rc == 0 ) {
+    if( rc == 0 && self->chunk == NULL ) {
         /* make sure file is opened */
         rc = SRASplitterFiler_OpenFile((SRASplitterFile*)(self->last_found->child.file), false);
     }
@@ -768,13 +957,13 @@ rc_t SRASplitter_AddSpot( const SRASplitter * cself, spotid_t spot, readmask_t *
                         if ( rc == 0 )
                         {
                             /* push spot to next splitter in chain */
-                            rc = SRASplitterFiler_PushKey( self->last_found->key );
+                            rc = SRASplitterFiler_PushKey( SRASplitter_Path( self ), self->last_found->key );
                             if ( rc == 0 )
                             {
                                 /* here comes RECURSION!!! */
                                 rc_t rc2;
                                 rc = SRASplitter_AddSpot( self->last_found->child.splitter, spot, local_readmask );
-                                rc2 = SRASplitterFiler_PopKey();
+                                rc2 = SRASplitterFiler_PopKey( SRASplitter_Path( self ) );
                                 rc = rc ? rc : rc2;
                             }
                         }
@@ -808,13 +997,13 @@ rc_t SRASplitter_AddSpot( const SRASplitter * cself, spotid_t spot, readmask_t *
                     if ( rc == 0 )
                     {
                         /* push spot to next splitter in chain */
-                        rc = SRASplitterFiler_PushKey( self->last_found->key );
+                        rc = SRASplitterFiler_PushKey( SRASplitter_Path( self ), self->last_found->key );
                         if ( rc == 0 )
                         {
                             /* here comes RECURSION!!! */
                             rc_t rc2;
                             rc = SRASplitter_AddSpot( self->last_found->child.splitter, spot, readmask );
-                            rc2 = SRASplitterFiler_PopKey();
+                            rc2 = SRASplitterFiler_PopKey( SRASplitter_Path( self ) );
                             rc = rc ? rc : rc2;
                         }
                     }
@@ -851,16 +1040,73 @@ rc_t SRASplitter_Release(const SRASplitter* cself)
     return rc;
 }
 
+rc_t SRASplitter_AttachChunk(const SRASplitter* cself, SRASplitterChunk* chunk)
+{
+    rc_t rc = 0;
+    SRASplitter* self = NULL;
+
+    if( (rc = SRASplitter_ResolveSelf(cself, rcAttaching, &self)) == 0 ) {
+        if( BSTreeFirst(&self->children) != NULL ) {
+            /* too late, splitter has seen spots already */
+            rc = RC(rcExe, rcNode, rcAttaching, rcSelf, rcBusy);
+        } else {
+            self->chunk = chunk;
+        }
+    }
+    return rc;
+}
+
+rc_t SRASplitter_SetMerge(const SRASplitter* cself, SRASplitter_Merge_Func* merge)
+{
+    rc_t rc = 0;
+    SRASplitter* self = NULL;
+
+    if( (rc = SRASplitter_ResolveSelf(cself, rcUpdating, &self)) == 0 ) {
+        self->Merge = merge;
+    }
+    return rc;
+}
+
+rc_t SRASplitter_Merge(const SRASplitter* cself, const SRASplitter* cother)
+{
+    rc_t rc = 0;
+    SRASplitter* self = NULL;
+    SRASplitter* other = NULL;
+
+    if( (rc = SRASplitter_ResolveSelf(cself, rcUpdating, &self)) == 0 &&
+        (rc = SRASplitter_ResolveSelf(cother, rcUpdating, &other)) == 0 ) {
+        SRASplitter_Child* n = (SRASplitter_Child*)BSTreeFirst(&other->children);
+
+        if( self->Merge != NULL ) {
+            rc = self->Merge(cself, cother);
+        }
+        /* children with same key are merged, the rest is moved over */
+        while( rc == 0 && n != NULL ) {
+            SRASplitter_Child* next = (SRASplitter_Child*)BSTNodeNext(&n->node);
+            SRASplitter_Child* found = (SRASplitter_Child*)BSTreeFind(&self->children, n->key, SRASplitter_Child_Find);
+            if( found == NULL ) {
+                BSTreeUnlink(&other->children, &n->node);
+                rc = BSTreeInsert(&self->children, &n->node, SRASplitter_Child_Cmp);
+            } else if( found->is_splitter && n->is_splitter ) {
+                rc = SRASplitter_Merge(found->child.splitter, n->child.splitter);
+            }
+            n = next;
+        }
+        other->last_found = NULL;
+    }
+    return rc;
+}
+
 rc_t SRASplitter_FileActivate(const SRASplitter* cself, const char* key)
 {
     rc_t rc = 0, rc2 = 0;
     SRASplitter* self = NULL;
 
     if( (rc = SRASplitter_ResolveSelf(cself, rcExecuting, &self)) == 0 ) {
-        if( (rc = SRASplitterFiler_PushKey(key)) == 0 ) {
+        if( (rc = SRASplitterFiler_PushKey(SRASplitter_Path(self), key)) == 0 ) {
             /* sets self->last_found */
             rc = SRASplitter_FindNextFile(self, key);
-            rc2 = SRASplitterFiler_PopKey();
+            rc2 = SRASplitterFiler_PopKey(SRASplitter_Path(self));
             rc = rc ? rc : rc2;
         }
     }
@@ -880,22 +1126,14 @@ rc_t SRASplitter_FileWrite( const SRASplitter* cself, spotid_t spot, const void*
         }
         else if ( buf != NULL && size > 0 )
         {
-            size_t writ = 0;
             SRASplitterFile* f = ( SRASplitterFile* )( self->last_found->child.file );
-            rc = KFileWrite( f->file, f->pos, buf, size, &writ );
-            if ( rc == 0 )
+            if ( self->chunk != NULL )
             {
-                f->pos += writ;
-                if ( f->curr_spot != spot && spot != 0 )
-                {
-                     f->curr_spot = spot;
-                     f->spot_qty = f->spot_qty + 1;
-                }
-                if ( g_filer->curr_spot != spot && spot != 0 )
-                {
-                    g_filer->curr_spot = spot;
-                    g_filer->spot_qty = g_filer->spot_qty + 1;
-                }
+                rc = SRASplitterChunk_Append( self->chunk, f, spot, buf, size );
+            }
+            else
+            {
+                rc = SRASplitterFiler_Write( f, spot, buf, size );
             }
         }
     }
@@ -914,6 +1152,11 @@ rc_t SRASplitter_FileWritePos( const SRASplitter* cself, spotid_t spot,
         {
             rc = RC( rcExe, rcFile, rcWriting, rcDirEntry, rcUnknown );
         }
+        else if ( self->chunk != NULL )
+        {
+            /* chunks are written out strictly sequential */
+            rc = RC( rcExe, rcFile, rcWriting, rcFunction, rcUnsupported );
+        }
         else if ( buf != NULL && size > 0 )
         {
             const SRASplitterFile* f = self->last_found->child.file;
@@ -132,6 +132,36 @@ rc_t SRASplitter_FileActivate(const SRASplitter* self, const char* key);
 rc_t SRASplitter_FileWrite( const SRASplitter* cself, spotid_t spot, const void* buf, size_t size );
 rc_t SRASplitter_FileWritePos( const SRASplitter* cself, spotid_t spot, uint64_t pos, const void* buf, size_t size );
 
+/**
+  * Chunks allow to dump spot ranges on parallel threads, each thread with own chain of factories:
+  * output of a splitter tree attached to a chunk is kept in memory instead of being written,
+  * collected output is written to files by SRASplitterFiler_WriteChunk in order of spots
+  */
+typedef struct SRASplitterChunk SRASplitterChunk;
+
+/* must be called after SRASplitterFactory_FilerPrefix */
+rc_t SRASplitterChunk_Make(SRASplitterChunk** self);
+void SRASplitterChunk_Release(SRASplitterChunk* self);
+
+/* attach root splitter and all splitters it spawns to chunk, before 1st spot is added */
+rc_t SRASplitter_AttachChunk(const SRASplitter* self, SRASplitterChunk* chunk);
+
+/* moves output collected so far into data, caller must KDataBufferWhack it */
+rc_t SRASplitterChunk_Detach(SRASplitterChunk* self, KDataBuffer* data);
+
+/* writes output detached from a chunk to file(s), not thread safe */
+rc_t SRASplitterFiler_WriteChunk(const KDataBuffer* data);
+
+/* optional method to move counters reported by Release from other into self, other's are zeroed */
+typedef rc_t (SRASplitter_Merge_Func)(const SRASplitter* self, const SRASplitter* other);
+
+/* set by splitters which report counters on Release */
+rc_t SRASplitter_SetMerge(const SRASplitter* self, SRASplitter_Merge_Func* merge);
+
+/* merges splitter tree of other into self's so that self reports as if it had seen spots of both,
+   other is left empty and silent, still must be released, not thread safe */
+rc_t SRASplitter_Merge(const SRASplitter* self, const SRASplitter* other);
+
 typedef struct SRASplitterFactory SRASplitterFactory;
 
 typedef rc_t (SRASplitterFactory_Init_Func)(const SRASplitterFactory* self);
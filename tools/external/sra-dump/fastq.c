@@ -637,6 +637,17 @@ static rc_t AlignedFilter_GetKey( const SRASplitter* cself, const char** key,
 }
 
 
+static rc_t AlignedFilter_Merge( const SRASplitter* cself, const SRASplitter* cother )
+{
+    AlignedFilter* self = ( AlignedFilter* )cself;
+    AlignedFilter* other = ( AlignedFilter* )cother;
+
+    self->rejected_reads += other->rejected_reads;
+    other->rejected_reads = 0;
+    return 0;
+}
+
+
 static rc_t AlignedFilter_Release( const SRASplitter* cself )
 {
     rc_t rc = 0;
@@ -711,6 +722,7 @@ static rc_t AlignedFilterFactory_NewObj( const SRASplitterFactory* cself, const
             filter->aligned = self->aligned;
             filter->unaligned = self->unaligned;
             filter->rejected_reads = 0;
+            rc = SRASplitter_SetMerge( *splitter, AlignedFilter_Merge );
         }
     }
     return rc;
@@ -848,6 +860,17 @@ static rc_t AlignRegionFilter_GetKey( const SRASplitter* cself, const char** key
 }
 
 
+static rc_t AlignRegionFilter_Merge( const SRASplitter* cself, const SRASplitter* cother )
+{
+    AlignRegionFilter* self = ( AlignRegionFilter* )cself;
+    AlignRegionFilter* other = ( AlignRegionFilter* )cother;
+
+    self->rejected_spots += other->rejected_spots;
+    other->rejected_spots = 0;
+    return 0;
+}
+
+
 static rc_t AlignRegionFilter_Release( const SRASplitter* cself )
 {
     rc_t rc = 0;
@@ -978,6 +1001,7 @@ static rc_t AlignRegionFilterFactory_NewObj( const SRASplitterFactory* cself, co
             filter->alregion = self->alregion;
             filter->alregion_qty = self->alregion_qty;
             filter->rejected_spots = 0;
+            rc = SRASplitter_SetMerge( *splitter, AlignRegionFilter_Merge );
         }
     }
     return rc;
@@ -1078,6 +1102,17 @@ static rc_t AlignPairDistanceFilter_GetKey( const SRASplitter* cself,
 }
 
 
+static rc_t AlignPairDistanceFilter_Merge( const SRASplitter* cself, const SRASplitter* cother )
+{
+    AlignPairDistanceFilter* self = ( AlignPairDistanceFilter* )cself;
+    AlignPairDistanceFilter* other = ( AlignPairDistanceFilter* )cother;
+
+    self->rejected_reads += other->rejected_reads;
+    other->rejected_reads = 0;
+    return 0;
+}
+
+
 static rc_t AlignPairDistanceFilter_Release( const SRASplitter* cself )
 {
     rc_t rc = 0;
@@ -1161,6 +1196,7 @@ static rc_t AlignPairDistanceFilterFactory_NewObj( const SRASplitterFactory* cse
             filter->mp_dist = self->mp_dist;
             filter->mp_dist_qty = self->mp_dist_qty;
             filter->rejected_reads = 0;
+            rc = SRASplitter_SetMerge( *splitter, AlignPairDistanceFilter_Merge );
         }
     }
     return rc;
@@ -1274,6 +1310,17 @@ static rc_t FastqBioFilter_GetKey( const SRASplitter* cself, const char** key,
 }
 
 
+static rc_t FastqBioFilter_Merge( const SRASplitter* cself, const SRASplitter* cother )
+{
+    FastqBioFilter* self = ( FastqBioFilter* )cself;
+    FastqBioFilter* other = ( FastqBioFilter* )cother;
+
+    self->rejected_reads += other->rejected_reads;
+    other->rejected_reads = 0;
+    return 0;
+}
+
+
 static rc_t FastqBioFilter_Release( const SRASplitter * cself )
 {
     rc_t rc = 0;
@@ -1337,6 +1384,7 @@ static rc_t FastqBioFilterFactory_NewObj( const SRASplitterFactory* cself, const
             FastqBioFilter * filter = ( FastqBioFilter * )( * splitter );
             filter->reader = self->reader;
             filter->rejected_reads = 0;
+            rc = SRASplitter_SetMerge( *splitter, FastqBioFilter_Merge );
         }
     }
     return rc;
@@ -1442,6 +1490,17 @@ static rc_t FastqRNumberFilter_GetKey( const SRASplitter* cself, const char** ke
 }
 
 
+static rc_t FastqRNumberFilter_Merge( const SRASplitter* cself, const SRASplitter* cother )
+{
+    FastqRNumberFilter* self = ( FastqRNumberFilter* )cself;
+    FastqRNumberFilter* other = ( FastqRNumberFilter* )cother;
+
+    self->rejected_reads += other->rejected_reads;
+    other->rejected_reads = 0;
+    return 0;
+}
+
+
 static rc_t FastqRNumberFilter_Release( const SRASplitter* cself )
 {
     rc_t rc = 0;
@@ -1506,6 +1565,7 @@ static rc_t FastqRNumberFilterFactory_NewObj( const SRASplitterFactory* cself, c
             FastqRNumberFilter * filter = ( FastqRNumberFilter * )( * splitter );
             filter->reader = self->reader;
             filter->rejected_reads = 0;
+            rc = SRASplitter_SetMerge( *splitter, FastqRNumberFilter_Merge );
         }
     }
     return rc;
@@ -1762,6 +1822,19 @@ static rc_t FastqQFilter_GetKey( const SRASplitter* cself, const char** key,
 }
 
 
+static rc_t FastqQFilter_Merge( const SRASplitter* cself, const SRASplitter* cother )
+{
+    FastqQFilter* self = ( FastqQFilter* )cself;
+    FastqQFilter* other = ( FastqQFilter* )cother;
+
+    self->rejected_spots += other->rejected_spots;
+    other->rejected_spots = 0;
+    self->rejected_reads += other->rejected_reads;
+    other->rejected_reads = 0;
+    return 0;
+}
+
+
 static rc_t FastqQFilter_Release( const SRASplitter * cself )
 {
     rc_t rc = 0;
@@ -1840,6 +1913,7 @@ static rc_t FastqQFilterFactory_NewObj( const SRASplitterFactory* cself, const S
             filter->buffer_for_quality = &self->kdbuf2;
             filter->rejected_spots = 0;
             filter->rejected_reads = 0;
+            rc = SRASplitter_SetMerge( *splitter, FastqQFilter_Merge );
         }
     }
     return rc;
@@ -1966,6 +2040,19 @@ static rc_t FastqReadLenFilter_GetKey( const SRASplitter* cself, const char** ke
 }
 
 
+static rc_t FastqReadLenFilter_Merge( const SRASplitter* cself, const SRASplitter* cother )
+{
+    FastqReadLenFilter* self = ( FastqReadLenFilter* )cself;
+    FastqReadLenFilter* other = ( FastqReadLenFilter* )cother;
+
+    self->rejected_spots += other->rejected_spots;
+    other->rejected_spots = 0;
+    self->rejected_reads += other->rejected_reads;
+    other->rejected_reads = 0;
+    return 0;
+}
+
+
 static rc_t FastqReadLenFilter_Release( const SRASplitter * cself )
 {
     rc_t rc = 0;
@@ -2032,6 +2119,7 @@ static rc_t FastqReadLenFilterFactory_NewObj( const SRASplitterFactory* cself, c
             filter->reader = self->reader;
             filter->rejected_spots = 0;
             filter->rejected_reads = 0;
+            rc = SRASplitter_SetMerge( *splitter, FastqReadLenFilter_Merge );
         }
     }
     return rc;
@@ -2077,6 +2165,52 @@ static rc_t FastqReadLenFilterFactory_Make( const SRASplitterFactory** cself,
 
 /* ============== FASTQ read splitter ============================ */
 
+/* initial alloc key_buf: "  1\0  2\0...\0  9\0 10\0 11\0...\03220..\08192\0" */
+static rc_t FastqReadKeysMake( char** key_buf, size_t key_offset )
+{
+    rc_t rc = 0;
+    if ( *key_buf == NULL )
+    {
+        if ( nreads_max > 9999 )
+        {
+            /* key_offset and sprintf format size are insufficient for keys longer than 4 digits */
+            rc = RC( rcExe, rcNode, rcConstructing, rcBuffer, rcInsufficient );
+        }
+        else
+        {
+            char* buf = malloc( nreads_max * key_offset );
+            if ( buf == NULL )
+            {
+                rc = RC( rcExe, rcNode, rcConstructing, rcMemory, rcExhausted );
+            }
+            else
+            {
+                /* fill buffer w/keys */
+                int i;
+                char* p = buf;
+                for ( i = 1; rc == 0 && i <= nreads_max; i++ )
+                {
+                    if ( sprintf( p, "%4u", i ) <= 0 )
+                    {
+                        rc = RC( rcExe, rcNode, rcConstructing, rcTransfer, rcIncomplete );
+                    }
+                    p += key_offset;
+                }
+                if ( rc == 0 )
+                {
+                    *key_buf = buf;
+                }
+                else
+                {
+                    free( buf );
+                }
+            }
+        }
+    }
+    return rc;
+}
+
+
 char* FastqReadSplitter_key_buf = NULL;
 
 
@@ -2104,39 +2238,12 @@ static rc_t FastqReadSplitter_GetKeySet( const SRASplitter* cself, const SRASpli
         uint32_t num_reads = 0;
 
         *keys = 0;
+        /* key_buf is filled by factory init, before any thread uses it */
         if ( FastqReadSplitter_key_buf == NULL )
         {
-            /* initial alloc key_buf: "  1\0  2\0...\0  9\0 10\0 11\0...\03220..\08192\0" */
-            if ( nreads_max > 9999 )
-            {
-                /* key_offset and sprintf format size are insufficient for keys longer than 4 digits */
-                rc = RC( rcExe, rcNode, rcExecuting, rcBuffer, rcInsufficient );
-            }
-            else
-            {
-                FastqReadSplitter_key_buf = malloc( nreads_max * key_offset );
-                if ( FastqReadSplitter_key_buf == NULL )
-                {
-                    rc = RC( rcExe, rcNode, rcExecuting, rcMemory, rcExhausted );
-                }
-                else
-                {
-                    /* fill buffer w/keys */
-                    int i;
-                    char* p = FastqReadSplitter_key_buf;
-                    for ( i = 1; rc == 0 && i <= nreads_max; i++ )
-                    {
-                        if ( sprintf( p, "%4u", i ) <= 0 )
-                        {
-                            rc = RC( rcExe, rcNode, rcExecuting, rcTransfer, rcIncomplete );
-                        }
-                        p += key_offset;
-                    }
-                }
-            }
+            rc = RC( rcExe, rcNode, rcExecuting, rcBuffer, rcNull );
         }
-
-        if ( rc == 0 )
+        else
         {
             rc = FastqReaderSeekSpot( self->reader, spot );
             if ( rc == 0 )
@@ -2237,6 +2344,10 @@ static rc_t FastqReadSplitterFactory_Init( const SRASplitterFactory* cself )
                               FastqArgs.is_platform_cs_native, false, FastqArgs.fasta > 0, false,
                               false, !FastqArgs.applyClip, FastqArgs.SuppressQualForCSKey, 0,
                               FastqArgs.offset, '\0', 0, 0 );
+        if ( rc == 0 )
+        {
+            rc = FastqReadKeysMake( &FastqReadSplitter_key_buf, 5 );
+        }
     }
     return rc;
 }
@@ -2331,39 +2442,12 @@ static rc_t Fastq3ReadSplitter_GetKeySet( const SRASplitter* cself, const SRASpl
         uint32_t num_reads = 0;
 
         *keys = 0;
+        /* key_buf is filled by factory init, before any thread uses it */
         if ( Fastq3ReadSplitter_key_buf == NULL )
         {
-            /* initial alloc key_buf: "  1\0  2\0...\0  9\0 10\0 11\0...\03220..\08192\0" */
-            if ( nreads_max > 9999 )
-            {
-                /* key_offset and sprintf format size are insufficient for keys longer than 4 digits */
-                rc = RC( rcExe, rcNode, rcExecuting, rcBuffer, rcInsufficient );
-            }
-            else
-            {
-                Fastq3ReadSplitter_key_buf = malloc( nreads_max * key_offset );
-                if ( Fastq3ReadSplitter_key_buf == NULL )
-                {
-                    rc = RC( rcExe, rcNode, rcExecuting, rcMemory, rcExhausted );
-                }
-                else
-                {
-                    /* fill buffer w/keys */
-                    int i;
-                    char* p = Fastq3ReadSplitter_key_buf;
-                    for ( i = 1; rc == 0 && i <= nreads_max; i++ )
-                    {
-                        if ( sprintf( p, "%4u", i ) <= 0 )
-                        {
-                            rc = RC( rcExe, rcNode, rcExecuting, rcTransfer, rcIncomplete );
-                        }
-                        p += key_offset;
-                    }
-                }
-            }
+            rc = RC( rcExe, rcNode, rcExecuting, rcBuffer, rcNull );
         }
-
-        if ( rc == 0 )
+        else
         {
             rc = FastqReaderSeekSpot( self->reader, spot );
             if ( rc == 0 )
@@ -2450,6 +2534,10 @@ static rc_t Fastq3ReadSplitterFactory_Init( const SRASplitterFactory* cself )
                               FastqArgs.is_platform_cs_native, false, FastqArgs.fasta > 0, false,
                               false, !FastqArgs.applyClip, FastqArgs.SuppressQualForCSKey, 0,
                               FastqArgs.offset, '\0', 0, 0 );
+        if ( rc == 0 )
+        {
+            rc = FastqReadKeysMake( &Fastq3ReadSplitter_key_buf, 5 );
+        }
     }
     return rc;
 }
@@ -3660,11 +3748,12 @@ rc_t FastqDumper_Factories( const SRADumperFmt* fmt, const SRASplitterFactory**
 
     if ( rc == 0 )
     {
-        if ( FastqArgs.b_deffmt != NULL )
+        /* factories are made once per table and thread, deflines are parsed only once */
+        if ( FastqArgs.b_deffmt != NULL && FastqArgs.b_defline == NULL )
         {
             rc = Defline_Parse( &FastqArgs.b_defline, FastqArgs.b_deffmt );
         }
-        if ( FastqArgs.q_deffmt != NULL )
+        if ( FastqArgs.q_deffmt != NULL && FastqArgs.q_defline == NULL )
         {
             rc = Defline_Parse( &FastqArgs.q_defline, FastqArgs.q_deffmt );
         }
@@ -3808,6 +3897,7 @@ rc_t SRADumper_Init( SRADumperFmt* fmt )
     fmt->gzip = true;
     fmt->bzip2 = true;
     fmt->split_files = false;
+    fmt->threads = true;
 
     return 0;
 }
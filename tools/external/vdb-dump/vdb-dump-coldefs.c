@@ -313,6 +313,39 @@ void vdcd_destroy( col_defs* defs ) {
     }
 }
 
+static void CC vdcd_copy_node( void* node, void* data ) {
+    const col_def * src = ( const col_def * )node;
+    col_defs * dst = ( col_defs * )data;
+    p_col_def col = vdcd_init_col( src -> name, dst -> str_limit );
+    if ( NULL != col ) {
+        col -> valid = src -> valid;
+        col -> excluded = src -> excluded;
+        col -> type_decl = src -> type_decl;
+        col -> type_desc = src -> type_desc;
+        col -> value_trans_fn = src -> value_trans_fn;
+        col -> dim_trans_fn = src -> dim_trans_fn;
+        col -> dim_trans_size = src -> dim_trans_size;
+        if ( 0 != VectorAppend( &( dst -> cols ), NULL, col ) ) {
+            vdcd_destroy_col( col );
+        }
+    }
+}
+
+/* same columns with their own content-buffers, to be added to another cursor */
+bool vdcd_copy( col_defs** dst, const col_defs* src ) {
+    bool res = false;
+    if ( NULL != src && vdcd_init( dst, src -> str_limit ) ) {
+        ( *dst ) -> max_colname_chars = src -> max_colname_chars;
+        VectorForEach( &( src -> cols ), false, vdcd_copy_node, *dst );
+        res = ( VectorLength( &( ( *dst ) -> cols ) ) == VectorLength( &( src -> cols ) ) );
+        if ( !res ) {
+            vdcd_destroy( *dst );
+            *dst = NULL;
+        }
+    }
+    return res;
+}
+
 static p_col_def vdcd_append_col( col_defs* defs, const char* name ) {
     p_col_def col = vdcd_init_col( name, defs -> str_limit );
     if ( NULL != col ) {
@@ -94,6 +94,7 @@ char *vdcd_make_domain_txt( const uint32_t domain );
 
 bool vdcd_init( col_defs** defs, const size_t str_limit );
 void vdcd_destroy( col_defs* defs );
+bool vdcd_copy( col_defs** dst, const col_defs* src );
 
 uint32_t vdcd_parse_string( col_defs* defs, const char* src, const VTable *tbl, uint32_t * invalid_columns );
 uint32_t vdcd_extract_from_table( col_defs* defs, const VTable *tbl, uint32_t * invalid_columns );
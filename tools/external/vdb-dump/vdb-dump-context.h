@@ -79,6 +79,7 @@ extern "C" {
 #define OPTION_BZIP2             "bzip2"
 #define OPTION_OUT_BUF_SIZE      "output-buffer-size"
 #define OPTION_NO_MULTITHREAD    "disable-multithreading"
+#define OPTION_THREADS           "threads"
 #define OPTION_INFO              "info"
 #define OPTION_SPOTGROUPS        "spotgroups"
 #define OPTION_MERGE_RANGES      "merge-ranges"
@@ -168,6 +169,7 @@ typedef struct dump_context
     uint16_t indented_line_len;
     uint32_t generic_idx;
     uint32_t slice_depth;
+    uint32_t num_threads;
     size_t cur_cache_size;
     size_t output_buffer_size;
     dump_format_t format;
@@ -29,8 +29,31 @@
 
 #include <klib/rc.h>
 #include <klib/log.h>
+#include <klib/out.h>
+#include <stdarg.h>
 #define DISP_RC(rc,err) if( rc != 0 ) LOGERR( klogInt, rc, err );
 
+/*************************************************************************************
+    all output of a row goes through here: to stdout, or into the buffer of the
+    row-context if the row is dumped by a worker-thread ( --threads )
+*************************************************************************************/
+static rc_t vdfo_out( const p_row_context r_ctx, const char * fmt, ... )
+{
+    rc_t rc;
+    va_list args;
+    va_start( args, fmt );
+    if ( NULL != r_ctx -> out )
+    {
+        rc = KDataBufferVPrintf( r_ctx -> out, fmt, args );
+    }
+    else
+    {
+        rc = KOutVMsg( fmt, args );
+    }
+    va_end( args );
+    return rc;
+}
+
 /*************************************************************************************
     default ( with line-length-limitation and pretty print )
 *************************************************************************************/
@@ -86,7 +109,7 @@ static void CC vdfo_print_col_default( void *item, void *data )
     }
 
     /* FINALLY we print the content of a column... */
-    KOutMsg( "%s\n", r_ctx -> s_col . buf );
+    vdfo_out( r_ctx, "%s\n", r_ctx -> s_col . buf );
 }
 
 static rc_t vdfo_print_row_default( const p_row_context r_ctx )
@@ -94,7 +117,7 @@ static rc_t vdfo_print_row_default( const p_row_context r_ctx )
     rc_t rc = 0;
     if ( r_ctx -> ctx -> print_row_id )
     {
-        rc = KOutMsg( "ROW-ID = %u\n", r_ctx -> row_id );
+        rc = vdfo_out( r_ctx, "ROW-ID = %u\n", r_ctx -> row_id );
     }
 
     if ( 0 == rc )
@@ -107,7 +130,7 @@ static rc_t vdfo_print_row_default( const p_row_context r_ctx )
         uint16_t i = 0;
         while ( i++ < r_ctx -> ctx -> lf_after_row && 0 == rc )
         {
-            rc = KOutMsg( "\n" );
+            rc = vdfo_out( r_ctx, "\n" );
         }
     }
     return rc;
@@ -151,13 +174,13 @@ static rc_t vdfo_print_row_csv( const p_row_context r_ctx )
     DISP_RC( rc, "dump_str_clear() failed" )
     if ( 0 == rc && r_ctx -> ctx -> print_row_id )
     {
-        rc = KOutMsg( "%u", r_ctx -> row_id );
+        rc = vdfo_out( r_ctx, "%u", r_ctx -> row_id );
     }
     if ( 0 == rc )
     {
         r_ctx -> col_nr = 0;
         VectorForEach( &( r_ctx -> col_defs -> cols ), false, vdfo_print_col_csv, r_ctx );
-        rc = KOutMsg( "%s\n", r_ctx -> s_col . buf );
+        rc = vdfo_out( r_ctx, "%s\n", r_ctx -> s_col . buf );
     }
     return rc;
 }
@@ -168,14 +191,15 @@ static rc_t vdfo_print_row_csv( const p_row_context r_ctx )
 static void CC vdfo_print_col_xml( void *item, void *data )
 {
     p_col_def col_def = ( p_col_def )item;
+    p_row_context r_ctx = ( p_row_context )data;
     if ( !( col_def -> valid ) || col_def -> excluded )
     {
         return;
     }
 
-    KOutMsg( " <%s>\n", col_def -> name );
-    KOutMsg( "%s", col_def -> content.buf );
-    KOutMsg( " </%s>\n", col_def -> name );
+    vdfo_out( r_ctx, " <%s>\n", col_def -> name );
+    vdfo_out( r_ctx, "%s", col_def -> content.buf );
+    vdfo_out( r_ctx, " </%s>\n", col_def -> name );
 }
 
 static rc_t vdfo_print_row_xml( const p_row_context r_ctx, bool first, bool last )
@@ -184,11 +208,11 @@ static rc_t vdfo_print_row_xml( const p_row_context r_ctx, bool first, bool last
     DISP_RC( rc, "dump_str_clear() failed" )
     if ( 0 == rc )
     {
-        rc = KOutMsg( "<row>\n" );
+        rc = vdfo_out( r_ctx, "<row>\n" );
         if ( 0 == rc )
         {
             VectorForEach( &( r_ctx -> col_defs -> cols ), false, vdfo_print_col_xml, r_ctx );
-            rc = KOutMsg( "</row>\n" );
+            rc = vdfo_out( r_ctx, "</row>\n" );
         }
     }
     return rc;
@@ -197,10 +221,16 @@ static rc_t vdfo_print_row_xml( const p_row_context r_ctx, bool first, bool last
 /*************************************************************************************
     JSON
 *************************************************************************************/
+typedef struct json_col_context
+{
+    p_row_context r_ctx;
+    rc_t rc;
+} json_col_context;
+
 static bool CC vdfo_print_col_json( void *item, void *data )
 {
     /* we do not ( can not ) handle json-specific printing regardin the value */
-    rc_t * rc = ( rc_t * )data;
+    json_col_context * j_ctx = ( json_col_context * )data;
     p_col_def col_def = ( p_col_def )item;
 
     if ( !( col_def -> valid ) || col_def -> excluded )
@@ -208,8 +238,8 @@ static bool CC vdfo_print_col_json( void *item, void *data )
         return true;
     }
 
-    *rc = KOutMsg( ",\n\"%s\":%s", col_def -> name, col_def -> content . buf );
-    return ( 0 != *rc );
+    j_ctx -> rc = vdfo_out( j_ctx -> r_ctx, ",\n\"%s\":%s", col_def -> name, col_def -> content . buf );
+    return ( 0 != j_ctx -> rc );
 }
 
 static rc_t vdfo_print_row_json( const p_row_context r_ctx, bool first, bool last )
@@ -218,34 +248,36 @@ static rc_t vdfo_print_row_json( const p_row_context r_ctx, bool first, bool las
     DISP_RC( rc, "dump_str_clear() failed" )
     if ( 0 == rc && first )
     {
-        rc = KOutMsg( "[\n" );        
+        rc = vdfo_out( r_ctx, "[\n" );        
     }
     if ( 0 == rc )
     {
-        rc = KOutMsg( "{\n" );
+        rc = vdfo_out( r_ctx, "{\n" );
     }
     if ( 0 == rc )
     {
-        rc = KOutMsg( "\"row_id\": %lu", r_ctx -> row_id );
+        rc = vdfo_out( r_ctx, "\"row_id\": %lu", r_ctx -> row_id );
     }
     if ( 0 == rc )
     {
-        VectorDoUntil( &( r_ctx -> col_defs -> cols ), false, vdfo_print_col_json, &rc );
+        json_col_context j_ctx = { r_ctx, 0 };
+        VectorDoUntil( &( r_ctx -> col_defs -> cols ), false, vdfo_print_col_json, &j_ctx );
+        rc = j_ctx . rc;
         if ( 0 == rc )
         {
             if ( last )
             {
-                rc = KOutMsg( "\n}\n" );
+                rc = vdfo_out( r_ctx, "\n}\n" );
             }
             else
             {
-                rc = KOutMsg( "\n},\n" );                        
+                rc = vdfo_out( r_ctx, "\n},\n" );                        
             }
         }
     }
     if ( 0 == rc && last )
     {
-        rc = KOutMsg( "]\n" );        
+        rc = vdfo_out( r_ctx, "]\n" );        
     }
     return rc;
 }
@@ -266,7 +298,7 @@ static void CC vdfo_print_col_piped( void *item, void *data )
     }
 
     /* first we print the row_id and the column-name for every column! */
-    KOutMsg( "%lu, %s: ", r_ctx -> row_id, col_def -> name );
+    vdfo_out( r_ctx, "%lu, %s: ", r_ctx -> row_id, col_def -> name );
 
     if ( ( col_def -> type_desc . domain == vtdAscii ) ||
          ( col_def -> type_desc . domain == vtdUnicode ) )
@@ -289,7 +321,7 @@ static void CC vdfo_print_col_piped( void *item, void *data )
     }
 
     if ( 0 == rc )
-        KOutMsg( "%s\n", col_def -> content . buf );
+        vdfo_out( r_ctx, "%s\n", col_def -> content . buf );
 }
 
 
@@ -308,10 +340,10 @@ static void CC vdfo_print_col_sra_dump( void *item, void *data )
     }
 
     /* first we print the row_id and the column-name for every column! */
-    KOutMsg( "%lu. %s: ", r_ctx -> row_id, col_def -> name );
+    vdfo_out( r_ctx, "%lu. %s: ", r_ctx -> row_id, col_def -> name );
 
     if ( 0 == rc )
-        KOutMsg( "%s\n", col_def -> content . buf );
+        vdfo_out( r_ctx, "%s\n", col_def -> content . buf );
 }
 
 
@@ -350,7 +382,7 @@ static rc_t vdfo_print_row_piped( const p_row_context r_ctx )
     if ( 0 == rc )
     {
         VectorForEach( &( r_ctx -> col_defs -> cols ), false, vdfo_print_col_piped, r_ctx );
-        rc = KOutMsg( "\n" );
+        rc = vdfo_out( r_ctx, "\n" );
     }
     return rc;
 }
@@ -362,7 +394,7 @@ static rc_t vdfo_print_row_sra_dump( const p_row_context r_ctx )
     if ( 0 == rc )
     {
         VectorForEach( &( r_ctx -> col_defs -> cols ), false, vdfo_print_col_sra_dump, r_ctx );
-        rc = KOutMsg( "\n" );
+        rc = vdfo_out( r_ctx, "\n" );
     }
     return rc;
 }
@@ -373,13 +405,13 @@ static rc_t vdfo_print_row_tab( const p_row_context r_ctx )
     DISP_RC( rc, "dump_str_clear() failed" )
 
     if ( 0 == rc && r_ctx -> ctx -> print_row_id )
-        rc = KOutMsg( "%u", r_ctx -> row_id );
+        rc = vdfo_out( r_ctx, "%u", r_ctx -> row_id );
     
     if ( 0 == rc )
     {
         r_ctx -> col_nr = 0;
         VectorForEach( &( r_ctx -> col_defs -> cols ), false, vdfo_print_col_tab, r_ctx );
-        rc = KOutMsg( "%s\n", r_ctx -> s_col . buf );
+        rc = vdfo_out( r_ctx, "%s\n", r_ctx -> s_col . buf );
     }
     return rc;
 }
@@ -29,6 +29,7 @@
 
 #include <vdb/cursor.h>
 #include <klib/vector.h>
+#include <klib/data-buffer.h>
 
 #include "vdb-dump-context.h"
 #include "vdb-dump-coldefs.h"
@@ -47,6 +48,7 @@ extern "C" {
         - a Vector containing p_col_data - pointers
         - a return-type to stop if reading data failed ( neccessary to stop after
           last row if no row-range is given at command-line )
+        - an optional buffer to print into instead of stdout ( used by worker-threads )
 
     needed as a (one and only) parameter to VectorForEach
 *************************************************************************************/
@@ -62,6 +64,7 @@ typedef struct row_context
     uint32_t col_nr;
     rc_t rc;
     rc_t last_rc;
+    KDataBuffer * out;      /* NULL ... print via KOutMsg() */
 } row_context;
 typedef row_context* p_row_context;
 
@@ -46,6 +46,13 @@
 #include <klib/printf.h>
 #include <klib/time.h>
 #include <klib/num-gen.h>
+#include <klib/out.h>
+#include <klib/data-buffer.h>
+
+#include <kproc/thread.h>
+#include <kproc/queue.h>
+
+#include <atomic32.h>
 
 #include <os-native.h>
 #include <sysalloc.h>
@@ -105,6 +112,7 @@ static const char * gzip_usage[]                = { "compress output using gzip"
 static const char * bzip2_usage[]               = { "compress output using bzip2",                  NULL };
 static const char * outbuf_size_usage[]         = { "size of output-buffer, 0...none",              NULL };
 static const char * disable_mt_usage[]          = { "disable multithreading",                       NULL };
+static const char * threads_usage[]             = { "dump rows on this many threads",               NULL };
 static const char * info_usage[]                = { "print info about run",                         NULL };
 static const char * spotgroup_usage[]           = { "show spotgroups",                              NULL };
 static const char * merge_ranges_usage[]        = { "merge and sort row-ranges",                    NULL };
@@ -161,6 +169,7 @@ OptDef DumpOptions[] =
     { OPTION_BZIP2,                 NULL,                     NULL, bzip2_usage,             1, false,  false },
     { OPTION_OUT_BUF_SIZE,          NULL,                     NULL, outbuf_size_usage,       1, true,   false },
     { OPTION_NO_MULTITHREAD,        NULL,                     NULL, disable_mt_usage,        1, false,  false },
+    { OPTION_THREADS,               NULL,                     NULL, threads_usage,           1, true,   false },
     { OPTION_INFO,                  NULL,                     NULL, info_usage,              1, false,  false },
     { OPTION_SPOTGROUPS,            NULL,                     NULL, spotgroup_usage,         1, false,  false },
     { OPTION_MERGE_RANGES,          NULL,                     NULL, merge_ranges_usage,      1, false,  false },
@@ -255,6 +264,7 @@ rc_t CC Usage ( const Args * args )
     HelpOptionLine ( NULL,                      OPTION_BZIP2,           NULL,           bzip2_usage );
     HelpOptionLine ( NULL,                      OPTION_OUT_BUF_SIZE,    "size",         outbuf_size_usage );
     HelpOptionLine ( NULL,                      OPTION_NO_MULTITHREAD,  NULL,           disable_mt_usage );
+    HelpOptionLine ( NULL,                      OPTION_THREADS,         "count",        threads_usage );
     HelpOptionLine ( NULL,                      OPTION_INFO,            NULL,           info_usage );
     HelpOptionLine ( NULL,                      OPTION_SPOTGROUPS,      NULL,           spotgroup_usage );
     HelpOptionLine ( NULL,                      OPTION_MERGE_RANGES,    NULL,           merge_ranges_usage );
@@ -403,19 +413,286 @@ static void vdm_row_error( const char * fmt, rc_t rc, uint64_t row_id ) {
     PLOGERR( klogInt, ( klogInt, rc, fmt, "row_nr=%lu", row_id ) );
 }
 
+/*************************************************************************************
+    dump_one_row:
+    * set the row-id into the cursor and open the cursor-row
+    * loop throuh the columns
+    * close the row
+    * call print_row (vdb-dump-formats.c) which actually prints the row
+
+r_ctx   [IN] ... row-context ( cursor, dump_context, col_defs, row_id ... )
+first   [IN] ... this is the first row of the row-set
+last    [IN] ... this is the last row of the row-set
+*************************************************************************************/
+static void vdm_dump_one_row( p_row_context r_ctx, bool first, bool last ) {
+    r_ctx -> rc = VCursorSetRowId( r_ctx -> cursor, r_ctx -> row_id );
+    if ( 0 != r_ctx -> rc ) {
+        vdm_row_error( "vdm_dump_rows().VCursorSetRowId( row#$(row_nr) ) failed",
+                    r_ctx -> rc, r_ctx -> row_id ); /* above */
+    } else {
+        r_ctx -> rc = VCursorOpenRow( r_ctx -> cursor );
+        if ( 0 != r_ctx -> rc ) {
+            vdm_row_error( "vdm_dump_rows().VCursorOpenRow( row#$(row_nr) ) failed",
+                        r_ctx -> rc, r_ctx -> row_id ); /* above */
+        } else {
+            /* first reset the string and valid-flag for every column */
+            vdcd_reset_content( r_ctx -> col_defs );
+            /* read the data of every column and create a string for it */
+            VectorForEach( &( r_ctx -> col_defs -> cols ), false, vdm_read_cell_data, r_ctx );
+            if ( 0 == r_ctx -> rc ) {
+                /* prints the collected strings, in vdb-dump-formats.c */
+                if ( !r_ctx -> ctx -> sum_num_elem ) {
+                    r_ctx -> rc = vdfo_print_row( r_ctx, first, last ); /* in vdb-dump-formats.c */
+                    if ( 0 != r_ctx -> rc ) {
+                        vdm_row_error( "vdm_dump_rows().vdfo_print_row( row#$(row_nr) ) failed",
+                            r_ctx -> rc, r_ctx -> row_id ); /* above */
+                    }
+                }
+            }
+            r_ctx -> rc = VCursorCloseRow( r_ctx -> cursor );
+            if ( 0 != r_ctx -> rc ) {
+                vdm_row_error( "vdm_dump_rows().VCursorCloseRow( row#$(row_nr) ) failed",
+                            r_ctx -> rc, r_ctx -> row_id ); /* above */
+            }
+        }
+    }
+}
+
+/*************************************************************************************
+    dumping rows on worker-threads ( --threads ):
+    * the row-set is cut into chunks of DUMP_CHUNK_ROWS consecutive rows
+    * every worker has its own cursor and column-definitions and dumps every n-th chunk
+      into a buffer instead of stdout
+    * the calling thread writes the buffers out in order of rows, so the output is
+      the same as without threads
+*************************************************************************************/
+#define DUMP_CHUNK_ROWS 4096
+#define DUMP_CHUNK_QUEUE 4
+
+typedef struct dump_chunk {
+    KDataBuffer text;           /* the printed rows */
+    rc_t rc;                    /* not 0 ... chunk ends at the row that failed */
+} dump_chunk;
+
+typedef struct dump_worker {
+    row_context r_ctx;          /* own cursor and column-definitions */
+    KQueue * q;                 /* printed chunks, in order of rows */
+    KThread * thread;
+    uint64_t count;             /* number of rows in the row-set */
+    uint64_t first_chunk;       /* worker dumps chunks first_chunk, first_chunk + step, ... */
+    uint64_t step;
+    atomic32_t * stop;          /* not 0 ... the writer gave up, print no more chunks */
+} dump_worker;
+
+/* the same table or view as src, with a new cursor and a copy of the column-definitions */
+static rc_t vdm_make_worker_row_context( const p_row_context src, p_row_context dst ) {
+    rc_t rc;
+    memset( dst, 0, sizeof *dst );
+    dst -> table = src -> table;
+    dst -> view = src -> view;
+    dst -> ctx = src -> ctx;
+    if ( NULL != src -> view ) {
+        rc = VViewCreateCursor( src -> view, &( dst -> cursor ) );
+        DISP_RC( rc, "VViewCreateCursor() failed" );
+    } else {
+        rc = VTableCreateCachedCursorRead( src -> table, &( dst -> cursor ), src -> ctx -> cur_cache_size );
+        DISP_RC( rc, "VTableCreateCursorRead() failed" );
+    }
+    if ( 0 == rc ) {
+        if ( !vdcd_copy( &( dst -> col_defs ), src -> col_defs ) ) {
+            rc = RC( rcVDB, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+            DISP_RC( rc, "vdcd_copy() failed" );
+        } else if ( vdcd_add_to_cursor( dst -> col_defs, dst -> cursor ) < 1 ) {
+            rc = RC( rcVDB, rcNoTarg, rcConstructing, rcParam, rcInvalid );
+        }
+    }
+    if ( 0 == rc ) {
+        rc = VCursorOpen( dst -> cursor );
+        DISP_RC( rc, "VCursorOpen() failed" );
+    }
+    if ( 0 == rc ) {
+        rc = vds_make( &( dst -> s_col ), dst -> ctx -> max_line_len, 512 ); /* vdb-dump-str.sh */
+        DISP_RC( rc, "vds_make() failed" );
+    }
+    return rc;
+}
+
+static void vdm_release_worker_row_context( p_row_context r_ctx ) {
+    vds_free( &( r_ctx -> s_col ) );
+    if ( NULL != r_ctx -> col_defs ) {
+        vdcd_destroy( r_ctx -> col_defs );
+    }
+    if ( NULL != r_ctx -> cursor ) {
+        vdh_vcursor_release( 0, r_ctx -> cursor );
+    }
+}
+
+static void vdm_destroy_chunk( dump_chunk * chunk ) {
+    KDataBufferWhack( &( chunk -> text ) );
+    free( chunk );
+}
+
+static rc_t CC vdm_dump_worker_thread( const KThread * t, void * data ) {
+    dump_worker * self = data;
+    p_row_context r_ctx = &( self -> r_ctx );
+    const struct num_gen_iter * iter;
+
+    r_ctx -> rc = num_gen_iterator_make( r_ctx -> ctx -> rows, &iter );
+    DISP_RC( r_ctx -> rc, "vdm_dump_rows().num_gen_iterator_make() failed" );
+    if ( 0 == r_ctx -> rc ) {
+        uint64_t num = 0; /* position of the next row in the row-set */
+        uint64_t c;
+        for ( c = self -> first_chunk;
+              0 == r_ctx -> rc && 0 == atomic32_read( self -> stop ) && c * DUMP_CHUNK_ROWS < self -> count;
+              c += self -> step ) {
+            uint64_t end = ( c + 1 ) * DUMP_CHUNK_ROWS;
+            dump_chunk * chunk = calloc( 1, sizeof *chunk );
+            if ( NULL == chunk ) {
+                r_ctx -> rc = RC( rcExe, rcBuffer, rcAllocating, rcMemory, rcExhausted );
+            } else {
+                r_ctx -> rc = KDataBufferMakeBytes( &( chunk -> text ), 0 );
+                if ( 0 != r_ctx -> rc ) {
+                    free( chunk );
+                }
+            }
+            if ( 0 != r_ctx -> rc ) break;
+            r_ctx -> out = &( chunk -> text );
+            /* the number-generator cannot seek: walk the row-set up to this chunk */
+            while ( ( 0 == r_ctx -> rc ) && num < end &&
+                    num_gen_iterator_next( iter, &( r_ctx -> row_id ), &( r_ctx -> rc ) ) ) {
+                if ( 0 == r_ctx -> rc && num >= c * DUMP_CHUNK_ROWS ) {
+                    r_ctx -> rc = Quitting();
+                    if ( 0 == r_ctx -> rc ) {
+                        vdm_dump_one_row( r_ctx, 0 == num, num >= self -> count - 1 );
+                    }
+                }
+                num += 1;
+            }
+            r_ctx -> out = NULL;
+            /* keep the rows printed before a failing one, vdm_dump_rows() prints them too */
+            chunk -> rc = r_ctx -> rc;
+            {
+                rc_t rc = KQueuePush( self -> q, chunk, NULL );
+                if ( 0 != rc ) {
+                    vdm_destroy_chunk( chunk );
+                    if ( 0 == r_ctx -> rc ) {
+                        r_ctx -> rc = rc;
+                    }
+                }
+            }
+        }
+        num_gen_iterator_destroy( iter );
+    }
+    /* vdm_dump_rows_threaded() pops this queue until it is sealed and empty */
+    KQueueSeal( self -> q );
+    return r_ctx -> rc;
+}
+
+/* the text printed into a chunk, without the terminating 0 of KDataBufferPrintf() */
+static rc_t vdm_write_chunk( const KDataBuffer * out ) {
+    rc_t rc = 0;
+    if ( out -> elem_count > 1 ) {
+        KWrtWriter writer = KOutWriterGet();
+        size_t num_writ;
+        rc = writer( KOutDataGet(), out -> base, out -> elem_count - 1, &num_writ );
+        DISP_RC( rc, "vdm_write_chunk() failed" );
+    }
+    return rc;
+}
+
+static rc_t vdm_dump_rows_threaded( p_row_context r_ctx, uint64_t count, uint32_t num_threads ) {
+    rc_t rc = 0;
+    rc_t rcw = 0;
+    rc_t rc_row = 0;
+    uint32_t i;
+    uint64_t c;
+    uint64_t num_chunks = ( count + DUMP_CHUNK_ROWS - 1 ) / DUMP_CHUNK_ROWS;
+    atomic32_t stop;
+    dump_worker * w;
+
+    atomic32_set( &stop, 0 );
+    if ( num_threads > num_chunks ) {
+        num_threads = ( uint32_t )num_chunks;
+    }
+    w = calloc( num_threads, sizeof *w );
+    if ( NULL == w ) {
+        return RC( rcExe, rcThread, rcAllocating, rcMemory, rcExhausted );
+    }
+
+    for ( i = 0; 0 == rc && i < num_threads; ++i ) {
+        w[ i ] . count = count;
+        w[ i ] . first_chunk = i;
+        w[ i ] . step = num_threads;
+        w[ i ] . stop = &stop;
+        rc = vdm_make_worker_row_context( r_ctx, &( w[ i ] . r_ctx ) );
+        if ( 0 == rc ) {
+            rc = KQueueMake( &( w[ i ] . q ), DUMP_CHUNK_QUEUE );
+            DISP_RC( rc, "KQueueMake() failed" );
+        }
+        if ( 0 == rc ) {
+            rc = KThreadMake( &( w[ i ] . thread ), vdm_dump_worker_thread, &( w[ i ] ) );
+            DISP_RC( rc, "KThreadMake() failed" );
+        }
+    }
+
+    /* the chunks are dealt round-robin: chunk c is in the queue of worker c % num_threads,
+       if that queue is sealed before the chunk arrives the worker has failed */
+    for ( c = 0; 0 == rc && c < num_chunks; ++c ) {
+        dump_chunk * chunk = NULL;
+        rc = KQueuePop( w[ c % num_threads ] . q, ( void ** )&chunk, NULL );
+        if ( 0 == rc ) {
+            rc = vdm_write_chunk( &( chunk -> text ) );
+            if ( 0 == rc ) {
+                /* the failing row ends the output, like without threads */
+                rc = rc_row = chunk -> rc;
+            }
+            vdm_destroy_chunk( chunk );
+        }
+    }
+
+    /* after an error the workers may still be printing ahead: stop them, and empty their
+       queues because a worker waits in KQueuePush() while its queue is full */
+    atomic32_set( &stop, 1 );
+    for ( i = 0; i < num_threads; ++i ) {
+        if ( NULL != w[ i ] . thread ) {
+            rc_t rc_thread = 0;
+            dump_chunk * chunk = NULL;
+            while ( 0 == KQueuePop( w[ i ] . q, ( void ** )&chunk, NULL ) ) {
+                vdm_destroy_chunk( chunk );
+            }
+            KThreadWait( w[ i ] . thread, &rc_thread );
+            KThreadRelease( w[ i ] . thread );
+            if ( 0 == rcw ) {
+                rcw = rc_thread;
+            }
+        }
+        /* be forgiving, like vdm_read_cell_data(), but remember the error */
+        if ( 0 != w[ i ] . r_ctx . last_rc ) {
+            r_ctx -> last_rc = w[ i ] . r_ctx . last_rc;
+        }
+        KQueueRelease( w[ i ] . q );
+        vdm_release_worker_row_context( &( w[ i ] . r_ctx ) );
+    }
+    free( w );
+
+    /* report what vdm_dump_rows() would have hit first: a failing row, then the error
+       that ended a worker, then the error writing to stdout */
+    if ( 0 != rc_row ) {
+        return rc_row;
+    }
+    return 0 != rcw ? rcw : rc;
+}
+
 /*************************************************************************************
     dump_rows:
     * is the main loop to dump all rows or all selected rows ( -R1-10 )
     * creates a dump-string ( parameterizes it with the wanted max. line-len )
     * starts the number-generator
     * as long as the number-generator has a number and the result-code is ok
-      do for every row-id:
-        - set the row-id into the cursor and open the cursor-row
-        - loop throuh the columns
-        - close the row
-        - call print_row (vdb-dump-formats.c) which actually prints the row
+      do for every row-id: "dump_one_row()"
     * the collection of the text's for the columns "read_cell_data_and_dump()"
       is separated from the actual printing "print_row()" !
+    * with --threads the rows are dumped by worker-threads ( see above )
 
 r_ctx   [IN] ... row-context ( cursor, dump_context, col_defs ... )
 *************************************************************************************/
@@ -423,6 +700,7 @@ static rc_t vdm_dump_rows( p_row_context r_ctx ) {
     /* the important row_id is a member of r_ctx ! */
     const struct num_gen_iter * iter;
 
+    r_ctx -> out = NULL;
     r_ctx -> rc = vds_make( &( r_ctx -> s_col ), r_ctx -> ctx->max_line_len, 512 ); /* vdb-dump-str.sh */
     DISP_RC( r_ctx -> rc, "vdm_dump_rows().vds_make() failed" );
     if ( 0 == r_ctx -> rc ) {
@@ -433,48 +711,20 @@ static rc_t vdm_dump_rows( p_row_context r_ctx ) {
             r_ctx -> rc = num_gen_iterator_count( iter, &count );
             DISP_RC( r_ctx -> rc, "vdm_dump_rows().num_gen_iterator_count() failed" );
             if ( 0 == r_ctx -> rc ) {
-                uint64_t num = 0;
-                while ( ( 0 == r_ctx -> rc ) &&
-                        num_gen_iterator_next( iter, &( r_ctx -> row_id ), &( r_ctx -> rc ) ) ) {
-                    if ( 0 == r_ctx -> rc ) {
-                        r_ctx -> rc = Quitting();
-                    }
-                    if ( 0 != r_ctx -> rc ) break;
-                    r_ctx -> rc = VCursorSetRowId( r_ctx -> cursor, r_ctx -> row_id );
-                    if ( 0 != r_ctx -> rc ) {
-                        vdm_row_error( "vdm_dump_rows().VCursorSetRowId( row#$(row_nr) ) failed",
-                                    r_ctx -> rc, r_ctx -> row_id ); /* above */
-                    } else {
-                        r_ctx -> rc = VCursorOpenRow( r_ctx -> cursor );
-                        if ( 0 != r_ctx -> rc ) {
-                            vdm_row_error( "vdm_dump_rows().VCursorOpenRow( row#$(row_nr) ) failed",
-                                        r_ctx -> rc, r_ctx -> row_id ); /* above */
-                        } else {
-                            /* first reset the string and valid-flag for every column */
-                            vdcd_reset_content( r_ctx -> col_defs );
-                            /* read the data of every column and create a string for it */
-                            VectorForEach( &( r_ctx -> col_defs -> cols ), false, vdm_read_cell_data, r_ctx );
-                            if ( 0 == r_ctx -> rc ) {
-                                /* prints the collected strings, in vdb-dump-formats.c */
-                                if ( !r_ctx -> ctx -> sum_num_elem ) {
-                                    bool first = ( 0 == num );
-                                    bool last  = ( num >= count - 1 );
-                                    r_ctx -> rc = vdfo_print_row( r_ctx, first, last ); /* in vdb-dump-formats.c */
-                                    if ( 0 != r_ctx -> rc ) {
-                                        vdm_row_error( "vdm_dump_rows().vdfo_print_row( row#$(row_nr) ) failed",
-                                            r_ctx -> rc, r_ctx -> row_id ); /* above */
-                                    }
-                                }
-                            }
-                            r_ctx -> rc = VCursorCloseRow( r_ctx -> cursor );
-                            if ( 0 != r_ctx -> rc ) {
-                                vdm_row_error( "vdm_dump_rows().VCursorCloseRow( row#$(row_nr) ) failed",
-                                            r_ctx -> rc, r_ctx -> row_id ); /* above */
-                            }
+                if ( r_ctx -> ctx -> num_threads > 1 && !r_ctx -> ctx -> sum_num_elem && count > DUMP_CHUNK_ROWS ) {
+                    r_ctx -> rc = vdm_dump_rows_threaded( r_ctx, count, r_ctx -> ctx -> num_threads );
+                } else {
+                    uint64_t num = 0;
+                    while ( ( 0 == r_ctx -> rc ) &&
+                            num_gen_iterator_next( iter, &( r_ctx -> row_id ), &( r_ctx -> rc ) ) ) {
+                        if ( 0 == r_ctx -> rc ) {
+                            r_ctx -> rc = Quitting();
                         }
-                    }
-                    num += 1;
-                } /* while( ... ) */
+                        if ( 0 != r_ctx -> rc ) break;
+                        vdm_dump_one_row( r_ctx, 0 == num, num >= count - 1 );
+                        num += 1;
+                    } /* while( ... ) */
+                }
             }
         }
         num_gen_iterator_destroy( iter );
@@ -0,0 +1,276 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "blob_pass.h"
+
+#ifndef _h_definitions_
+#include "definitions.h"
+#endif
+
+#ifndef _h_helper_
+#include "helper.h"
+#endif
+
+#ifndef _h_klib_out_
+#include <klib/out.h>
+#endif
+
+#ifndef _h_klib_printf_
+#include <klib/printf.h>
+#endif
+
+#ifndef _h_klib_log_
+#include <klib/log.h>
+#endif
+
+#ifndef _h_kdb_table_
+#include <kdb/table.h>
+#endif
+
+#ifndef _h_kdb_namelist_
+#include <kdb/namelist.h>
+#endif
+
+#ifndef _h_kfs_directory_
+#include <kfs/directory.h>
+#endif
+
+#ifndef _h_copy_meta_
+#include "copy_meta.h"
+#endif
+
+#include <string.h>
+
+/* a column can only pass through if it is a direct projection of a physical column
+   with the same name, stored by the same schema-table on both sides */
+static bool blob_pass_candidate( const p_col_def col, const KNamelist * physical ) {
+    if ( ! col -> to_copy || col -> redactable ) return false;
+    if ( NULL == col -> src_cast || NULL == col -> dst_cast ) return false;
+    /* a different cast on both sides means a type-conversion */
+    if ( 0 != strcmp( col -> src_cast, col -> dst_cast ) ) return false;
+    return nlt_is_name_in_KNamelist( physical, col -> name );
+}
+
+/* the blobs are only valid in the dst-table if it is declared by the same
+   schema-table ( name and version ) as the src-table */
+static bool blob_pass_same_schema( const VTable * src_table, const VTable * dst_table ) {
+    char src_spec[ 1024 ];
+    char dst_spec[ 1024 ];
+    rc_t rc = VTableTypespec( src_table, src_spec, sizeof src_spec );
+    DISP_RC( rc, "blob_pass_same_schema:VTableTypespec( src ) failed" );
+    if ( 0 == rc ) {
+        rc = VTableTypespec( dst_table, dst_spec, sizeof dst_spec );
+        DISP_RC( rc, "blob_pass_same_schema:VTableTypespec( dst ) failed" );
+    }
+    return ( 0 == rc && 0 == strcmp( src_spec, dst_spec ) );
+}
+
+/* a physical column can be written by more than one writable column:
+   each of them has to be copied, otherwise the physical columns
+   copied later would contain data the user has not asked for */
+static bool blob_pass_all_writables_copied( const col_defs* defs, VTable * dst_table ) {
+    KNamelist * writables;
+    bool res = false;
+    rc_t rc = VTableListWritableColumns( dst_table, &writables );
+    DISP_RC( rc, "blob_pass_all_writables_copied:VTableListWritableColumns() failed" );
+    if ( 0 == rc ) {
+        uint32_t idx, len = VectorLength( &( defs -> cols ) );
+        res = true;
+        for ( idx = 0;  res && idx < len; ++idx ) {
+            const p_col_def col = ( p_col_def ) VectorGet ( &( defs -> cols ), idx );
+            if ( NULL != col && ! col -> to_copy ) {
+                res = ! nlt_is_name_in_KNamelist( writables, col -> name );
+            }
+        }
+        KNamelistRelease( writables );
+    }
+    return res;
+}
+
+rc_t blob_pass_mark_columns( col_defs* defs, const VTable * src_table,
+                             VTable * dst_table, const bool show ) {
+    const KTable * ktab;
+    rc_t rc;
+
+    if ( NULL == defs ) {
+        return RC( rcExe, rcNoTarg, rcResolving, rcSelf, rcNull );
+    }
+    if ( NULL == src_table || NULL == dst_table ) {
+        return RC( rcExe, rcNoTarg, rcResolving, rcParam, rcNull );
+    }
+    if ( ! blob_pass_same_schema( src_table, dst_table ) ) {
+        LOGMSG( klogInfo, "passthrough disabled: the schema of the dst-table differs" );
+        return 0;
+    }
+    if ( ! blob_pass_all_writables_copied( defs, dst_table ) ) {
+        LOGMSG( klogInfo, "passthrough disabled: not all writable columns are copied" );
+        return 0;
+    }
+    rc = VTableOpenKTableRead( src_table, &ktab );
+    DISP_RC( rc, "blob_pass_mark_columns:VTableOpenKTableRead() failed" );
+    if ( 0 == rc ) {
+        KNamelist * physical;
+        rc = KTableListCol( ktab, &physical );
+        DISP_RC( rc, "blob_pass_mark_columns:KTableListCol() failed" );
+        if ( 0 == rc ) {
+            uint32_t idx, len = VectorLength( &( defs -> cols ) );
+            uint32_t in_pipeline = 0;
+            int32_t first_candidate = -1;
+
+            for ( idx = 0;  idx < len; ++idx ) {
+                p_col_def col = ( p_col_def ) VectorGet ( &( defs -> cols ), idx );
+                if ( NULL != col && col -> to_copy ) {
+                    if ( blob_pass_candidate( col, physical ) ) {
+                        col -> passthrough = true;
+                        col -> to_copy = false;
+                        if ( first_candidate < 0 ) {
+                            first_candidate = idx;
+                        }
+                    } else {
+                        in_pipeline++;
+                    }
+                }
+            }
+
+            /* the write-cursor needs at least one column */
+            if ( 0 == in_pipeline && first_candidate >= 0 ) {
+                p_col_def col = col_defs_get( defs, first_candidate );
+                col -> passthrough = false;
+                col -> to_copy = true;
+            }
+
+            if ( show ) {
+                for ( idx = 0;  idx < len; ++idx ) {
+                    p_col_def col = ( p_col_def ) VectorGet ( &( defs -> cols ), idx );
+                    if ( NULL != col && col -> passthrough ) {
+                        KOutMsg( "passthrough column: >%s<\n", col -> name );
+                    }
+                }
+            }
+            KNamelistRelease( physical );
+        }
+        KTableRelease( ktab );
+    }
+    return rc;
+}
+
+static bool blob_pass_any_column( const col_defs* defs ) {
+    uint32_t idx, len = VectorLength( &( defs -> cols ) );
+    for ( idx = 0;  idx < len; ++idx ) {
+        const p_col_def col = ( p_col_def ) VectorGet ( &( defs -> cols ), idx );
+        if ( NULL != col && col -> passthrough ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* every physical column the row-pipeline has not produced belongs to a passthrough-column:
+   its own physical column and siblings it is stored in ( READ and ALTREAD for instance ) */
+static rc_t blob_pass_copy_physical( const KTable * src_ktab, const KDirectory * src_dir,
+                                     KDirectory * dst_dir, const bool show ) {
+    KNamelist * physical;
+    rc_t rc = KTableListCol( src_ktab, &physical );
+    DISP_RC( rc, "blob_pass_copy_physical:KTableListCol() failed" );
+    if ( 0 == rc ) {
+        uint32_t idx, count;
+        rc = KNamelistCount( physical, &count );
+        for ( idx = 0; idx < count && 0 == rc; ++idx ) {
+            const char * name;
+            rc = KNamelistGet( physical, idx, &name );
+            if ( 0 == rc ) {
+                char path[ 4096 ];
+                size_t written;
+                rc = string_printf( path, sizeof path, &written, "col/%s", name );
+                if ( 0 == rc && kptNotFound == KDirectoryPathType( dst_dir, "%s", path ) ) {
+                    if ( show ) {
+                        KOutMsg( "copy blobs of >%s<\n", name );
+                    }
+                    rc = KDirectoryCopy( src_dir, dst_dir, true, path, path );
+                    if ( 0 != rc ) {
+                        PLOGERR( klogErr, ( klogErr, rc,
+                                 "copying the blobs of column $(col) failed",
+                                 "col=%s", name ) );
+                    }
+                }
+            }
+        }
+        KNamelistRelease( physical );
+    }
+    return rc;
+}
+
+rc_t blob_pass_copy_columns( const col_defs* defs, const VTable * src_table,
+                             VTable * dst_table, const bool show ) {
+    const KTable * src_ktab;
+    rc_t rc;
+
+    if ( NULL == defs ) {
+        return RC( rcExe, rcNoTarg, rcCopying, rcSelf, rcNull );
+    }
+    if ( NULL == src_table || NULL == dst_table ) {
+        return RC( rcExe, rcNoTarg, rcCopying, rcParam, rcNull );
+    }
+    if ( ! blob_pass_any_column( defs ) ) {
+        return 0;
+    }
+    rc = VTableOpenKTableRead( src_table, &src_ktab );
+    DISP_RC( rc, "blob_pass_copy_columns:VTableOpenKTableRead() failed" );
+    if ( 0 == rc ) {
+        KTable * dst_ktab;
+        rc = VTableOpenKTableUpdate( dst_table, &dst_ktab );
+        DISP_RC( rc, "blob_pass_copy_columns:VTableOpenKTableUpdate() failed" );
+        if ( 0 == rc ) {
+            const KDirectory * src_dir;
+            rc = KTableOpenDirectoryRead( src_ktab, &src_dir );
+            DISP_RC( rc, "blob_pass_copy_columns:KTableOpenDirectoryRead() failed" );
+            if ( 0 == rc ) {
+                KDirectory * dst_dir;
+                rc = KTableOpenDirectoryUpdate( dst_ktab, &dst_dir );
+                DISP_RC( rc, "blob_pass_copy_columns:KTableOpenDirectoryUpdate() failed" );
+                if ( 0 == rc ) {
+                    /* the dst-table may not have a single column yet */
+                    rc = KDirectoryCreateDir( dst_dir, 0775, kcmOpen | kcmParents, "col" );
+                    DISP_RC( rc, "blob_pass_copy_columns:KDirectoryCreateDir() failed" );
+                    if ( 0 == rc ) {
+                        rc = blob_pass_copy_physical( src_ktab, src_dir, dst_dir, show );
+                    }
+                    KDirectoryRelease( dst_dir );
+                }
+                KDirectoryRelease( src_dir );
+            }
+            KTableRelease( dst_ktab );
+        }
+        KTableRelease( src_ktab );
+    }
+    if ( 0 == rc ) {
+        /* the write-cursor has produced statistics only for the columns it has seen,
+           all rows are copied unchanged: the statistics of the src-table are valid */
+        rc = copy_table_meta_node( src_table, dst_table, "STATS", show );
+        DISP_RC( rc, "blob_pass_copy_columns:copy_table_meta_node( STATS ) failed" );
+    }
+    return rc;
+}
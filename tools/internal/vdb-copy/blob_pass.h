@@ -0,0 +1,77 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_blob_pass_
+#define _h_blob_pass_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef _h_klib_rc_
+#include <klib/rc.h>
+#endif
+
+#ifndef _h_vdb_table_
+#include <vdb/table.h>
+#endif
+
+#ifndef _h_vdb_coldefs_
+#include "coldefs.h"
+#endif
+
+/*
+ * walks the list of column-definitions and moves every column that
+ * does not need a transformation out of the row-pipeline:
+ * the column has to be marked as to_copy, must not be redactable,
+ * must not be type-converted ( src_cast equals dst_cast ) and the
+ * source-table must have a physical column with the same name
+ * these columns get passthrough = true and to_copy = false
+ * nothing is moved if the dst-table is declared by a different
+ * schema-table than the src-table, or if a writable column is not copied
+ * at least one column is left in the row-pipeline, because the
+ * write-cursor needs a column to produce the rows of the dst-table
+*/
+rc_t blob_pass_mark_columns( col_defs* defs, const VTable * src_table,
+                             VTable * dst_table, const bool show );
+
+
+/*
+ * if columns are marked as passthrough: copies the physical
+ * column-directories ( blobs, index and metadata ) the row-pipeline has
+ * not produced byte by byte from the src-table into the dst-table,
+ * a passthrough-column may be stored in more than one of them,
+ * then copies the STATS-node of the table-metadata,
+ * has to be called after the write-cursor of the dst-table has been released
+*/
+rc_t blob_pass_copy_columns( const col_defs* defs, const VTable * src_table,
+                             VTable * dst_table, const bool show );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
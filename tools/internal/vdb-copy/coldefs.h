@@ -92,6 +92,9 @@ typedef struct col_def
     bool redactable;        /* this column is in the list of redactable
                                columns */
 
+    bool passthrough;       /* this column is not copied row by row,
+                               its physical blobs are copied as they are */
+
     VTypedecl type_decl;    /* type-decl of this column via read-schema */
     VTypedesc type_desc;    /* type-desc of this column via read-schema */
 
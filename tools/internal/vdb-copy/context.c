@@ -385,6 +385,7 @@ static void context_evaluate_options( const Args *my_args, p_context ctx ) {
         ctx -> show_meta     = context_get_bool_option( my_args, OPTION_SHOW_META, false );
         ctx -> force_kcmInit = context_get_bool_option( my_args, OPTION_FORCE, false );
         ctx -> force_unlock  = context_get_bool_option( my_args, OPTION_UNLOCK, false );
+        ctx -> passthrough   = context_get_bool_option( my_args, OPTION_PASSTHROUGH, false );
 
         context_set_md5_mode( ctx, context_get_str_option( my_args, OPTION_MD5_MODE ) );
         context_set_blob_checksum( ctx, context_get_str_option( my_args, OPTION_BLOB_CHECKSUM ) );
@@ -402,6 +403,7 @@ static void context_evaluate_options( const Args *my_args, p_context ctx ) {
         {
             const char * row_range = context_get_str_option( my_args, OPTION_ROWS );
             context_set_row_range( ctx, row_range );
+            ctx -> rows_requested = ( NULL != row_range );
         }
         nlt_make_VNamelist_from_string( &( ctx -> src_schema_list ), 
                                         context_get_str_option( my_args, OPTION_SCHEMA ) );
@@ -82,6 +82,7 @@ extern "C" {
 #define OPTION_FORCE             "force"
 #define OPTION_UNLOCK            "unlock"
 #define OPTION_BLOB_CHECKSUM     "blob_checksum"
+#define OPTION_PASSTHROUGH       "passthrough"
 
 
 #define ALIAS_TABLE             "T"
@@ -107,6 +108,7 @@ extern "C" {
 #define ALIAS_FORCE             "f"
 #define ALIAS_UNLOCK            "u"
 #define ALIAS_BLOB_CHECKSUM     "b"
+#define ALIAS_PASSTHROUGH       "P"
 
 
 /* *******************************************************************
@@ -138,6 +140,8 @@ typedef struct context
     uint8_t blob_checksum;
     bool force_kcmInit;
     bool force_unlock;
+    bool passthrough;
+    bool rows_requested;
 
     /* set by application */
     bool dont_remove_target;
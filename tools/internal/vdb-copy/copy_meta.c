@@ -417,6 +417,45 @@ rc_t copy_table_meta ( const VTable *src_table, VTable *dst_table,
 }
 
 
+rc_t copy_table_meta_node ( const VTable *src_table, VTable *dst_table,
+                            const char * node_path, const bool show_meta ) {
+    const KMetadata *src_meta;
+    rc_t rc;
+
+    if ( NULL == src_table || NULL == dst_table || NULL == node_path ) {
+        return RC( rcExe, rcNoTarg, rcCopying, rcParam, rcNull );
+    }
+    rc = VTableOpenMetadataRead ( src_table, & src_meta );
+    DISP_RC( rc, "copy_table_meta_node:VTableOpenMetadataRead() failed" );
+    if ( 0 == rc ) {
+        const KMDataNode *src_root;
+        rc = KMetadataOpenNodeRead ( src_meta, & src_root, NULL );
+        DISP_RC( rc, "copy_table_meta_node:KMetadataOpenNodeRead() failed" );
+        if ( 0 == rc ) {
+            const KMDataNode *src_node;
+            if ( 0 == KMDataNodeOpenNodeRead ( src_root, & src_node, "%s", node_path ) ) {
+                KMetadata *dst_meta;
+                KMDataNodeRelease ( src_node );
+                rc = VTableOpenMetadataUpdate ( dst_table, & dst_meta );
+                DISP_RC( rc, "copy_table_meta_node:VTableOpenMetadataUpdate() failed" );
+                if ( 0 == rc ) {
+                    KMDataNode *dst_root;
+                    rc = KMetadataOpenNodeUpdate ( dst_meta, & dst_root, NULL );
+                    DISP_RC( rc, "copy_table_meta_node:KMetadataOpenNodeUpdate() failed" );
+                    if ( 0 == rc ) {
+                        rc = copy_metadata_child ( src_root, dst_root, node_path, show_meta );
+                        KMDataNodeRelease ( dst_root );
+                    }
+                    KMetadataRelease ( dst_meta );
+                }
+            }
+            KMDataNodeRelease ( src_root );
+        }
+        KMetadataRelease ( src_meta );
+    }
+    return rc;
+}
+
 rc_t copy_database_meta ( const VDatabase *src_db, VDatabase *dst_db,
                           const char * excluded_nodes,
                           const bool show_meta ) {
@@ -47,6 +47,11 @@ rc_t copy_table_meta ( const VTable *src_table, VTable *dst_table,
                        const char * excluded_nodes,
                        const bool show_meta, const bool schema_updated );
 
+/* copies one node ( with all of its children ) of the table-metadata,
+   a missing node in the src-table is not an error */
+rc_t copy_table_meta_node ( const VTable *src_table, VTable *dst_table,
+                            const char * node_path, const bool show_meta );
+
 rc_t copy_database_meta ( const VDatabase *src_db, VDatabase *dst_db,
                           const char * excluded_nodes,
                           const bool show_meta );
@@ -64,6 +64,10 @@
 #include "copy_meta.h"
 #endif
 
+#ifndef _h_blob_pass_
+#include "blob_pass.h"
+#endif
+
 static const char * table_usage[] = { "table-name", NULL };
 static const char * rows_usage[] = { "set of rows to be copied(default = all)", NULL };
 #if ALLOW_COLUMN_SPEC
@@ -87,6 +91,7 @@ static const char * md5mode_usage[] = { "MD5-mode def.: auto, '1'...forced ON, '
 static const char * blcmode_usage[] = { "Blob-checksum def.: auto, '1'...CRC32, 'M'...MD5, '0'...OFF)", NULL };
 static const char * force_usage[] = { "forces an existing target to be overwritten", NULL };
 static const char * unlock_usage[] = { "forces a locked target to be unlocked", NULL };
+static const char * passthrough_usage[] = { "copy blobs of unchanged columns without decoding them", NULL };
 
 OptDef MyOptions[] = {
     { OPTION_TABLE, ALIAS_TABLE, NULL, table_usage, 1, true, false },
@@ -111,7 +116,8 @@ OptDef MyOptions[] = {
     { OPTION_MD5_MODE, ALIAS_MD5_MODE, NULL, md5mode_usage, 1, true, false },
     { OPTION_BLOB_CHECKSUM, ALIAS_BLOB_CHECKSUM, NULL, blcmode_usage, 1, true, false },
     { OPTION_FORCE, ALIAS_FORCE, NULL, force_usage, 1, false, false },
-    { OPTION_UNLOCK, ALIAS_UNLOCK, NULL, unlock_usage, 1, false, false }
+    { OPTION_UNLOCK, ALIAS_UNLOCK, NULL, unlock_usage, 1, false, false },
+    { OPTION_PASSTHROUGH, ALIAS_PASSTHROUGH, NULL, passthrough_usage, 1, false, false }
 };
 
 const char UsageDefaultName[] = "vdb-copy";
@@ -164,6 +170,7 @@ rc_t CC Usage ( const Args * args ) {
     HelpOptionLine ( ALIAS_UNLOCK, OPTION_UNLOCK, NULL, unlock_usage );
     HelpOptionLine ( ALIAS_MD5_MODE, OPTION_MD5_MODE, NULL, md5mode_usage );
     HelpOptionLine ( ALIAS_BLOB_CHECKSUM, OPTION_BLOB_CHECKSUM, NULL, blcmode_usage );
+    HelpOptionLine ( ALIAS_PASSTHROUGH, OPTION_PASSTHROUGH, NULL, passthrough_usage );
 
     HelpOptionsStandard();
 
@@ -490,6 +497,31 @@ static rc_t vdb_copy_make_dst_table( const p_context ctx,
     return rc;
 }
 
+/* columns can only bypass the row-pipeline if every row of the source
+   ends up in the destination: no row-range and no row dropped or redacted
+   because of the filter-column */
+static rc_t vdb_copy_select_passthrough( const p_context ctx,
+                                         const VTable * src_table,
+                                         VTable * dst_table,
+                                         col_defs * columns,
+                                         bool all_rows ) {
+    rc_t rc = 0;
+    if ( ctx -> passthrough ) {
+        if ( -1 != columns -> filter_idx ) {
+            if ( !ctx -> ignore_reject || !ctx -> ignore_redact ) {
+                all_rows = false;
+            }
+        }
+        if ( all_rows ) {
+            rc = blob_pass_mark_columns( columns, src_table, dst_table, ctx -> show_matching );
+            DISP_RC( rc, "vdb_copy_select_passthrough:blob_pass_mark_columns() failed" );
+        } else {
+            LOGMSG( klogInfo, "passthrough disabled: not all rows are copied unchanged" );
+        }
+    }
+    return rc;
+}
+
 static rc_t vdb_copy_open_dest_table( const p_context ctx,
                                       const VTable * src_table,
                                       VTable * dst_table,
@@ -507,6 +539,10 @@ static rc_t vdb_copy_open_dest_table( const p_context ctx,
     DISP_RC( rc, "vdb_copy_open_dest_table:col_defs_mark_writable_columns() failed" );
     if ( 0 != rc ) return rc;
 
+    /* unchanged columns leave the row-pipeline, their blobs are copied later */
+    rc = vdb_copy_select_passthrough( ctx, src_table, dst_table, columns, !ctx -> rows_requested );
+    if ( 0 != rc ) return rc;
+
     /* make a writable cursor */
     rc = VTableCreateCursorWrite( dst_table, dst_cursor, kcmInsert );
     DISP_RC( rc, "vdb_copy_open_dest_table:VTableCreateCursorWrite(dst) failed" );
@@ -782,14 +818,17 @@ static rc_t vdb_copy_table2( const p_context ctx,
                                      &is_legacy, type_matcher );
     if ( 0 == rc ) {
         VCursor * dst_cursor;
+
+        /* this function does not fail, because it is ok to not find
+           filter-column, redactable types and excluded columns
+           ( done before the dst-cursor is made, to know which columns
+             can bypass the row-pipeline ) */
+        vdb_copy_find_filter_and_redact_columns( src_schema,
+                               columns, &(ctx->config), type_matcher );
+
         rc = vdb_copy_open_dest_table( ctx, src_table, dst_table, &dst_cursor, columns, 
                                        is_legacy );
         if ( 0 == rc ) {
-            /* this function does not fail, because it is ok to not find
-               filter-column, redactable types and excluded columns */
-            vdb_copy_find_filter_and_redact_columns( src_schema,
-                                   columns, &(ctx->config), type_matcher );
-
             rc = vdb_copy_row_loop( ctx, src_cursor, dst_cursor,
                                     columns, ctx->rvals );
 
@@ -797,6 +836,10 @@ static rc_t vdb_copy_table2( const p_context ctx,
                 rc_t rc1 = VCursorRelease( dst_cursor );
                 DISP_RC( rc1, "vdb_copy_table2:VCursorRelease() failed" );
             }
+            if ( 0 == rc && ctx -> passthrough ) {
+                rc = blob_pass_copy_columns( columns, src_table, dst_table, ctx -> show_matching );
+                DISP_RC( rc, "vdb_copy_table2:blob_pass_copy_columns() failed" );
+            }
             if ( 0 == rc && ctx -> reindex ) {
                 /* releasing the cursor is necessary for reindex */
                 rc = VTableReindex( dst_table );
@@ -859,6 +902,8 @@ static rc_t perform_vdb_copy_on_table( const p_context ctx,
 }
 
 static rc_t vdb_copy_cur_2_cur( const p_context ctx,
+                                const VTable * src_tab,
+                                VTable * dst_tab,
                                 const VCursor * src_cursor,
                                 VCursor * dst_cursor,
                                 const VSchema * schema,
@@ -867,6 +912,12 @@ static rc_t vdb_copy_cur_2_cur( const p_context ctx,
                                 const char * tab_name ) {
     rc_t rc = col_defs_apply_casts( columns, type_matcher );
     DISP_RC( rc, "vdb_copy_cur_2_cur:col_defs_apply_casts() failed" );
+    if ( 0 == rc && ctx -> passthrough ) {
+        /* the whole table is copied, the row-range is ignored here */
+        vdb_copy_find_filter_and_redact_columns( schema,
+                               columns, &(ctx->config), type_matcher );
+        rc = vdb_copy_select_passthrough( ctx, src_tab, dst_tab, columns, true );
+    }
     if ( 0 == rc ) {
         rc = col_defs_add_to_wr_cursor( columns, dst_cursor, false );
         DISP_RC( rc, "vdb_copy_cur_2_cur:col_defs_add_to_wr_cursor(dst) failed" );
@@ -950,7 +1001,7 @@ static rc_t vdb_copy_tab_2_tab( const p_context ctx,
                                     DISP_RC( rc, "vdb_copy_tab_2_tab:VTableCreateCursorWrite(dst) failed" );
                                     if ( 0 == rc ) {
                                         /*****************************************************/
-                                        rc = vdb_copy_cur_2_cur( ctx, src_cursor, dst_cursor,
+                                        rc = vdb_copy_cur_2_cur( ctx, src_tab, dst_tab, src_cursor, dst_cursor,
                                                                  schema, columns, type_matcher,
                                                                  tab_name );
                                         /*****************************************************/
@@ -959,6 +1010,10 @@ static rc_t vdb_copy_tab_2_tab( const p_context ctx,
                                         rc_t rc1 = VCursorRelease( dst_cursor );
                                         DISP_RC( rc1, "vdb_copy_tab_2_tab:VCursorRelease(dst) failed" );
                                     }
+                                    if ( 0 == rc && ctx -> passthrough ) {
+                                        rc = blob_pass_copy_columns( columns, src_tab, dst_tab, ctx -> show_matching );
+                                        DISP_RC( rc, "vdb_copy_tab_2_tab:blob_pass_copy_columns() failed" );
+                                    }
                                 }
                                 {
                                     rc_t rc1 = VCursorRelease( src_cursor );
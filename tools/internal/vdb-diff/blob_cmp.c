@@ -0,0 +1,328 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "blob_cmp.h"
+
+#include <klib/log.h>
+#include <klib/out.h>
+#include <kdb/table.h>
+#include <kdb/column.h>
+#include <vdb/cursor.h>
+#include <vdb/blob.h>
+
+#include <sysalloc.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct blob_cmp
+{
+    const KColumn * kcol[ 2 ];
+
+    /* the window of rows covered by the last pair of blobs */
+    int64_t first;
+    uint64_t count;
+    bool same;
+
+    /* raw bytes of the blobs, reused from blob to blob */
+    void * buf[ 2 ];
+    size_t buf_size[ 2 ];
+
+    uint64_t blobs_same;
+    uint64_t blobs_differ;
+} blob_cmp;
+
+
+void blob_cmp_destroy( struct blob_cmp * self )
+{
+    if ( self != NULL )
+    {
+        uint32_t i;
+        for ( i = 0; i < 2; ++i )
+        {
+            if ( self -> kcol[ i ] != NULL )
+                KColumnRelease( self -> kcol[ i ] );
+            free( self -> buf[ i ] );
+        }
+        free( self );
+    }
+}
+
+static rc_t blob_cmp_open_kcol( const VTable * tab, const char * name, const KColumn ** kcol )
+{
+    const KTable * ktab;
+    rc_t rc = VTableOpenKTableRead( tab, &ktab );
+    if ( rc == 0 )
+    {
+        rc = KTableOpenColumnRead( ktab, kcol, "%s", name );
+        KTableRelease( ktab );
+    }
+    return rc;
+}
+
+/* a column is a direct projection of its physical column if the cursor hands out
+   the blob of the physical column itself: no function sits between them,
+   the cells are then nothing but the decoded bytes of that physical blob */
+static bool blob_cmp_is_direct( const VTable * tab, const char * name )
+{
+    bool res = false;
+    const VCursor * curs;
+    rc_t rc = VTableCreateCursorRead( tab, &curs );
+    if ( rc == 0 )
+    {
+        uint32_t idx_col, idx_phys;
+        rc = VCursorAddColumn( curs, &idx_col, "%s", name );
+        if ( rc == 0 )
+            rc = VCursorAddColumn( curs, &idx_phys, ".%s", name );
+        if ( rc == 0 )
+            rc = VCursorOpen( curs );
+        if ( rc == 0 )
+        {
+            int64_t first;
+            uint64_t count;
+            rc = VCursorIdRange( curs, idx_col, &first, &count );
+            if ( rc == 0 && count > 0 )
+            {
+                const VBlob * blob_col;
+                rc = VCursorGetBlobDirect( curs, &blob_col, first, idx_col );
+                if ( rc == 0 )
+                {
+                    const VBlob * blob_phys;
+                    rc = VCursorGetBlobDirect( curs, &blob_phys, first, idx_phys );
+                    if ( rc == 0 )
+                    {
+                        res = ( blob_col == blob_phys );
+                        VBlobRelease( blob_phys );
+                    }
+                    VBlobRelease( blob_col );
+                }
+            }
+        }
+        VCursorRelease( curs );
+    }
+    return res;
+}
+
+/* the default type of the column has to be the same in both tables */
+static bool blob_cmp_same_type( const VTable * tab_1, const VTable * tab_2, const char * name )
+{
+    bool res = false;
+    uint32_t dflt_1, dflt_2;
+    KNamelist * types_1;
+    rc_t rc = VTableColumnDatatypes( tab_1, name, &dflt_1, &types_1 );
+    if ( rc == 0 )
+    {
+        KNamelist * types_2;
+        rc = VTableColumnDatatypes( tab_2, name, &dflt_2, &types_2 );
+        if ( rc == 0 )
+        {
+            const char * type_1;
+            const char * type_2;
+            rc = KNamelistGet( types_1, dflt_1, &type_1 );
+            if ( rc == 0 )
+                rc = KNamelistGet( types_2, dflt_2, &type_2 );
+            if ( rc == 0 )
+                res = ( strcmp( type_1, type_2 ) == 0 );
+            KNamelistRelease( types_2 );
+        }
+        KNamelistRelease( types_1 );
+    }
+    return res;
+}
+
+/* same bytes only mean same cells if both tables decode them the same way */
+static bool blob_cmp_same_schema( const VTable * tab_1, const VTable * tab_2 )
+{
+    char spec_1[ 1024 ];
+    char spec_2[ 1024 ];
+    rc_t rc = VTableTypespec( tab_1, spec_1, sizeof spec_1 );
+    if ( rc == 0 )
+        rc = VTableTypespec( tab_2, spec_2, sizeof spec_2 );
+    return ( rc == 0 && strcmp( spec_1, spec_2 ) == 0 );
+}
+
+static rc_t blob_cmp_make( struct blob_cmp ** self, const VTable * tab_1, const VTable * tab_2, const char * name )
+{
+    rc_t rc = 0;
+    blob_cmp * tmp;
+    *self = NULL;
+
+    /* a column that does not qualify is simply compared cell by cell */
+    if ( !blob_cmp_same_type( tab_1, tab_2, name ) ||
+         !blob_cmp_is_direct( tab_1, name ) ||
+         !blob_cmp_is_direct( tab_2, name ) )
+        return 0;
+
+    tmp = calloc( 1, sizeof( * tmp ) );
+    if ( tmp == NULL )
+        rc = RC( rcExe, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+    else
+    {
+        if ( blob_cmp_open_kcol( tab_1, name, &( tmp -> kcol[ 0 ] ) ) == 0 &&
+             blob_cmp_open_kcol( tab_2, name, &( tmp -> kcol[ 1 ] ) ) == 0 )
+            *self = tmp;
+        else
+            blob_cmp_destroy( tmp );
+    }
+    return rc;
+}
+
+rc_t blob_cmp_attach( col_defs * defs, const VTable * tab_1, const VTable * tab_2 )
+{
+    rc_t rc = 0;
+    uint32_t i;
+    uint32_t count = VectorLength( &( defs -> cols ) );
+    if ( !blob_cmp_same_schema( tab_1, tab_2 ) )
+        return 0;
+    for ( i = 0; i < count && rc == 0; ++i )
+    {
+        col_pair * pair = VectorGet( &( defs -> cols ), i );
+        if ( pair != NULL && pair -> blobs == NULL )
+        {
+            rc = blob_cmp_make( &( pair -> blobs ), tab_1, tab_2, pair -> name );
+            if ( rc != 0 )
+            {
+                LOGERR ( klogInt, rc, "blob_cmp_make() failed" );
+            }
+        }
+    }
+    return rc;
+}
+
+/* read the whole blob into self -> buf[ idx ] */
+static rc_t blob_cmp_read( blob_cmp * self, uint32_t idx, const KColumnBlob * blob, size_t * size )
+{
+    size_t num_read, remaining;
+    char dummy[ 8 ];
+    rc_t rc = KColumnBlobRead ( blob, 0, dummy, 0, &num_read, &remaining );
+    if ( rc == 0 )
+    {
+        size_t total = num_read + remaining;
+        if ( total > self -> buf_size[ idx ] )
+        {
+            void * p = realloc( self -> buf[ idx ], total );
+            if ( p == NULL )
+                return RC( rcExe, rcBlob, rcReading, rcMemory, rcExhausted );
+            self -> buf[ idx ] = p;
+            self -> buf_size[ idx ] = total;
+        }
+
+        *size = 0;
+        while ( rc == 0 && *size < total )
+        {
+            rc = KColumnBlobRead ( blob, *size, ( char * )self -> buf[ idx ] + *size,
+                                   total - *size, &num_read, &remaining );
+            if ( rc == 0 && num_read == 0 )
+                rc = RC( rcExe, rcBlob, rcReading, rcData, rcInsufficient );
+            *size += num_read;
+        }
+    }
+    return rc;
+}
+
+static bool blob_cmp_load( blob_cmp * self, int64_t row_id )
+{
+    const KColumnBlob * blob_1;
+    rc_t rc = KColumnOpenBlobRead( self -> kcol[ 0 ], &blob_1, row_id );
+    if ( rc == 0 )
+    {
+        const KColumnBlob * blob_2;
+        rc = KColumnOpenBlobRead( self -> kcol[ 1 ], &blob_2, row_id );
+        if ( rc == 0 )
+        {
+            int64_t first_1, first_2;
+            uint32_t count_1, count_2;
+            rc = KColumnBlobIdRange( blob_1, &first_1, &count_1 );
+            if ( rc == 0 )
+                rc = KColumnBlobIdRange( blob_2, &first_2, &count_2 );
+            if ( rc == 0 )
+            {
+                int64_t end_1 = first_1 + count_1;
+                int64_t end_2 = first_2 + count_2;
+
+                /* only the rows covered by both blobs are settled by this pair */
+                self -> first = first_1 > first_2 ? first_1 : first_2;
+                self -> count = ( end_1 < end_2 ? end_1 : end_2 ) - self -> first;
+                self -> same = false;
+
+                /* blobs cut differently can not be compared byte by byte */
+                if ( first_1 == first_2 && count_1 == count_2 )
+                {
+                    size_t size_1, size_2;
+                    rc = blob_cmp_read( self, 0, blob_1, &size_1 );
+                    if ( rc == 0 )
+                        rc = blob_cmp_read( self, 1, blob_2, &size_2 );
+                    if ( rc == 0 )
+                        self -> same = ( size_1 == size_2 &&
+                                         memcmp( self -> buf[ 0 ], self -> buf[ 1 ], size_1 ) == 0 );
+                }
+
+                if ( self -> same )
+                    self -> blobs_same++;
+                else
+                    self -> blobs_differ++;
+            }
+            KColumnBlobRelease( blob_2 );
+        }
+        KColumnBlobRelease( blob_1 );
+    }
+
+    if ( rc != 0 )
+    {
+        /* forget the window, this row will be decoded */
+        self -> count = 0;
+        return false;
+    }
+    return true;
+}
+
+bool blob_cmp_row_same( struct blob_cmp * self, int64_t row_id )
+{
+    if ( self == NULL )
+        return false;
+    if ( self -> count == 0 || row_id < self -> first || row_id >= self -> first + ( int64_t )self -> count )
+    {
+        if ( !blob_cmp_load( self, row_id ) )
+            return false;
+    }
+    return self -> same;
+}
+
+void blob_cmp_add_counts( struct blob_cmp * dst, const struct blob_cmp * src )
+{
+    if ( dst != NULL && src != NULL )
+    {
+        dst -> blobs_same += src -> blobs_same;
+        dst -> blobs_differ += src -> blobs_differ;
+    }
+}
+
+rc_t blob_cmp_report( const struct blob_cmp * self, const char * name )
+{
+    if ( self == NULL )
+        return KOutMsg( "%s: not a direct physical column of the same schema in both tables, all cells decoded\n", name );
+    return KOutMsg( "%s: %,lu blobs identical, %,lu blobs decoded\n",
+                    name, self -> blobs_same, self -> blobs_differ );
+}
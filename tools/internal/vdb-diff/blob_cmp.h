@@ -0,0 +1,74 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_blob_cmp_
+#define _h_blob_cmp_
+
+#include <klib/rc.h>
+#include <vdb/table.h>
+
+#include "coldefs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************************************************************
+blob-cmp compares the physical blobs of a column-pair,
+cells in blobs with identical bytes do not have to be decoded
+********************************************************************/
+struct blob_cmp;
+
+/*
+ * attach a blob-cmp to every pair that is a direct projection of a physical column
+ * with the same name and type in both tables, declared by the same schema-table,
+ * pairs without one are compared cell by cell as before
+*/
+rc_t blob_cmp_attach( col_defs * defs, const VTable * tab_1, const VTable * tab_2 );
+
+/*
+ * is the row inside a blob that is byte-for-byte the same in both tables?
+ * ( any error while reading the blobs answers false, to fall back to decoding )
+*/
+bool blob_cmp_row_same( struct blob_cmp * self, int64_t row_id );
+
+/*
+ * print how many blobs were identical / had to be decoded
+*/
+rc_t blob_cmp_report( const struct blob_cmp * self, const char * name );
+
+/*
+ * add the counters of src to dst ( to report on the blob-cmp's of several threads )
+*/
+void blob_cmp_add_counts( struct blob_cmp * dst, const struct blob_cmp * src );
+
+void blob_cmp_destroy( struct blob_cmp * self );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
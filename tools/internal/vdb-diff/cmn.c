@@ -25,16 +25,147 @@
 */
 
 #include "cmn.h"
+#include "blob_cmp.h"
 #include <klib/log.h>
 #include <klib/out.h>
+#include <klib/printf.h>
+
+#include <sysalloc.h>
+#include <stdlib.h>
+#include <string.h>
+
+void cmn_log_init( diff_log * log )
+{
+    memset( log, 0, sizeof( * log ) );
+}
+
+void cmn_log_release( diff_log * log )
+{
+    free( log -> text );
+    free( log -> rows );
+    cmn_log_init( log );
+}
+
+/* makes room for at least needed more bytes of text */
+static rc_t cmn_log_reserve( diff_log * log, size_t needed )
+{
+    if ( log -> text_len + needed > log -> text_size )
+    {
+        size_t new_size = ( log -> text_size == 0 ) ? 4096 : log -> text_size * 2;
+        char * tmp;
+        while ( new_size < log -> text_len + needed )
+            new_size *= 2;
+        tmp = realloc( log -> text, new_size );
+        if ( tmp == NULL )
+            return RC( rcExe, rcBuffer, rcWriting, rcMemory, rcExhausted );
+        log -> text = tmp;
+        log -> text_size = new_size;
+    }
+    return 0;
+}
+
+rc_t cmn_print( diff_log * log, const char * fmt, ... )
+{
+    rc_t rc = 0;
+    va_list args;
+
+    va_start( args, fmt );
+    if ( log == NULL )
+        rc = KOutVMsg( fmt, args );
+    else
+    {
+        /* format right into the log, a cell can be longer than any fixed buffer */
+        size_t needed = 256;
+        while ( ( rc = cmn_log_reserve( log, needed ) ) == 0 )
+        {
+            size_t avail = log -> text_size - log -> text_len;
+            size_t num_writ = 0;
+            va_list args_copy;
+
+            va_copy( args_copy, args );
+            rc = string_vprintf( log -> text + log -> text_len, avail, &num_writ, fmt, args_copy );
+            va_end( args_copy );
+            if ( rc == 0 )
+            {
+                log -> text_len += num_writ;
+                break;
+            }
+            if ( GetRCState( rc ) != rcInsufficient )
+                break;
+            /* num_writ is the size needed, if it is known */
+            needed = ( num_writ >= avail ) ? num_writ + 1 : avail * 2;
+        }
+    }
+    va_end( args );
+    return rc;
+}
+
+rc_t cmn_log_row( diff_log * log, uint32_t diffs )
+{
+    if ( log -> rows_len == log -> rows_size )
+    {
+        uint32_t new_size = ( log -> rows_size == 0 ) ? 16 : log -> rows_size * 2;
+        diff_row * tmp = realloc( log -> rows, new_size * sizeof( * tmp ) );
+        if ( tmp == NULL )
+            return RC( rcExe, rcBuffer, rcWriting, rcMemory, rcExhausted );
+        log -> rows = tmp;
+        log -> rows_size = new_size;
+    }
+    log -> rows[ log -> rows_len ] . text_end = log -> text_len;
+    log -> rows[ log -> rows_len ] . rows_checked = log -> rows_checked;
+    log -> rows[ log -> rows_len ] . diffs = diffs;
+    log -> rows_len++;
+    log -> diffs += diffs;
+    return 0;
+}
+
+rc_t cmn_log_flush( const diff_log * log, unsigned long int max_err, unsigned long int * diffs,
+                    uint64_t * rows_checked, uint64_t * rows_different )
+{
+    rc_t rc = 0;
+    size_t printed = 0;
+    uint32_t i;
+
+    for ( i = 0; i < log -> rows_len && rc == 0 && *diffs < max_err; ++i )
+    {
+        const diff_row * row = &( log -> rows[ i ] );
+        rc = KOutMsg( "%.*s", ( int )( row -> text_end - printed ), log -> text + printed );
+        printed = row -> text_end;
+        *diffs += row -> diffs;
+        ( *rows_different )++;
+    }
+
+    if ( i == log -> rows_len && *diffs < max_err )
+    {
+        /* everything was needed: the whole range has been checked */
+        if ( rc == 0 && printed < log -> text_len )
+            rc = KOutMsg( "%.*s", ( int )( log -> text_len - printed ), log -> text + printed );
+        *rows_checked += log -> rows_checked;
+    }
+    else if ( i > 0 )
+    {
+        /* a single thread would have stopped after this row */
+        *rows_checked += log -> rows[ i - 1 ] . rows_checked;
+    }
+    return rc;
+}
 
 rc_t cmn_diff_column( const col_pair * pair,
                       const VCursor * cur_1, const VCursor * cur_2,
-                      int64_t row_id,  bool * res )
+                      int64_t row_id,  bool * res, diff_log * log )
 {
     uint32_t elem_bits_1, boff_1, row_len_1;
     const void * base_1;
-    rc_t rc = VCursorCellDataDirect ( cur_1, row_id, pair->idx[ 0 ], 
+    rc_t rc;
+
+    /* identical physical blobs decode to identical cells */
+    if ( blob_cmp_row_same( pair -> blobs, row_id ) )
+    {
+        *res = true;
+        return 0;
+    }
+
+    rc = VCursorCellDataDirect ( cur_1, row_id, pair->idx[ 0 ], 
                                     &elem_bits_1, &base_1, &boff_1, &row_len_1 );
     if ( rc != 0 )
     {
@@ -61,21 +192,21 @@ rc_t cmn_diff_column( const col_pair * pair,
             if ( elem_bits_1 != elem_bits_2 )
             {
                 *res = false;
-                rc = KOutMsg( "%s[ %ld ].elem_bits %u != %u\n", pair->name, row_id, elem_bits_1, elem_bits_2 );
+                rc = cmn_print( log, "%s[ %ld ].elem_bits %u != %u\n", pair->name, row_id, elem_bits_1, elem_bits_2 );
             }
 
             if ( row_len_1 != row_len_2 )
             {
                 *res = false;
                 if ( rc == 0 )
-                    rc = KOutMsg( "%s[ %ld ].row_len %u != %u\n", pair->name, row_id, row_len_1, row_len_2 );
+                    rc = cmn_print( log, "%s[ %ld ].row_len %u != %u\n", pair->name, row_id, row_len_1, row_len_2 );
             }
 
             if ( boff_1 != 0 || boff_2 != 0 )
             {
                 *res = false;
                 if ( rc == 0 )
-                    rc = KOutMsg( "%s[ %ld ].bit_offset: %u, %u\n", pair->name, row_id, boff_1, boff_2 );
+                    rc = cmn_print( log, "%s[ %ld ].bit_offset: %u, %u\n", pair->name, row_id, boff_1, boff_2 );
             }
             
             if ( *res )
@@ -84,7 +215,7 @@ rc_t cmn_diff_column( const col_pair * pair,
                 if ( num_bits & 0x07 )
                 {
                     if ( rc == 0 )
-                        rc = KOutMsg( "%s[ %ld ].bits_total %% 8 = %u\n", pair->name, row_id, ( num_bits % 8 ) );
+                        rc = cmn_print( log, "%s[ %ld ].bits_total %% 8 = %u\n", pair->name, row_id, ( num_bits % 8 ) );
                 }
                 else
                 {
@@ -93,7 +224,7 @@ rc_t cmn_diff_column( const col_pair * pair,
                     if ( cmp != 0 )
                     {
                         if ( rc == 0 )
-                            rc = KOutMsg( "%s[ %ld ] differ\n", pair->name, row_id );
+                            rc = cmn_print( log, "%s[ %ld ] differ\n", pair->name, row_id );
                         *res = false;
                     }
                 }
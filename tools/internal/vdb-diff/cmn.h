@@ -37,9 +37,45 @@
 extern "C" {
 #endif
 
+/********************************************************************
+diff-log collects the output of a worker-thread, it is printed later
+in row/column order to give the same report as a single thread
+********************************************************************/
+typedef struct diff_row
+{
+    size_t text_end;            /* end of the output of this row in diff_log.text */
+    uint64_t rows_checked;      /* rows checked so far, including this one */
+    uint32_t diffs;             /* differing columns in this row */
+} diff_row;
+
+typedef struct diff_log
+{
+    char * text;
+    size_t text_len;
+    size_t text_size;
+    diff_row * rows;
+    uint32_t rows_len;
+    uint32_t rows_size;
+    uint64_t rows_checked;      /* all rows checked */
+    unsigned long int diffs;    /* sum of rows[].diffs */
+} diff_log;
+
+void cmn_log_init( diff_log * log );
+void cmn_log_release( diff_log * log );
+
+/* log == NULL prints directly via KOutMsg */
+rc_t cmn_print( diff_log * log, const char * fmt, ... );
+
+/* closes the output of a row with differences */
+rc_t cmn_log_row( diff_log * log, uint32_t diffs );
+
+/* prints the logged rows as long as *diffs < max_err, counts what was printed */
+rc_t cmn_log_flush( const diff_log * log, unsigned long int max_err, unsigned long int * diffs,
+                    uint64_t * rows_checked, uint64_t * rows_different );
+
 rc_t cmn_diff_column( const col_pair * pair,
                       const VCursor * cur_1, const VCursor * cur_2,
-                      int64_t row_id,  bool * res );
+                      int64_t row_id,  bool * res, diff_log * log );
 
 rc_t cmn_make_num_gen( const VCursor * cur_1, const VCursor * cur_2,
                        int idx_1, int idx_2,
@@ -30,9 +30,13 @@
 #include <klib/num-gen.h>
 #include <vdb/cursor.h>
 #include <klib/progressbar.h>
+#include <kproc/thread.h>
+#include <atomic32.h>
+#include <atomic64.h>
 
 #include "coldefs.h"
 #include "cmn.h"
+#include "blob_cmp.h"
 
 #include <sysalloc.h>
 #include <stdlib.h>
@@ -61,7 +65,7 @@ static rc_t cbc_diff_column_iter( const col_pair * pair, const VCursor * cur_1,
             bool col_equal = true;
 
             if ( pair != NULL )
-                rc = cmn_diff_column( pair, cur_1, cur_2, row_id,  &col_equal );
+                rc = cmn_diff_column( pair, cur_1, cur_2, row_id,  &col_equal, NULL );
 
             if ( !col_equal )
             {
@@ -83,6 +87,8 @@ static rc_t cbc_diff_column_iter( const col_pair * pair, const VCursor * cur_1,
 
     if ( rc == 0 )
         rc = KOutMsg( "\n%,lu rows checked, %,lu rows differ\n", rows_checked, rows_different );
+    if ( rc == 0 && dctx -> blobs && pair != NULL )
+        rc = blob_cmp_report( pair -> blobs, pair -> name );
 
     if ( progress != NULL ) destroy_progressbar( progress );
 	
@@ -146,8 +152,8 @@ static rc_t cbc_diff_column( col_pair * pair, const VCursor * cur_1, const VCurs
     return rc;
 }
 
-rc_t cbc_diff_columns( const col_defs * defs, const VTable * tab_1, const VTable * tab_2,
-                       const struct diff_ctx * dctx, const char * tablename, unsigned long int *diffs )
+static rc_t cbc_diff_columns_1( const col_defs * defs, const VTable * tab_1, const VTable * tab_2,
+                                const struct diff_ctx * dctx, const char * tablename, unsigned long int *diffs )
 {
     rc_t rc = 0;
     uint32_t i;
@@ -188,3 +194,260 @@ rc_t cbc_diff_columns( const col_defs * defs, const VTable * tab_1, const VTable
     }
     return rc;
 }
+
+
+/* ----------------------------------------------------------------------------------
+    --threads: the columns are handed out to worker-threads in order, each column
+    gets its own pair of cursors. The output of every column is collected and
+    printed in column-order, so the report is the same as the one of a single thread.
+   ---------------------------------------------------------------------------------- */
+
+typedef struct cbc_job
+{
+    col_pair * pair;
+    diff_log log;
+    atomic64_t diffs;           /* published for the columns after this one */
+    rc_t rc;                    /* the output stops after the first column that failed */
+    bool done;
+} cbc_job;
+
+typedef struct cbc_par
+{
+    const VTable * tab_1;
+    const VTable * tab_2;
+    const struct diff_ctx * dctx;
+    cbc_job * jobs;
+    uint32_t job_count;
+    atomic32_t next_job;
+} cbc_par;
+
+/* the columns before this one plus this one have found enough differences already */
+static bool cbc_enough_diffs( cbc_par * par, uint32_t idx, unsigned long int own )
+{
+    uint64_t sum = own;
+    uint32_t i;
+    for ( i = 0; i < idx && sum < par -> dctx -> max_err; ++i )
+        sum += atomic64_read( &( par -> jobs[ i ] . diffs ) );
+    return ( sum >= par -> dctx -> max_err );
+}
+
+static rc_t cbc_diff_job_iter( cbc_par * par, uint32_t idx, const VCursor * cur_1, const VCursor * cur_2,
+                               const struct num_gen_iter * iter )
+{
+    cbc_job * job = &( par -> jobs[ idx ] );
+    rc_t rc = 0;
+    int64_t row_id;
+
+    while ( rc == 0 && num_gen_iterator_next( iter, &row_id, &rc ) )
+    {
+        bool col_equal = true;
+
+        /* the columns before us may have made this one unnecessary */
+        if ( ( job -> log . rows_checked & 0x3FF ) == 0 &&
+             cbc_enough_diffs( par, idx, job -> log . diffs ) )
+            break;
+
+        if ( rc == 0 ) rc = Quitting();    /* to be able to cancel the loop by signal */
+        if ( rc == 0 )
+            rc = cmn_diff_column( job -> pair, cur_1, cur_2, row_id, &col_equal, &( job -> log ) );
+        job -> log . rows_checked++;
+
+        if ( !col_equal )
+        {
+            if ( rc == 0 ) rc = cmn_print( &( job -> log ), "\n" );
+            if ( rc == 0 ) rc = cmn_log_row( &( job -> log ), 1 );
+            atomic64_read_and_add( &( job -> diffs ), 1 );
+            if ( cbc_enough_diffs( par, idx, job -> log . diffs ) )
+                break;
+        }
+    }
+    return rc;
+}
+
+static rc_t cbc_diff_job( cbc_par * par, uint32_t idx )
+{
+    col_pair * pair = par -> jobs[ idx ] . pair;
+    const VCursor * cur_1;
+    const VCursor * cur_2;
+    rc_t rc = VTableCreateCursorRead( par -> tab_1, &cur_1 );
+    if ( rc != 0 )
+    {
+        LOGERR ( klogInt, rc, "VTableCreateCursorRead( acc #1 ) failed" );
+    }
+    else
+    {
+        rc = VTableCreateCursorRead( par -> tab_2, &cur_2 );
+        if ( rc != 0 )
+        {
+            LOGERR ( klogInt, rc, "VTableCreateCursorRead( acc #2 ) failed" );
+        }
+        else
+        {
+            rc = VCursorAddColumn( cur_1, &( pair -> idx[ 0 ] ), "%s", pair -> name );
+            if ( rc != 0 )
+            {
+                LOGERR ( klogInt, rc, "VCursorAddColumn( acc #1 ) failed" );
+            }
+            if ( rc == 0 )
+            {
+                rc = VCursorAddColumn( cur_2, &( pair -> idx[ 1 ] ), "%s", pair -> name );
+                if ( rc != 0 )
+                {
+                    LOGERR ( klogInt, rc, "VCursorAddColumn( acc #2 ) failed" );
+                }
+            }
+            if ( rc == 0 )
+            {
+                rc = VCursorOpen( cur_1 );
+                if ( rc != 0 )
+                {
+                    LOGERR ( klogInt, rc, "VCursorOpen( acc #1 ) failed" );
+                }
+            }
+            if ( rc == 0 )
+            {
+                rc = VCursorOpen( cur_2 );
+                if ( rc != 0 )
+                {
+                    LOGERR ( klogInt, rc, "VCursorOpen( acc #2 ) failed" );
+                }
+            }
+            if ( rc == 0 )
+            {
+                struct num_gen * rows_to_diff = NULL;
+                rc = cmn_make_num_gen( cur_1, cur_2, pair->idx[0], pair->idx[1], par -> dctx -> rows, &rows_to_diff );
+                if ( rc == 0 && rows_to_diff != NULL )
+                {
+                    const struct num_gen_iter * iter = NULL;
+                    rc = num_gen_iterator_make( rows_to_diff, &iter );
+                    if ( rc != 0 )
+                    {
+                        LOGERR ( klogInt, rc, "num_gen_iterator_make() failed" );
+                    }
+                    else if ( iter != NULL )
+                    {
+                        rc = cbc_diff_job_iter( par, idx, cur_1, cur_2, iter );
+                        num_gen_iterator_destroy( iter );
+                    }
+                    num_gen_destroy( rows_to_diff );
+                }
+            }
+            VCursorRelease( cur_2 );
+        }
+        VCursorRelease( cur_1 );
+    }
+    return rc;
+}
+
+static rc_t CC cbc_worker_thread( const KThread * self, void * data )
+{
+    cbc_par * par = data;
+    rc_t rc = 0;
+    while ( rc == 0 )
+    {
+        uint32_t idx = atomic32_read_and_add( &( par -> next_job ), 1 );
+        if ( idx >= par -> job_count )
+            break;
+        /* no need to start a column a single thread would not have reached */
+        if ( !cbc_enough_diffs( par, idx, 0 ) )
+            rc = cbc_diff_job( par, idx );
+        par -> jobs[ idx ] . rc = rc;
+        par -> jobs[ idx ] . done = true;
+    }
+    return rc;
+}
+
+static rc_t cbc_diff_columns_parallel( const col_defs * defs, const VTable * tab_1, const VTable * tab_2,
+                                       const struct diff_ctx * dctx, const char * tablename, unsigned long int *diffs )
+{
+    rc_t rc = 0;
+    uint32_t count = VectorLength( &( defs -> cols ) );
+    uint32_t thread_count = dctx -> threads;
+    KThread ** threads;
+    cbc_par par;
+    uint32_t i;
+
+    memset( &par, 0, sizeof par );
+    par . tab_1 = tab_1;
+    par . tab_2 = tab_2;
+    par . dctx = dctx;
+    atomic32_set( &par . next_job, 0 );
+
+    par . jobs = calloc( count, sizeof( par . jobs[ 0 ] ) );
+    threads = calloc( thread_count, sizeof( threads[ 0 ] ) );
+    if ( par . jobs == NULL || threads == NULL )
+        rc = RC( rcExe, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+    else
+    {
+        for ( i = 0; i < count; ++i )
+        {
+            col_pair * pair = VectorGet( &( defs -> cols ), i );
+            if ( pair != NULL )
+            {
+                cbc_job * job = &( par . jobs[ par . job_count++ ] );
+                job -> pair = pair;
+                cmn_log_init( &( job -> log ) );
+                atomic64_set( &( job -> diffs ), 0 );
+            }
+        }
+
+        for ( i = 0; i < thread_count && rc == 0; ++i )
+        {
+            rc = KThreadMake( &( threads[ i ] ), cbc_worker_thread, &par );
+            if ( rc != 0 )
+            {
+                LOGERR ( klogInt, rc, "KThreadMake() failed" );
+            }
+        }
+        for ( i = 0; i < thread_count; ++i )
+        {
+            if ( threads[ i ] != NULL )
+            {
+                rc_t rc_thread = 0;
+                KThreadWait( threads[ i ], &rc_thread );
+                if ( rc == 0 ) rc = rc_thread;
+                KThreadRelease( threads[ i ] );
+            }
+        }
+
+        /* print in column order, a single thread would have stopped at max_err,
+           or after the output of the column that failed */
+        {
+            rc_t rc_print = 0;
+            bool printing = true;
+            for ( i = 0; i < par . job_count; ++i )
+            {
+                cbc_job * job = &( par . jobs[ i ] );
+                printing = printing && job -> done && *diffs < dctx -> max_err;
+                if ( printing )
+                {
+                    uint64_t rows_checked = 0;
+                    uint64_t rows_different = 0;
+                    rc_print = KOutMsg( "comparing column '%s.%s'\n", tablename, job -> pair -> name );
+                    if ( rc_print == 0 )
+                        rc_print = cmn_log_flush( &( job -> log ), dctx -> max_err, diffs, &rows_checked, &rows_different );
+                    printing = ( rc_print == 0 && job -> rc == 0 );
+                    if ( printing )
+                        rc_print = KOutMsg( "\n%,lu rows checked, %,lu rows differ\n", rows_checked, rows_different );
+                    if ( rc_print == 0 && printing && dctx -> blobs )
+                        rc_print = blob_cmp_report( job -> pair -> blobs, job -> pair -> name );
+                    printing = printing && ( rc_print == 0 );
+                }
+                cmn_log_release( &( job -> log ) );
+            }
+            if ( rc == 0 ) rc = rc_print;
+        }
+    }
+    free( threads );
+    free( par . jobs );
+    return rc;
+}
+
+
+rc_t cbc_diff_columns( const col_defs * defs, const VTable * tab_1, const VTable * tab_2,
+                       const struct diff_ctx * dctx, const char * tablename, unsigned long int *diffs )
+{
+    if ( dctx -> threads > 1 )
+        return cbc_diff_columns_parallel( defs, tab_1, tab_2, dctx, tablename, diffs );
+    return cbc_diff_columns_1( defs, tab_1, tab_2, dctx, tablename, diffs );
+}
@@ -25,6 +25,7 @@
 */
 
 #include "coldefs.h"
+#include "blob_cmp.h"
 #include <klib/text.h>
 #include <klib/out.h>
 
@@ -54,6 +55,7 @@ static void CC col_defs_destroy_pair( void * node, void * data )
 			free( pair -> name );
 			pair -> name = NULL;
 		}
+		blob_cmp_destroy( pair -> blobs );
         free( pair );
     }
 }
@@ -164,6 +166,32 @@ rc_t col_defs_fill( col_defs * defs, const KNamelist * list )
 }
 
 
+/*
+ * make a new list with the same column-names ( for another thread )
+*/
+rc_t col_defs_clone( const col_defs * src, col_defs ** dst )
+{
+    rc_t rc = col_defs_init( dst );
+    if ( rc == 0 )
+    {
+        uint32_t i;
+        uint32_t count = VectorLength( &( src -> cols ) );
+        for ( i = 0; i < count && rc == 0; ++i )
+        {
+            const col_pair * pair = VectorGet( &( src -> cols ), i );
+            if ( pair != NULL )
+                rc = col_defs_append_col_pair( *dst, pair -> name );
+        }
+        if ( rc != 0 )
+        {
+            col_defs_destroy( *dst );
+            *dst = NULL;
+        }
+    }
+    return rc;
+}
+
+
 /*
  * how many columns do we have in here?
 */
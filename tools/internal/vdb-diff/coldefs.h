@@ -47,6 +47,7 @@ typedef struct col_pair
 {
     char * name;
 	uint32_t idx[ 2 ];		/* a pair of sub-col-defs */
+	struct blob_cmp * blobs;	/* physical blob compare, NULL if not used */
 } col_pair;
 
 
@@ -77,6 +78,12 @@ rc_t col_defs_destroy( col_defs * defs );
 rc_t col_defs_fill( col_defs * defs, const KNamelist * list );
 
 
+/*
+ * make a new list with the same column-names ( for another thread )
+*/
+rc_t col_defs_clone( const col_defs * src, col_defs ** dst );
+
+
 /*
  * how many columns do we have in here?
 */
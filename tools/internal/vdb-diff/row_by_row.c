@@ -30,9 +30,13 @@
 #include <klib/num-gen.h>
 #include <vdb/cursor.h>
 #include <klib/progressbar.h>
+#include <kproc/thread.h>
+#include <atomic32.h>
+#include <atomic64.h>
 
 #include "coldefs.h"
 #include "cmn.h"
+#include "blob_cmp.h"
 
 #include <sysalloc.h>
 #include <stdlib.h>
@@ -74,7 +78,7 @@ static rc_t rbr_diff_columns_iter( const col_defs * defs, const VCursor * cur_1,
 					if ( pair != NULL )
 					{
                         bool col_equal;
-                        rc = cmn_diff_column( pair, cur_1, cur_2, row_id,  &col_equal );
+                        rc = cmn_diff_column( pair, cur_1, cur_2, row_id,  &col_equal, NULL );
                         if ( !col_equal )
                         {
                             row_equal = false;
@@ -104,6 +108,17 @@ static rc_t rbr_diff_columns_iter( const col_defs * defs, const VCursor * cur_1,
 			rc = KOutMsg( "\n%,lu rows checked ( %d columns each ), %,lu rows differ\n",
 				rows_checked, column_count, rows_different );
 
+		if ( rc == 0 && dctx -> blobs )
+		{
+			uint32_t col_id;
+			for ( col_id = 0; col_id < column_count && rc == 0; ++col_id )
+			{
+				col_pair * pair = VectorGet( &( defs -> cols ), col_id );
+				if ( pair != NULL )
+					rc = blob_cmp_report( pair -> blobs, pair -> name );
+			}
+		}
+
 		if ( progress != NULL )
 			destroy_progressbar( progress );
 			
@@ -113,8 +128,8 @@ static rc_t rbr_diff_columns_iter( const col_defs * defs, const VCursor * cur_1,
 }
 
 
-rc_t rbr_diff_columns( col_defs * defs, const VTable * tab_1, const VTable * tab_2,
-                       const struct diff_ctx * dctx, unsigned long int *diffs )
+static rc_t rbr_diff_columns_1( col_defs * defs, const VTable * tab_1, const VTable * tab_2,
+                                const struct diff_ctx * dctx, unsigned long int *diffs )
 {
 	const VCursor * cur_1;
 	rc_t rc = VTableCreateCursorRead( tab_1, &cur_1 );
@@ -189,3 +204,377 @@ rc_t rbr_diff_columns( col_defs * defs, const VTable * tab_1, const VTable * tab
 	}
 	return rc;
 }
+
+
+/* ----------------------------------------------------------------------------------
+    --threads: the row-range is cut into shards, the worker-threads pick them up in
+    order, each worker has its own cursors and its own copy of the column-list.
+    The output of every shard is collected and printed in shard-order, so the
+    report is the same as the one of a single thread.
+   ---------------------------------------------------------------------------------- */
+
+#define RBR_SHARDS_PER_THREAD 4
+
+typedef struct rbr_shard
+{
+    int64_t first;
+    uint64_t count;
+    diff_log log;
+    atomic64_t diffs;           /* published for the shards after this one */
+    rc_t rc;                    /* the output stops after the first shard that failed */
+    bool done;
+} rbr_shard;
+
+typedef struct rbr_par
+{
+    const struct diff_ctx * dctx;
+    const struct num_gen * rows;
+    rbr_shard * shards;
+    uint32_t shard_count;
+    atomic32_t next_shard;
+} rbr_par;
+
+typedef struct rbr_worker
+{
+    rbr_par * par;
+    col_defs * defs;
+    const VCursor * cur_1;
+    const VCursor * cur_2;
+    KThread * thread;
+} rbr_worker;
+
+/* the shards before this one plus this one have found enough differences already */
+static bool rbr_enough_diffs( rbr_par * par, uint32_t idx, unsigned long int own )
+{
+    uint64_t sum = own;
+    uint32_t i;
+    for ( i = 0; i < idx && sum < par -> dctx -> max_err; ++i )
+        sum += atomic64_read( &( par -> shards[ i ] . diffs ) );
+    return ( sum >= par -> dctx -> max_err );
+}
+
+static rc_t rbr_diff_shard( rbr_worker * w, uint32_t idx )
+{
+    rbr_shard * shard = &( w -> par -> shards[ idx ] );
+    uint32_t column_count = VectorLength( &( w -> defs -> cols ) );
+    struct num_gen * rows = NULL;
+    rc_t rc = num_gen_copy( w -> par -> rows, &rows );
+    if ( rc != 0 )
+    {
+        LOGERR ( klogInt, rc, "num_gen_copy() failed" );
+    }
+    else
+    {
+        rc = num_gen_trim( rows, shard -> first, shard -> count );
+        if ( rc != 0 )
+        {
+            LOGERR ( klogInt, rc, "num_gen_trim() failed" );
+        }
+        else if ( !num_gen_empty( rows ) )
+        {
+            const struct num_gen_iter * iter = NULL;
+            rc = num_gen_iterator_make( rows, &iter );
+            if ( rc != 0 )
+            {
+                LOGERR ( klogInt, rc, "num_gen_iterator_make() failed" );
+            }
+            else if ( iter != NULL )
+            {
+                int64_t row_id;
+                while ( rc == 0 && num_gen_iterator_next( iter, &row_id, &rc ) )
+                {
+                    uint32_t row_diffs = 0;
+                    uint32_t col_id;
+
+                    /* the shards before us may have made this one unnecessary */
+                    if ( ( shard -> log . rows_checked & 0x3FF ) == 0 &&
+                         rbr_enough_diffs( w -> par, idx, shard -> log . diffs ) )
+                        break;
+
+                    if ( rc == 0 ) rc = Quitting();    /* to be able to cancel the loop by signal */
+                    for ( col_id = 0; col_id < column_count && rc == 0; ++col_id )
+                    {
+                        col_pair * pair = VectorGet( &( w -> defs -> cols ), col_id );
+                        if ( pair != NULL )
+                        {
+                            bool col_equal;
+                            rc = cmn_diff_column( pair, w -> cur_1, w -> cur_2, row_id, &col_equal, &( shard -> log ) );
+                            if ( !col_equal )
+                                row_diffs++;
+                        }
+                    }
+                    shard -> log . rows_checked++;
+
+                    if ( row_diffs > 0 )
+                    {
+                        if ( rc == 0 ) rc = cmn_print( &( shard -> log ), "\n" );
+                        if ( rc == 0 ) rc = cmn_log_row( &( shard -> log ), row_diffs );
+                        atomic64_read_and_add( &( shard -> diffs ), row_diffs );
+                        if ( rbr_enough_diffs( w -> par, idx, shard -> log . diffs ) )
+                            break;
+                    }
+                }
+                num_gen_iterator_destroy( iter );
+            }
+        }
+        num_gen_destroy( rows );
+    }
+    return rc;
+}
+
+static rc_t CC rbr_worker_thread( const KThread * self, void * data )
+{
+    rbr_worker * w = data;
+    rc_t rc = 0;
+    while ( rc == 0 )
+    {
+        uint32_t idx = atomic32_read_and_add( &( w -> par -> next_shard ), 1 );
+        if ( idx >= w -> par -> shard_count )
+            break;
+        rc = rbr_diff_shard( w, idx );
+        w -> par -> shards[ idx ] . rc = rc;
+        w -> par -> shards[ idx ] . done = true;
+    }
+    return rc;
+}
+
+static rc_t rbr_make_worker( rbr_worker * w, const col_defs * defs, const VTable * tab_1, const VTable * tab_2,
+                             const struct diff_ctx * dctx )
+{
+    rc_t rc = col_defs_clone( defs, &( w -> defs ) );
+    if ( rc != 0 )
+    {
+        LOGERR ( klogInt, rc, "col_defs_clone() failed" );
+    }
+    else if ( dctx -> blobs )
+    {
+        rc = blob_cmp_attach( w -> defs, tab_1, tab_2 );
+    }
+
+    if ( rc == 0 )
+    {
+        rc = VTableCreateCursorRead( tab_1, &( w -> cur_1 ) );
+        if ( rc != 0 )
+        {
+            LOGERR ( klogInt, rc, "VTableCreateCursorRead( acc #1 ) failed" );
+        }
+    }
+    if ( rc == 0 )
+    {
+        rc = VTableCreateCursorRead( tab_2, &( w -> cur_2 ) );
+        if ( rc != 0 )
+        {
+            LOGERR ( klogInt, rc, "VTableCreateCursorRead( acc #2 ) failed" );
+        }
+    }
+    if ( rc == 0 )
+    {
+        rc = col_defs_add_to_cursor( w -> defs, w -> cur_1, 0 );
+        if ( rc != 0 )
+        {
+            LOGERR ( klogInt, rc, "failed to add all requested columns to cursor of 1st accession" );
+        }
+    }
+    if ( rc == 0 )
+    {
+        rc = col_defs_add_to_cursor( w -> defs, w -> cur_2, 1 );
+        if ( rc != 0 )
+        {
+            LOGERR ( klogInt, rc, "failed to add all requested columns to cursor of 2nd accession" );
+        }
+    }
+    if ( rc == 0 )
+    {
+        rc = VCursorOpen( w -> cur_1 );
+        if ( rc != 0 )
+        {
+            LOGERR ( klogInt, rc, "VCursorOpen( acc #1 ) failed" );
+        }
+    }
+    if ( rc == 0 )
+    {
+        rc = VCursorOpen( w -> cur_2 );
+        if ( rc != 0 )
+        {
+            LOGERR ( klogInt, rc, "VCursorOpen( acc #2 ) failed" );
+        }
+    }
+    return rc;
+}
+
+static void rbr_release_worker( rbr_worker * w, col_defs * defs )
+{
+    if ( w -> defs != NULL )
+    {
+        /* collect the blob-counters for the report */
+        uint32_t i;
+        uint32_t count = VectorLength( &( defs -> cols ) );
+        for ( i = 0; i < count; ++i )
+        {
+            col_pair * pair = VectorGet( &( defs -> cols ), i );
+            const col_pair * mine = VectorGet( &( w -> defs -> cols ), i );
+            if ( pair != NULL && mine != NULL )
+                blob_cmp_add_counts( pair -> blobs, mine -> blobs );
+        }
+        col_defs_destroy( w -> defs );
+    }
+    if ( w -> cur_2 != NULL ) VCursorRelease( w -> cur_2 );
+    if ( w -> cur_1 != NULL ) VCursorRelease( w -> cur_1 );
+}
+
+/* cut the rows into shards of equal id-ranges */
+static rc_t rbr_make_shards( rbr_par * par, uint32_t shard_count )
+{
+    const struct num_gen_iter * iter = NULL;
+    rc_t rc = num_gen_iterator_make( par -> rows, &iter );
+    if ( rc != 0 )
+    {
+        LOGERR ( klogInt, rc, "num_gen_iterator_make() failed" );
+    }
+    else if ( iter != NULL )
+    {
+        int64_t first, last;
+        if ( num_gen_iterator_next( iter, &first, &rc ) )
+        {
+            rc = num_gen_iterator_max( iter, &last );
+            if ( rc != 0 )
+            {
+                LOGERR ( klogInt, rc, "num_gen_iterator_max() failed" );
+            }
+            else
+            {
+                uint64_t span = ( last >= first ) ? ( uint64_t )( last - first ) + 1 : 1;
+                uint64_t per_shard = ( span + shard_count - 1 ) / shard_count;
+                uint32_t i;
+
+                par -> shards = calloc( shard_count, sizeof( par -> shards[ 0 ] ) );
+                if ( par -> shards == NULL )
+                    rc = RC( rcExe, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+                else
+                {
+                    for ( i = 0; i < shard_count; ++i )
+                    {
+                        rbr_shard * shard = &( par -> shards[ i ] );
+                        uint64_t offset = per_shard * i;
+                        shard -> first = first + offset;
+                        shard -> count = ( offset >= span ) ? 0 : ( span - offset < per_shard ? span - offset : per_shard );
+                        cmn_log_init( &( shard -> log ) );
+                        atomic64_set( &( shard -> diffs ), 0 );
+                    }
+                    par -> shard_count = shard_count;
+                }
+            }
+        }
+        num_gen_iterator_destroy( iter );
+    }
+    return rc;
+}
+
+static rc_t rbr_diff_columns_parallel( col_defs * defs, const VTable * tab_1, const VTable * tab_2,
+                                       const struct diff_ctx * dctx, unsigned long int *diffs )
+{
+    rc_t rc = 0;
+    uint32_t column_count = VectorLength( &( defs -> cols ) );
+    uint32_t thread_count = dctx -> threads;
+    uint32_t i;
+    rbr_par par;
+    rbr_worker * workers = calloc( thread_count, sizeof( workers[ 0 ] ) );
+
+    if ( workers == NULL )
+        return RC( rcExe, rcNoTarg, rcConstructing, rcMemory, rcExhausted );
+
+    memset( &par, 0, sizeof par );
+    par . dctx = dctx;
+    atomic32_set( &par . next_shard, 0 );
+
+    for ( i = 0; i < thread_count && rc == 0; ++i )
+    {
+        workers[ i ] . par = &par;
+        rc = rbr_make_worker( &( workers[ i ] ), defs, tab_1, tab_2, dctx );
+    }
+
+    if ( rc == 0 )
+    {
+        struct num_gen * rows_to_diff = NULL;
+        rc = cmn_make_num_gen( workers[ 0 ] . cur_1, workers[ 0 ] . cur_2, 0, 0, dctx -> rows, &rows_to_diff );
+        if ( rc == 0 && rows_to_diff != NULL )
+        {
+            par . rows = rows_to_diff;
+            rc = rbr_make_shards( &par, thread_count * RBR_SHARDS_PER_THREAD );
+            if ( rc == 0 && par . shard_count > 0 )
+            {
+                uint64_t rows_checked = 0;
+                uint64_t rows_different = 0;
+
+                for ( i = 0; i < thread_count && rc == 0; ++i )
+                {
+                    rc = KThreadMake( &( workers[ i ] . thread ), rbr_worker_thread, &( workers[ i ] ) );
+                    if ( rc != 0 )
+                    {
+                        LOGERR ( klogInt, rc, "KThreadMake() failed" );
+                    }
+                }
+                for ( i = 0; i < thread_count; ++i )
+                {
+                    if ( workers[ i ] . thread != NULL )
+                    {
+                        rc_t rc_thread = 0;
+                        KThreadWait( workers[ i ] . thread, &rc_thread );
+                        if ( rc == 0 ) rc = rc_thread;
+                        KThreadRelease( workers[ i ] . thread );
+                    }
+                }
+
+                /* print in shard order, a single thread would have stopped at max_err,
+                   or after the output of the shard that failed */
+                {
+                    rc_t rc_print = 0;
+                    bool printing = true;
+                    for ( i = 0; i < par . shard_count; ++i )
+                    {
+                        rbr_shard * shard = &( par . shards[ i ] );
+                        printing = printing && shard -> done && *diffs < dctx -> max_err;
+                        if ( printing )
+                        {
+                            rc_print = cmn_log_flush( &( shard -> log ), dctx -> max_err, diffs,
+                                                      &rows_checked, &rows_different );
+                            printing = ( rc_print == 0 && shard -> rc == 0 );
+                        }
+                        cmn_log_release( &( shard -> log ) );
+                    }
+                    if ( rc == 0 ) rc = rc_print;
+                }
+
+                if ( rc == 0 )
+                    rc = KOutMsg( "\n%,lu rows checked ( %d columns each ), %,lu rows differ\n",
+                        rows_checked, column_count, rows_different );
+            }
+            free( par . shards );
+            num_gen_destroy( rows_to_diff );
+        }
+    }
+
+    for ( i = 0; i < thread_count; ++i )
+        rbr_release_worker( &( workers[ i ] ), defs );
+    free( workers );
+
+    if ( rc == 0 && dctx -> blobs )
+    {
+        for ( i = 0; i < column_count && rc == 0; ++i )
+        {
+            col_pair * pair = VectorGet( &( defs -> cols ), i );
+            if ( pair != NULL )
+                rc = blob_cmp_report( pair -> blobs, pair -> name );
+        }
+    }
+    return rc;
+}
+
+
+rc_t rbr_diff_columns( col_defs * defs, const VTable * tab_1, const VTable * tab_2,
+                       const struct diff_ctx * dctx, unsigned long int *diffs )
+{
+    if ( dctx -> threads > 1 )
+        return rbr_diff_columns_parallel( defs, tab_1, tab_2, dctx, diffs );
+    return rbr_diff_columns_1( defs, tab_1, tab_2, dctx, diffs );
+}
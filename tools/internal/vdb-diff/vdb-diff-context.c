@@ -54,6 +54,8 @@ void init_diff_ctx( struct diff_ctx * dctx )
 	dctx -> show_progress = false;
 	dctx -> intersect = false;
     dctx -> columnwise = false;
+    dctx -> blobs = false;
+    dctx -> threads = 1;
 }
 
 void release_diff_ctx( struct diff_ctx * dctx )
@@ -161,6 +163,9 @@ rc_t gather_diff_ctx( struct diff_ctx * dctx, Args * args )
 		dctx -> intersect = get_bool_option( args, OPTION_INTERSECT, false );
 		dctx -> max_err = get_uint32t_option( args, OPTION_MAXERR, 1 );
         dctx -> columnwise = get_bool_option( args, OPTION_COLUMNWISE, false );
+        dctx -> blobs = get_bool_option( args, OPTION_BLOBS, false );
+        dctx -> threads = get_uint32t_option( args, OPTION_THREADS, 1 );
+        if ( dctx -> threads == 0 ) dctx -> threads = 1;
     }
 
     return rc;
@@ -199,6 +204,10 @@ rc_t report_diff_ctx( struct diff_ctx * dctx )
 		rc = KOutMsg( "- max err : %u\n", dctx -> max_err );
 	if ( rc == 0 )
 		rc = KOutMsg( "- col-by-col: %s\n", dctx -> columnwise ? "yes" : "no" );
+	if ( rc == 0 )
+		rc = KOutMsg( "- blobs : %s\n", dctx -> blobs ? "yes" : "no" );
+	if ( rc == 0 )
+		rc = KOutMsg( "- threads : %u\n", dctx -> threads );
 
 	if ( rc == 0 )
 		rc = KOutMsg( "\n" );
@@ -45,6 +45,7 @@
 #include "vdb-diff-context.h"
 #include "row_by_row.h"
 #include "col_by_col.h"
+#include "blob_cmp.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -57,6 +58,8 @@ static const char * maxerr_usage[] = { "max errors im comparing (default = 1)",
 static const char * intersect_usage[] = { "intersect column-set from both runs", NULL };
 static const char * exclude_usage[] = { "exclude these columns from comapring", NULL };
 static const char * columnwise_usage[] = { "exclude these columns from comapring", NULL };
+static const char * blobs_usage[] = { "compare physical blobs first, decode only blobs that differ", NULL };
+static const char * threads_usage[] = { "number of threads: columns ( col-by-col ) or row-ranges are compared in parallel (default = 1)", NULL };
 
 OptDef MyOptions[] =
 {
@@ -67,7 +70,9 @@ OptDef MyOptions[] =
 	{ OPTION_MAXERR, 		ALIAS_MAXERR,		NULL, 	maxerr_usage,		1, 	true, 	false },
 	{ OPTION_INTERSECT,		ALIAS_INTERSECT,	NULL, 	intersect_usage,	1, 	false, 	false },
 	{ OPTION_EXCLUDE,		ALIAS_EXCLUDE,		NULL, 	exclude_usage,		1, 	true, 	false },
-    { OPTION_COLUMNWISE,    ALIAS_COLUMNWISE,   NULL,   columnwise_usage,   1,  false,  false }
+    { OPTION_COLUMNWISE,    ALIAS_COLUMNWISE,   NULL,   columnwise_usage,   1,  false,  false },
+    { OPTION_BLOBS,         ALIAS_BLOBS,        NULL,   blobs_usage,        1,  false,  false },
+    { OPTION_THREADS,       ALIAS_THREADS,      NULL,   threads_usage,      1,  true,   false }
 };
 
 const char UsageDefaultName[] = "vdb-diff";
@@ -106,6 +111,8 @@ rc_t CC Usage ( const Args * args )
 	HelpOptionLine ( ALIAS_INTERSECT, 	OPTION_INTERSECT,   NULL,			intersect_usage );
 	HelpOptionLine ( ALIAS_EXCLUDE, 	OPTION_EXCLUDE,   	"column-set",	exclude_usage );
 	HelpOptionLine ( ALIAS_COLUMNWISE, 	OPTION_COLUMNWISE, 	NULL,	        columnwise_usage );
+	HelpOptionLine ( ALIAS_BLOBS, 		OPTION_BLOBS, 		NULL,	        blobs_usage );
+	HelpOptionLine ( ALIAS_THREADS, 	OPTION_THREADS, 	"count",	    threads_usage );
 
     HelpOptionsStandard ();
     HelpVersion ( fullpath, KAppVersion() );
@@ -159,6 +166,8 @@ static rc_t perform_table_diff( const VTable * tab_1, const VTable * tab_2,
                 else
                 {
                     rc = col_defs_fill( defs, cols_to_diff );
+                    if ( rc == 0 && dctx -> blobs )
+                        rc = blob_cmp_attach( defs, tab_1, tab_2 );
                     if ( rc == 0 )
                     {
                         /* ******************************************* */
@@ -94,6 +94,7 @@ typedef struct globals
     uint32_t searchBatchSize;   ///< Max search batch size
     uint32_t numThreads;        ///< Max number of threads for batch search
     bool hasExtraLogging;       ///< Additional logging enabled
+    bool serialDecode;          ///< Decode records and compare them to the reference on the main thread
 
     size_t minBatchSize; ///< Minimum batch size for spot assembly
     uint32_t LOADER_MEM_LIMIT_GB; ///< Farm job memory limit in GB (via LOADER_MEM_LIMIT_GB env varirable)
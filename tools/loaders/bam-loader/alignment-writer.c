@@ -265,3 +265,22 @@ rc_t AlignmentRecordInit(AlignmentRecord *const self, unsigned const readlen)
     
     return 0;
 }
+
+void AlignmentRecordCopyCompressed(AlignmentRecord *const self, AlignmentRecord const *const src)
+{
+    unsigned const readlen = (unsigned)src->data.has_mismatch.elements;
+
+    assert(self->data.has_mismatch.elements == readlen);
+    memmove(self->buffer.base, src->buffer.base, LayoutStorage(0, readlen, 0, 0, 0, 0, 0));
+
+    self->data.ref_offset.elements = src->data.ref_offset.elements;
+    self->data.ref_offset_type.elements = src->data.ref_offset_type.elements;
+    self->data.mismatch.elements = src->data.mismatch.elements;
+    self->data.has_ref_offset.elements = src->data.has_ref_offset.elements;
+    self->data.has_mismatch.elements = src->data.has_mismatch.elements;
+    self->data.effective_offset = src->data.effective_offset;
+    self->data.ref_len = src->data.ref_len;
+
+    self->read_start = src->read_start;
+    self->read_len = src->read_len;
+}
@@ -98,4 +98,8 @@ rc_t AlignmentWhack(Alignment *self, bool commit);
 
 rc_t AlignmentRecordInit(AlignmentRecord *self, unsigned readlen);
 
+/* takes what ReferenceSeq_Compress filled into src, except the reference row ids,
+ * both records are initialized for the same read length */
+void AlignmentRecordCopyCompressed(AlignmentRecord *self, AlignmentRecord const *src);
+
 #endif
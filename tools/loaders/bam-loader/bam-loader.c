@@ -92,6 +92,7 @@ Debugging Options:
   only-verify                       exit after verifying existence of references
   max-rec-count <number>            exit after processing this many records (per file)
   nomatch-log <path>                log alignments with no matching bases
+  serial-decode                     decode records and compare them to the reference on the main thread
 
 Filtering Options:
   minimum-match <number>            minimum number of matches for an alignment
@@ -166,6 +167,7 @@ static char const option_threads[] = "threads";
 static char const option_extra_logging[] = "extra-logging";
 static char const option_min_batch_size[] = "min-batch-size";
 static char const option_telemetry[] = "telemetry";
+static char const option_serial_decode[] = "serial-decode";
 
 #define OPTION_INPUT option_input
 #define OPTION_OUTPUT option_output
@@ -196,6 +198,7 @@ static char const option_telemetry[] = "telemetry";
 #define OPTION_EXTRA_LOGGING option_extra_logging
 #define OPTION_MIN_BATCH_SIZE option_min_batch_size
 #define OPTION_TELEMETRY option_telemetry
+#define OPTION_SERIAL_DECODE option_serial_decode
 
 
 #define ALIAS_INPUT  "i"
@@ -312,6 +315,13 @@ char const * only_verify_usage[] =
     NULL
 };
 
+static
+char const * serial_decode_usage[] =
+{
+    "Decode records and compare them to the reference on the main thread (for debugging)",
+    NULL
+};
+
 static
 char const * use_QUAL_usage[] =
 {
@@ -523,6 +533,7 @@ OptDef Options[] =
     { OPTION_EXTRA_LOGGING, NULL, NULL, is_extra_logging, 1, false, false },
     { OPTION_MIN_BATCH_SIZE, NULL, NULL, min_batch_size_usage, 1, true,  false },
     { OPTION_TELEMETRY, NULL, NULL, number_of_threads, 1, true, false },
+    { OPTION_SERIAL_DECODE, NULL, NULL, serial_decode_usage, 1, false, false },
 };
 
 const char* OptHelpParam[] =
@@ -566,7 +577,8 @@ const char* OptHelpParam[] =
     NULL,				/* threads */
     NULL,				/* extra logging */
     "count",     	    /* min cache size */
-    "file-name"			/* telemetry file name */    
+    "file-name",		/* telemetry file name */
+    NULL				/* serial decode */
 };
 
 rc_t UsageSummary (char const * progname)
@@ -767,6 +779,7 @@ static rc_t main_1(int argc, char *argv[], bool const continuing, unsigned const
         uint32_t pcount;
 
         SET_FLAG(G.onlyVerifyReferences, option_only_verify);
+        SET_FLAG(G.serialDecode, option_serial_decode);
         SET_FLAG(G.noVerifyReferences, option_no_verify);
         SET_FLAG(G.useQUAL, option_use_qual);
         SET_FLAG(G.limit2config, option_ref_config);
@@ -1969,11 +1969,55 @@ static void BAM_FileReadSAM_SplitLine(char const *const line, unsigned const fie
     unsigned i = 0;
 
     while (fld < fields) {
-        if (line[i++] == '\0')
-            start[fld++] = i;
+        i += (unsigned)strlen(line + i) + 1;
+        start[fld++] = i;
     }
 }
 
+/* copies the buffered bytes up to and including the next line feed
+ * returns false if the buffer is empty or the bytes need SAMFileRead1,
+ * i.e. there is a put back character or a carriage return
+ */
+static bool BAM_FileReadSAM_CopyBuffered(SAMFile *const self, KDataBuffer *data, unsigned *const nread, unsigned *const fields, bool *const eol, rc_t *const rc)
+{
+    char const *const buf = (char const *)self->file.buf;
+    char const *const start = buf + self->file.bpos;
+    char const *const bend = buf + self->file.bmax;
+    char const *end;
+    size_t len;
+    char *dst;
+    char *tab;
+
+    if (self->putback != -1 || start == bend)
+        return false;
+
+    end = memchr(start, '\n', bend - start);
+    *eol = end != NULL;
+    end = end ? end + 1 : bend;
+    if (memchr(start, '\r', end - start) != NULL)
+        return false;
+
+    len = end - start;
+    if (*nread + len > data->elem_count) {
+        *rc = KDataBufferResize(data, (*nread + len) * 2);
+        if (*rc) return true;
+    }
+    dst = (char *)data->base + *nread;
+    memmove(dst, start, len);
+    self->file.bpos += len;
+    *nread += (unsigned)len;
+
+    for (tab = dst; (tab = memchr(tab, '\t', len - (tab - dst))) != NULL; ++tab) {
+        *tab = '\0';
+        ++*fields;
+    }
+    if (*eol) {
+        dst[len - 1] = '\0';
+        ++*fields;
+    }
+    return true;
+}
+
 static rc_t BAM_FileReadSAM_1(BAM_File *const self, KDataBuffer *data, KDataBuffer *starts)
 {
     rc_t rc = 0;
@@ -1981,20 +2025,31 @@ static rc_t BAM_FileReadSAM_1(BAM_File *const self, KDataBuffer *data, KDataBuff
     unsigned nread = 0;
     unsigned fields = 0;
 
-    while ((ch = SAMFileRead1(&self->file.sam)) >= 0) {
-        if (nread == data->elem_count) {
-            rc = KDataBufferResize(data, ((size_t)nread) * 2);
+    for ( ; ; ) {
+        bool eol = false;
+
+        if (BAM_FileReadSAM_CopyBuffered(&self->file.sam, data, &nread, &fields, &eol, &rc)) {
             if (rc) return rc;
+            if (!eol)
+                continue;
         }
-        ((char *)data->base)[nread] = ch;
-        nread += 1;
-        if (ch != '\t' && ch != '\n')
-            continue;
+        else {
+            if ((ch = SAMFileRead1(&self->file.sam)) < 0)
+                break;
+            if (nread == data->elem_count) {
+                rc = KDataBufferResize(data, ((size_t)nread) * 2);
+                if (rc) return rc;
+            }
+            ((char *)data->base)[nread] = ch;
+            nread += 1;
+            if (ch != '\t' && ch != '\n')
+                continue;
 
-        ++fields;
-        ((char *)data->base)[nread - 1] = '\0';
-        if (ch == '\t')
-            continue;
+            ++fields;
+            ((char *)data->base)[nread - 1] = '\0';
+            if (ch == '\t')
+                continue;
+        }
 
         KDataBufferResize(data, nread);
         rc = KDataBufferResize(starts, fields);
@@ -2034,7 +2089,12 @@ static rc_t BAM_FileReadSAM(BAM_File *const self, BAM_Alignment **const rslt)
             ctx.refSeqs = self->refSeqs;
             ctx.depth = 0;
 
-            parser = SAM2BAM_Parser_parse(data.base, offsets.elem_count, offsets.base, self->buffer, sizeof(self->buffer), BAM_FileRefNameIncrementalLookup, &ctx, &rc);
+            parser = SAM2BAM_Parser_parse_fast(data.base, offsets.elem_count, offsets.base, self->buffer, sizeof(self->buffer), BAM_FileRefNameIncrementalLookup, &ctx, &rc);
+            if (parser == NULL && rc == 0) {
+                /* not the common form; the full parser validates it */
+                ctx.depth = 0;
+                parser = SAM2BAM_Parser_parse(data.base, offsets.elem_count, offsets.base, self->buffer, sizeof(self->buffer), BAM_FileRefNameIncrementalLookup, &ctx, &rc);
+            }
         }
     }
     if (parser) {
@@ -247,6 +247,49 @@ struct queue_rec_t
     BAM_Alignment* alignment{nullptr};  ///< BAM Alignment
     metadata_t* metadata{nullptr};      ///< Pointer to metadata
     uint32_t row_id{0};                 ///< Corresponding metadata row
+    char const* seq{nullptr};           ///< Decoded sequence, nullptr if not decoded (CG records)
+    uint8_t const* qual{nullptr};       ///< Decoded quality, original quality (OQ) with offset removed unless G.useQUAL
+    rc_t qual_rc{0};                    ///< Error getting the quality
+    bool qual_oq{false};                ///< Quality came from OQ
+    uint32_t const* cigar{nullptr};     ///< CIGAR with hard clips converted (see ConvertHardClips), nullptr if not decoded
+    uint32_t cigar_count{0};            ///< Number of operations in cigar
+    int lpad{0};                        ///< Length of the left hard clip converted to soft clip
+    int rpad{0};                        ///< Length of the right hard clip converted to soft clip
+    bool hardclipped{false};            ///< Original CIGAR has hard clips
+    bool overhang_checked{false};       ///< cigar is already clipped at the reference end (see ClipOverhangingAlignment)
+    bool overhang_fixed{false};         ///< cigar was clipped at the reference end
+    uint8_t rna_orient{' '};            ///< RNA strand (XS tag)
+    AlignmentRecord const* compressed{nullptr}; ///< Compared to the reference by DecodeBatch, nullptr if not
+};
+
+/**
+ * @brief Batch of records passed from the bam_read thread to the main thread
+ *
+ * The records are decoded on the executor while the batch waits in the queue,
+ * the decoded sequences and qualities are kept in the batch buffer
+ */
+struct queue_batch_t
+{
+    vector<queue_rec_t> recs;           ///< Records in file order
+    vector<char> buffer;                ///< Decoded sequences and qualities
+    vector<uint32_t> cigars;            ///< Prepared CIGARs
+    vector<AlignmentRecord> compressed; ///< Alignments compared to the reference, indexed like recs
+    tf::Future<void> decoded;           ///< Ready when the records are decoded
+
+    ~queue_batch_t() {
+        for (auto& data : compressed)
+            KDataBufferWhack(&data.buffer);
+    }
+};
+
+/**
+ * @brief Reference reader of an executor worker, made on its first use
+ */
+struct worker_reference_t
+{
+    ReferenceReader reader{};           ///< See ReferenceReaderInit
+    bool tried{false};                  ///< ReferenceReaderInit was called
+    bool ok{false};                     ///< ReferenceReaderInit succeeded
 };
 
 struct context_t {
@@ -276,6 +319,8 @@ struct context_t {
     size_t m_estimatedBatchSize = 0;      ///< Estimated size of the search batch
     bool m_calcBatchSize = true;          ///< Flag to indicate whether the batch needs to be calculated
     unique_ptr<tf::Executor> m_executor;  ///< Taskflow executor
+    VDBManager const *m_vdb_mgr{nullptr}; ///< For the reference readers of the workers
+    vector<worker_reference_t> m_ref_readers; ///< Reference readers indexed by executor worker id
 #if defined(HAS_CTX_VALUE)
      MMArray *id2value;
 #endif
@@ -944,9 +989,20 @@ static rc_t SetupContext(context_t *ctx, unsigned numfiles)
     ctx->m_estimatedBatchSize = G.searchBatchSize;
     ctx->m_key_filter.reset(new fnv_murmur_filter);
     ctx->m_executor.reset(new tf::Executor(G.numThreads));
+    ctx->m_ref_readers.resize(ctx->m_executor->num_workers());
     return rc;
 }
 
+/* call when the executor is gone */
+static void ReleaseReferenceReaders(context_t *ctx)
+{
+    for (auto& ref : ctx->m_ref_readers) {
+        if (ref.ok)
+            ReferenceReaderWhack(&ref.reader);
+    }
+    ctx->m_ref_readers.clear();
+}
+
 static void ContextReleaseMemBank(context_t *ctx)
 {
     MemBankRelease(ctx->frags);
@@ -1560,9 +1616,42 @@ static bool isHardClipped(unsigned const ops, uint32_t const cigar[/* ops */])
     return false;
 }
 
-static rc_t FixOverhangingAlignment(KDataBuffer *cigBuf, uint32_t *opCount, uint32_t refPos, uint32_t refLen, uint32_t readlen)
+/**
+ * @brief Converts hard clips at the ends of the CIGAR to soft clips unless G.acceptHardClip
+ *
+ * @return true if the CIGAR has hard clips
+ */
+static bool ConvertHardClips(uint32_t cigar[], uint32_t const opCount, int *const lpad, int *const rpad)
+{
+    if (!isHardClipped(opCount, cigar))
+        return false;
+    if (!G.acceptHardClip) {
+        uint32_t const lOp = cigar[0];
+        uint32_t const rOp = cigar[opCount - 1];
+
+        *lpad = (lOp & 0xF) == 5 ? (lOp >> 4) : 0;
+        *rpad = (rOp & 0xF) == 5 ? (rOp >> 4) : 0;
+
+        if (*lpad != 0) {
+            uint32_t const new_lOp = (((uint32_t)*lpad) << 4) | 4;
+            cigar[0] = new_lOp;
+        }
+        if (*rpad != 0) {
+            uint32_t const new_rOp = (((uint32_t)*rpad) << 4) | 4;
+            cigar[opCount - 1] = new_rOp;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Soft clips the part of the alignment beyond the reference end
+ *
+ * cigar must have room for *opCount + 1 operations
+ * @return true if the alignment was clipped
+ */
+static bool ClipOverhangingAlignment(uint32_t cigar[], uint32_t *opCount, uint32_t refPos, uint32_t refLen, uint32_t readlen)
 {
-    uint32_t const *cigar = (uint32_t*)cigBuf->base;
     uint32_t refend = refPos;
     uint32_t seqpos = 0;
     uint32_t i;
@@ -1596,24 +1685,32 @@ static rc_t FixOverhangingAlignment(KDataBuffer *cigBuf, uint32_t *opCount, uint
             uint32_t const left = seqpos - chop;
             if (left * 2 > readlen) {
                 uint32_t const clip = readlen - left;
-                rc_t rc;
 
                 *opCount = i + 2;
-                rc = KDataBufferResize(cigBuf, *opCount);
-                if (rc) return rc;
-                ((uint32_t *)cigBuf->base)[i  ] = (newlen << 4) | code;
-                ((uint32_t *)cigBuf->base)[i+1] = (clip << 4) | 4;
-                OVERHANGING_ALIGNMENT;
-                break;
+                cigar[i  ] = (newlen << 4) | code;
+                cigar[i+1] = (clip << 4) | 4;
+                return true;
             }
         }
     }
+    return false;
+}
+
+static rc_t FixOverhangingAlignment(KDataBuffer *cigBuf, uint32_t *opCount, uint32_t refPos, uint32_t refLen, uint32_t readlen)
+{
+    rc_t const rc = KDataBufferResize(cigBuf, *opCount + 1);
+    if (rc) return rc;
+    if (ClipOverhangingAlignment((uint32_t *)cigBuf->base, opCount, refPos, refLen, readlen))
+        OVERHANGING_ALIGNMENT;
     return 0;
 }
 
 static context_t GlobalContext;
 #ifdef NEW_QUEUE
-static ReaderWriterQueue<queue_rec_t> rw_queue{1024};
+static constexpr size_t DECODE_BATCH_SIZE = 256;
+static ReaderWriterQueue<unique_ptr<queue_batch_t>> rw_queue{64};
+static unique_ptr<queue_batch_t> rw_batch;  ///< Batch being consumed by the main thread
+static size_t rw_batch_pos = 0;             ///< Next record in rw_batch
 atomic<bool> rw_done{false};
 #else
 static KQueue *bamq;
@@ -1633,11 +1730,184 @@ static rc_t BAM_FileReadDetached(BAM_File const *self, BAM_Alignment **rec)
     return rc;
 }
 
+#ifdef NEW_QUEUE
+/**
+ * @brief Reference reader of the calling executor worker
+ *
+ * @return nullptr if the reader cannot be made, the records are compared on the main thread then
+ */
+static ReferenceReader *WorkerReferenceReader()
+{
+    int const id = GlobalContext.m_executor->this_worker_id();
+    if (id < 0 || (size_t)id >= GlobalContext.m_ref_readers.size())
+        return nullptr;
+    auto& ref = GlobalContext.m_ref_readers[id];
+    if (!ref.tried) {
+        ref.tried = true;
+        ref.ok = ReferenceReaderInit(&ref.reader, GlobalContext.m_vdb_mgr) == 0;
+        if (!ref.ok)
+            spdlog::info("Worker {}: references are compared on the main thread", id);
+    }
+    return ref.ok ? &ref.reader : nullptr;
+}
+
+/**
+ * @brief Decodes sequences and qualities and prepares CIGARs of the batch records
+ *
+ * Only the records and the reference list of the BAM header are read, runs on the executor threads.
+ * The hard clips are converted and, unless secondary alignments are deferred and may get padded
+ * by the main thread, the aligned records overhanging the reference end are clipped and compared
+ * to the reference with the ReferenceReader of the worker. The main thread keeps the ordering and
+ * coverage state of the reference and the writes (see ReferenceReadCompressed)
+ */
+static void DecodeBatch(queue_batch_t *const batch, BAM_File const *const bam)
+{
+    size_t size = 0;
+    size_t cigar_size = 0;
+    for (auto& queue_rec : batch->recs) {
+        uint32_t readlen = 0;
+        uint32_t const *cigar;
+        uint32_t opCount;
+        rc_t const rc = BAM_AlignmentCGReadLength(queue_rec.alignment, &readlen);
+        if (rc == 0 || GetRCState(rc) != rcNotFound)
+            continue; /* CG records and errors are handled by the main thread */
+        BAM_AlignmentGetReadLength(queue_rec.alignment, &readlen);
+        BAM_AlignmentGetRawCigar(queue_rec.alignment, &cigar, &opCount);
+        size += 2 * readlen;
+        cigar_size += opCount + 1;
+    }
+    batch->buffer.resize(size);
+    batch->cigars.resize(cigar_size);
+    batch->compressed.resize(batch->recs.size());
+
+    ReferenceReader *const reader = G.deferSecondary ? nullptr : WorkerReferenceReader();
+    vector<char> padded;
+    char *dst = batch->buffer.data();
+    uint32_t *cigar = batch->cigars.data();
+    for (auto& queue_rec : batch->recs) {
+        BAM_Alignment const *const rec = queue_rec.alignment;
+        BAMRefSeq const *refSeq = NULL;
+        int64_t rpos = -1;
+        uint32_t readlen = 0;
+        rc_t const rc = BAM_AlignmentCGReadLength(rec, &readlen);
+        if (rc == 0 || GetRCState(rc) != rcNotFound)
+            continue;
+        BAM_AlignmentGetReadLength(rec, &readlen);
+        {
+            uint32_t *const rec_cigar = cigar;
+            uint32_t const *raw;
+            uint32_t opCount;
+
+            BAM_AlignmentGetRawCigar(rec, &raw, &opCount);
+            cigar += opCount + 1;
+            memmove(rec_cigar, raw, opCount * sizeof(uint32_t));
+            queue_rec.cigar = rec_cigar;
+            queue_rec.hardclipped = ConvertHardClips(rec_cigar, opCount, &queue_rec.lpad, &queue_rec.rpad);
+            if (!G.deferSecondary) {
+                uint16_t flags = 0;
+                int32_t refSeqId = -1;
+
+                BAM_AlignmentGetFlags(rec, &flags);
+                BAM_AlignmentGetPosition(rec, &rpos);
+                BAM_AlignmentGetRefSeqId(rec, &refSeqId);
+                BAM_FileGetRefSeqById(bam, refSeqId, &refSeq);
+                if ((flags & BAMFlags_SelfIsUnmapped) != 0)
+                    refSeq = NULL; /* not aligned, the main thread does not clip it */
+                if (rpos >= 0 && refSeq != NULL) {
+                    uint32_t const seqlen = readlen + queue_rec.lpad + queue_rec.rpad;
+                    queue_rec.overhang_fixed = ClipOverhangingAlignment(rec_cigar, &opCount, rpos, refSeq->length, seqlen);
+                    queue_rec.overhang_checked = true;
+                }
+            }
+            queue_rec.cigar_count = opCount;
+            BAM_AlignmentGetRNAStrand(rec, &queue_rec.rna_orient);
+        }
+
+        BAM_AlignmentGetSequence(rec, dst);
+        queue_rec.seq = dst;
+        dst += readlen;
+
+        uint8_t *const qual = (uint8_t *)dst;
+        uint8_t const *squal = NULL;
+        queue_rec.qual = qual;
+        dst += readlen;
+        if (G.useQUAL) {
+            BAM_AlignmentGetQuality(rec, &squal);
+            memmove(qual, squal, readlen);
+        }
+        else {
+            uint8_t qoffset = 0;
+
+            queue_rec.qual_rc = BAM_AlignmentGetQuality2(rec, &squal, &qoffset);
+            if (queue_rec.qual_rc)
+                continue;
+            if (qoffset) {
+                for (unsigned i = 0; i != readlen; ++i)
+                    qual[i] = squal[i] - qoffset;
+                queue_rec.qual_oq = true;
+            }
+            else
+                memmove(qual, squal, readlen);
+        }
+
+        if (reader != nullptr && queue_rec.overhang_checked && queue_rec.qual_rc == 0) {
+            /* the sequence as the main thread passes it to ReferenceRead: hard clips padded with N */
+            uint32_t const seqlen = readlen + queue_rec.lpad + queue_rec.rpad;
+            uint8_t const rna_orient = queue_rec.rna_orient;
+            int const intronType = rna_orient == '+' ? NCBI_align_ro_intron_plus :
+                                   rna_orient == '-' ? NCBI_align_ro_intron_minus :
+                                                       NCBI_align_ro_intron_unknown;
+            AlignmentRecord *const data = &batch->compressed[&queue_rec - batch->recs.data()];
+
+            padded.assign(seqlen, 'N');
+            memmove(padded.data() + queue_rec.lpad, queue_rec.seq, readlen);
+            if (AlignmentRecordInit(data, seqlen) == 0 &&
+                ReferenceReaderCompress(reader, data, refSeq->name, rpos,
+                                        queue_rec.cigar, queue_rec.cigar_count,
+                                        padded.data(), seqlen, intronType) == 0)
+            {
+                queue_rec.compressed = data;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Releases the records of rw_batch not yet returned by getNextRecord
+ */
+static void ReleaseRemainingRecords()
+{
+    if (!rw_batch)
+        return;
+    for ( ; rw_batch_pos < rw_batch->recs.size(); ++rw_batch_pos)
+        BAM_AlignmentRelease(rw_batch->recs[rw_batch_pos].alignment);
+    rw_batch.reset();
+    rw_batch_pos = 0;
+}
+
+static void PushBatch(unique_ptr<queue_batch_t>& batch, BAM_File const *const bam)
+{
+    auto const ptr = batch.get();
+    batch->decoded = GlobalContext.m_executor->async([ptr, bam]() {
+        if (!G.serialDecode)
+            DecodeBatch(ptr, bam);
+    });
+    while (!rw_queue.try_enqueue(std::move(batch))) {
+        if (rw_done)
+            break;
+        std::this_thread::yield();
+    }
+}
+#endif
+
 static rc_t run_bamread_thread(const KThread *self, void *const file)
 {
     rc_t rc = 0;
     size_t NR = 0;
     auto bam = (const BAM_File*)file;
+#ifdef NEW_QUEUE
+    unique_ptr<queue_batch_t> batch;
+#endif
     while (rc == 0) {
         if (rw_done)
             break;
@@ -1681,27 +1951,37 @@ static rc_t run_bamread_thread(const KThread *self, void *const file)
             if (rc) break;
         }
 
-        for ( ; ; ) {
 #ifdef NEW_QUEUE
-            if (rw_queue.try_enqueue(std::move(queue_rec))) {
-                break;
-            }
-            if (rw_done)
-                break;
-            std::this_thread::yield();    
+        if (!batch) {
+            batch.reset(new queue_batch_t);
+            batch->recs.reserve(DECODE_BATCH_SIZE);
+        }
+        batch->recs.push_back(queue_rec);
+        if (batch->recs.size() == DECODE_BATCH_SIZE)
+            PushBatch(batch, bam);
 #else
+        for ( ; ; ) {
             timeout_t tm;
             TimeoutInit(&tm, 1000);
             rc = KQueuePush(bamq, queue_rec, &tm);
             if (rc == 0 || (int)GetRCObject(rc) != rcTimeout)
                 break;
-#endif
         }
+#endif
     }
 
 #ifndef NEW_QUEUE
     KQueueSeal(bamq);
 #else
+    if (batch && !batch->recs.empty() && !batch->decoded.valid())
+        PushBatch(batch, bam);
+    if (batch) {
+        /* not queued: the main thread stopped reading */
+        if (batch->decoded.valid())
+            batch->decoded.wait();
+        for (auto& queue_rec : batch->recs)
+            BAM_AlignmentRelease(queue_rec.alignment);
+    }
     rw_done.store(true);
 #endif
     if (rc) {
@@ -1742,12 +2022,24 @@ static queue_rec_t* const getNextRecord(BAM_File const *const bam, rc_t *const r
     while (*rc == 0 && (*rc = Quitting()) == 0) {
         //BAM_Alignment const *rec = NULL;
 #ifdef NEW_QUEUE
-        if (rw_queue.try_dequeue(queue_rec)) {
+        if (rw_batch && rw_batch_pos < rw_batch->recs.size()) {
             ++dequeued;
-            return queue_rec;
+            return rw_batch->recs[rw_batch_pos++];
         }
-        if (rw_done.load())
+        rw_batch.reset();
+        rw_batch_pos = 0;
+        if (rw_queue.try_dequeue(rw_batch)) {
+            rw_batch->decoded.wait();
+            continue;
+        }
+        if (rw_done.load()) {
+            /* the last batch may have been queued just before rw_done was set */
+            if (rw_queue.try_dequeue(rw_batch)) {
+                rw_batch->decoded.wait();
+                continue;
+            }
             break;
+        }
         std::this_thread::yield();
 #else
         timeout_t tm;
@@ -1768,6 +2060,9 @@ static queue_rec_t* const getNextRecord(BAM_File const *const bam, rc_t *const r
 #endif
     }
     spdlog::info("Dequeued: {:L}", dequeued);
+#ifdef NEW_QUEUE
+    ReleaseRemainingRecords();
+#endif
     rw_done = true;
     {
         rc_t rc2 = 0;
@@ -2241,7 +2536,15 @@ MIXED_BASE_AND_COLOR:
 
             /* resize buffers */
             BAM_AlignmentGetReadLength(rec, &readlen);
-            BAM_AlignmentGetRawCigar(rec, &tmp, &opCount);
+#ifdef NEW_QUEUE
+            if (queue_rec.cigar != nullptr) {
+                /* prepared by DecodeBatch */
+                tmp = queue_rec.cigar;
+                opCount = queue_rec.cigar_count;
+            }
+            else
+#endif
+                BAM_AlignmentGetRawCigar(rec, &tmp, &opCount);
             rc = KDataBufferResize(&cigBuf, opCount);
             assert(rc == 0);
             if (rc) {
@@ -2251,7 +2554,15 @@ MIXED_BASE_AND_COLOR:
             }
             memmove(cigBuf.base, tmp, opCount * sizeof(uint32_t));
 
-            hardclipped = isHardClipped(opCount, (const uint32_t*)cigBuf.base);
+#ifdef NEW_QUEUE
+            if (queue_rec.cigar != nullptr) {
+                hardclipped = queue_rec.hardclipped;
+                lpad = queue_rec.lpad;
+                rpad = queue_rec.rpad;
+            }
+            else
+#endif
+                hardclipped = ConvertHardClips((uint32_t*)cigBuf.base, opCount, &lpad, &rpad);
             if (hardclipped) {
                 if (isPrimary && !wasPromoted) {
                     /* when we promote a secondary to primary and it is hardclipped, we want to "fix" it */
@@ -2262,28 +2573,11 @@ MIXED_BASE_AND_COLOR:
                         goto LOOP_END;
                     }
                 }
-                else if (!G.acceptHardClip) { /* convert to soft clip */
-                    uint32_t *const cigar = (uint32_t*)cigBuf.base;
-                    uint32_t const lOp = cigar[0];
-                    uint32_t const rOp = cigar[opCount - 1];
-
-                    lpad = (lOp & 0xF) == 5 ? (lOp >> 4) : 0;
-                    rpad = (rOp & 0xF) == 5 ? (rOp >> 4) : 0;
-
-                    if (lpad + rpad == 0) {
-                        // FATAL ERROR, DATA ERROR
-                        rc = RC(rcApp, rcFile, rcReading, rcData, rcInvalid);
-                        (void)PLOGERR(klogErr, (klogErr, rc, "File '$(file)' contains invalid CIGAR", "file=%s", bamFile));
-                        goto LOOP_END;
-                    }
-                    if (lpad != 0) {
-                        uint32_t const new_lOp = (((uint32_t)lpad) << 4) | 4;
-                        cigar[0] = new_lOp;
-                    }
-                    if (rpad != 0) {
-                        uint32_t const new_rOp = (((uint32_t)rpad) << 4) | 4;
-                        cigar[opCount - 1] = new_rOp;
-                    }
+                else if (!G.acceptHardClip && lpad + rpad == 0) {
+                    // FATAL ERROR, DATA ERROR
+                    rc = RC(rcApp, rcFile, rcReading, rcData, rcInvalid);
+                    (void)PLOGERR(klogErr, (klogErr, rc, "File '$(file)' contains invalid CIGAR", "file=%s", bamFile));
+                    goto LOOP_END;
                 }
             }
 
@@ -2347,31 +2641,49 @@ MIXED_BASE_AND_COLOR:
             memset(seqDNA, 'N', (readlen | csSeqLen) + lpad + rpad);
             memset(qual, 0, (readlen | csSeqLen) + lpad + rpad);
 
-            BAM_AlignmentGetSequence(rec, seqDNA + lpad);
-            if (G.useQUAL) {
-                uint8_t const *squal;
-
-                BAM_AlignmentGetQuality(rec, &squal);
-                memmove(qual + lpad, squal, readlen);
-            }
-            else {
-                uint8_t const *squal;
-                uint8_t qoffset = 0;
-                unsigned i;
-
-                rc = BAM_AlignmentGetQuality2(rec, &squal, &qoffset);
+#ifdef NEW_QUEUE
+            if (queue_rec.seq != nullptr) {
+                /* decoded by DecodeBatch */
+                memmove(seqDNA + lpad, queue_rec.seq, readlen);
+                rc = queue_rec.qual_rc;
                 if (rc) {
                     // FATAL ERROR; DATA INCONSISTENT
                     (void)PLOGERR(klogErr, (klogErr, rc, "Spot '$(name)': length of original quality does not match sequence", "name=%s", name));
                     goto LOOP_END;
                 }
-                if (qoffset) {
-                    for (i = 0; i != readlen; ++i)
-                        qual[i + lpad] = squal[i] - qoffset;
+                memmove(qual + lpad, queue_rec.qual, readlen);
+                if (queue_rec.qual_oq)
                     QUAL_CHANGED_OQ;
-                }
-                else
+            }
+            else
+#endif
+            {
+                BAM_AlignmentGetSequence(rec, seqDNA + lpad);
+                if (G.useQUAL) {
+                    uint8_t const *squal;
+
+                    BAM_AlignmentGetQuality(rec, &squal);
                     memmove(qual + lpad, squal, readlen);
+                }
+                else {
+                    uint8_t const *squal;
+                    uint8_t qoffset = 0;
+                    unsigned i;
+
+                    rc = BAM_AlignmentGetQuality2(rec, &squal, &qoffset);
+                    if (rc) {
+                        // FATAL ERROR; DATA INCONSISTENT
+                        (void)PLOGERR(klogErr, (klogErr, rc, "Spot '$(name)': length of original quality does not match sequence", "name=%s", name));
+                        goto LOOP_END;
+                    }
+                    if (qoffset) {
+                        for (i = 0; i != readlen; ++i)
+                            qual[i + lpad] = squal[i] - qoffset;
+                        QUAL_CHANGED_OQ;
+                    }
+                    else
+                        memmove(qual + lpad, squal, readlen);
+                }
             }
             readlen = readlen + lpad + rpad;
             data.data.align_group.elements = 0;
@@ -2691,13 +3003,35 @@ MIXED_BASE_AND_COLOR:
             uint32_t misses = 0;
             uint8_t rna_orient = ' ';
 
-            FixOverhangingAlignment(&cigBuf, &opCount, rpos, refSeq->length, readlen);
-            BAM_AlignmentGetRNAStrand(rec, &rna_orient);
+#ifdef NEW_QUEUE
+            if (queue_rec.overhang_checked) {
+                /* clipped by DecodeBatch */
+                if (queue_rec.overhang_fixed)
+                    OVERHANGING_ALIGNMENT;
+            }
+            else
+#endif
+                FixOverhangingAlignment(&cigBuf, &opCount, rpos, refSeq->length, readlen);
+#ifdef NEW_QUEUE
+            if (queue_rec.cigar != nullptr)
+                rna_orient = queue_rec.rna_orient;
+            else
+#endif
+                BAM_AlignmentGetRNAStrand(rec, &rna_orient);
             {
                 int const intronType = rna_orient == '+' ? NCBI_align_ro_intron_plus :
                                        rna_orient == '-' ? NCBI_align_ro_intron_minus :
                                                    hasCG ? NCBI_align_ro_complete_genomics :
                                                            NCBI_align_ro_intron_unknown;
+#ifdef NEW_QUEUE
+                if (queue_rec.compressed != nullptr && queue_rec.overhang_checked && !hasCG &&
+                    AR_BASECOUNT(*queue_rec.compressed) == readlen)
+                {
+                    /* compared by DecodeBatch */
+                    rc = ReferenceReadCompressed(ref, &data, rpos, queue_rec.compressed, readlen, &matches, &misses);
+                }
+                else
+#endif
                 rc = ReferenceRead(ref, &data, rpos, (const uint32_t*)cigBuf.base, opCount, seqDNA, readlen, intronType, &matches, &misses);
             }
             if (rc == 0) {
@@ -3405,11 +3739,14 @@ WRITE_ALIGNMENT:
 #else
     rw_done.store(true);
     KThreadWait(bamread_thread, NULL);
+    ReleaseRemainingRecords();
     {
-        queue_rec_t queue_rec;
-        while (rw_queue.try_dequeue(queue_rec)) {
+        unique_ptr<queue_batch_t> batch;
+        while (rw_queue.try_dequeue(batch)) {
             //spdlog::info("There still recs, dude!");
-            BAM_AlignmentRelease(queue_rec.alignment);
+            batch->decoded.wait();
+            for (auto& queue_rec : batch->recs)
+                BAM_AlignmentRelease(queue_rec.alignment);
         }
     }
 
@@ -4182,6 +4519,7 @@ static rc_t ArchiveBAM(VDBManager *mgr, VDatabase *db,
     rc = ReferenceInit(&ref, mgr, db);
     if (rc)
         return rc;
+    ctx->m_vdb_mgr = mgr;
 
     if (G.onlyVerifyReferences) {
         for (i = 0; i < bamFiles && rc == 0; ++i) {
@@ -4301,6 +4639,7 @@ static rc_t ArchiveBAM(VDBManager *mgr, VDatabase *db,
     }
     ctx->m_read_groups.clear();
     ctx->m_executor.reset(nullptr);
+    ReleaseReferenceReaders(ctx);
 
     rc2 = AlignmentWhack(align, *has_alignments && rc == 0 && (rc = Quitting()) == 0);
     if (rc == 0)
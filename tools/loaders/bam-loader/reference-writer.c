@@ -27,6 +27,7 @@
 #include <klib/rc.h>
 #include <klib/log.h>
 #include <kfs/file.h>
+#include <kfs/directory.h>
 
 #include <kapp/main.h> /* for Quitting */
 
@@ -57,6 +58,12 @@
 #define UNSORTED_CACHE_SIZE (350 * 1024 * 1024)
 #endif
 
+/* a ReferenceReader keeps only a window of the reference it compares against */
+#define READER_OPEN_TABLE_LIMIT (2)
+#define READER_CACHE_SIZE (32 * 1024 * 1024)
+/* every ReferenceReader loads the fasta files: above this size they are compared on the main thread */
+#define READER_MAX_FASTA_SIZE (256 * 1024 * 1024)
+
 #if _DEBUGGING
 #define DUMP_CONFIG 1
 #endif
@@ -522,25 +529,13 @@ static void GetCounts(AlignmentRecord const *data, unsigned const seqLen,
     *nIndels = insert + delete;
 }
 
-rc_t ReferenceRead(Reference *self, AlignmentRecord *data, uint64_t const pos,
-                   uint32_t const rawCigar[], uint32_t const cigCount,
-                   char const seqDNA[], uint32_t const seqLen,
-                   uint8_t rna_orient, uint32_t *matches, uint32_t *misses)
+static rc_t ReferenceAccount(Reference *self, AlignmentRecord const *data, uint64_t const pos,
+                             uint32_t const seqLen, uint32_t *matches, uint32_t *misses)
 {
     unsigned nmis = 0;
     unsigned nmatch = 0;
     unsigned indels = 0;
     rc_t rc = 0;
-       
-    *matches = 0;
-    BAIL_ON_FAIL(ReferenceSeq_Compress(self->rseq,
-                                       (G.acceptHardClip ? ewrefmgr_co_AcceptHardClip : 0) + ewrefmgr_cmp_Binary,
-                                       (INSDC_coord_len)pos,
-                                       seqDNA, seqLen,
-                                       rawCigar, cigCount,
-                                       0, NULL, 0, 0, NULL, 0,
-                                       rna_orient,
-                                       &data->data));
 
     GetCounts(data, seqLen, &nmatch, &nmis, &indels);
     *matches = nmatch;
@@ -559,6 +554,37 @@ rc_t ReferenceRead(Reference *self, AlignmentRecord *data, uint64_t const pos,
     return rc;
 }
 
+rc_t ReferenceRead(Reference *self, AlignmentRecord *data, uint64_t const pos,
+                   uint32_t const rawCigar[], uint32_t const cigCount,
+                   char const seqDNA[], uint32_t const seqLen,
+                   uint8_t rna_orient, uint32_t *matches, uint32_t *misses)
+{
+    *matches = 0;
+    BAIL_ON_FAIL(ReferenceSeq_Compress(self->rseq,
+                                       (G.acceptHardClip ? ewrefmgr_co_AcceptHardClip : 0) + ewrefmgr_cmp_Binary,
+                                       (INSDC_coord_len)pos,
+                                       seqDNA, seqLen,
+                                       rawCigar, cigCount,
+                                       0, NULL, 0, 0, NULL, 0,
+                                       rna_orient,
+                                       &data->data));
+
+    return ReferenceAccount(self, data, pos, seqLen, matches, misses);
+}
+
+rc_t ReferenceReadCompressed(Reference *self, AlignmentRecord *data, uint64_t const pos,
+                             AlignmentRecord const *compressed, uint32_t const seqLen,
+                             uint32_t *matches, uint32_t *misses)
+{
+    *matches = 0;
+    AlignmentRecordCopyCompressed(data, compressed);
+    /* the rows of the reader are numbered in its own order of references */
+    BAIL_ON_FAIL(ReferenceSeq_TranslateOffset_int(self->rseq, data->data.effective_offset,
+                                                  &data->ref_id, &data->ref_start,
+                                                  &data->global_ref_start));
+    return ReferenceAccount(self, data, pos, seqLen, matches, misses);
+}
+
 static rc_t IdVecAppend(KDataBuffer *vec, uint64_t id)
 {
     uint64_t const end = vec->elem_count;
@@ -613,3 +639,92 @@ rc_t ReferenceWhack(Reference *self, bool commit)
     }
     return rc;
 }
+
+static uint64_t FastaFilesSize(void)
+{
+    uint64_t total = 0;
+    KDirectory *dir = NULL;
+    unsigned i;
+
+    if (KDirectoryNativeDir(&dir) != 0)
+        return UINT64_MAX;
+    for (i = 0; G.refFiles[i]; ++i) {
+        uint64_t size = 0;
+        if (KDirectoryFileSize(dir, &size, "%s", G.refFiles[i]) != 0) {
+            total = UINT64_MAX;
+            break;
+        }
+        total += size;
+    }
+    KDirectoryRelease(dir);
+    return total;
+}
+
+rc_t ReferenceReaderInit(ReferenceReader *self, const VDBManager *mgr)
+{
+    rc_t rc;
+    unsigned i;
+
+    memset(self, 0, sizeof(*self));
+    if (FastaFilesSize() > READER_MAX_FASTA_SIZE)
+        return RC(rcApp, rcTable, rcConstructing, rcSize, rcExcessive);
+
+    rc = ReferenceMgr_Make(&self->mgr, NULL, mgr, 0,
+                           G.refXRefPath, G.inpath,
+                           G.maxSeqLen, READER_CACHE_SIZE, READER_OPEN_TABLE_LIMIT);
+    for (i = 0; rc == 0 && G.refFiles[i]; ++i)
+        rc = ReferenceMgr_FastaPath(self->mgr, G.refFiles[i]);
+    if (rc)
+        ReferenceReaderWhack(self);
+    return rc;
+}
+
+rc_t ReferenceReaderCompress(ReferenceReader *self, AlignmentRecord *data,
+                             char const id[], uint64_t const pos,
+                             uint32_t const rawCigar[], uint32_t const cigCount,
+                             char const seqDNA[], uint32_t const seqLen,
+                             uint8_t rna_orient)
+{
+    if (self->rseq == NULL || !str__equal(id, self->id)) {
+        ReferenceSeq const *rseq = NULL;
+        bool shouldUnmap = false;
+        bool wasRenamed = false;
+
+        if (self->rseq)
+            ReferenceSeq_Release(self->rseq);
+        free(self->id);
+        self->rseq = NULL;
+        self->id = NULL;
+
+        BAIL_ON_FAIL(ReferenceMgr_GetSeq(self->mgr, &rseq, id, &shouldUnmap, G.allowMultiMapping, &wasRenamed));
+        if (shouldUnmap) {
+            /* the main thread unmaps these alignments */
+            ReferenceSeq_Release(rseq);
+            return RC(rcApp, rcTable, rcReading, rcId, rcIgnored);
+        }
+        self->id = strdup(id);
+        if (self->id == NULL) {
+            ReferenceSeq_Release(rseq);
+            return RC(rcApp, rcTable, rcReading, rcMemory, rcExhausted);
+        }
+        self->rseq = rseq;
+    }
+    return ReferenceSeq_Compress(self->rseq,
+                                 (G.acceptHardClip ? ewrefmgr_co_AcceptHardClip : 0) + ewrefmgr_cmp_Binary,
+                                 (INSDC_coord_len)pos,
+                                 seqDNA, seqLen,
+                                 rawCigar, cigCount,
+                                 0, NULL, 0, 0, NULL, 0,
+                                 rna_orient,
+                                 &data->data);
+}
+
+void ReferenceReaderWhack(ReferenceReader *self)
+{
+    if (self->rseq)
+        ReferenceSeq_Release(self->rseq);
+    if (self->mgr)
+        ReferenceMgr_Release(self->mgr, false, NULL, false, Quitting);
+    free(self->id);
+    memset(self, 0, sizeof(*self));
+}
@@ -56,6 +56,14 @@ typedef struct s_reference {
     bool out_of_order;
 } Reference;
 
+/* compares alignments to the reference on a worker thread:
+ * it has a ReferenceMgr of its own, without a database, and shares no cursor with Reference */
+typedef struct s_reference_reader {
+    const ReferenceMgr *mgr;
+    const ReferenceSeq *rseq;
+    char *id;                    /* name rseq was looked up by */
+} ReferenceReader;
+
 rc_t ReferenceInit(Reference *self, const VDBManager *mgr, VDatabase *db);
 rc_t ReferenceSetFile(Reference *self, char const id[],
                       uint64_t length, uint8_t const md5[16],
@@ -72,6 +80,18 @@ rc_t ReferenceRead(Reference *self, AlignmentRecord *data, uint64_t pos,
                    uint32_t const rawCigar[], uint32_t cigCount,
                    char const seqDNA[], uint32_t seqLen,
                    uint8_t rna_orient, uint32_t *matches, uint32_t *misses);
+/* for alignments ReferenceReaderCompress has compared already */
+rc_t ReferenceReadCompressed(Reference *self, AlignmentRecord *data, uint64_t pos,
+                             AlignmentRecord const *compressed, uint32_t seqLen,
+                             uint32_t *matches, uint32_t *misses);
 rc_t ReferenceWhack(Reference *self, bool commit);
 
+rc_t ReferenceReaderInit(ReferenceReader *self, const VDBManager *mgr);
+rc_t ReferenceReaderCompress(ReferenceReader *self, AlignmentRecord *data,
+                             char const id[], uint64_t pos,
+                             uint32_t const rawCigar[], uint32_t cigCount,
+                             char const seqDNA[], uint32_t seqLen,
+                             uint8_t rna_orient);
+void ReferenceReaderWhack(ReferenceReader *self);
+
 #endif
@@ -269,7 +269,7 @@ static bool parse_pos(SAM2BAM_Parser *const self, uint8_t *const fld, int ch, rc
             *rc = RC(rcAlign, rcFile, rcReading, rcData, rcInvalid);
         return false;
     }
-    bam_alignment_set_i32(fld, ((int32_t)value) - 1);
+    bam_alignment_set_i32(fld, (int32_t)(uint32_t)(value - 1));
     return true;
 }
 
@@ -1353,6 +1353,376 @@ static SAM2BAM_Parser *init(  SAM2BAM_Parser *const self
     return self;
 }
 
+/* MARK: fast path
+ * Whole fields are parsed at once, only the common spelling of each field is
+ * accepted. Anything else is left to the character parser above, which
+ * validates the record and reports the errors.
+ */
+
+/** digits only; at least one digit unless empty_ok **/
+static bool fast_unsigned(char const *cp, char const *const endp, uint64_t const max, bool const empty_ok, uint64_t *const rslt)
+{
+    uint64_t value = 0;
+
+    if (cp == endp && !empty_ok)
+        return false;
+    for ( ; cp < endp; ++cp) {
+        unsigned const digit = (unsigned)(*cp - '0');
+        if (digit > 9)
+            return false;
+        value = value * 10 + digit;
+        if (value > max)
+            return false;
+    }
+    *rslt = value;
+    return true;
+}
+
+/** -?[0-9]+ **/
+static bool fast_i32(char const *cp, char const *const endp, int32_t *const rslt)
+{
+    bool const neg = cp < endp && *cp == '-';
+    uint64_t value;
+
+    if (!fast_unsigned(cp + (neg ? 1 : 0), endp, neg ? (uint64_t)INT32_MAX + 1 : INT32_MAX, false, &value))
+        return false;
+    *rslt = neg ? -(uint32_t)value : (uint32_t)value;
+    return true;
+}
+
+/** same result as the character parser, floating point is not re-implemented **/
+static bool fast_numeric(char const *cp, char const *const endp, number_parser *const rslt)
+{
+    rslt->state = 0;
+    for ( ; cp < endp; ++cp) {
+        if (!parse_numeric(rslt, *cp))
+            return false;
+    }
+    return rslt->state != 0 && rslt->ok;
+}
+
+static bool fast_refname(SAM2BAM_Parser *const self, char const *cp, char const *const endp, uint8_t *const fld)
+{
+    int32_t result;
+    rc_t rc = 0;
+
+    if (endp - cp == 1 && *cp == '*') {
+        bam_alignment_set_i32(fld, -1);
+        return true;
+    }
+    for ( ; cp < endp; ++cp) {
+        if (!self->lookup(self->lookup_ctx, *cp, &result, &rc))
+            return false;
+    }
+    if (!self->lookup(self->lookup_ctx, -1, &result, &rc))
+        return false;
+    bam_alignment_set_i32(fld, result);
+    return true;
+}
+
+static bool fast_QNAME(SAM2BAM_Parser *const self, char const *const value, char const *const endp, rc_t *const rc)
+{
+    size_t const len = endp - value;
+    size_t current;
+    size_t i;
+
+    if (len == 1 && *value == '*') {
+        RESULT_FIELD(read_name_len) = 0;
+        return true;
+    }
+    if (len >= 255)
+        return false;
+    for (i = 0; i < len; ++i) {
+        int const ch = value[i];
+        if (ch < '!' || ch > '~' || ch == '@')
+            return false;
+    }
+    if ((current = check_size(self, len + 1, rc)) == 0)
+        return false;
+    memmove(&self->rslt->raw[current], value, len);
+    self->rslt->raw[current + len] = '\0';
+    RESULT_FIELD(read_name_len) = (uint8_t)(len + 1);
+    return true;
+}
+
+static bool fast_CIGAR(SAM2BAM_Parser *const self, char const *cp, char const *const endp, rc_t *const rc)
+{
+    size_t n_cigars = 0;
+
+    if (endp - cp == 1 && *cp == '*')
+        cp = endp;
+    while (cp < endp) {
+        char const *const start = cp;
+        uint64_t length = 0;
+        int64_t packed;
+        size_t offset;
+
+        while (cp < endp && (unsigned)(*cp - '0') <= 9)
+            ++cp;
+        if (cp == start || cp == endp)
+            return false;
+        if (!fast_unsigned(start, cp, UINT32_MAX >> 4, false, &length))
+            return false;
+        if ((packed = packCIGAR(length, *cp++)) < 0)
+            return false;
+        if ((offset = check_size(self, 4, rc)) == 0)
+            return false;
+        bam_alignment_set_u32(&self->rslt->raw[offset], (uint32_t)packed);
+        ++n_cigars;
+    }
+    if (n_cigars >= UINT16_MAX)
+        return false;
+    bam_alignment_set_u16(RESULT_FIELD(n_cigars), (uint16_t)n_cigars);
+    return true;
+}
+
+static bool fast_SEQ(SAM2BAM_Parser *const self, char const *const value, char const *const endp, rc_t *const rc)
+{
+    size_t const len = (endp - value == 1 && *value == '*') ? 0 : (size_t)(endp - value);
+    size_t current;
+    size_t i;
+
+    if (len > UINT32_MAX)
+        return false;
+    if (len > 0) {
+        uint8_t *dst;
+
+        if ((current = check_size(self, (len + 1) / 2, rc)) == 0)
+            return false;
+        dst = &self->rslt->raw[current];
+        for (i = 0; i < len; ++i) {
+            int const ch = value[i];
+            if (!(   (ch >= 'A' && ch <= 'Z')
+                  || (ch >= 'a' && ch <= 'z')
+                  ||  ch == '=' || ch == '.'))
+            {
+                return false;
+            }
+            if (i % 2 == 0)
+                dst[i / 2] = (uint8_t)(translate_to_4nabin(ch) << 4);
+            else
+                dst[i / 2] |= translate_to_4nabin(ch);
+        }
+    }
+    bam_alignment_set_u32(RESULT_FIELD(read_len), (uint32_t)len);
+    return true;
+}
+
+static bool fast_QUAL(SAM2BAM_Parser *const self, char const *const value, char const *const endp, rc_t *const rc)
+{
+    size_t const readlen = bam_alignment_get_u32(RESULT_FIELD(read_len));
+    bool const missing = endp - value == 1 && *value == '*';
+    size_t current;
+    size_t i;
+
+    if (!missing && (size_t)(endp - value) != readlen)
+        return false;
+    if (readlen == 0)
+        return true;
+    if ((current = check_size(self, readlen, rc)) == 0)
+        return false;
+    if (missing) {
+        memset(&self->rslt->raw[current], -1, readlen);
+        return true;
+    }
+    for (i = 0; i < readlen; ++i) {
+        int const ch = value[i];
+        if (ch < '!' || ch > '~')
+            return false;
+        self->rslt->raw[current + i] = (uint8_t)(ch - 33);
+    }
+    return true;
+}
+
+/** TAG:TYPE:VALUE **/
+static bool fast_EXTRA(SAM2BAM_Parser *const self, char const *const value, char const *const endp, rc_t *const rc)
+{
+    size_t const len = endp - value;
+    char const *cp = value + 5;
+    size_t current;
+
+    if (len == 0)
+        return true;
+    if (len < 5 || !(   (value[0] >= 'A' && value[0] <= 'Z')
+                     || (value[0] >= 'a' && value[0] <= 'z'))
+        || value[2] != ':' || value[4] != ':')
+    {
+        return false;
+    }
+    switch (value[3]) {
+    case 'A':
+        if (len != 6 || value[5] < '!' || value[5] > '~')
+            return false;
+        if ((current = check_size(self, 4, rc)) == 0)
+            return false;
+        memmove(&self->rslt->raw[current], value, 2);
+        self->rslt->raw[current + 2] = 'A';
+        self->rslt->raw[current + 3] = value[5];
+        return true;
+    case 'i':
+    {
+        int32_t number;
+        if (!fast_i32(cp, endp, &number))
+            return false;
+        if ((current = check_size(self, 7, rc)) == 0)
+            return false;
+        memmove(&self->rslt->raw[current], value, 2);
+        self->rslt->raw[current + 2] = 'i';
+        bam_alignment_set_i32(&self->rslt->raw[current + 3], number);
+        return true;
+    }
+    case 'f':
+        if (!fast_numeric(cp, endp, &self->numeric))
+            return false;
+        if ((current = check_size(self, 7, rc)) == 0)
+            return false;
+        memmove(&self->rslt->raw[current], value, 2);
+        self->rslt->raw[current + 2] = 'f';
+        bam_alignment_set_f32(&self->rslt->raw[current + 3], number_parser_get(&self->numeric));
+        return true;
+    case 'Z':
+    case 'H':
+    {
+        size_t const n = endp - cp;
+        size_t i;
+        for (i = 0; i < n; ++i) {
+            int const ch = cp[i];
+            if (value[3] == 'Z' ? !((ch >= '!' && ch <= '~') || ch == ' ')
+                                : !((ch >= '0' && ch <= '9') || (ch >= 'A' && ch <= 'F')))
+                return false;
+        }
+        if (value[3] == 'H' && n % 2 != 0)
+            return false;
+        if ((current = check_size(self, 3 + n + 1, rc)) == 0)
+            return false;
+        memmove(&self->rslt->raw[current], value, 2);
+        self->rslt->raw[current + 2] = value[3];
+        memmove(&self->rslt->raw[current + 3], cp, n);
+        self->rslt->raw[current + 3 + n] = '\0';
+        return true;
+    }
+    case 'B':
+    {
+        int const subtype = cp < endp ? *cp++ : 0;
+        int const type = (subtype == 'C' || subtype == 'I' || subtype == 'S') ? 'I'
+                       : (subtype == 'c' || subtype == 'i' || subtype == 's') ? 'i'
+                       : subtype == 'f' ? 'f' : 0;
+        size_t countPos;
+
+        if (type == 0)
+            return false;
+        if ((current = check_size(self, 8, rc)) == 0)
+            return false;
+        memmove(&self->rslt->raw[current], value, 2);
+        self->rslt->raw[current + 2] = 'B';
+        self->rslt->raw[current + 3] = type;
+        countPos = current + 4;
+        bam_alignment_set_i32(&self->rslt->raw[countPos], 0);
+        while (cp < endp) {
+            char const *elem;
+            char const *elem_end;
+
+            if (*cp++ != ',')
+                return false;
+            elem = cp;
+            elem_end = (char const *)memchr(cp, ',', endp - cp);
+            if (elem_end == NULL)
+                elem_end = endp;
+            cp = elem_end;
+            if ((current = check_size(self, 4, rc)) == 0)
+                return false;
+            if (type == 'I') {
+                uint64_t number;
+                if (!fast_unsigned(elem, elem_end, UINT32_MAX, false, &number))
+                    return false;
+                bam_alignment_set_u32(&self->rslt->raw[current], (uint32_t)number);
+            }
+            else if (type == 'i') {
+                int32_t number;
+                if (!fast_i32(elem, elem_end, &number))
+                    return false;
+                bam_alignment_set_i32(&self->rslt->raw[current], number);
+            }
+            else {
+                if (!fast_numeric(elem, elem_end, &self->numeric))
+                    return false;
+                bam_alignment_set_f32(&self->rslt->raw[current], number_parser_get(&self->numeric));
+            }
+            bam_alignment_inc_i32(&self->rslt->raw[countPos]);
+        }
+        return true;
+    }
+    }
+    return false;
+}
+
+static bool parse_fast_fields(  SAM2BAM_Parser *const self
+                              , char const *const data
+                              , unsigned const fields
+                              , unsigned const *const offsets
+                              , rc_t *const rc
+                              )
+{
+#define FIELD_START(I) (data + ((I) == 0 ? 0 : offsets[(I) - 1]))
+#define FIELD_END(I) (data + offsets[(I)] - 1)
+    uint64_t value;
+    int32_t tlen;
+    unsigned i;
+
+    if (fields < 11)
+        return false;
+
+    if (!fast_QNAME(self, FIELD_START(0), FIELD_END(0), rc))
+        return false;
+
+    if (!fast_unsigned(FIELD_START(1), FIELD_END(1), UINT16_MAX, false, &value))
+        return false;
+    bam_alignment_set_u16(RESULT_FIELD(flags), (uint16_t)value);
+
+    if (!fast_refname(self, FIELD_START(2), FIELD_END(2), RESULT_FIELD(rID)))
+        return false;
+
+    if (!fast_unsigned(FIELD_START(3), FIELD_END(3), (uint64_t)INT32_MAX + 1, true, &value))
+        return false;
+    bam_alignment_set_i32(RESULT_FIELD(pos), (int32_t)(uint32_t)(value - 1));
+
+    if (!fast_unsigned(FIELD_START(4), FIELD_END(4), UINT8_MAX, true, &value))
+        return false;
+    RESULT_FIELD(mapQual) = (uint8_t)value;
+
+    if (!fast_CIGAR(self, FIELD_START(5), FIELD_END(5), rc))
+        return false;
+
+    if (FIELD_END(6) - FIELD_START(6) == 1 && *FIELD_START(6) == '=')
+        bam_alignment_set_i32(RESULT_FIELD(mate_rID), bam_alignment_get_i32(RESULT_FIELD(rID)));
+    else if (!fast_refname(self, FIELD_START(6), FIELD_END(6), RESULT_FIELD(mate_rID)))
+        return false;
+
+    if (!fast_unsigned(FIELD_START(7), FIELD_END(7), (uint64_t)INT32_MAX + 1, true, &value))
+        return false;
+    bam_alignment_set_i32(RESULT_FIELD(mate_pos), (int32_t)(uint32_t)(value - 1));
+
+    if (!fast_i32(FIELD_START(8), FIELD_END(8), &tlen))
+        return false;
+    bam_alignment_set_i32(RESULT_FIELD(ins_size), tlen);
+
+    if (!fast_SEQ(self, FIELD_START(9), FIELD_END(9), rc))
+        return false;
+
+    if (!fast_QUAL(self, FIELD_START(10), FIELD_END(10), rc))
+        return false;
+
+    for (i = 11; i < fields; ++i) {
+        if (!fast_EXTRA(self, FIELD_START(i), FIELD_END(i), rc))
+            return false;
+    }
+    self->field = fields;
+    self->parser = PARSER_FUNCTION(EXTRA);
+    return true;
+#undef FIELD_START
+#undef FIELD_END
+}
+
 static SAM2BAM_Parser *parse(  char const *const data
                              , unsigned const fields
                              , unsigned const *const offsets
@@ -1422,6 +1792,34 @@ SAM2BAM_Parser *SAM2BAM_Parser_parse(  char const *const data
     return parse(data, fields, offsets, static_buffer, buffer_size, lookup, lookup_ctx, rc);
 }
 
+SAM2BAM_Parser *SAM2BAM_Parser_parse_fast(  char const *const data
+                                          , unsigned const fields
+                                          , unsigned const *const offsets
+                                          , void *const static_buffer
+                                          , size_t const buffer_size
+                                          , RefNameLookupFunction lookup
+                                          , RefNameLookupContext *lookup_ctx
+                                          , rc_t *rc
+                                          )
+{
+    SAM2BAM_Parser *const self = (SAM2BAM_Parser*)malloc(sizeof(*self));
+
+    *rc = 0;
+    if (self == NULL || init(self, static_buffer, buffer_size, lookup, lookup_ctx) == NULL) {
+        free(self);
+        *rc = RC(rcAlign, rcFile, rcReading, rcMemory, rcExhausted);
+        return NULL;
+    }
+    self->record_chars = offsets[fields - 1] - 1;
+    if (parse_fast_fields(self, data, fields, offsets, rc))
+        return self;
+
+    if (self->rslt != static_buffer)
+        free(self->rslt);
+    free(self);
+    return NULL;
+}
+
 SAM2BAM_Parser *SAM2BAM_Parser_initialize(  SAM2BAM_Parser *const self
                                           , void *const static_buffer
                                           , size_t const buffer_size
@@ -79,3 +79,19 @@ SAM2BAM_Parser *SAM2BAM_Parser_parse(  char const *const data
                                      , RefNameLookupContext *lookup_ctx
                                      , rc_t *rc
                                      );
+
+/** \brief parses the common form of a record
+ *
+ * Fields are parsed whole instead of one character at a time.
+ * \returns NULL with *rc == 0 if the record needs SAM2BAM_Parser_parse,
+ * which accepts everything the SAM spec allows and reports the errors
+ **/
+SAM2BAM_Parser *SAM2BAM_Parser_parse_fast(  char const *const data
+                                          , unsigned const fields
+                                          , unsigned const *const offsets
+                                          , void *const static_buffer
+                                          , size_t const buffer_size
+                                          , RefNameLookupFunction lookup
+                                          , RefNameLookupContext *lookup_ctx
+                                          , rc_t *rc
+                                          );
@@ -42,6 +42,11 @@
 #include <klib/printf.h> /* string_printf */
 #include <klib/status.h> /* STSMSG */
 
+#include <kproc/queue.h> /* KQueue */
+#include <kproc/thread.h> /* KThread */
+
+#include <atomic32.h> /* atomic32_t */
+
 #include <vdb/schema.h> /* VDBManagerMakeSchema */
 
 #include <loader/loader-meta.h> /* KLoaderMeta_Write */
@@ -50,6 +55,7 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <string.h>
 
 typedef struct SParam_struct
 {
@@ -80,6 +86,7 @@ typedef struct SParam_struct
     uint32_t single_mate;
     uint32_t cluster_size;
     uint32_t load_other_evidence;
+    uint32_t threads;
 
     uint32_t read_len;
 } SParam;
@@ -343,6 +350,7 @@ typedef struct FGroupMAP_struct {
     const CGLoaderFile* seq;
     const CGLoaderFile* align;
     const CGLoaderFile* tagLfr;
+    int64_t start_rowid; /* SEQUENCE row of the 1st read */
 } FGroupMAP;
 
 static
@@ -414,9 +422,8 @@ bool CC FGroupMAP_FindRowId( BSTNode *node, void *data )
     const FGroupMAP* n = (const FGroupMAP*)node;
 
     if( FGroupMAP_Cmp(&d->key, node) == 0 ) {
-        if( CGLoaderFile_GetStartRow(n->seq, &d->rowid) == 0 ) {
-            return true;
-        }
+        d->rowid = n->start_rowid;
+        return true;
     }
     return false;
 }
@@ -626,57 +633,100 @@ typedef enum {
     eCtxLfr,
     eCtxMapping
 } TCtx;
-static bool _FGroupMAPDone(FGroupMAP *self, TCtx ctx, FGroupMAP_LoadData* d) {
+static bool _FGroupMAPDone(FGroupMAP *self, TCtx ctx, rc_t* rc) {
     /* (rcData rcDone) is always set on reads file EOF */
     bool eofLfr = true;
     bool eofMapping = true;
-    assert(self && d);
-    if (d->rc == 0 ||
-        GetRCState(d->rc) != rcDone || GetRCObject(d->rc) != (enum RCObject)rcData)
+    assert(self && rc);
+    if (*rc == 0 ||
+        GetRCState(*rc) != rcDone || GetRCObject(*rc) != (enum RCObject)rcData)
     {
         return false;
     }
-    d->rc = 0;
-    if (d->rc == 0 && self->tagLfr != NULL) {
-        d->rc = CGLoaderFile_IsEof(self->tagLfr, &eofLfr);
+    *rc = 0;
+    if (*rc == 0 && self->tagLfr != NULL) {
+        *rc = CGLoaderFile_IsEof(self->tagLfr, &eofLfr);
     }
-    if (d->rc == 0 && self->align != NULL) {
-        d->rc = CGLoaderFile_IsEof(self->align, &eofMapping);
+    if (*rc == 0 && self->align != NULL) {
+        *rc = CGLoaderFile_IsEof(self->align, &eofMapping);
     }
-    if (d->rc == 0) {
+    if (*rc == 0) {
         switch (ctx) {
             case eCtxRead:
                 if (!eofLfr) {
                     /* not EOF */
-                    d->rc = RC(rcExe, rcFile, rcReading, rcData, rcUnexpected);
-                    CGLoaderFile_LOG(self->align, klogErr, d->rc,
+                    *rc = RC(rcExe, rcFile, rcReading, rcData, rcUnexpected);
+                    CGLoaderFile_LOG(self->align, klogErr, *rc,
                         "extra tag LFRs, possible that corresponding "
                         "reads file is truncated", NULL);
                 }
                 else if (!eofMapping) {
                     /* not EOF */
-                    d->rc = RC(rcExe, rcFile, rcReading, rcData, rcUnexpected);
-                    CGLoaderFile_LOG(self->align, klogErr, d->rc,
+                    *rc = RC(rcExe, rcFile, rcReading, rcData, rcUnexpected);
+                    CGLoaderFile_LOG(self->align, klogErr, *rc,
                         "extra mappings, possible that corresponding "
                         "reads file is truncated", NULL);
                 }
                 break;
             case eCtxLfr:
             case eCtxMapping:
-                d->rc = RC(rcExe, rcFile, rcReading, rcCondition, rcInvalid);
+                *rc = RC(rcExe, rcFile, rcReading, rcCondition, rcInvalid);
                 break;
             default:
                 assert(0);
                 break;
         }
     }
-    if (d->rc == 0) {
+    if (*rc == 0) {
         /* mappings and lfr file EOF detected ok */
         DEBUG_MSG(5, (" done\n", FGroupKey_Validate(&self->key)));
     }
     return true;
 }
 
+/* parses next spot of the group: read, tag lfr and mappings */
+static
+rc_t FGroupMAP_GetSpot(FGroupMAP* n, TReadsData* reads, TMappingsData* mappings, TCtx* ctx)
+{
+    rc_t rc;
+
+    *ctx = eCtxRead;
+    rc = CGLoaderFile_GetRead(n->seq, reads);
+    if (rc == 0 && n->tagLfr != NULL) {
+        *ctx = eCtxLfr;
+        rc = CGLoaderFile_GetTagLfr(n->tagLfr, reads);
+    }
+    if (rc == 0) {
+        if ((reads->flags
+               & (cg_eLeftHalfDnbNoMatches | cg_eLeftHalfDnbMapOverflow))
+            &&
+            (reads->flags
+               & (cg_eRightHalfDnbNoMatches | cg_eRightHalfDnbMapOverflow)))
+        {
+            mappings->map_qty = 0;
+        } else {
+            *ctx = eCtxMapping;
+            rc = CGLoaderFile_GetMapping(n->align, mappings);
+        }
+    }
+    return rc;
+}
+
+static
+rc_t FGroupMAP_WriteSpot(FGroupMAP* n, FGroupMAP_LoadData* d)
+{
+    rc_t rc;
+
+    if (n->start_rowid == 0) {
+        n->start_rowid = d->db.reads->rowid;
+    }
+/* alignment written 1st than sequence -> primary_alignment_id must be set!! */
+    if ((rc = CGWriterAlgn_Write(d->db.walgn, d->db.reads)) == 0) {
+        rc = CGWriterSeq_Write(d->db.wseq);
+    }
+    return rc;
+}
+
 bool CC FGroupMAP_LoadReads( BSTNode *node, void *data )
 {
     TCtx ctx = eCtxRead;
@@ -687,32 +737,11 @@ bool CC FGroupMAP_LoadReads( BSTNode *node, void *data )
 
     DEBUG_MSG(5, (" started\n", FGroupKey_Validate(&n->key)));
     while (!done && d->rc == 0) {
-        ctx = eCtxRead;
-        d->rc = CGLoaderFile_GetRead(n->seq, d->db.reads);
-        if (d->rc == 0 && n->tagLfr != NULL) {
-            ctx = eCtxLfr;
-            d->rc = CGLoaderFile_GetTagLfr(n->tagLfr, d->db.reads);
-        }
+        d->rc = FGroupMAP_GetSpot(n, d->db.reads, d->db.mappings, &ctx);
         if (d->rc == 0) {
-            if ((d->db.reads->flags
-                   & (cg_eLeftHalfDnbNoMatches | cg_eLeftHalfDnbMapOverflow))
-                &&
-                (d->db.reads->flags
-                   & (cg_eRightHalfDnbNoMatches | cg_eRightHalfDnbMapOverflow)))
-            {
-                d->db.mappings->map_qty = 0;
-            } else {
-                ctx = eCtxMapping;
-                d->rc = CGLoaderFile_GetMapping(n->align, d->db.mappings);
-            }
-/* alignment written 1st than sequence -> primary_alignment_id must be set!! */
-            if (d->rc == 0 &&
-                (d->rc = CGWriterAlgn_Write(d->db.walgn, d->db.reads)) == 0)
-            {
-                d->rc = CGWriterSeq_Write(d->db.wseq);
-            }
+            d->rc = FGroupMAP_WriteSpot(n, d);
         }
-        done = _FGroupMAPDone(n, ctx, d);
+        done = _FGroupMAPDone(n, ctx, &d->rc);
         d->rc = d->rc ? d->rc : Quitting();
     }
     if( d->rc != 0 ) {
@@ -724,6 +753,316 @@ bool CC FGroupMAP_LoadReads( BSTNode *node, void *data )
     return d->rc != 0;
 }
 
+/* with threads groups are parsed in parallel into batches of spots,
+   the calling thread writes the batches in order of groups,
+   so the row ids are the same as when loading on a single thread */
+#define LOAD_BATCH_SPOTS 1024
+#define LOAD_BATCH_QUEUE 8
+
+typedef struct FGroupMAP_Spot_struct {
+    uint32_t reads_format;
+    uint16_t flags;
+    uint16_t map_qty;
+    uint32_t map_first; /* in batch map */
+    uint32_t spot_len;
+    uint32_t read_len;
+    uint32_t qual_len;
+    uint32_t spot_group; /* offset in batch text */
+    uint32_t spot_group_len;
+    char read[CG_READS15_SPOT_LEN + 1];
+    char qual[CG_READS15_SPOT_LEN + 1];
+} FGroupMAP_Spot;
+
+typedef struct FGroupMAP_Batch_struct {
+    bool last; /* the group ends with this batch */
+    uint32_t qty;
+    FGroupMAP_Spot spot[LOAD_BATCH_SPOTS];
+    uint32_t map_qty;
+    uint32_t map_max;
+    TMappingsData_map* map;
+    uint32_t text_qty;
+    uint32_t text_max;
+    char* text;
+} FGroupMAP_Batch;
+
+static
+void FGroupMAP_BatchWhack(FGroupMAP_Batch* self)
+{
+    if (self != NULL) {
+        free(self->map);
+        free(self->text);
+        free(self);
+    }
+}
+
+static
+rc_t FGroupMAP_BatchAdd(FGroupMAP_Batch* self, const TReadsData* reads, const TMappingsData* mappings)
+{
+    FGroupMAP_Spot* s = &self->spot[self->qty];
+    uint32_t sg_len = reads->seq.spot_group.elements;
+    const char* sg = reads->seq.spot_group.buffer;
+
+    if (self->map_qty + mappings->map_qty > self->map_max) {
+        uint32_t max = self->map_max ? self->map_max : 4 * LOAD_BATCH_SPOTS;
+        TMappingsData_map* m;
+
+        while (max < self->map_qty + mappings->map_qty) {
+            max *= 2;
+        }
+        if ((m = realloc(self->map, max * sizeof(*m))) == NULL) {
+            return RC(rcExe, rcBuffer, rcAllocating, rcMemory, rcExhausted);
+        }
+        self->map = m;
+        self->map_max = max;
+    }
+    /* spot group changes per record only with tag lfr, keep one copy of a repeated one */
+    if (self->qty == 0 || sg_len != s[-1].spot_group_len ||
+        memcmp(&self->text[s[-1].spot_group], sg, sg_len) != 0)
+    {
+        if (self->text_qty + sg_len > self->text_max) {
+            uint32_t max = self->text_max ? self->text_max * 2 : 4096;
+            char* t;
+
+            while (max < self->text_qty + sg_len) {
+                max *= 2;
+            }
+            if ((t = realloc(self->text, max)) == NULL) {
+                return RC(rcExe, rcBuffer, rcAllocating, rcMemory, rcExhausted);
+            }
+            self->text = t;
+            self->text_max = max;
+        }
+        if (sg_len > 0) {
+            memmove(&self->text[self->text_qty], sg, sg_len);
+        }
+        s->spot_group = self->text_qty;
+        self->text_qty += sg_len;
+    }
+    else {
+        s->spot_group = s[-1].spot_group;
+    }
+    s->spot_group_len = sg_len;
+
+    s->reads_format = reads->reads_format;
+    s->flags = reads->flags;
+    s->spot_len = reads->seq.spot_len;
+    s->read_len = reads->seq.sequence.elements;
+    s->qual_len = reads->seq.quality.elements;
+    memmove(s->read, reads->read, sizeof(s->read));
+    memmove(s->qual, reads->qual, sizeof(s->qual));
+
+    s->map_first = self->map_qty;
+    s->map_qty = mappings->map_qty;
+    if (mappings->map_qty > 0) {
+        memmove(&self->map[self->map_qty], mappings->map, mappings->map_qty * sizeof(mappings->map[0]));
+        self->map_qty += mappings->map_qty;
+    }
+
+    self->qty++;
+    return 0;
+}
+
+/* puts spot into writers' data the same way the parsers fill it */
+static
+void FGroupMAP_BatchGet(const FGroupMAP_Batch* self, uint32_t i, TReadsData* reads, TMappingsData* mappings)
+{
+    const FGroupMAP_Spot* s = &self->spot[i];
+
+    reads->reads_format = s->reads_format;
+    reads->flags = s->flags;
+    reads->seq.spot_len = s->spot_len;
+    reads->seq.sequence.elements = s->read_len;
+    reads->seq.quality.elements = s->qual_len;
+    memmove(reads->read, s->read, sizeof(reads->read));
+    memmove(reads->qual, s->qual, sizeof(reads->qual));
+    reads->reverse[0] = '\0';
+    reads->reverse[s->spot_len / 2] = '\0';
+    reads->seq.spot_group.buffer = s->spot_group_len ? &self->text[s->spot_group] : NULL;
+    reads->seq.spot_group.elements = s->spot_group_len;
+
+    mappings->map_qty = s->map_qty;
+    if (s->map_qty > 0) {
+        memmove(mappings->map, &self->map[s->map_first], s->map_qty * sizeof(mappings->map[0]));
+    }
+}
+
+typedef struct FGroupMAP_Worker_struct {
+    KThread* thread;
+    KQueue* q; /* parsed batches, in order of groups */
+    FGroupMAP** groups;
+    uint32_t qty;
+    uint32_t first; /* thread parses groups first, first + step, ... */
+    uint32_t step;
+    atomic32_t* stop; /* not 0 when the writer gave up on the slides */
+} FGroupMAP_Worker;
+
+static
+rc_t FGroupMAP_ParseReads(FGroupMAP_Worker* self, FGroupMAP* n, TReadsData* reads, TMappingsData* mappings)
+{
+    rc_t rc = 0;
+    TCtx ctx = eCtxRead;
+    bool done = false;
+    FGroupMAP_Batch* b = NULL;
+
+    DEBUG_MSG(5, (" started\n", FGroupKey_Validate(&n->key)));
+    while (!done && rc == 0) {
+        if (b == NULL && (b = calloc(1, sizeof(*b))) == NULL) {
+            rc = RC(rcExe, rcBuffer, rcAllocating, rcMemory, rcExhausted);
+            break;
+        }
+        rc = FGroupMAP_GetSpot(n, reads, mappings, &ctx);
+        if (rc == 0) {
+            rc = FGroupMAP_BatchAdd(b, reads, mappings);
+        }
+        if (rc == 0 && b->qty == LOAD_BATCH_SPOTS) {
+            if ((rc = KQueuePush(self->q, b, NULL)) == 0) {
+                b = NULL;
+            }
+        }
+        done = _FGroupMAPDone(n, ctx, &rc);
+        rc = rc ? rc : Quitting();
+        rc = rc ? rc : (atomic32_read(self->stop) ? RC(rcExe, rcThread, rcExecuting, rcThread, rcCanceled) : 0);
+    }
+    if (rc == 0) {
+        b->last = true;
+        if ((rc = KQueuePush(self->q, b, NULL)) == 0) {
+            b = NULL;
+        }
+    }
+    else if (atomic32_read(self->stop) == 0) {
+        CGLoaderFile_LOG(n->seq, klogErr, rc, NULL, NULL);
+        CGLoaderFile_LOG(n->align, klogErr, rc, NULL, NULL);
+    }
+    FGroupMAP_BatchWhack(b);
+    FGroupMAP_CloseFiles(n);
+    return rc;
+}
+
+static
+rc_t CC FGroupMAP_WorkerThread(const KThread* t, void* data)
+{
+    rc_t rc = 0;
+    FGroupMAP_Worker* self = data;
+    TReadsData* reads = calloc(1, sizeof(*reads));
+    TMappingsData* mappings = calloc(1, sizeof(*mappings));
+    uint32_t i;
+
+    if (reads == NULL || mappings == NULL) {
+        rc = RC(rcExe, rcThread, rcAllocating, rcMemory, rcExhausted);
+    }
+    for (i = self->first; rc == 0 && i < self->qty && atomic32_read(self->stop) == 0; i += self->step) {
+        rc = FGroupMAP_ParseReads(self, self->groups[i], reads, mappings);
+    }
+    free(reads);
+    free(mappings);
+    /* the writer pops batches of this thread's groups until the queue is sealed and empty */
+    KQueueSeal(self->q);
+    return rc;
+}
+
+static
+void CC FGroupMAP_Count(BSTNode* node, void* data)
+{
+    ++*(uint32_t*)data;
+}
+
+static
+void CC FGroupMAP_Collect(BSTNode* node, void* data)
+{
+    FGroupMAP*** next = data;
+    *(*next)++ = (FGroupMAP*)node;
+}
+
+static
+rc_t FGroupMAP_LoadReadsThreaded(const BSTree* slides, FGroupMAP_LoadData* d, uint32_t num_threads)
+{
+    rc_t rc = 0, rcw = 0;
+    uint32_t i, qty = 0, g;
+    atomic32_t stop;
+    FGroupMAP** groups;
+    FGroupMAP** next;
+    FGroupMAP_Worker* w;
+
+    atomic32_set(&stop, 0);
+    BSTreeForEach(slides, false, FGroupMAP_Count, &qty);
+    if (num_threads > qty) {
+        num_threads = qty;
+    }
+    if (num_threads == 0) {
+        return 0;
+    }
+    groups = calloc(qty, sizeof(*groups));
+    w = calloc(num_threads, sizeof(*w));
+    if (groups == NULL || w == NULL) {
+        free(groups);
+        free(w);
+        return RC(rcExe, rcThread, rcAllocating, rcMemory, rcExhausted);
+    }
+    next = groups;
+    BSTreeForEach(slides, false, FGroupMAP_Collect, &next);
+
+    for (i = 0; rc == 0 && i < num_threads; i++) {
+        w[i].groups = groups;
+        w[i].qty = qty;
+        w[i].first = i;
+        w[i].step = num_threads;
+        w[i].stop = &stop;
+        if ((rc = KQueueMake(&w[i].q, LOAD_BATCH_QUEUE)) == 0) {
+            rc = KThreadMake(&w[i].thread, FGroupMAP_WorkerThread, &w[i]);
+        }
+    }
+
+    /* the groups are written in slide order: group g is parsed by thread g % num_threads
+       and ends with its batch marked last, a queue sealed before that batch means
+       the thread failed */
+    for (g = 0; rc == 0 && g < qty; g++) {
+        bool last = false;
+
+        while (rc == 0 && !last) {
+            FGroupMAP_Batch* b = NULL;
+
+            if ((rc = KQueuePop(w[g % num_threads].q, (void**)&b, NULL)) == 0) {
+                for (i = 0; rc == 0 && i < b->qty; i++) {
+                    FGroupMAP_BatchGet(b, i, d->db.reads, d->db.mappings);
+                    rc = FGroupMAP_WriteSpot(groups[g], d);
+                }
+                last = b->last;
+                FGroupMAP_BatchWhack(b);
+                if (rc != 0) {
+                    CGLoaderFile_LOG(groups[g]->seq, klogErr, rc, NULL, NULL);
+                }
+            }
+            rc = rc ? rc : Quitting();
+        }
+    }
+
+    /* after an error the threads may still be parsing further groups: stop them, and free
+       the batches they queued because a thread waits in KQueuePush() while its queue is full */
+    atomic32_set(&stop, 1);
+    for (i = 0; i < num_threads; i++) {
+        if (w[i].thread != NULL) {
+            rc_t rc_thread = 0;
+            FGroupMAP_Batch* b = NULL;
+
+            while (KQueuePop(w[i].q, (void**)&b, NULL) == 0) {
+                FGroupMAP_BatchWhack(b);
+            }
+            KThreadWait(w[i].thread, &rc_thread);
+            KThreadRelease(w[i].thread);
+            if (rcw == 0 && GetRCState(rc_thread) != rcCanceled) {
+                rcw = rc_thread;
+            }
+        }
+        KQueueRelease(w[i].q);
+    }
+    free(w);
+    free(groups);
+
+    /* a thread logs its parse error with the file, return it rather than the error
+       the writer got from the sealed queue */
+    return rcw ? rcw : rc;
+}
+
 bool CC FGroupMAP_LoadEvidence( BSTNode *node, void *data )
 {
     FGroupMAP* n = (FGroupMAP*)node;
@@ -893,7 +1232,10 @@ static rc_t Load( SParam* param )
                     rc = DB_Init( param, &data.db );
                     if ( rc == 0 )
                     {
-                        BSTreeDoUntil( &slides, false, FGroupMAP_LoadReads, &data );
+                        if ( param->threads > 1 )
+                            data.rc = FGroupMAP_LoadReadsThreaded( &slides, &data, param->threads );
+                        else
+                            BSTreeDoUntil( &slides, false, FGroupMAP_LoadReads, &data );
                         rc = data.rc;
                         if ( rc == 0 )
                         {
@@ -967,6 +1309,7 @@ const char* single_mate_usage[] = {"if secondary mates have duplicates preserve
 const char* cluster_size_usage[] = {"defines cluster window on the reference, records only 1 placement from given cluster size; default is zero which means ignore", NULL};
 const char* no_read_ahead_usage[] = {"disable input files threaded caching", NULL};
 const char* library_usage[] = {"copy extra file/directory into output", NULL};
+const char* threads_usage[] = {"number of threads parsing reads and mappings files, default is 4; 1 parses on the loading thread", NULL};
 
 /* this enum must have same order as MainArgs array below */
 enum OptDefIndex {
@@ -989,7 +1332,8 @@ enum OptDefIndex {
     eopt_SingleMate,
     eopt_ClusterSize,
     eopt_noReadAhead,
-    eopt_Library
+    eopt_Library,
+    eopt_Threads
 };
 
 OptDef MainArgs[] =
@@ -1015,7 +1359,8 @@ OptDef MainArgs[] =
     { "single-mate",      NULL, NULL, single_mate_usage,    1, false, false },
     { "cluster-size",     NULL, NULL, cluster_size_usage,   1, true,  false },
     { "input-no-threads", "t",  NULL, no_read_ahead_usage,  1, false, false },
-    { "library",          "l",  NULL, library_usage,        1, true,  false }
+    { "library",          "l",  NULL, library_usage,        1, true,  false },
+    { "threads",          NULL, NULL, threads_usage,        1, true,  false }
 };
 const size_t MainArgsQty = sizeof(MainArgs) / sizeof(MainArgs[0]);
 
@@ -1070,7 +1415,7 @@ rc_t CC KMain( int argc, char* argv[] )
 {
     rc_t rc = 0;
     Args* args = NULL;
-    const char* errmsg = NULL, *refseq_chunk = NULL, *min_mapq = NULL, *cluster_size = NULL;
+    const char* errmsg = NULL, *refseq_chunk = NULL, *min_mapq = NULL, *cluster_size = NULL, *threads = NULL;
     const XMLLogger* xml_logger = NULL;
     SParam params;
     memset(&params, 0, sizeof(params));
@@ -1176,6 +1521,11 @@ rc_t CC KMain( int argc, char* argv[] )
             errmsg = MainArgs[eopt_ClusterSize].name;
         } else if( (rc = ArgsOptionCount(args, MainArgs[eopt_SingleMate].name, &params.single_mate)) != 0 ) {
             errmsg = MainArgs[eopt_SingleMate].name;
+        } else if( (rc = ArgsOptionCount(args, MainArgs[eopt_Threads].name, &count)) != 0 || count > 1 ) {
+            rc = rc ? rc : RC(rcExe, rcArgv, rcParsing, rcParam, rcExcessive);
+            errmsg = MainArgs[eopt_Threads].name;
+        } else if( count > 0 && (rc = ArgsOptionValue(args, MainArgs[eopt_Threads].name, 0, (const void **)&threads)) != 0 ) {
+            errmsg = MainArgs[eopt_Threads].name;
 
         } else {
             do {
@@ -1222,6 +1572,18 @@ rc_t CC KMain( int argc, char* argv[] )
                 else
                     params.cluster_size = 0;
 
+                params.threads = 4;
+                if( threads != NULL ) {
+                    errno = 0;
+                    val = strtol(threads, &end, 10);
+                    if( errno != 0 || threads == end || *end != '\0' || val < 1 || val > 256 ) {
+                        rc = RC(rcExe, rcArgv, rcReading, rcParam, rcInvalid);
+                        errmsg = MainArgs[eopt_Threads].name;
+                        break;
+                    }
+                    params.threads = val;
+                }
+
                 rc = KDirectoryNativeDir( &params.input_dir );
                 if ( rc != 0 )
                     errmsg = "current directory";
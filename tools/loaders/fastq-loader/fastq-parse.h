@@ -147,6 +147,11 @@ extern void FASTQScan_inline_sequence(FASTQParseBlock* pb);
 extern void FASTQScan_inline_quality(FASTQParseBlock* pb);
 extern void FASTQScan_skip_to_eol(FASTQParseBlock* pb); /*the next token will be EOL or EOF*/
 
+/* records parsed bypassing the scanner (see fastq-reader.c) */
+extern bool FASTQScan_at_record_start(FASTQParseBlock* pb); /* the scanner is between records */
+extern void FASTQScan_skip_record(FASTQParseBlock* pb, size_t lines); /* a record of 'lines' lines has been consumed */
+extern bool FASTQ_plain_records; /* set to false to parse every record with the grammar (for testing) */
+
 extern void FASTQ_set_lineno (int line_number, void* scanner);
 
 extern int FASTQ_lex(FASTQToken* tok, FASTQParseBlock * pb);
@@ -34,6 +34,7 @@ typedef struct FastqSequence    FastqSequence;
 
 #include "fastq-reader.h"
 #include "fastq-parse.h"
+#include "fastq-grammar.h"
 
 #include <sysalloc.h>
 #include <stdlib.h>
@@ -478,6 +479,9 @@ static ReaderFile_vt_v1 FastqReaderFile_vt =
     /* end minor version == 0 */
 };
 
+/* the scanner's input is read in blocks of this size, a block containing a 0 ends the input */
+#define FASTQ_INPUT_BLOCK 8192
+
 struct FastqReaderFile
 {
     ReaderFile dad;
@@ -487,6 +491,8 @@ struct FastqReaderFile
 
     const char* recordStart; /* raw source of the record being currently parsed */
     size_t curPos;           /* current tokenization position relative to recordStart */
+    uint64_t recordPos;      /* file offset of recordStart */
+    uint64_t checkedEnd;     /* the file has no 0s before this offset */
     bool lastEol;
     bool eolInserted;
 };
@@ -520,9 +526,582 @@ void FASTQ_ParseBlockInit ( FASTQParseBlock* pb )
     pb->qualityLength = 0;
 }
 
+/*--------------------------------------------------------------------------
+ * Plain records
+ *
+ * The bulk of FASTQ inputs are 4-line records ('@' tag line, bases, '+' line, qualities)
+ * with one of a few common tag line layouts. Such records are parsed straight from the
+ * loader file's buffer, bypassing the scanner and the grammar. Everything else (FASTA,
+ * multi-line, inline and colorspace reads, unusual tag lines, errors) goes to the grammar,
+ * so the code below accepts only what it can parse exactly the way the grammar would.
+ */
+
+bool FASTQ_plain_records = true;
+
+/* one token of a tag line, as returned by the scanner's tag line rules */
+typedef struct TagToken
+{
+    int type; /* fqXXX, a single character or fqENDLINE at the end of the line */
+    const char* text;
+    size_t length;
+} TagToken;
+
+/* components of a plain record, offsets are into the record;
+   copied into the parse block once the whole record is recognized */
+typedef struct PlainRecord
+{
+    size_t spotNameOffset;
+    size_t spotNameLength;
+    size_t spotGroupOffset;
+    size_t spotGroupLength;
+    uint8_t readNumber;
+    uint8_t secondaryReadNumber;
+    bool lowQuality;
+
+    size_t readOffset;
+    size_t readLength;
+    size_t qualityOffset;
+    size_t qualityLength;
+    uint8_t qualityAsciiOffset;
+} PlainRecord;
+
+static bool IsDigit ( char ch )
+{
+    return ch >= '0' && ch <= '9';
+}
+
+static bool IsAlphaNum ( char ch )
+{   /* {alphanum} */
+    return ( ch >= 'A' && ch <= 'Z' ) || ( ch >= 'a' && ch <= 'z' ) || IsDigit ( ch ) || ch == '-';
+}
+
+static bool IsCsKey ( char ch )
+{   /* {cskey} */
+    switch ( ch )
+    {
+    case 'A': case 'C': case 'G': case 'T':
+    case 'a': case 'c': case 'g': case 't':
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool IsBase ( char ch )
+{   /* {base} */
+    switch ( ch )
+    {
+    case 'A': case 'C': case 'G': case 'T': case 'N':
+    case 'a': case 'c': case 'g': case 't': case 'n':
+    case '.':
+        return true;
+    default:
+        return false;
+    }
+}
+
+static size_t SpanDigits ( const char* p, const char* end )
+{
+    const char* start = p;
+    while ( p < end && IsDigit ( *p ) )
+        ++p;
+    return p - start;
+}
+
+/* :{digits}:{digits}:{digits}:{digits} */
+static size_t SpanCoords ( const char* p, const char* end )
+{
+    const char* start = p;
+    int i;
+    for ( i = 0; i < 4; ++i )
+    {
+        size_t digits;
+        if ( p == end || *p != ':' )
+            return 0;
+        digits = SpanDigits ( p + 1, end );
+        if ( digits == 0 )
+            return 0;
+        p += 1 + digits;
+    }
+    return p - start;
+}
+
+/* [SDE]RR{digits}\.{digits} */
+static size_t SpanRunDotSpot ( const char* p, const char* end )
+{
+    size_t run, spot;
+    if ( end - p < 6 || ( p[0] != 'S' && p[0] != 'D' && p[0] != 'E' ) || p[1] != 'R' || p[2] != 'R' )
+        return 0;
+    run = SpanDigits ( p + 3, end );
+    if ( run == 0 || p + 3 + run == end || p[3 + run] != '.' )
+        return 0;
+    spot = SpanDigits ( p + 4 + run, end );
+    return spot == 0 ? 0 : 4 + run + spot;
+}
+
+/* the next tag line token: the longest match among the scanner's rules, the earlier rule on a tie */
+static void NextTagToken ( const char* p, const char* end, TagToken* tok )
+{
+    size_t length;
+
+    tok->text = p;
+    if ( p == end )
+    {
+        tok->type = fqENDLINE;
+        tok->length = 0;
+        return;
+    }
+
+    tok->type = (unsigned char) *p; /* . */
+    tok->length = 1;
+
+    length = SpanCoords ( p, end );
+    if ( length > 0 )
+    {   /* nothing else starts with ':' */
+        tok->type = fqCOORDS;
+        tok->length = length;
+        return;
+    }
+    if ( *p == '#' )
+    {
+        for ( length = 1; p + length < end && ( IsAlphaNum ( p[length] ) || p[length] == '_' ); ++length )
+            ;
+        tok->type = fqSPOTGROUP;
+        tok->length = length;
+        return;
+    }
+    if ( *p == ' ' || *p == '\t' )
+    {
+        for ( length = 1; p + length < end && ( p[length] == ' ' || p[length] == '\t' ); ++length )
+            ;
+        tok->type = fqWS;
+        tok->length = length;
+        return;
+    }
+    if ( IsAlphaNum ( *p ) )
+    {
+        size_t alnum;
+        for ( alnum = 1; p + alnum < end && IsAlphaNum ( p[alnum] ); ++alnum )
+            ;
+        length = SpanRunDotSpot ( p, end );
+        if ( length > alnum )
+        {
+            tok->type = fqRUNDOTSPOT;
+            tok->length = length;
+        }
+        else if ( SpanDigits ( p, end ) == alnum )
+        {
+            tok->type = fqNUMBER;
+            tok->length = alnum;
+        }
+        else
+        {
+            tok->type = fqALPHANUM;
+            tok->length = alnum;
+        }
+    }
+}
+
+/* same as SetReadNumber() in fastq-grammar.y; false on an inconsistent secondary read number */
+static bool SetPlainReadNumber ( const FASTQParseBlock* pb, PlainRecord* rec, const TagToken* tok )
+{
+    if ( pb->defaultReadNumber != -1 )
+    {
+        if ( tok->length == 1 && tok->text[0] == '1' )
+            rec->readNumber = 1;
+        else if ( tok->length == 1 && tok->text[0] == '0' )
+            rec->readNumber = pb->defaultReadNumber;
+        else if ( tok->length == 1 )
+        {
+            uint8_t readNum = tok->text[0] - '0';
+            if ( rec->secondaryReadNumber == 0 )
+                rec->secondaryReadNumber = readNum;
+            else if ( rec->secondaryReadNumber != readNum )
+                return false;
+            rec->readNumber = 2;
+        }
+        else
+            rec->readNumber = pb->defaultReadNumber;
+    }
+    return true;
+}
+
+/* same as SetSpotGroup() in fastq-grammar.y */
+static void SetPlainSpotGroup ( const FASTQParseBlock* pb, PlainRecord* rec, const char* record, const char* text, size_t length )
+{
+    if ( ! pb->ignoreSpotGroups )
+    {
+        if ( text[0] == '#' )
+        {
+            ++text;
+            --length;
+        }
+        if ( length != 1 || text[0] != '0' )
+        {
+            rec->spotGroupOffset = text - record;
+            rec->spotGroupLength = length;
+        }
+    }
+}
+
+/* Casava 1.8 read descriptor following the tag's white space: {digits}[:{alphanum}:{digits}[:index]] */
+static bool ParsePlainCasava ( const FASTQParseBlock* pb, PlainRecord* rec, const char* record, const char* p, const char* end )
+{
+    TagToken tok;
+    size_t bases, colors;
+
+    NextTagToken ( p, end, & tok );
+    if ( tok.type != fqNUMBER || ! SetPlainReadNumber ( pb, rec, & tok ) )
+        return false;
+    p += tok.length;
+    if ( p == end )
+        return true;
+    if ( *p != ':' )
+        return false;
+
+    NextTagToken ( ++p, end, & tok );
+    if ( tok.type != fqALPHANUM )
+        return false;
+    if ( tok.length == 1 && tok.text[0] == 'Y' )
+        rec->lowQuality = true;
+    p += tok.length;
+    if ( p == end || *p != ':' )
+        return false;
+
+    NextTagToken ( ++p, end, & tok );
+    if ( tok.type != fqNUMBER )
+        return false;
+    p += tok.length;
+    if ( p == end )
+        return true;
+    if ( *p != ':' )
+        return false;
+
+    /* the index is scanned as an inline sequence; whatever follows it is skipped */
+    if ( ++p == end )
+        return true;
+    for ( bases = 0; p + bases < end && ( IsBase ( p[bases] ) || p[bases] == '+' ); ++bases )
+        ;
+    colors = 0;
+    if ( IsCsKey ( *p ) )
+    {
+        while ( p + 1 + colors < end && ( ( p[1 + colors] >= '0' && p[1 + colors] <= '3' ) || p[1 + colors] == '.' ) )
+            ++colors;
+        if ( colors > 0 && 1 + colors > bases )
+            return false; /* a colorspace index */
+    }
+    if ( bases == 0 )
+        bases = SpanDigits ( p, end );
+    if ( bases == 0 )
+        return false;
+    SetPlainSpotGroup ( pb, rec, record, p, bases );
+    return true;
+}
+
+/* Recognizes the tag line layouts below, [p, end) is the tag line following '@' without the end of line.
+    name
+    name/N [ ...]
+    name[:C:C:C:C][#group][/N]
+    name[:C:C:C:C][#group][/N] N[:alpha:N[:index]][...]
+    name[:C:C:C:C][#group][/N] alpha[...]
+    SRRN.N[.N|/N][ ...]
+    where [...] is skipped by the grammar
+*/
+static bool ParsePlainTagLine ( const FASTQParseBlock* pb, PlainRecord* rec, const char* record, const char* p, const char* end )
+{
+    TagToken tok;
+    bool nameSpotGroup = false;
+
+    if ( p != end && ( end[-1] == ' ' || end[-1] == '\t' ) )
+        return false; /* the grammar may treat trailing white space as the next line */
+
+    rec->spotNameOffset = p - record;
+    NextTagToken ( p, end, & tok );
+
+    if ( tok.type == fqRUNDOTSPOT )
+    {
+        rec->spotNameLength = tok.length;
+        p += tok.length;
+        NextTagToken ( p, end, & tok );
+        if ( tok.type == fqENDLINE || tok.type == fqWS )
+            return true;
+        if ( tok.type != '.' && tok.type != '/' )
+            return false;
+        NextTagToken ( p + 1, end, & tok );
+        return tok.type == fqNUMBER && SetPlainReadNumber ( pb, rec, & tok );
+    }
+
+    /* name */
+    if ( tok.type != fqALPHANUM && tok.type != fqNUMBER )
+        return false;
+    do
+    {
+        p += tok.length;
+        NextTagToken ( p, end, & tok );
+    }
+    while ( tok.type == fqALPHANUM || tok.type == fqNUMBER || tok.type == '_' || tok.type == '.' || tok.type == ':' );
+    rec->spotNameLength = p - record - rec->spotNameOffset;
+
+    if ( tok.type == fqCOORDS )
+    {
+        rec->spotNameLength += tok.length;
+        p += tok.length;
+        NextTagToken ( p, end, & tok );
+        nameSpotGroup = true;
+    }
+    if ( tok.type == fqSPOTGROUP )
+    {
+        SetPlainSpotGroup ( pb, rec, record, tok.text, tok.length );
+        p += tok.length;
+        NextTagToken ( p, end, & tok );
+        nameSpotGroup = true;
+    }
+
+    if ( tok.type == fqENDLINE )
+        return true;
+
+    if ( tok.type == '/' )
+    {
+        if ( pb->defaultReadNumber == -1 )
+            return false; /* PacBio: part of the spot name */
+        NextTagToken ( p + 1, end, & tok );
+        if ( tok.type != fqNUMBER || ! SetPlainReadNumber ( pb, rec, & tok ) )
+            return false;
+        p = tok.text + tok.length;
+        NextTagToken ( p, end, & tok );
+        if ( tok.type == fqENDLINE )
+            return true;
+        if ( tok.type != fqWS )
+            return false;
+        if ( ! nameSpotGroup )
+            return true;
+        NextTagToken ( p + tok.length, end, & tok );
+        if ( tok.type == fqALPHANUM )
+            return true;
+        if ( tok.type != fqNUMBER )
+            return false;
+        NextTagToken ( tok.text + tok.length, end, & tok );
+        return tok.type == fqENDLINE || tok.type == fqWS;
+    }
+
+    if ( tok.type == fqWS && nameSpotGroup )
+    {
+        p += tok.length;
+        NextTagToken ( p, end, & tok );
+        if ( tok.type == fqALPHANUM )
+            return true;
+        return ParsePlainCasava ( pb, rec, record, p, end );
+    }
+
+    return false;
+}
+
+/* end of the line starting at p, NULL if not in the buffer */
+static const char* LineEnd ( const char* p, const char* end, const char** eol )
+{
+    const char* nl = memchr ( p, '\n', end - p );
+    if ( nl != NULL )
+    {
+        *eol = ( nl > p && nl[-1] == '\r' ) ? nl - 1 : nl;
+        return nl + 1;
+    }
+    return NULL;
+}
+
+/* Parse a plain record at the start of [buf, buf + size)
+    returns: 1 - parsed, *consumed and *lines are set;
+             0 - the record may continue past the end of the buffer;
+            -1 - leave the record to the grammar
+*/
+static int ParsePlainRecord ( const FASTQParseBlock* pb, PlainRecord* rec, const char* buf, size_t size, bool eof, size_t* consumed, size_t* lines )
+{
+    const char* end = buf + size;
+    const char* line;
+    const char* next;
+    const char* eol;
+    const char* p;
+    uint8_t floor;
+    uint8_t ceiling;
+
+    switch ( pb->qualityFormat )
+    {   /* see CheckQualities() in fastq-grammar.y */
+    case FASTQphred33:
+        floor = 33; ceiling = 126;
+        rec->qualityAsciiOffset = 33;
+        break;
+    case FASTQphred64:
+        floor = 64; ceiling = 127;
+        rec->qualityAsciiOffset = 64;
+        break;
+    case FASTQlogodds:
+        floor = 59; ceiling = 126;
+        rec->qualityAsciiOffset = 64;
+        break;
+    default:
+        return -1;
+    }
+
+    if ( size == 0 || buf[0] != '@' )
+        return -1;
+
+    /* tag line */
+    next = LineEnd ( buf, end, & eol );
+    if ( next == NULL )
+        return eof ? -1 : 0;
+    if ( ! ParsePlainTagLine ( pb, rec, buf, buf + 1, eol ) )
+        return -1;
+
+    /* bases */
+    line = next;
+    next = LineEnd ( line, end, & eol );
+    if ( next == NULL )
+        return eof ? -1 : 0;
+    if ( eol == line )
+        return -1;
+    for ( p = line; p < eol; ++p )
+    {
+        if ( ! IsBase ( *p ) )
+            return -1;
+    }
+    rec->readOffset = line - buf;
+    rec->readLength = eol - line;
+
+    /* '+' line, the rest of it is ignored */
+    line = next;
+    next = LineEnd ( line, end, & eol );
+    if ( next == NULL )
+        return eof ? -1 : 0;
+    if ( line[0] != '+' || memchr ( line, 0, next - line ) != NULL )
+        return -1;
+
+    /* qualities */
+    line = next;
+    next = LineEnd ( line, end, & eol );
+    if ( next == NULL )
+        return eof ? -1 : 0;
+    if ( eol == line )
+        return -1;
+    for ( p = line; p < eol; ++p )
+    {
+        if ( (uint8_t)*p < floor || (uint8_t)*p > ceiling )
+            return -1;
+    }
+    rec->qualityOffset = line - buf;
+    rec->qualityLength = eol - line;
+    *lines = 4;
+
+    /* empty lines belong to the record; it has to be followed by the next one or the end of input */
+    for ( p = next; p < end && ( *p == '\n' || ( *p == '\r' && p + 1 < end && p[1] == '\n' ) ); p += ( *p == '\n' ) ? 1 : 2 )
+        ++ *lines;
+    if ( p == end )
+    {
+        if ( ! eof )
+            return 0;
+    }
+    else if ( *p != '@' )
+        return -1;
+    else if ( p + 1 == end )
+    {   /* the grammar reports a lone '@' at the end of file together with the preceding end of line */
+        return eof ? -1 : 0;
+    }
+
+    *consumed = p - buf;
+    return 1;
+}
+
+/* parse the next record bypassing the scanner if it is a plain one; *parsed is false if the grammar has to be used */
+static rc_t FastqReaderFileParsePlainRecord ( FastqReaderFile* self, bool* parsed )
+{
+    rc_t rc;
+    FASTQParseBlock* pb = & self->pb;
+    PlainRecord rec;
+    const char* buf;
+    size_t size;
+    size_t consumed = 0;
+    size_t lines = 0;
+    bool eof = false;
+    int res;
+
+    *parsed = false;
+    if ( ! FASTQ_plain_records || self->reader == NULL || ! FASTQScan_at_record_start ( pb ) )
+        return 0;
+
+    if ( KLoaderFile_Read ( self->reader, 0, 0, (const void**) & buf, & size ) != 0 || buf == NULL )
+        return 0;
+    while ( true )
+    {
+        memset ( & rec, 0, sizeof rec );
+        rec.secondaryReadNumber = pb->secondaryReadNumber;
+        res = ParsePlainRecord ( pb, & rec, buf, size, eof, & consumed, & lines );
+        if ( res != 0 )
+            break;
+        {   /* the record continues past the end of the loader's buffer, refill it */
+            size_t length;
+            if ( KLoaderFile_Read ( self->reader, 0, size + 1, (const void**) & buf, & length ) != 0 )
+                return 0; /* does not fit into the buffer */
+            eof = length <= size;
+            if ( ! eof && KLoaderFile_Read ( self->reader, 0, 0, (const void**) & buf, & size ) != 0 )
+                return 0;
+        }
+    }
+    if ( res < 0 )
+        return 0;
+
+    {   /* the scanner would not see a record extending into a block with a 0 in it */
+        uint64_t start = self->recordPos + self->curPos;
+        uint64_t end = ( self->recordPos + consumed + FASTQ_INPUT_BLOCK - 1 ) / FASTQ_INPUT_BLOCK * FASTQ_INPUT_BLOCK;
+        if ( start < self->checkedEnd )
+            start = self->checkedEnd;
+        if ( start < end )
+        {
+            size_t length;
+            if ( KLoaderFile_Read ( self->reader, 0, end - self->recordPos, (const void**) & buf, & length ) != 0 )
+                return 0;
+            if ( end > self->recordPos + length ) /* end of file */
+                end = self->recordPos + length;
+            if ( start < end && memchr ( buf + ( start - self->recordPos ), 0, end - start ) != NULL )
+                return 0;
+            self->checkedEnd = end;
+        }
+    }
+
+    rc = KDataBufferResize ( & pb->record->source, consumed );
+    if ( rc != 0 )
+        return rc;
+    memmove ( pb->record->source.base, buf, consumed );
+
+    pb->length = consumed;
+    pb->spotNameOffset = rec.spotNameOffset;
+    pb->spotNameLength = rec.spotNameLength;
+    pb->spotGroupOffset = rec.spotGroupOffset;
+    pb->spotGroupLength = rec.spotGroupLength;
+    pb->readOffset = rec.readOffset;
+    pb->readLength = rec.readLength;
+    pb->qualityOffset = rec.qualityOffset;
+    pb->qualityLength = rec.qualityLength;
+    pb->qualityAsciiOffset = rec.qualityAsciiOffset;
+    pb->secondaryReadNumber = rec.secondaryReadNumber;
+    pb->expectedQualityLines = 1;
+    pb->record->seq.readnumber = rec.readNumber;
+    pb->record->seq.lowQuality = rec.lowQuality;
+    *parsed = true;
+
+    /* advance the record start pointer beyond the record, the scanner's read-ahead is dropped */
+    rc = KLoaderFile_Read( self->reader, consumed, 0, (const void**)& self->recordStart, & size);
+    if (rc != 0)
+        LogErr(klogErr, rc, "FastqReaderFileGetRecord failed");
+    self->recordPos += consumed;
+    self->curPos = 0;
+    self->lastEol = true;
+    FASTQScan_skip_record ( pb, lines );
+
+    return rc;
+}
+
 rc_t FastqReaderFileGetRecord ( const FastqReaderFile *f, const Record** result )
 {
     rc_t rc;
+    bool plain;
     FastqReaderFile* self = (FastqReaderFile*) f;
 
     if (self->pb.fatalError)
@@ -540,34 +1119,39 @@ rc_t FastqReaderFileGetRecord ( const FastqReaderFile *f, const Record** result
 
     FASTQ_ParseBlockInit( & self->pb );
 
-    if ( FASTQ_parse( & self->pb ) == 0 && self->pb.record->rej == 0 )
-    {   /* normal end of input */
-        RecordRelease((const Record*)self->pb.record);
-        *result = 0;
-        return 0;
-    }
-
-    /*TODO: remove? compensate for an artificially inserted trailing \n */
-    if ( self->eolInserted )
+    rc = FastqReaderFileParsePlainRecord( self, & plain );
+    if ( ! plain )
     {
-        -- self->pb.length;
-        self->eolInserted = false;
-    }
+        if ( FASTQ_parse( & self->pb ) == 0 && self->pb.record->rej == 0 )
+        {   /* normal end of input */
+            RecordRelease((const Record*)self->pb.record);
+            *result = 0;
+            return 0;
+        }
 
-    if (self->pb.record->rej != 0) /* had error(s) */
-    {   /* save the complete raw source in the Rejected object */
-        StringInit(& self->pb.record->rej->source, string_dup(self->recordStart, self->pb.length), self->pb.length, (uint32_t)self->pb.length);
-        self->pb.record->rej->fatal = self->pb.fatalError;
-    }
+        /*TODO: remove? compensate for an artificially inserted trailing \n */
+        if ( self->eolInserted )
+        {
+            -- self->pb.length;
+            self->eolInserted = false;
+        }
 
-    if (rc == 0 && self->reader != 0)
-    {
-        /* advance the record start pointer beyond the last token */
-        size_t length;
-        rc = KLoaderFile_Read( self->reader, self->pb.length, 0, (const void**)& self->recordStart, & length);
-        if (rc != 0)
-            LogErr(klogErr, rc, "FastqReaderFileGetRecord failed");
-        self->curPos -= self->pb.length;
+        if (self->pb.record->rej != 0) /* had error(s) */
+        {   /* save the complete raw source in the Rejected object */
+            StringInit(& self->pb.record->rej->source, string_dup(self->recordStart, self->pb.length), self->pb.length, (uint32_t)self->pb.length);
+            self->pb.record->rej->fatal = self->pb.fatalError;
+        }
+
+        if (rc == 0 && self->reader != 0)
+        {
+            /* advance the record start pointer beyond the last token */
+            size_t length;
+            rc = KLoaderFile_Read( self->reader, self->pb.length, 0, (const void**)& self->recordStart, & length);
+            if (rc != 0)
+                LogErr(klogErr, rc, "FastqReaderFileGetRecord failed");
+            self->curPos -= self->pb.length;
+            self->recordPos += self->pb.length;
+        }
     }
 
     StringInit( & self->pb.record->seq.spotname,    (const char*)self->pb.record->source.base + self->pb.spotNameOffset,    self->pb.spotNameLength, (uint32_t)self->pb.spotNameLength);
@@ -603,8 +1187,14 @@ size_t CC FASTQ_input(FASTQParseBlock* pb, char* buf, size_t max_size)
 {
     FastqReaderFile* self = (FastqReaderFile*)pb->self;
     size_t length;
+    rc_t rc;
+
+    /* keep the reads aligned to the blocks even after records parsed bypassing the scanner */
+    size_t left = FASTQ_INPUT_BLOCK - ( self->recordPos + self->curPos ) % FASTQ_INPUT_BLOCK;
+    if ( max_size > left )
+        max_size = left;
 
-    rc_t rc = KLoaderFile_Read( self->reader, 0, self->curPos + max_size, (const void**)& self->recordStart, & length);
+    rc = KLoaderFile_Read( self->reader, 0, self->curPos + max_size, (const void**)& self->recordStart, & length);
 
     if ( rc != 0 )
     {
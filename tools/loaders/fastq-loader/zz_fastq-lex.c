@@ -2867,6 +2867,32 @@ void CC FASTQScan_skip_to_eol(FASTQParseBlock* pb)
     }
 }
 
+bool CC FASTQScan_at_record_start(FASTQParseBlock* pb)
+{
+    struct yyguts_t* yyg = (struct yyguts_t*)pb->scanner;
+    /* TAG_LINE is left behind by the next record's '@' put back by the grammar */
+    return YY_START == INITIAL || YY_START == TAG_LINE;
+}
+
+void CC FASTQScan_skip_record(FASTQParseBlock* pb, size_t lines)
+{
+    struct yyguts_t* yyg = (struct yyguts_t*)pb->scanner;
+    if ( ! YY_CURRENT_BUFFER )
+    {   /* the scanner has not run yet */
+        yyensure_buffer_stack(pb->scanner);
+        YY_CURRENT_BUFFER_LVALUE = yy_create_buffer(yyin, YY_BUF_SIZE, pb->scanner);
+    }
+    else
+    {   /* the input will be read again starting from the next record */
+        yy_flush_buffer(YY_CURRENT_BUFFER, pb->scanner);
+    }
+    /* same state as after the grammar has parsed a record and put back the next record's '@' */
+    YY_CURRENT_BUFFER_LVALUE->yy_at_bol = 0;
+    BEGIN TAG_LINE;
+    yylineno += lines;
+    pb->column = 1;
+}
+
 void CC FASTQ_unlex(FASTQParseBlock* pb, FASTQToken* token)
 {
     size_t i;
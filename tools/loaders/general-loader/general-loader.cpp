@@ -34,6 +34,7 @@
 #include <kfs/directory.h>
 
 #include <general-writer/general-writer.h>
+#include <general-writer/gw-ring.hpp>
 
 using namespace std;
 
@@ -43,17 +44,54 @@ GeneralLoader::Reader::Reader( const struct KStream& p_input )
 :   m_input ( p_input ),
     m_buffer ( 0 ),
     m_bufSize ( 0 ),
-    m_readCount ( 0 )
+    m_readCount ( 0 ),
+    m_ring ( 0 ),
+    m_direct ( 0 ),
+    m_directSize ( 0 )
 {
     KStreamAddRef ( & m_input );
 }
 
 GeneralLoader::Reader::~Reader()
 {
+    delete m_ring;
     KStreamRelease ( & m_input );
     free ( m_buffer );
 }
 
+rc_t
+GeneralLoader::Reader::UseRing( const std::string& p_path )
+{
+    if ( m_ring != 0 )
+    {
+        return RC ( rcExe, rcFile, rcOpening, rcFile, rcExists );
+    }
+
+    try
+    {
+        m_ring = ncbi::GWRing::attach ( p_path );
+    }
+    catch ( const char* x )
+    {
+        pLogMsg ( klogErr, "general-loader: cannot attach to shared ring '$(p)': $(x)", "p=%s,x=%s", p_path . c_str (), x );
+        return RC ( rcExe, rcFile, rcOpening, rcFile, rcInvalid );
+    }
+
+    pLogMsg ( klogDebug, "general-loader: reading from shared ring '$(p)'", "p=%s", p_path . c_str () );
+    return 0;
+}
+
+void
+GeneralLoader::Reader::ReleaseDirect()
+{
+    if ( m_direct != 0 )
+    {
+        m_ring -> consume ( m_directSize );
+        m_direct = 0;
+        m_directSize = 0;
+    }
+}
+
 rc_t
 GeneralLoader::Reader::Read( void * p_buffer, size_t p_size )
 {
@@ -63,12 +101,56 @@ GeneralLoader::Reader::Read( void * p_buffer, size_t p_size )
              ( unsigned int ) p_size, m_readCount );
 
     m_readCount += p_size;
-    return KStreamReadExactly ( & m_input, p_buffer, p_size );
+    if ( m_ring == 0 )
+    {
+        return KStreamReadExactly ( & m_input, p_buffer, p_size );
+    }
+
+    ReleaseDirect ();
+    try
+    {
+        if ( ! m_ring -> read ( p_buffer, p_size ) )
+        {
+            return RC ( rcExe, rcFile, rcReading, rcTransfer, rcIncomplete );
+        }
+    }
+    catch ( const char* x )
+    {
+        pLogMsg ( klogErr, "general-loader: $(x)", "x=%s", x );
+        return RC ( rcExe, rcFile, rcReading, rcTransfer, rcCanceled );
+    }
+    return 0;
 }
 
 rc_t
 GeneralLoader::Reader::Read( size_t p_size )
 {
+    pLogMsg ( klogDebug, "general-loader: reading $(s) bytes", "s=%u", ( unsigned int ) p_size );
+
+    if ( m_ring != 0 )
+    {
+        ReleaseDirect ();
+        if ( p_size <= m_ring -> size () )
+        {   // hand out the bytes in place, without copying them out of the ring
+            try
+            {
+                m_direct = m_ring -> peek ( p_size );
+            }
+            catch ( const char* x )
+            {
+                pLogMsg ( klogErr, "general-loader: $(x)", "x=%s", x );
+                return RC ( rcExe, rcFile, rcReading, rcTransfer, rcCanceled );
+            }
+            if ( m_direct == 0 )
+            {
+                return RC ( rcExe, rcFile, rcReading, rcTransfer, rcIncomplete );
+            }
+            m_directSize = p_size;
+            m_readCount += p_size;
+            return 0;
+        }
+    }
+
     if ( p_size > m_bufSize )
     {
         m_buffer = realloc ( m_buffer, p_size );
@@ -80,7 +162,10 @@ GeneralLoader::Reader::Read( size_t p_size )
         }
     }
 
-    pLogMsg ( klogDebug, "general-loader: reading $(s) bytes", "s=%u", ( unsigned int ) p_size );
+    if ( m_ring != 0 )
+    {
+        return Read ( m_buffer, p_size );
+    }
 
     m_readCount += p_size;
     return KStreamReadExactly ( & m_input, m_buffer, p_size );
@@ -39,6 +39,11 @@ struct VDatabase;
 struct VDBManager;
 struct VSchema;
 
+namespace ncbi
+{
+    class GWRing;
+}
+
 #define GeneralLoaderSignatureString GW_SIGNATURE
 
 class GeneralLoader
@@ -74,17 +79,28 @@ private:
         // if rc == 0, there are p_size bytes available through GetBuffer until the next call to Read
         rc_t Read( size_t p_size ); 
         
-        const void* GetBuffer() const { return m_buffer; }
+        const void* GetBuffer() const { return m_direct != 0 ? m_direct : m_buffer; }
         
         void Align( uint8_t p_bytes = 4 );
         
         uint64_t GetReadCount() { return m_readCount; }
         
+        // continue reading from the shared-memory ring created by the writer ( evt_use_ring )
+        rc_t UseRing( const std::string& p_path );
+        
+    private:
+        // hand the bytes of the last in-place read back to the ring
+        void ReleaseDirect();
+        
     private:
         const struct KStream& m_input;
         void* m_buffer;
         size_t m_bufSize;
         uint64_t m_readCount;
+        
+        ncbi::GWRing* m_ring;
+        const void* m_direct;   // points into m_ring until the next Read
+        size_t m_directSize;
     };
     
     class DatabaseLoader
@@ -213,13 +229,31 @@ private:
         virtual rc_t ParseEvents ( Reader&, DatabaseLoader& );
         
     private:
-        // read p_dataSize bytes and use one of the decoder functions in utf8-like-int-codec.h to unpack a sequence of integer values, 
-        // stored in m_unpackingBuf as a collection of bytes
-        template < typename T_uintXX > rc_t UncompressInt ( Reader& p_reader, uint32_t p_dataSize, int ( * p_decode ) ( uint8_t const* buf_start, uint8_t const* buf_xend, T_uintXX* ret_decoded ) );
+        // cells of one column staged by evt_cell_batch until evt_next_rows
+        struct CellBatch
+        {
+            std::vector<uint8_t>    data;       // unpacked cell data, concatenated in row order
+            std::vector<size_t>     cellBytes;  // unpacked size of each cell
+        };
+        
+        // from ColumnId to CellBatch
+        typedef std::map < uint32_t, CellBatch > CellBatches;
+
+    private:
+        // use one of the decoder functions in utf8-like-int-codec.h to unpack a sequence of p_dataSize bytes of integer values, 
+        // appended to p_out as a collection of bytes
+        template < typename T_uintXX > rc_t UncompressInt ( const void* p_data, uint32_t p_dataSize, int ( * p_decode ) ( uint8_t const* buf_start, uint8_t const* buf_xend, T_uintXX* ret_decoded ), std::vector<uint8_t>& p_out );
+        
+        // unpack p_dataSize bytes of column data into p_out; returns a non-0 rc for unsupported element sizes
+        rc_t UnpackData ( const DatabaseLoader :: Column& p_col, const void* p_data, uint32_t p_dataSize, std::vector<uint8_t>& p_out );
         
         rc_t ParseData ( Reader& p_reader, DatabaseLoader& p_dbLoader, uint32_t p_columnId, uint32_t p_dataSize );
+        rc_t ParseCellBatch ( Reader& p_reader, DatabaseLoader& p_dbLoader, uint32_t p_columnId );
+        rc_t CommitRows ( DatabaseLoader& p_dbLoader, uint32_t p_tableId, uint32_t p_rowCount );
         
         std::vector<uint8_t>    m_unpackingBuf;
+        std::vector<uint32_t>   m_batchLens;
+        CellBatches             m_batches;
     };
     
 private:    
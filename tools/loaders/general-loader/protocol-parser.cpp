@@ -106,6 +106,27 @@ GeneralLoader :: UnpackedProtocolParser :: ParseEvents ( Reader& p_reader, Datab
             }
             break;
 
+        case evt_use_ring:
+            {
+                LogMsg ( klogDebug, "protocol-parser event: Use-Ring" );
+
+                gw_1string_evt_v1 evt;
+                rc = ReadEvent ( p_reader, evt );
+                if ( rc == 0 )
+                {
+                    size_t path_size = ncbi :: size ( evt );
+                    rc = p_reader . Read ( path_size );
+                    if ( rc == 0 )
+                    {
+                        string path ( ( const char * ) p_reader . GetBuffer (), path_size );
+                        // the padding was written to the pipe, before the switch
+                        p_reader . Align ();
+                        rc = p_reader . UseRing ( path );
+                    }
+                }
+            }
+            break;
+
         case evt_software_name:
             {
                 LogMsg ( klogDebug, "protocol-parser event: Software-Name" );
@@ -460,13 +481,12 @@ GeneralLoader :: UnpackedProtocolParser :: ParseEvents ( Reader& p_reader, Datab
 
 template < typename T_uintXX >
 rc_t
-GeneralLoader :: PackedProtocolParser :: UncompressInt (  Reader& p_reader, uint32_t p_dataSize, int (*p_decode) ( uint8_t const* buf_start, uint8_t const* buf_xend, T_uintXX* ret_decoded )  )
+GeneralLoader :: PackedProtocolParser :: UncompressInt ( const void* p_data, uint32_t p_dataSize, int (*p_decode) ( uint8_t const* buf_start, uint8_t const* buf_xend, T_uintXX* ret_decoded ), std::vector<uint8_t>& p_out )
 {
-    m_unpackingBuf . clear();
     // reserve enough for the best-packed case, when each element is represented with 1 byte
-    m_unpackingBuf . reserve ( sizeof ( T_uintXX ) * p_dataSize );
+    p_out . reserve ( p_out . size () + sizeof ( T_uintXX ) * p_dataSize );
 
-    const uint8_t* buf_begin = reinterpret_cast<const uint8_t*> ( p_reader . GetBuffer() );
+    const uint8_t* buf_begin = reinterpret_cast<const uint8_t*> ( p_data );
     const uint8_t* buf_end   = buf_begin + p_dataSize;
     while ( buf_begin < buf_end )
     {
@@ -480,7 +500,7 @@ GeneralLoader :: PackedProtocolParser :: UncompressInt (  Reader& p_reader, uint
 
         for ( size_t i = 0; i < sizeof ( T_uintXX ); ++i )
         {
-            m_unpackingBuf . push_back ( reinterpret_cast<const uint8_t*> ( & ret_decoded ) [ i ] );
+            p_out . push_back ( reinterpret_cast<const uint8_t*> ( & ret_decoded ) [ i ] );
         }
 
         buf_begin += numRead;
@@ -489,6 +509,23 @@ GeneralLoader :: PackedProtocolParser :: UncompressInt (  Reader& p_reader, uint
     return 0;
 }
 
+rc_t
+GeneralLoader :: PackedProtocolParser :: UnpackData ( const DatabaseLoader :: Column& p_col, const void* p_data, uint32_t p_dataSize, std::vector<uint8_t>& p_out )
+{
+    switch ( p_col . elemBits )
+    {
+    case 16:
+        return UncompressInt ( p_data, p_dataSize, decode_uint16, p_out );
+    case 32:
+        return UncompressInt ( p_data, p_dataSize, decode_uint32, p_out );
+    case 64:
+        return UncompressInt ( p_data, p_dataSize, decode_uint64, p_out );
+    default:
+        LogMsg ( klogErr, "protocol-parser: bad element size for packed integer" );
+        return RC ( rcExe, rcFile, rcReading, rcData, rcInvalid );
+    }
+}
+
 rc_t
 GeneralLoader :: PackedProtocolParser :: ParseData ( Reader& p_reader, DatabaseLoader& p_dbLoader, uint32_t p_columnId, uint32_t p_dataSize )
 {
@@ -501,22 +538,8 @@ GeneralLoader :: PackedProtocolParser :: ParseData ( Reader& p_reader, DatabaseL
         {
             if ( col -> IsCompressed () )
             {
-                switch ( col -> elemBits )
-                {
-                case 16:
-                    rc = UncompressInt ( p_reader, p_dataSize, decode_uint16 );
-                    break;
-                case 32:
-                    rc = UncompressInt ( p_reader, p_dataSize, decode_uint32 );
-                    break;
-                case 64:
-                    rc = UncompressInt ( p_reader, p_dataSize, decode_uint64 );
-                    break;
-                default:
-                    LogMsg ( klogErr, "protocol-parser: bad element size for packed integer" );
-                    rc = RC ( rcExe, rcFile, rcReading, rcData, rcInvalid );
-                    break;
-                }
+                m_unpackingBuf . clear();
+                rc = UnpackData ( * col, p_reader . GetBuffer (), p_dataSize, m_unpackingBuf );
                 if ( rc == 0 )
                 {
                     rc = p_dbLoader . CellData ( p_columnId, m_unpackingBuf . data(), m_unpackingBuf . size() * 8 / col -> elemBits );
@@ -535,6 +558,157 @@ GeneralLoader :: PackedProtocolParser :: ParseData ( Reader& p_reader, DatabaseL
     return rc;
 }
 
+rc_t
+GeneralLoader :: PackedProtocolParser :: ParseCellBatch ( Reader& p_reader, DatabaseLoader& p_dbLoader, uint32_t p_columnId )
+{
+    gwp_cell_batch_evt_v1 evt;
+    rc_t rc = ReadEvent ( p_reader, evt );
+    if ( rc != 0 )
+    {
+        return rc;
+    }
+
+    const DatabaseLoader :: Column* col = p_dbLoader . GetColumn ( p_columnId );
+    if ( col == 0 )
+    {
+        return RC ( rcExe, rcFile, rcReading, rcColumn, rcNotFound );
+    }
+
+    CellBatch & batch = m_batches [ p_columnId ];
+    if ( ! batch . cellBytes . empty () )
+    {
+        pLogMsg ( klogErr, "protocol-parser: second cell batch for column $(i) before rows are committed", "i=%u", p_columnId );
+        return RC ( rcExe, rcFile, rcReading, rcData, rcUnexpected );
+    }
+
+    // the length table
+    uint32_t cellCount = ncbi :: cell_count ( evt );
+    uint32_t lensSize = ncbi :: lens_size ( evt );
+    rc = p_reader . Read ( lensSize );
+    if ( rc != 0 )
+    {
+        return rc;
+    }
+
+    m_batchLens . clear ();
+    uint64_t total = 0;
+    const uint8_t* lens_begin = reinterpret_cast<const uint8_t*> ( p_reader . GetBuffer () );
+    const uint8_t* lens_end   = lens_begin + lensSize;
+    for ( uint32_t i = 0; i < cellCount; ++ i )
+    {
+        uint32_t len;
+        int numRead = decode_uint32 ( lens_begin, lens_end, & len );
+        if ( numRead <= 0 )
+        {
+            pLogMsg ( klogErr, "protocol-parser: decode_uint32() returned $(i) in cell batch", "i=%i", numRead );
+            return RC ( rcExe, rcFile, rcReading, rcData, rcCorrupt );
+        }
+        lens_begin += numRead;
+        m_batchLens . push_back ( len );
+        total += len;
+    }
+
+    uint32_t dataSize = ncbi :: data_size ( evt );
+    if ( lens_begin != lens_end || total != dataSize )
+    {
+        LogMsg ( klogErr, "protocol-parser: cell batch sizes do not match its data" );
+        return RC ( rcExe, rcFile, rcReading, rcData, rcCorrupt );
+    }
+
+    // the cells themselves
+    if ( dataSize != 0 )
+    {
+        rc = p_reader . Read ( dataSize );
+        if ( rc != 0 )
+        {
+            return rc;
+        }
+    }
+
+    batch . data . clear ();
+    batch . cellBytes . reserve ( cellCount );
+
+    const uint8_t* data = reinterpret_cast<const uint8_t*> ( p_reader . GetBuffer () );
+    if ( col -> IsCompressed () )
+    {
+        for ( uint32_t i = 0; i < cellCount; ++ i )
+        {
+            size_t before = batch . data . size ();
+            rc = UnpackData ( * col, data, m_batchLens [ i ], batch . data );
+            if ( rc != 0 )
+            {
+                batch . cellBytes . clear ();
+                return rc;
+            }
+            data += m_batchLens [ i ];
+            batch . cellBytes . push_back ( batch . data . size () - before );
+        }
+    }
+    else
+    {
+        batch . data . assign ( data, data + dataSize );
+        batch . cellBytes . assign ( m_batchLens . begin (), m_batchLens . end () );
+    }
+
+    return 0;
+}
+
+rc_t
+GeneralLoader :: PackedProtocolParser :: CommitRows ( DatabaseLoader& p_dbLoader, uint32_t p_tableId, uint32_t p_rowCount )
+{
+    // collect the batches staged for this table
+    std::vector < CellBatches :: iterator > staged;
+    for ( CellBatches :: iterator it = m_batches . begin (); it != m_batches . end (); ++ it )
+    {
+        if ( it -> second . cellBytes . empty () )
+        {
+            continue;
+        }
+        const DatabaseLoader :: Column* col = p_dbLoader . GetColumn ( it -> first );
+        if ( col == 0 || col -> tableId != p_tableId )
+        {
+            continue;
+        }
+        if ( it -> second . cellBytes . size () != p_rowCount )
+        {
+            pLogMsg ( klogErr,
+                      "protocol-parser: cell batch for column $(c) holds $(n) cells, $(r) rows committed",
+                      "c=%u,n=%lu,r=%u",
+                      it -> first, ( unsigned long ) it -> second . cellBytes . size (), p_rowCount );
+            return RC ( rcExe, rcFile, rcReading, rcData, rcInvalid );
+        }
+        staged . push_back ( it );
+    }
+
+    std::vector < size_t > offsets ( staged . size (), 0 );
+    rc_t rc = 0;
+    for ( uint32_t row = 0; rc == 0 && row < p_rowCount; ++ row )
+    {
+        for ( size_t i = 0; rc == 0 && i < staged . size (); ++ i )
+        {
+            uint32_t columnId = staged [ i ] -> first;
+            const CellBatch& batch = staged [ i ] -> second;
+            size_t bytes = batch . cellBytes [ row ];
+            const DatabaseLoader :: Column* col = p_dbLoader . GetColumn ( columnId );
+            // an empty cell is still written, unlike a missing one
+            rc = p_dbLoader . CellData ( columnId, batch . data . data () + offsets [ i ], bytes * 8 / col -> elemBits );
+            offsets [ i ] += bytes;
+        }
+        if ( rc == 0 )
+        {
+            rc = p_dbLoader . NextRow ( p_tableId );
+        }
+    }
+
+    for ( size_t i = 0; i < staged . size (); ++ i )
+    {
+        staged [ i ] -> second . data . clear ();
+        staged [ i ] -> second . cellBytes . clear ();
+    }
+
+    return rc;
+}
+
 rc_t
 GeneralLoader :: PackedProtocolParser :: ParseEvents( Reader& p_reader, DatabaseLoader& p_dbLoader )
 {
@@ -627,6 +801,24 @@ GeneralLoader :: PackedProtocolParser :: ParseEvents( Reader& p_reader, Database
             }
             break;
 
+        case evt_use_ring:
+            {
+                LogMsg ( klogDebug, "protocol-parser event: Use-Ring (packed)" );
+
+                gwp_1string_evt_U16_v1 evt;
+                rc = ReadEvent ( p_reader, evt );
+                if ( rc == 0 )
+                {
+                    size_t path_size = ncbi :: size ( evt );
+                    rc = p_reader . Read ( path_size );
+                    if ( rc == 0 )
+                    {
+                        rc = p_reader . UseRing ( string ( ( const char * ) p_reader . GetBuffer (), path_size ) );
+                    }
+                }
+            }
+            break;
+
         case evt_software_name:
             {
                 LogMsg ( klogDebug, "protocol-parser event: Software-Name (packed)" );
@@ -837,6 +1029,14 @@ GeneralLoader :: PackedProtocolParser :: ParseEvents( Reader& p_reader, Database
 
         case evt_end_stream:
             LogMsg ( klogDebug, "protocol-parser event: End-Stream (packed)" );
+            for ( CellBatches :: const_iterator it = m_batches . begin (); it != m_batches . end (); ++ it )
+            {
+                if ( ! it -> second . cellBytes . empty () )
+                {
+                    pLogMsg ( klogErr, "protocol-parser: cell batch for column $(i) was never committed", "i=%u", it -> first );
+                    return RC ( rcExe, rcFile, rcReading, rcData, rcIncomplete );
+                }
+            }
             return p_dbLoader . CloseStream ();
 
         case evt_cell_data:
@@ -937,6 +1137,28 @@ GeneralLoader :: PackedProtocolParser :: ParseEvents( Reader& p_reader, Database
             }
             break;
 
+        case evt_cell_batch:
+            {
+                uint32_t columnId = ncbi :: id ( evt_header );
+                pLogMsg ( klogDebug, "protocol-parser event: Cell-Batch (packed), id=$(i)", "i=%u", columnId );
+                rc = ParseCellBatch ( p_reader, p_dbLoader, columnId );
+            }
+            break;
+
+        case evt_next_rows:
+            {
+                uint32_t tableId = ncbi :: id ( evt_header );
+                pLogMsg ( klogDebug, "protocol-parser event: Next-Rows (packed), id=$(i)", "i=%u", tableId );
+
+                gwp_next_rows_evt_v1 evt;
+                rc = ReadEvent ( p_reader, evt );
+                if ( rc == 0 )
+                {
+                    rc = CommitRows ( p_dbLoader, tableId, ncbi :: get_nrows ( evt ) );
+                }
+            }
+            break;
+
         case evt_move_ahead:
             {
                 uint32_t tableId = ncbi :: id ( evt_header );
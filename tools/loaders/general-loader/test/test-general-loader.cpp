@@ -1416,6 +1416,97 @@ FIXTURE_TEST_CASE ( MultipleTables_Multiple_Columns_MultipleRows, GeneralLoaderF
     REQUIRE_EQ ( t2c2v2,    GetValue<uint8_t>   ( Table2, U8Column, 2 ) );
 }
 
+// batched cells ( packed only )
+
+FIXTURE_TEST_CASE ( CellBatch_OneColumn, GeneralLoaderFixture )
+{
+    if ( ! TestSource::packed )
+        return;
+
+    OpenStream_OneTableOneColumn ( GetName() );
+
+    vector < string > cells;
+    cells . push_back ( "first" );
+    cells . push_back ( "" );
+    cells . push_back ( "third value" );
+    m_source . CellBatchEvent ( DefaultColumnId, cells );
+    m_source . NextRowsEvent ( DefaultTableId, 3 );
+    m_source . CloseStreamEvent();
+
+    REQUIRE ( Run ( m_source . MakeSource (), 0 ) );
+
+    REQUIRE_EQ ( cells [ 0 ], GetValue<string> ( DefaultTable, DefaultColumn, 1 ) );
+    REQUIRE_EQ ( cells [ 1 ], GetValue<string> ( DefaultTable, DefaultColumn, 2 ) );
+    REQUIRE_EQ ( cells [ 2 ], GetValue<string> ( DefaultTable, DefaultColumn, 3 ) );
+    REQUIRE_THROW ( GetValue<string> ( DefaultTable, DefaultColumn, 4 ) );
+}
+
+FIXTURE_TEST_CASE ( CellBatch_MixedWithRowEvents, GeneralLoaderFixture )
+{
+    if ( ! TestSource::packed )
+        return;
+
+    SetUpStream_OneTable ( GetName() );
+
+    m_source . NewColumnEvent ( 1, DefaultTableId, DefaultColumn, 8 );
+    m_source . NewColumnEvent ( 2, DefaultTableId, U32Column, 32 );
+    m_source . OpenStreamEvent();
+
+    uint32_t value2 = 12345;
+    m_source . CellDefaultEvent( 2, value2 );
+
+    string value1 = "single row";
+    m_source . CellDataEvent( 1, value1 );
+    m_source . NextRowEvent ( DefaultTableId );
+
+    vector < string > cells;
+    cells . push_back ( "batched 1" );
+    cells . push_back ( "batched 2" );
+    m_source . CellBatchEvent ( 1, cells );
+    m_source . NextRowsEvent ( DefaultTableId, 2 );
+    m_source . CloseStreamEvent();
+
+    REQUIRE ( Run ( m_source . MakeSource (), 0 ) );
+
+    REQUIRE_EQ ( value1,      GetValue<string>    ( DefaultTable, DefaultColumn, 1 ) );
+    REQUIRE_EQ ( cells [ 0 ], GetValue<string>    ( DefaultTable, DefaultColumn, 2 ) );
+    REQUIRE_EQ ( cells [ 1 ], GetValue<string>    ( DefaultTable, DefaultColumn, 3 ) );
+    REQUIRE_EQ ( value2,      GetValue<uint32_t>  ( DefaultTable, U32Column, 3 ) );
+}
+
+FIXTURE_TEST_CASE ( CellBatch_RowCountMismatch, GeneralLoaderFixture )
+{
+    if ( ! TestSource::packed )
+        return;
+
+    OpenStream_OneTableOneColumn ( GetName() );
+
+    vector < string > cells;
+    cells . push_back ( "a" );
+    cells . push_back ( "b" );
+    cells . push_back ( "c" );
+    m_source . CellBatchEvent ( DefaultColumnId, cells );
+    m_source . NextRowsEvent ( DefaultTableId, 2 );
+    m_source . CloseStreamEvent();
+
+    REQUIRE ( Run ( m_source . MakeSource (), SILENT_RC ( rcExe, rcFile, rcReading, rcData, rcInvalid ) ) );
+}
+
+FIXTURE_TEST_CASE ( CellBatch_NoCommit, GeneralLoaderFixture )
+{
+    if ( ! TestSource::packed )
+        return;
+
+    OpenStream_OneTableOneColumn ( GetName() );
+
+    vector < string > cells;
+    cells . push_back ( "never committed" );
+    m_source . CellBatchEvent ( DefaultColumnId, cells );
+    m_source . CloseStreamEvent();
+
+    REQUIRE ( Run ( m_source . MakeSource (), SILENT_RC ( rcExe, rcFile, rcReading, rcData, rcIncomplete ) ) );
+}
+
 FIXTURE_TEST_CASE ( AdditionalSchemaIncludePaths_Single, GeneralLoaderFixture )
 {
     string schemaPath = "schema";
@@ -33,6 +33,7 @@
 #include "../../tools/loaders/general-loader/general-loader.hpp"
 
 #include <kfs/ramfile.h>
+#include <general-writer/utf8-like-int-codec.h>
 
 #include <sysalloc.h>
 
@@ -441,6 +442,28 @@ TestSource::Buffer::WritePacked ( const TestSource::Event& p_event )
         }
         break;
         
+    case evt_cell_batch:
+        {
+            gwp_cell_batch_evt_v1 hdr;
+            init ( hdr, p_event . m_id1, p_event . m_event );
+            set_cell_count ( hdr, p_event . m_uint32 );
+            set_lens_size ( hdr, ( uint32_t ) p_event . m_str1 . size () );
+            set_data_size ( hdr, ( uint32_t ) p_event . m_val . size () );
+            Write ( & hdr, sizeof hdr );
+            Write ( p_event . m_str1 . data (), p_event . m_str1 . size () );
+            Write ( p_event . m_val . data (), p_event . m_val . size () );
+        }
+        break;
+        
+    case evt_next_rows:
+        {
+            gwp_next_rows_evt_v1 hdr;
+            init ( hdr, p_event . m_id1, p_event . m_event );
+            set_nrows ( hdr, ( uint32_t ) p_event . m_uint64 );
+            Write ( & hdr, sizeof hdr );
+        }
+        break;
+        
     default:
         throw logic_error ( "TestSource::Buffer::WritePacked: event not implemented" );
     }
@@ -558,6 +581,29 @@ TestSource::MoveAheadEvent ( TableId p_id, uint64_t p_count )
     m_buffer -> Write ( Event ( evt_move_ahead, p_id, p_count ) );
 }
 
+void 
+TestSource::CellBatchEvent ( ColumnId p_columnId, const vector < string >& p_cells )
+{
+    string data;
+    string lens;
+    for ( size_t i = 0; i != p_cells . size (); ++i )
+    {
+        uint8_t buf [ 8 ];
+        int bytes = encode_uint32 ( ( uint32_t ) p_cells [ i ] . size (), buf, buf + sizeof buf );
+        lens . append ( ( const char * ) buf, bytes );
+        data += p_cells [ i ];
+    }
+    Event evt ( evt_cell_batch, p_columnId, ( uint32_t ) p_cells . size (), ( uint32_t ) data . size (), data . data () );
+    evt . m_str1 = lens;
+    m_buffer -> Write ( evt );
+}
+
+void 
+TestSource::NextRowsEvent ( TableId p_id, uint32_t p_count )
+{
+    m_buffer -> Write ( Event ( evt_next_rows, p_id, ( uint64_t ) p_count ) );
+}
+
 template<> void TestSource::CellDataEvent ( ColumnId p_columnId, string p_value )
 {
     m_buffer -> Write ( Event ( evt_cell_data, p_columnId, ( uint32_t ) p_value . size(), ( uint32_t ) p_value . size(), p_value . c_str() ) );
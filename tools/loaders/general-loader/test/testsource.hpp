@@ -86,6 +86,8 @@ public:
     void CloseStreamEvent ();
     void NextRowEvent ( TableId p_id );
     void MoveAheadEvent ( TableId p_id, uint64_t p_count );
+    void CellBatchEvent ( ColumnId p_columnId, const std :: vector < std :: string >& p_cells ); // packed only
+    void NextRowsEvent ( TableId p_id, uint32_t p_count ); // packed only
     void CellDefaultEvent ( ColumnId p_columnId, const std :: string& p_value );
     void CellDefaultEvent ( ColumnId p_columnId, uint32_t p_value );
     void CellDefaultEvent ( ColumnId p_columnId, bool p_value );
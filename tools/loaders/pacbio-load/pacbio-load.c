@@ -58,6 +58,9 @@
 
 #include <kfs/arrayfile.h>
 
+#include <kproc/thread.h>
+#include <atomic32.h>
+
 #include <loader/loader-meta.h>
 
 #include <sysalloc.h>
@@ -236,63 +239,184 @@ typedef struct seq_con_pas_met
     con_ctx consensus;      /* from pl-consensus.h */
     pas_ctx passes;         /* from pl-passes.h */
     met_ctx metrics;        /* from pl-metrics.h */
+
+    /* the tables are loaded concurrently, each one but SEQUENCE needs its own progressbar */
+    ld_context con_lctx;
+    ld_context pas_lctx;
+    ld_context met_lctx;
 } seq_con_pas_met;
 
 
+enum { tab_sequence = 0, tab_consensus, tab_passes, tab_metrics, tab_count };
+
+
+/* gives a table its own copy of the load-context:
+   the text-progressbar is shown only for the first table loaded */
+static ld_context * pacbio_table_lctx( ld_context * dst, const ld_context * lctx, bool with_progress )
+{
+    *dst = *lctx;
+    dst->xml_progress = NULL;
+    dst->with_progress = with_progress;
+    return dst;
+}
+
+
 /* we have to pass in the first hdf5-source, because prepare of sequences needs it */
-static rc_t pacbio_prepare( VDatabase * database, seq_con_pas_met * dst, KDirectory * first_src, ld_context *lctx )
+static rc_t pacbio_prepare( context * ctx, VDatabase * database, seq_con_pas_met * dst,
+                            KDirectory * first_src, ld_context *lctx )
 {
     rc_t rc;
+    bool with_progress = lctx->with_progress && !ctx_ld_sequence( ctx );
 
     dst->sequence.cursor = NULL;
     dst->consensus.cursor = NULL;
     dst->passes.cursor = NULL;
     dst->metrics.cursor = NULL;
 
+    pacbio_table_lctx( &dst->con_lctx, lctx, with_progress );
+    with_progress = with_progress && !ctx_ld_consensus( ctx );
+    pacbio_table_lctx( &dst->pas_lctx, lctx, with_progress );
+    with_progress = with_progress && !ctx_ld_passes( ctx );
+    pacbio_table_lctx( &dst->met_lctx, lctx, with_progress );
+
     rc = prepare_seq( database, &dst->sequence, first_src, lctx ); /* pl-sequence.c */
     if ( rc == 0 )
-        rc = prepare_consensus( database, &dst->consensus, lctx ); /* pl-consensus.c */
+        rc = prepare_consensus( database, &dst->consensus, &dst->con_lctx ); /* pl-consensus.c */
     if ( rc == 0 )
-        rc = prepare_passes( database, &dst->passes, lctx ); /* pl-passes.c */
+        rc = prepare_passes( database, &dst->passes, &dst->pas_lctx ); /* pl-passes.c */
     if ( rc == 0 )
-        rc = prepare_metrics( database, &dst->metrics, lctx ); /* pl-metrics.c */
+        rc = prepare_metrics( database, &dst->metrics, &dst->met_lctx ); /* pl-metrics.c */
     return rc;
 }
 
 
-static rc_t pacbio_load_src( context *ctx, seq_con_pas_met * dst, KDirectory * src, bool * consensus_present )
+/* one table of the current hdf5-source, loaded on its own thread */
+typedef struct table_job
+{
+    seq_con_pas_met * dst;
+    KDirectory * src;
+    KThread * thread;
+    uint32_t tab;
+    rc_t rc;
+    bool wanted;
+} table_job;
+
+
+static rc_t pacbio_load_table( table_job * job )
+{
+    switch( job->tab )
+    {
+        case tab_sequence  : return load_seq_src( &job->dst->sequence, job->src ); /* pl-sequence.c */
+        case tab_consensus : return load_consensus_src( &job->dst->consensus, job->src ); /* pl-consensus.c */
+        case tab_passes    : return load_passes_src( &job->dst->passes, job->src ); /* pl-passes.c */
+        case tab_metrics   : return load_metrics_src( &job->dst->metrics, job->src ); /* pl-metrics.c */
+    }
+    return RC( rcExe, rcNoTarg, rcLoading, rcParam, rcInvalid );
+}
+
+
+static rc_t CC pacbio_table_thread( const KThread * self, void * data )
 {
-    rc_t rc1, rc = 0;
+    table_job * job = ( table_job * ) data;
+    job->rc = pacbio_load_table( job );
+    return job->rc;
+}
 
-    if ( ctx_ld_sequence( ctx ) )
-        rc = load_seq_src( &dst->sequence, src ); /* pl-sequence.c */
 
-    if ( rc == 0 && ctx_ld_consensus( ctx ) )
+/* starts loading the table on a thread of its own, or loads it here if no thread can be made */
+static void pacbio_table_start( table_job * job )
+{
+    if ( job->wanted &&
+         KThreadMake ( &job->thread, pacbio_table_thread, job ) != 0 )
     {
-        rc1 = load_consensus_src( &dst->consensus, src ); /* pl-consensus.c */
-        if ( rc1 == 0 )
-            *consensus_present = true;
-        else
-            LOGMSG( klogWarn, "the consensus-group is missing" );
+        job->thread = NULL;
+        job->rc = pacbio_load_table( job );
     }
+}
 
-    if ( rc == 0 && ctx_ld_passes( ctx ) && *consensus_present )
+
+static void pacbio_table_wait( table_job * job )
+{
+    if ( job->thread != NULL )
     {
-        rc1 = load_passes_src( &dst->passes, src ); /* pl-passes.c */
-        if ( rc1 != 0 )
-            LOGMSG( klogWarn, "the passes-table is missing" );
+        rc_t status;
+        KThreadWait ( job->thread, &status );
+        KThreadRelease ( job->thread );
+        job->thread = NULL;
     }
+}
+
+
+static void pacbio_table_run( table_job * job )
+{
+    if ( job->wanted )
+        job->rc = pacbio_load_table( job );
+}
+
+
+/* every table has its own cursor and reads its own hdf5-datasets,
+   they are loaded concurrently taking turns on the hdf5-library ( pl_lock ):
+   SEQUENCE on a thread of its own while CONSENSUS is loaded, then, if the
+   consensus-group has been loaded, PASSES and METRICS while SEQUENCE still loads */
+static rc_t pacbio_load_src( context *ctx, seq_con_pas_met * dst, KDirectory * src, bool * consensus_present )
+{
+    rc_t rc = 0;
+    table_job jobs[ tab_count ];
+    uint32_t idx;
 
-    if ( rc == 0 && ctx_ld_metrics( ctx ) && *consensus_present )
+    memset( jobs, 0, sizeof jobs );
+    for ( idx = 0; idx < tab_count; ++idx )
     {
-        rc1 = load_metrics_src( &dst->metrics, src ); /* pl-metrics.c */
-        if ( rc1 != 0 )
-            LOGMSG( klogWarn, "the metrics-table is missing" );
+        jobs[ idx ].dst = dst;
+        jobs[ idx ].src = src;
+        jobs[ idx ].tab = idx;
     }
+
+    jobs[ tab_sequence ].wanted = ctx_ld_sequence( ctx );
+    jobs[ tab_consensus ].wanted = ctx_ld_consensus( ctx );
+    pacbio_table_start( &jobs[ tab_sequence ] );
+    pacbio_table_run( &jobs[ tab_consensus ] );
+
+    if ( jobs[ tab_consensus ].wanted && jobs[ tab_consensus ].rc == 0 )
+        *consensus_present = true;
+
+    /* passes and metrics are loaded only if a consensus-group has been loaded */
+    jobs[ tab_passes ].wanted = ctx_ld_passes( ctx ) && *consensus_present;
+    jobs[ tab_metrics ].wanted = ctx_ld_metrics( ctx ) && *consensus_present;
+    pacbio_table_start( &jobs[ tab_passes ] );
+    pacbio_table_run( &jobs[ tab_metrics ] );
+
+    pacbio_table_wait( &jobs[ tab_passes ] );
+    pacbio_table_wait( &jobs[ tab_sequence ] );
+
+    if ( jobs[ tab_sequence ].wanted )
+        rc = jobs[ tab_sequence ].rc;
+
+    if ( rc == 0 && jobs[ tab_consensus ].wanted && jobs[ tab_consensus ].rc != 0 )
+        LOGMSG( klogWarn, "the consensus-group is missing" );
+
+    if ( rc == 0 && jobs[ tab_passes ].wanted && jobs[ tab_passes ].rc != 0 )
+        LOGMSG( klogWarn, "the passes-table is missing" );
+
+    if ( rc == 0 && jobs[ tab_metrics ].wanted && jobs[ tab_metrics ].rc != 0 )
+        LOGMSG( klogWarn, "the metrics-table is missing" );
+
     return rc;
 }
 
 
+static void pacbio_release_progress( ld_context * lctx )
+{
+    pl_lock_acquire();
+    if ( lctx->xml_progress != NULL )
+    {
+        KLoadProgressbar_Release( lctx->xml_progress, false );
+        lctx->xml_progress = NULL;
+    }
+    pl_lock_unlock();
+}
+
+
 static rc_t pacbio_finish( seq_con_pas_met * dst )
 {
     rc_t rc = finish_seq( &dst->sequence ); /* pl-sequence.c */
@@ -302,6 +426,9 @@ static rc_t pacbio_finish( seq_con_pas_met * dst )
         rc = finish_passes( &dst->passes ); /* pl-passes.c */
     if ( rc == 0 )
         rc = finish_metrics( &dst->metrics ); /* pl-metrics.c */
+    pacbio_release_progress( &dst->con_lctx );
+    pacbio_release_progress( &dst->pas_lctx );
+    pacbio_release_progress( &dst->met_lctx );
     return rc;
 }
 
@@ -367,6 +494,107 @@ static rc_t pacbio_get_MultiParts( KDirectory * hdf5_src, VNamelist * parts )
 }
 
 
+/* the next part of a multipart-input is opened on a thread of its own,
+   the start of its raw file is read ahead into the OS-cache while the current part is loaded:
+   no more than PREFETCH_LIMIT, so that the pages of the current part are not evicted,
+   and only until the current part is done */
+#define PREFETCH_BLOCK_SIZE ( 4 * 1024 * 1024 )
+#define PREFETCH_LIMIT ( 256 * 1024 * 1024 )
+
+typedef struct part_prefetch
+{
+    KDirectory * wd;
+    const VNamelist * path_list;
+    KDirectory * hdf5_src;
+    KThread * thread;
+    atomic32_t stop;    /* set when the current part is loaded */
+    uint32_t idx;
+    rc_t rc;
+} part_prefetch;
+
+
+/* returns the number of bytes read */
+static uint64_t pacbio_read_ahead( KDirectory * wd, const char * path, uint64_t limit, atomic32_t * stop )
+{
+    uint64_t pos = 0;
+    const KFile * f;
+    if ( KDirectoryOpenFileRead ( wd, &f, "%s", path ) == 0 )
+    {
+        char * buffer = ( char * )malloc( PREFETCH_BLOCK_SIZE );
+        if ( buffer != NULL )
+        {
+            size_t num_read;
+            while ( pos < limit && atomic32_read ( stop ) == 0 )
+            {
+                size_t to_read = PREFETCH_BLOCK_SIZE;
+                if ( limit - pos < to_read )
+                    to_read = ( size_t )( limit - pos );
+                if ( KFileReadAll ( f, pos, buffer, to_read, &num_read ) != 0 || num_read == 0 )
+                    break;
+                pos += num_read;
+            }
+            free( buffer );
+        }
+        KFileRelease( f );
+    }
+    return pos;
+}
+
+
+static rc_t pacbio_prefetch_part( part_prefetch * pf )
+{
+    pl_lock_acquire();
+    pf->rc = pacbio_get_hdf5_src( pf->wd, pf->path_list, pf->idx, &pf->hdf5_src );
+    pl_lock_unlock();
+    if ( pf->rc == 0 )
+    {
+        const char * src_path;
+        if ( VNameListGet ( pf->path_list, pf->idx, &src_path ) == 0 && src_path != NULL )
+            pacbio_read_ahead( pf->wd, src_path, PREFETCH_LIMIT, &pf->stop );
+    }
+    return pf->rc;
+}
+
+
+static rc_t CC pacbio_prefetch_thread( const KThread * self, void * data )
+{
+    return pacbio_prefetch_part( ( part_prefetch * ) data );
+}
+
+
+static void pacbio_prefetch_start( part_prefetch * pf, KDirectory * wd,
+                                   const VNamelist * path_list, uint32_t idx )
+{
+    pf->wd = wd;
+    pf->path_list = path_list;
+    pf->hdf5_src = NULL;
+    pf->idx = idx;
+    pf->rc = 0;
+    atomic32_set ( &pf->stop, 0 );
+    if ( KThreadMake ( &pf->thread, pacbio_prefetch_thread, pf ) != 0 )
+        pf->thread = NULL;
+}
+
+
+/* waits for the prefetch, or opens the part here if no thread could be made */
+static rc_t pacbio_prefetch_finish( part_prefetch * pf, KDirectory ** hdf5_src )
+{
+    /* the part is about to be loaded, reading it ahead is of no use any more */
+    atomic32_set ( &pf->stop, 1 );
+    if ( pf->thread != NULL )
+    {
+        rc_t status;
+        KThreadWait ( pf->thread, &status );
+        KThreadRelease ( pf->thread );
+        pf->thread = NULL;
+    }
+    else
+        pacbio_prefetch_part( pf );
+    *hdf5_src = pf->hdf5_src;
+    return pf->rc;
+}
+
+
 static rc_t pacbio_load_multipart( context * ctx, KDirectory * wd, VDatabase * database,
                                    KDirectory ** hdf5_src, bool * consensus_present,
                                    ld_context * lctx, uint32_t count )
@@ -374,19 +602,41 @@ static rc_t pacbio_load_multipart( context * ctx, KDirectory * wd, VDatabase * d
     seq_con_pas_met dst;
     uint32_t idx = 0;
     /* the loop is complicated, because pacbio_prepare needs the first hdf5-src opened ! */
-    rc_t rc = pacbio_prepare( database, &dst, *hdf5_src, lctx );
+    rc_t rc = pl_lock_make();
+    if ( rc != 0 )
+    {
+        KDirectoryRelease ( *hdf5_src );
+        return rc;
+    }
+    rc = pacbio_prepare( ctx, database, &dst, *hdf5_src, lctx );
     while ( idx < count && rc == 0 )
     {
+        part_prefetch next = { NULL };
+        if ( idx + 1 < count )
+            pacbio_prefetch_start( &next, wd, ctx->src_paths, idx + 1 );
+
         rc = pacbio_load_src( ctx, &dst, *hdf5_src, consensus_present );
         idx++;
-        if ( rc == 0 && idx < count )
+        if ( idx < count )
         {
+            /* the prefetch-thread may be in the hdf5-library right now */
+            pl_lock_acquire();
             KDirectoryRelease ( *hdf5_src );
-            rc = pacbio_get_hdf5_src( wd, ctx->src_paths, idx, hdf5_src );
+            pl_lock_unlock();
+            *hdf5_src = NULL;
+
+            /* a running prefetch has to be waited for even after an error */
+            if ( rc == 0 || next.thread != NULL )
+            {
+                rc_t rc1 = pacbio_prefetch_finish( &next, hdf5_src );
+                if ( rc == 0 )
+                    rc = rc1;
+            }
         }
     }
     pacbio_finish( &dst );
     KDirectoryRelease ( *hdf5_src );
+    pl_lock_release();
     return rc;
 }
 
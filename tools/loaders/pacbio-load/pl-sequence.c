@@ -658,7 +658,9 @@ static rc_t seq_loader( ld_context *lctx, KDirectory * hdf5_src, VCursor * curso
                 const KNamelist *region_types;
                 /* read the meta-data-entry "RegionTypes" of the hdf5-regions-table
                    into a KNamelist */
+                pl_lock_acquire();
                 rc = KArrayFileGetMeta ( BaseCallsTab.rgn.hdf5_regions.af, "RegionTypes", &region_types );
+                pl_lock_unlock();
                 if ( rc != 0 )
                 {
                     LOGERR( klogErr, rc, "cannot read Regions.RegionTypes" );
@@ -865,7 +867,9 @@ rc_t load_seq_src( seq_ctx * sctx, KDirectory * hdf5_src )
                 const KNamelist *region_types;
                 /* read the meta-data-entry "RegionTypes" of the hdf5-regions-table
                    into a KNamelist */
+                pl_lock_acquire();
                 rc = KArrayFileGetMeta ( sctx->BaseCallsTab.rgn.hdf5_regions.af, "RegionTypes", &region_types );
+                pl_lock_unlock();
                 if ( rc != 0 )
                 {
                     LOGERR( klogErr, rc, "cannot read Regions.RegionTypes" );
@@ -34,6 +34,7 @@
 #include <kdb/database.h>
 #include <vdb/database.h>
 #include <vdb/vdb-priv.h>
+#include <kproc/lock.h>
 
 void lctx_init( ld_context * lctx )
 {
@@ -63,6 +64,45 @@ void lctx_free( ld_context * lctx )
 }
 
 
+static KLock * pl_lock = NULL;
+
+rc_t pl_lock_make( void )
+{
+    rc_t rc = 0;
+    if ( pl_lock == NULL )
+    {
+        rc = KLockMake ( &pl_lock );
+        if ( rc != 0 )
+            LOGERR( klogErr, rc, "cannot make lock" );
+    }
+    return rc;
+}
+
+
+void pl_lock_release( void )
+{
+    if ( pl_lock != NULL )
+    {
+        KLockRelease ( pl_lock );
+        pl_lock = NULL;
+    }
+}
+
+
+void pl_lock_acquire( void )
+{
+    if ( pl_lock != NULL )
+        KLockAcquire ( pl_lock );
+}
+
+
+void pl_lock_unlock( void )
+{
+    if ( pl_lock != NULL )
+        KLockUnlock ( pl_lock );
+}
+
+
 rc_t check_src_objects( const KDirectory *hdf5_dir,
                         const char ** groups, 
                         const char **tables,
@@ -76,7 +116,9 @@ rc_t check_src_objects( const KDirectory *hdf5_dir,
     {
         while ( groups[ idx ] != NULL && rc == 0 )
         {
+            pl_lock_acquire();
             pt = KDirectoryPathType ( hdf5_dir, "%s", groups[idx] );
+            pl_lock_unlock();
             if ( pt != kptDir )
             {
                 rc = RC( rcExe, rcNoTarg, rcAllocating, rcParam, rcInvalid );
@@ -97,7 +139,9 @@ rc_t check_src_objects( const KDirectory *hdf5_dir,
     {
         while ( tables[ idx ] != NULL && rc == 0 )
         {
+            pl_lock_acquire();
             pt = KDirectoryPathType ( hdf5_dir, "%s", tables[idx] );
+            pl_lock_unlock();
             if ( pt != kptDataset )
             {
                 rc = RC( rcExe, rcNoTarg, rcAllocating, rcParam, rcInvalid );
@@ -127,7 +171,7 @@ void init_array_file( af_data * af )
 }
 
 
-void free_array_file( af_data * af )
+static void free_array_file_intern( af_data * af )
 {
     if ( af->af != NULL )
     {
@@ -152,6 +196,14 @@ void free_array_file( af_data * af )
 }
 
 
+void free_array_file( af_data * af )
+{
+    pl_lock_acquire();
+    free_array_file_intern( af );
+    pl_lock_unlock();
+}
+
+
 static rc_t read_cache_content( af_data * af )
 {
     rc_t rc = 0;
@@ -185,14 +237,14 @@ static rc_t read_cache_content( af_data * af )
 }
 
 
-rc_t open_array_file( const KDirectory *dir,
-                      const char *name,
-                      af_data * af,
-                      const uint64_t expected_element_bits,
-                      const uint64_t expected_cols,
-                      bool disp_wrong_bitsize,
-                      bool cache_content,
-                      bool supress_err_msg )
+static rc_t open_array_file_intern( const KDirectory *dir,
+                                    const char *name,
+                                    af_data * af,
+                                    const uint64_t expected_element_bits,
+                                    const uint64_t expected_cols,
+                                    bool disp_wrong_bitsize,
+                                    bool cache_content,
+                                    bool supress_err_msg )
 {
     rc_t rc;
 
@@ -215,7 +267,7 @@ rc_t open_array_file( const KDirectory *dir,
     {
         PLOGERR( klogErr, ( klogErr, rc, "cannot open hdf5-arrayfile '$(name)'",
                             "name=%s", name ) );
-        free_array_file( af );
+        free_array_file_intern( af );
         return rc;
     }
     /* detect the dimensionality of the array-file */
@@ -224,7 +276,7 @@ rc_t open_array_file( const KDirectory *dir,
     {
         PLOGERR( klogErr, ( klogErr, rc, "cannot retrieve dimensionality on '$(name)'",
                             "name=%s", name ) );
-        free_array_file( af );
+        free_array_file_intern( af );
         return rc;
     }
     /* make a array to hold the extent in every dimension */
@@ -234,7 +286,7 @@ rc_t open_array_file( const KDirectory *dir,
         rc = RC ( rcApp, rcArgv, rcAccessing, rcMemory, rcExhausted );
         PLOGERR( klogErr, ( klogErr, rc, "cannot allocate enough memory for extents of '$(name)'",
                             "name=%s", name ) );
-        free_array_file( af );
+        free_array_file_intern( af );
         return rc;
     }
     /* read the actuall extents into the created array */
@@ -243,7 +295,7 @@ rc_t open_array_file( const KDirectory *dir,
     {
         PLOGERR( klogErr, ( klogErr, rc, "cannot retrieve extents of '$(name)'",
                             "name=%s", name ) );
-        free_array_file( af );
+        free_array_file_intern( af );
         return rc;
     }
     /* request the size of the element in bits */
@@ -252,7 +304,7 @@ rc_t open_array_file( const KDirectory *dir,
     {
         PLOGERR( klogErr, ( klogErr, rc, "cannot retrieve element-size of '$(name)'",
                             "name=%s", name ) );
-        free_array_file( af );
+        free_array_file_intern( af );
         return rc;
     }
     /* compare the discovered bit-size with the expected one */
@@ -267,7 +319,7 @@ rc_t open_array_file( const KDirectory *dir,
             PLOGERR( klogErr, ( klogErr, rc, "unexpected element-bits of $(bsize) in '$(name)'",
                      "bsize=%lu,name=%s", af->element_bits, name ) );
 
-        free_array_file( af );
+        free_array_file_intern( af );
         return rc;
     }
 
@@ -280,7 +332,7 @@ rc_t open_array_file( const KDirectory *dir,
             rc = RC ( rcExe, rcNoTarg, rcLoading, rcData, rcInconsistent );
             PLOGERR( klogErr, ( klogErr, rc, "unexpected dimensionality of $(dim) in '$(name)'",
                                 "dim=%lu,name=%s", af->dimensionality, name ) );
-            free_array_file( af );
+            free_array_file_intern( af );
             return rc;
         }
     }
@@ -292,7 +344,7 @@ rc_t open_array_file( const KDirectory *dir,
             rc = RC ( rcExe, rcNoTarg, rcLoading, rcData, rcInconsistent );
             PLOGERR( klogErr, ( klogErr, rc, "unexpected dimensionality of $(dim) in '$(name)'",
                                 "dim=%lu,name=%s", af->dimensionality, name ) );
-            free_array_file( af );
+            free_array_file_intern( af );
             return rc;
         }
         else
@@ -302,7 +354,7 @@ rc_t open_array_file( const KDirectory *dir,
                 rc = RC ( rcExe, rcNoTarg, rcLoading, rcData, rcInconsistent );
                 PLOGERR( klogErr, ( klogErr, rc, "unexpected extent[1] of $(ext) in '$(name)'",
                                     "ext=%lu,name=%s", af->extents[ 1 ], name ) );
-                free_array_file( af );
+                free_array_file_intern( af );
                 return rc;
             }
         }
@@ -315,6 +367,24 @@ rc_t open_array_file( const KDirectory *dir,
 }
 
 
+rc_t open_array_file( const KDirectory *dir,
+                      const char *name,
+                      af_data * af,
+                      const uint64_t expected_element_bits,
+                      const uint64_t expected_cols,
+                      bool disp_wrong_bitsize,
+                      bool cache_content,
+                      bool supress_err_msg )
+{
+    rc_t rc;
+    pl_lock_acquire();
+    rc = open_array_file_intern( dir, name, af, expected_element_bits, expected_cols,
+                                 disp_wrong_bitsize, cache_content, supress_err_msg );
+    pl_lock_unlock();
+    return rc;
+}
+
+
 /* assembles the 'absolute' path to the requested array-file before opening it */
 rc_t open_element( const KDirectory *hdf5_dir, 
                    af_data *element, 
@@ -350,7 +420,11 @@ rc_t array_file_read_dim1( af_data * af, const uint64_t pos,
 {
     rc_t rc = 0;
     if ( af->content == NULL )
+    {
+        pl_lock_acquire();
         rc = KArrayFileRead ( af->af, 1, &pos, dst, &count, n_read );
+        pl_lock_unlock();
+    }
     else
     {
         if ( ( pos + count ) > af->extents[ 0 ] )
@@ -388,7 +462,9 @@ rc_t array_file_read_dim2( af_data * af, const uint64_t pos,
         pos2[ 1 ] = 0;
         count2[ 0 ] = count;
         count2[ 1 ] = ext2;
+        pl_lock_acquire();
         rc = KArrayFileRead ( af->af, 2, pos2, dst, count2, read2 );
+        pl_lock_unlock();
         if ( rc != 0 )
             LOGERR( klogErr, rc, "error reading arrayfile-data (2 dim)" );
         *n_read = read2[ 0 ];
@@ -573,6 +649,7 @@ rc_t load_table( VDatabase * database, KDirectory * hdf5_src, ld_context *lctx,
 rc_t progress_chunk( const KLoadProgressbar ** xml_progress, const uint64_t chunk )
 {
     rc_t rc;
+    pl_lock_acquire();
     /* release the old progressbar... */
     if ( *xml_progress != NULL )
     {
@@ -582,7 +659,8 @@ rc_t progress_chunk( const KLoadProgressbar ** xml_progress, const uint64_t chun
     rc = KLoadProgressbar_Make( xml_progress, 0 );
     if ( rc == 0 )
         rc = KLoadProgressbar_Append( *xml_progress, chunk );
-    else
+    pl_lock_unlock();
+    if ( rc != 0 )
         LOGERR( klogErr, rc, "cannot make KLoadProgressbar" );
 
     return rc;
@@ -591,10 +669,14 @@ rc_t progress_chunk( const KLoadProgressbar ** xml_progress, const uint64_t chun
 
 rc_t progress_step( const KLoadProgressbar * xml_progress )
 {
+    rc_t rc = 0;
     if ( xml_progress != NULL )
-       return KLoadProgressbar_Process( xml_progress, 1, false );
-    else
-        return 0;
+    {
+        pl_lock_acquire();
+        rc = KLoadProgressbar_Process( xml_progress, 1, false );
+        pl_lock_unlock();
+    }
+    return rc;
 }
 
 
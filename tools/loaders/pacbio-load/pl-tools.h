@@ -190,6 +190,14 @@ typedef struct ld_context
 void lctx_init( ld_context * lctx );
 void lctx_free( ld_context * lctx );
 
+/* the hdf5-library and the progressbars are not thread-safe,
+   tables loaded concurrently take turns through this lock,
+   acquire/unlock do nothing if the lock has not been made */
+rc_t pl_lock_make( void );
+void pl_lock_release( void );
+void pl_lock_acquire( void );
+void pl_lock_unlock( void );
+
 
 rc_t check_src_objects( const KDirectory *hdf5_dir,
                         const char ** groups,
@@ -8,6 +8,7 @@
  */
 
 #include "fastq_read.hpp"
+#include "fastq_defline_scanner.hpp"
 #include "regexpr.hpp"
 #include <insdc/sra.h>
 
@@ -61,9 +62,19 @@ public:
      */
     virtual bool Matches(const string_view& defline)
     {
-        return re.Matches(defline);
+        mFastMatch = mFastPath && FastMatches(defline);
+        return mFastMatch || re.Matches(defline);
     }
 
+    /**
+     * @brief Enable or disable the hand-written scanner
+     *
+     * Disabled scanner leaves RE2 as the only matcher (used for testing)
+     *
+     * @param[in] value
+     */
+    void SetFastPath(bool value) { mFastPath = value; }
+
     /**
      * @brief retrun Defline description
      *
@@ -92,9 +103,21 @@ public:
 
 
 protected:
+    /**
+     * @brief Hand-written scanner for the matcher's pattern
+     *
+     * Fills re.GetMatch() with the same groups RE2 would capture
+     *
+     * @param[in] defline
+     * @return false if the scanner did not decide, RE2 is used then
+     */
+    virtual bool FastMatches(const string_view& defline) { return false; }
+
     string mDefLineName;             ///< Defline description
     CRegExprMatcher re;              ///< regexpr matcher
     string m_tmp_spot;               ///< variable for spot name assembly 
+    bool mFastPath = true;           ///< hand-written scanner is enabled
+    bool mFastMatch = false;         ///< last match was done by the hand-written scanner
 
 };
 
@@ -252,7 +275,7 @@ public:
         auto& readNum = re.GetMatch()[10];
 
         m_tmp_suffix.set(nullptr, 0);
-        if (illuminaOldSuffix2.Matches(y)) {
+        if (HasSuffix2(y) && illuminaOldSuffix2.Matches(y)) {
             y = illuminaOldSuffix2.GetMatch()[0];
             auto& suffix = illuminaOldSuffix2.GetMatch()[1];
             if (suffix.size() >= 3) {
@@ -260,7 +283,7 @@ public:
                     suffix.remove_prefix(2);
                 m_tmp_suffix = suffix;                    
             }         
-        } else if (!readNum.empty() && illuminaOldSuffix.Matches(readNum)) {
+        } else if (!readNum.empty() && (!mFastPath || readNum.size() >= 4) && illuminaOldSuffix.Matches(readNum)) {
             readNum = illuminaOldSuffix.GetMatch()[0];    
             if (illuminaOldSuffix.GetMatch()[1].size() >= 3) 
                 m_tmp_suffix = illuminaOldSuffix.GetMatch()[1];
@@ -354,6 +377,24 @@ public:
 
     }
 
+    /**
+     * @brief Check if illuminaOldSuffix2 can match y
+     *
+     * A number followed by a non-digit can only be found
+     * if y is not just digits and dots with an optional leading minus
+     */
+    bool HasSuffix2(const re2::StringPiece& y) const
+    {
+        if (!mFastPath)
+            return true;
+        size_t i = (!y.empty() && y[0] == '-') ? 1 : 0;
+        for (; i < y.size(); ++i) {
+            if (!sharq::scan::is_digit(y[i]) && y[i] != '.')
+                return true;
+        }
+        return false;
+    }
+
     int countExtraNumbersInIllumina(re2::StringPiece& prefix, re2::StringPiece& sep_str, re2::StringPiece& x, re2::StringPiece& y)
     {
         if (sep_str.empty())
@@ -407,6 +448,12 @@ public:
             "illuminaNew",
             R"(^[@>+]([!-~]+?)([:_])(\d+)([:_])(\d+)([:_])(-?\d+\.?\d*)([:_])(-?\d+\.\d+|\d+)(\s+|[:_|-])([12345]|):([NY]):(\d+|O):?([!-~]*?)(\s+|$))")
     {}
+
+protected:
+    bool FastMatches(const string_view& defline) override
+    {
+        return sharq::scan::illumina_new(defline, &re.GetMatch()[0]);
+    }
 };
 
 
@@ -494,6 +541,11 @@ public:
             R"(^[@>+]?([!-~]+?)(:)(\d+)(:)(\d+)(:)(-?\d+\.?\d*)([-:])(-?\d+\.\d+|-?\d+)_?[012]?(#[!-~]*?|)\s?(/[12345]|\\[12345])?(\s+|$))")
     {}
 
+protected:
+    bool FastMatches(const string_view& defline) override
+    {
+        return sharq::scan::illumina_old_colon(defline, &re.GetMatch()[0]);
+    }
 };
 
 class CDefLineMatcherIlluminaOldUnderscore : public CDefLineMatcherIlluminaOldBase
@@ -580,6 +632,11 @@ public:
         read.SetSpotGroup(re.GetMatch()[5]);
     }
 
+protected:
+    bool FastMatches(const string_view& defline) override
+    {
+        return sharq::scan::bgi_old(defline, &re.GetMatch()[0]);
+    }
 };
 
 class CDefLineMatcherBgiNew : public CDefLineMatcher
@@ -617,6 +674,12 @@ public:
 
         read.SetReadFilter(re.GetMatch()[8] == "Y" ? 1 : 0);
     }
+
+protected:
+    bool FastMatches(const string_view& defline) override
+    {
+        return sharq::scan::bgi_new(defline, &re.GetMatch()[0]);
+    }
 };
 
 // NANOPORE
@@ -920,6 +983,27 @@ public:
         // 0 self.name
         read.SetSpot( re.GetMatch()[0] );
 
+        if ( mFastMatch )
+        {   // same searches as below, the defline is known to be plain ASCII
+            const string_view input( re.GetLastInput() );
+            re2::StringPiece value;
+            if ( sharq::scan::number_after( input, "read", value ) )
+            {
+                read.SetNanoporeReadNo( value );
+            }
+            if ( sharq::scan::number_after( input, "ch", value ) )
+            {
+                read.SetChannel( value );
+            }
+            if ( sharq::scan::token_after( input, "barcode=", value ) &&
+                 value != "unclassified" )
+            {
+                read.SetSpotGroup( value );
+            }
+            PostProcess( read );
+            return;
+        }
+
         if ( getPoreReadNo.Matches(re.GetLastInput()) )
         {
             read.SetNanoporeReadNo( getPoreReadNo.GetMatch()[0] );
@@ -940,6 +1024,19 @@ public:
         PostProcess( read );
     }
 
+protected:
+    bool FastMatches(const string_view& defline) override
+    {
+        if ( !sharq::scan::nanopore_uuid( defline, &re.GetMatch()[0] ) )
+        {
+            return false;
+        }
+        re.SetLastInput( defline );
+        return true;
+    }
+
+public:
+
     CRegExprMatcher getPoreReadNo;
     CRegExprMatcher getPoreChannel;
     CRegExprMatcher getPoreBarcode;
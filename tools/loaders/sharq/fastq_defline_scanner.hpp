@@ -0,0 +1,475 @@
+#ifndef __CFASTQ_DEFLINE_SCANNER_HPP__
+#define __CFASTQ_DEFLINE_SCANNER_HPP__
+
+/**
+ * @file fastq_defline_scanner.hpp
+ * @brief Hand-written scanners for the most common defline formats
+ *
+ * Each scanner reproduces the RE2 submatches of the corresponding matcher's pattern
+ * (see fastq_defline_matcher.hpp) for an unambiguous subset of deflines.
+ * A scanner returning false has not decided anything, the caller falls back to RE2.
+ *
+ * Only deflines made of printable ASCII and RE2 whitespace are scanned,
+ * so \S is the same as [!-~] for everything accepted here.
+ */
+
+#include <cstring>
+#include <string_view>
+#include <re2/re2.h>
+
+using namespace std;
+
+namespace sharq {
+
+namespace scan {
+
+/// RE2 \s
+inline bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\f' || c == '\r';
+}
+
+inline bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+inline bool is_print(char c)
+{
+    return c >= '!' && c <= '~';
+}
+
+/// c is one of chars, '\0' never is
+inline bool is_one_of(char c, const char* chars)
+{
+    return c != '\0' && strchr(chars, c) != nullptr;
+}
+
+inline bool is_plain(const string_view& s)
+{
+    for (char c : s) {
+        if (!is_print(c) && !is_space(c))
+            return false;
+    }
+    return true;
+}
+
+inline size_t skip_digits(const string_view& s, size_t pos)
+{
+    while (pos < s.size() && is_digit(s[pos]))
+        ++pos;
+    return pos;
+}
+
+inline size_t skip_spaces(const string_view& s, size_t pos)
+{
+    while (pos < s.size() && is_space(s[pos]))
+        ++pos;
+    return pos;
+}
+
+/// [!-~]*
+inline size_t skip_token(const string_view& s, size_t pos)
+{
+    while (pos < s.size() && is_print(s[pos]))
+        ++pos;
+    return pos;
+}
+
+inline re2::StringPiece piece(const string_view& s, size_t from, size_t to)
+{
+    return re2::StringPiece(s.data() + from, to - from);
+}
+
+/// character at pos or '\0' past the end (plain deflines have no '\0')
+inline char at(const string_view& s, size_t pos)
+{
+    return pos < s.size() ? s[pos] : '\0';
+}
+
+/// -?\d+\.?\d* followed by one of seps, returns end of the number or 0
+inline size_t x_coord(const string_view& s, size_t pos, const char* seps)
+{
+    size_t p = pos;
+    if (at(s, p) == '-')
+        ++p;
+    size_t e = skip_digits(s, p);
+    if (e == p)
+        return 0;
+    if (at(s, e) == '.')
+        e = skip_digits(s, e + 1);
+    return is_one_of(at(s, e), seps) ? e : 0;
+}
+
+/// (-?\d+\.\d+|-?\d+) or (-?\d+\.\d+|\d+) when !allow_minus, returns end or 0
+/// the greedy alternative is the only one that can be followed by a separator
+inline size_t y_coord(const string_view& s, size_t pos, bool allow_minus)
+{
+    size_t p = pos;
+    if (at(s, p) == '-')
+        ++p;
+    size_t e = skip_digits(s, p);
+    if (e == p)
+        return 0;
+    if (at(s, e) == '.' && is_digit(at(s, e + 1)))
+        return skip_digits(s, e + 1);
+    return (p == pos || allow_minus) ? e : 0;
+}
+
+/**
+ * @brief ([12345]|):([NY]):(\d+|O):?([!-~]*?)(\s+|$)
+ *
+ * @param[out] m 5 groups: readNum, filter, reserved, spotGroup, endSep
+ */
+inline bool read_tail(const string_view& s, size_t pos, re2::StringPiece* m)
+{
+    size_t p = pos;
+    if (at(s, p) >= '1' && at(s, p) <= '5' && at(s, p + 1) == ':') {
+        m[0] = piece(s, p, p + 1);
+        p += 2;
+    } else if (at(s, p) == ':') {
+        m[0] = piece(s, p, p);
+        p += 1;
+    } else
+        return false;
+
+    if ((at(s, p) != 'N' && at(s, p) != 'Y') || at(s, p + 1) != ':')
+        return false;
+    m[1] = piece(s, p, p + 1);
+    p += 2;
+
+    size_t e = skip_digits(s, p);
+    if (e == p) {
+        if (at(s, p) != 'O')
+            return false;
+        ++e;
+    }
+    m[2] = piece(s, p, e);
+    p = e;
+    if (at(s, p) == ':')
+        ++p;
+    e = skip_token(s, p);
+    m[3] = piece(s, p, e);
+    m[4] = piece(s, e, skip_spaces(s, e));
+    return true;
+}
+
+/**
+ * @brief illuminaNew:
+ * ^[@>+]([!-~]+?)([:_])(\d+)([:_])(\d+)([:_])(-?\d+\.?\d*)([:_])(-?\d+\.\d+|\d+)(\s+|[:_|-])
+ * followed by read_tail
+ *
+ * The prefix is lazy, so the first separator the rest matches after wins;
+ * all the other groups have a single way to match.
+ *
+ * @param[out] m 15 groups
+ */
+inline bool illumina_new(const string_view& s, re2::StringPiece* m)
+{
+    const char* seps = ":_";
+    if (s.size() < 2 || !is_one_of(s[0], "@>+") || !is_plain(s))
+        return false;
+    const size_t token_end = skip_token(s, 1);
+    for (size_t p = 2; p < token_end; ++p) {
+        if (s[p] != ':' && s[p] != '_')
+            continue;
+        size_t lane = p + 1;
+        size_t lane_end = skip_digits(s, lane);
+        if (lane_end == lane || !is_one_of(at(s, lane_end), seps))
+            continue;
+        size_t tile = lane_end + 1;
+        size_t tile_end = skip_digits(s, tile);
+        if (tile_end == tile || !is_one_of(at(s, tile_end), seps))
+            continue;
+        size_t x = tile_end + 1;
+        size_t x_end = x_coord(s, x, seps);
+        if (x_end == 0)
+            continue;
+        size_t y = x_end + 1;
+        size_t y_end = y_coord(s, y, false);
+        if (y_end == 0 || y_end >= s.size())
+            continue;
+        size_t tail;
+        if (is_space(s[y_end]))
+            tail = skip_spaces(s, y_end);
+        else if (is_one_of(s[y_end], ":_|-"))
+            tail = y_end + 1;
+        else
+            continue;
+        if (!read_tail(s, tail, m + 10))
+            continue;
+        m[0] = piece(s, 1, p);
+        m[1] = piece(s, p, p + 1);
+        m[2] = piece(s, lane, lane_end);
+        m[3] = piece(s, lane_end, lane_end + 1);
+        m[4] = piece(s, tile, tile_end);
+        m[5] = piece(s, tile_end, tile_end + 1);
+        m[6] = piece(s, x, x_end);
+        m[7] = piece(s, x_end, x_end + 1);
+        m[8] = piece(s, y, y_end);
+        m[9] = piece(s, y_end, tail);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief _?[012]?(#[!-~]*?|)\s?(/[12345]|\\[12345])?(\s+|$)
+ *
+ * Optional parts are tried the way RE2 prefers them, the first complete match wins.
+ *
+ * @param[out] m 3 groups: spotGroup, readNum, endSep
+ */
+inline bool illumina_old_tail(const string_view& s, size_t pos, re2::StringPiece* m)
+{
+    // \s?(/[12345]|\\[12345])?(\s+|$)
+    auto rest = [&](size_t r) {
+        for (int sp = is_space(at(s, r)); sp >= 0; --sp) {
+            size_t r2 = r + sp;
+            bool has_num = (at(s, r2) == '/' || at(s, r2) == '\\') && at(s, r2 + 1) >= '1' && at(s, r2 + 1) <= '5';
+            for (int num = has_num; num >= 0; --num) {
+                size_t r3 = r2 + 2 * num;
+                if (r3 < s.size() && !is_space(s[r3]))
+                    continue;
+                m[1] = num ? piece(s, r2, r3) : re2::StringPiece();
+                m[2] = piece(s, r3, skip_spaces(s, r3));
+                return true;
+            }
+        }
+        return false;
+    };
+    for (int u = at(s, pos) == '_'; u >= 0; --u) {
+        size_t p1 = pos + u;
+        for (int d = at(s, p1) >= '0' && at(s, p1) <= '2'; d >= 0; --d) {
+            size_t p2 = p1 + d;
+            if (at(s, p2) == '#') {
+                const size_t last = skip_token(s, p2 + 1);
+                for (size_t r = p2 + 1; r <= last; ++r) {
+                    if (rest(r)) {
+                        m[0] = piece(s, p2, r);
+                        return true;
+                    }
+                }
+            }
+            if (rest(p2)) {
+                m[0] = piece(s, p2, p2);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief IlluminaOldColon:
+ * ^[@>+]?([!-~]+?)(:)(\d+)(:)(\d+)(:)(-?\d+\.?\d*)([-:])(-?\d+\.\d+|-?\d+)
+ * followed by illumina_old_tail
+ *
+ * Only deflines starting with [@>+] are scanned.
+ *
+ * @param[out] m 12 groups
+ */
+inline bool illumina_old_colon(const string_view& s, re2::StringPiece* m)
+{
+    if (s.size() < 2 || !is_one_of(s[0], "@>+") || !is_plain(s))
+        return false;
+    const size_t token_end = skip_token(s, 1);
+    for (size_t p = 2; p < token_end; ++p) {
+        if (s[p] != ':')
+            continue;
+        size_t lane = p + 1;
+        size_t lane_end = skip_digits(s, lane);
+        if (lane_end == lane || at(s, lane_end) != ':')
+            continue;
+        size_t tile = lane_end + 1;
+        size_t tile_end = skip_digits(s, tile);
+        if (tile_end == tile || at(s, tile_end) != ':')
+            continue;
+        size_t x = tile_end + 1;
+        size_t x_end = x_coord(s, x, "-:");
+        if (x_end == 0)
+            continue;
+        size_t y = x_end + 1;
+        size_t y_end = y_coord(s, y, true);
+        if (y_end == 0 || !illumina_old_tail(s, y_end, m + 9))
+            continue;
+        m[0] = piece(s, 1, p);
+        m[1] = piece(s, p, p + 1);
+        m[2] = piece(s, lane, lane_end);
+        m[3] = piece(s, lane_end, lane_end + 1);
+        m[4] = piece(s, tile, tile_end);
+        m[5] = piece(s, tile_end, tile_end + 1);
+        m[6] = piece(s, x, x_end);
+        m[7] = piece(s, x_end, x_end + 1);
+        m[8] = piece(s, y, y_end);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief BGI spot name: ^[@>+](\S{1,3}\d{9}\S{0,3})(L\d)(C\d{3})(R\d{3})([_]?\d{1,8})
+ *
+ * Tries the repetition counts in RE2 order and calls rest(end of spot)
+ * for every way the spot name matches until rest returns true.
+ *
+ * @param[out] m 5 groups: flowcell, lane, column, row, readNo
+ */
+template<typename F>
+bool bgi_spot(const string_view& s, size_t token_end, re2::StringPiece* m, F&& rest)
+{
+    auto digits = [&](size_t pos, size_t count) {
+        if (pos + count > token_end)
+            return false;
+        for (size_t i = pos; i < pos + count; ++i) {
+            if (!is_digit(s[i]))
+                return false;
+        }
+        return true;
+    };
+    for (size_t a = 3; a >= 1; --a) {
+        if (!digits(1 + a, 9))
+            continue;
+        for (int b = 3; b >= 0; --b) {
+            const size_t lane = 1 + a + 9 + b;
+            const size_t col = lane + 2;
+            const size_t row = col + 4;
+            const size_t num = row + 4;
+            if (num > token_end ||
+                s[lane] != 'L' || !digits(lane + 1, 1) ||
+                s[col] != 'C' || !digits(col + 1, 3) ||
+                s[row] != 'R' || !digits(row + 1, 3))
+                continue;
+            for (int u = at(s, num) == '_'; u >= 0; --u) {
+                for (size_t d = 8; d >= 1; --d) {
+                    if (!digits(num + u, d))
+                        continue;
+                    m[0] = piece(s, 1, lane);
+                    m[1] = piece(s, lane, col);
+                    m[2] = piece(s, col, row);
+                    m[3] = piece(s, row, num);
+                    m[4] = piece(s, num, num + u + d);
+                    if (rest(num + u + d))
+                        return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief BgiNew: BGI spot name followed by (\S*)(\s+|[_|-]) and read_tail
+ *
+ * Only the common form with the read tail in the next token is scanned,
+ * then the suffix takes the rest of the spot token whichever way the spot name matched.
+ *
+ * @param[out] m 12 groups
+ */
+inline bool bgi_new(const string_view& s, re2::StringPiece* m)
+{
+    if (s.size() < 2 || !is_one_of(s[0], "@>+") || !is_plain(s))
+        return false;
+    const size_t token_end = skip_token(s, 1);
+    if (token_end == s.size())
+        return false;
+    const size_t tail = skip_spaces(s, token_end);
+    if (!read_tail(s, tail, m + 7))
+        return false;
+    return bgi_spot(s, token_end, m, [&](size_t pos) {
+        m[5] = piece(s, pos, token_end);
+        m[6] = piece(s, token_end, tail);
+        return true;
+    });
+}
+
+/**
+ * @brief BgiOld: BGI spot name followed by (#[!-~]*?|)(/[1234]\S*|)(\s+|$)
+ *
+ * @param[out] m 8 groups
+ */
+inline bool bgi_old(const string_view& s, re2::StringPiece* m)
+{
+    if (s.size() < 2 || !is_one_of(s[0], "@>+") || !is_plain(s))
+        return false;
+    const size_t token_end = skip_token(s, 1);
+    auto is_read_num = [&](size_t pos) {
+        return at(s, pos) == '/' && at(s, pos + 1) >= '1' && at(s, pos + 1) <= '4';
+    };
+    return bgi_spot(s, token_end, m, [&](size_t pos) {
+        size_t r = pos;
+        if (at(s, pos) == '#') {
+            // lazy spot group ends at the first read number or at the end of the token
+            r = pos + 1;
+            while (r < token_end && !is_read_num(r))
+                ++r;
+        } else if (pos < token_end && !is_read_num(pos))
+            return false;
+        m[5] = piece(s, pos, r);
+        m[6] = piece(s, r < token_end ? r : token_end, token_end);
+        m[7] = piece(s, token_end, skip_spaces(s, token_end));
+        return true;
+    });
+}
+
+/**
+ * @brief Nanopore4: [@>+]([!-~]*?\S{8}-\S{4}-\S{4}-\S{4}-\S{12}\S*[_]?\d?)...
+ *
+ * Only deflines whose first token carries the UUID are scanned,
+ * then the name is the whole first token.
+ *
+ * @param[out] m 1 group
+ */
+inline bool nanopore_uuid(const string_view& s, re2::StringPiece* m)
+{
+    if (s.size() < 2 || !is_one_of(s[0], "@>+") || !is_plain(s))
+        return false;
+    const size_t token_end = skip_token(s, 1);
+    for (size_t i = 1; i + 36 <= token_end; ++i) {
+        if (s[i + 8] == '-' && s[i + 13] == '-' && s[i + 18] == '-' && s[i + 23] == '-') {
+            m[0] = piece(s, 1, token_end);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Leftmost key[=_]?(\d+)
+ */
+inline bool number_after(const string_view& s, const string_view& key, re2::StringPiece& number)
+{
+    for (size_t pos = s.find(key); pos != string_view::npos; pos = s.find(key, pos + 1)) {
+        size_t p = pos + key.size();
+        if (at(s, p) == '=' || at(s, p) == '_')
+            ++p;
+        size_t e = skip_digits(s, p);
+        if (e > p) {
+            number = piece(s, p, e);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Leftmost key(\S+)
+ */
+inline bool token_after(const string_view& s, const string_view& key, re2::StringPiece& token)
+{
+    for (size_t pos = s.find(key); pos != string_view::npos; pos = s.find(key, pos + 1)) {
+        size_t p = pos + key.size();
+        size_t e = skip_token(s, p);
+        if (e > p) {
+            token = piece(s, p, e);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace scan
+
+} // namespace sharq
+
+#endif
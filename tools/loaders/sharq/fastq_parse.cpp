@@ -48,6 +48,7 @@
 #include <json.hpp>
 #include <algorithm>
 #include <insdc/sra.h>
+#include <sys/stat.h>
 
 
 #if __has_include(<experimental/filesystem>)
@@ -125,9 +126,11 @@ private:
     bool mHasReadPairs{false};          ///< Flag to indicate that read pairs are defined in the command line 
     unsigned int mThreads{24};          ///< Number of threads to use
     string mTelemetryFile;              ///< Telemetry report file name
+    unsigned mTelemetryInterval{10};    ///< Pipeline snapshot interval in seconds, 0 - no snapshots
     string mSpotFile;                   ///< Spot_name file, optional request to serialize  all spot names
     string mNameColumn;                 ///< NAME column's name, ('NONE', 'NAME', 'RAW_NAME')
     string mOutputFile;                 ///< Outut file name - not currently used
+    string mShmRingDir;                 ///< Directory for the shared-memory ring to general-loader, empty = pipe only
     json mExperimentSpecs;              ///< Json from Experiment file
     ostream* mpOutStr{nullptr};         ///< Output stream pointer  = not currently used
     shared_ptr<fastq_writer> m_writer;  ///< FASTQ writer
@@ -135,6 +138,10 @@ private:
     uint32_t mMaxErrCount{100};         ///< Maximum numbers of errors allowed when parsing reads
     atomic<uint32_t> mErrorCount{0};            ///< Global error counter
     size_t mHotReadsThreshold{10000000};      ///< Threshold for hot reads
+    size_t mColdMemoryLimit{0};               ///< Memory budget for cold reads, 0 - no limit
+    string mSpillDir;                         ///< Directory for cold reads spill files
+    bool mFirstPassCache{false};              ///< Replay first pass reads from a cache file instead of re-parsing the input
+    unsigned mInflateThreads{0};              ///< Inflate threads per gzip input, 0 - single-threaded bxzstr
     uint8_t m_platform_code{0};         ///< Platform code set from the parameters
     set<int> mErrorSet = { 100, 110, 111, 120, 130, 140, 160, 190}; ///< Error codes that will be allowed up to mMaxErrCount
     size_t mMaxSpotsInLinearMode = 1200000000; ///< Max spot number for linear (non-spot assembly) mode
@@ -231,6 +238,10 @@ int CFastqParseApp::AppMain(int argc, const char* argv[])
 
         mTelemetryFile.clear();
         app.add_option("--telemetry,-t", mTelemetryFile, "Telemetry report file");
+        app.add_option("--telemetry-interval", mTelemetryInterval, "Seconds between pipeline queue and stage snapshots written to <telemetry file>.pipeline.json (0 - no snapshots, default: 10)");
+
+        mShmRingDir.clear();
+        app.add_flag("--shm-ring{/dev/shm}", mShmRingDir, "Pass the output to general-loader through a shared-memory ring (set optional value to choose the ring directory, stdout must be a pipe)");
 
         vector<string> read_pairs(4);
         app.add_option("--read1PairFiles", read_pairs[0], "Read 1 files");
@@ -255,6 +266,14 @@ int CFastqParseApp::AppMain(int argc, const char* argv[])
 
         app.add_option("--hot-reads-threshold", mHotReadsThreshold, "Hot reads threshold");
 
+        app.add_option("--cold-memory-limit", mColdMemoryLimit, "Memory budget for far (cold) reads in spot assembly, reads beyond it are spilled to disk (e.g. 32GB, default: no limit)")
+            ->transform(CLI::AsSizeValue(false));
+        mSpillDir = fs::temp_directory_path().string();
+        app.add_option("--spill-dir", mSpillDir, "Directory for spilled cold reads")
+            ->check(CLI::ExistingDirectory);
+        app.add_option("--inflate-threads", mInflateThreads, "Threads inflating each gzip input, BGZF and multi-member files are inflated in parallel (default: 0 - single-threaded)");
+        app.add_flag("--first-pass-cache", mFirstPassCache, "Cache reads parsed by the first pass of spot assembly in --spill-dir, the second pass does not decompress the input again");
+
         string experiment_file;
         app.add_option("--experiment", experiment_file, "Read structure description");
 
@@ -345,6 +364,8 @@ int CFastqParseApp::AppMain(int argc, const char* argv[])
                 }
             }
         }
+        if (!mTelemetryFile.empty())
+            pipeline_stats.start_reporting(mTelemetryFile + ".pipeline.json", mTelemetryInterval);
         ret_code = Run();
     } catch (fastq_error& e) {
         spdlog::error(e.Message());
@@ -388,12 +409,16 @@ unsigned long getPeakRSS() {
 
 void CFastqParseApp::xReportTelemetry()
 {
+    pipeline_stats.stop_reporting();
     if (mTelemetryFile.empty())
         return;
 #ifdef __linux__
     if (mNoTimeStamp == false)
         mReport["max_memory_kb"] = getPeakRSS();
 #endif
+    // queue waits and stage rates depend on timing
+    if (mNoTimeStamp == false)
+        pipeline_stats.snapshot(mReport["pipeline"]);
     try {
         ofstream f(mTelemetryFile.c_str(), ios::out);
         f << mReport.dump(4, ' ', true) << endl;
@@ -624,6 +649,12 @@ void CFastqParseApp::xCreateWriterFromDigest(json& data)
 
     m_writer->set_attr("name_column", mNameColumn);
     m_writer->set_attr("destination", mDestination);
+    if (!mShmRingDir.empty() && mpOutStr == &cout) {
+        // the ring only replaces a pipe, a regular file has no reader on the other end
+        struct stat st;
+        if (fstat(1, &st) == 0 && S_ISFIFO(st.st_mode))
+            m_writer->set_attr("shm_ring", mShmRingDir);
+    }
     m_writer->set_attr("version", SHARQ_VERSION);
     m_writer->set_attr("readTypes", string(mReadTypes.begin(), mReadTypes.end()));
 
@@ -665,6 +696,8 @@ int CFastqParseApp::xRun()
         if (!mDebug)
             parser.set_spot_file(mSpotFile);
         parser.set_allow_early_end(mAllowEarlyFileEnd);
+        parser.set_inflate_threads(mInflateThreads);
+        parser.set_threads(mThreads);
         m_writer->open();
         auto err_checker = [this](fastq_error& e) -> void { CFastqParseApp::xCheckErrorLimits(e);};
         for (auto& group : data["groups"]) {
@@ -724,7 +757,10 @@ void CFastqParseApp::xParseWithAssembly(json& group, parser_t& parser)
 
     //Reset readers
     mErrorCount = 0;
-    parser.set_readers(group);
+    if (parser.has_first_pass_cache())
+        parser.reuse_readers(group);
+    else
+        parser.set_readers(group);
 
     size_t num_rows = read_names.size();
     if (num_rows > numeric_limits<uint32_t>::max()) {
@@ -775,7 +811,11 @@ int CFastqParseApp::xRunSpotAssembly()
         if (!mDebug)
             parser.set_spot_file(mSpotFile);
         parser.set_allow_early_end(mAllowEarlyFileEnd);
+        parser.set_inflate_threads(mInflateThreads);
         parser.set_hot_reads_threshold(mHotReadsThreshold);
+        parser.set_cold_memory_limit(mColdMemoryLimit, mSpillDir);
+        if (mFirstPassCache)
+            parser.set_first_pass_cache(mSpillDir);
 
         //auto err_checker = [this](fastq_error& e) { CFastqParseApp::xCheckErrorLimits(e);};
         for (auto& group : data["groups"]) {
@@ -48,6 +48,9 @@
 #include "hashing.hpp"
 // input streams
 #include "bxzstr/bxzstr.hpp"
+#include "gz_inflate.hpp"
+#include "fastq_simd.hpp"
+#include "pipeline_stats.hpp"
 #include <bm/bm64.h>
 #include <bm/bmdbg.h>
 #include <bm/bmtimer.h>
@@ -61,6 +64,7 @@
 #include <chrono>
 #include <json.hpp>
 #include <set>
+#include <unordered_map>
 #include <limits>
 #include "taskflow/taskflow.hpp"
 #include "taskflow/algorithm/sort.hpp"
@@ -96,9 +100,8 @@ static constexpr int ASSEMBLE_QUEUE_SIZE = 2 * 1024;
 static constexpr int SAVE_SPOT_QUEUE_SIZE = 1 * 1024;
 static constexpr int CLEAR_SPOT_QUEUE_SIZE = 1 * 1024;
 
-//#define PRINT_QUEUE_T_STATS
-
 // ReaderWriterQueue wrapper
+// depth and wait times are collected in pipeline_stats under the queue name
 template<typename T, int QUEUE_SIZE = 1024>
 struct queue_t {
     string m_name;
@@ -110,89 +113,49 @@ struct queue_t {
     
     size_t enqueue_count{0};
     size_t dequeue_count{0};
+    queue_stats_t& m_stats;
 
-#ifdef PRINT_QUEUE_T_STATS    
-    std::chrono::duration<double> enqueue_idle_time;
-    spdlog::stopwatch enqueue_sw;
-    std::chrono::duration<double> dequeue_idle_time;
-    spdlog::stopwatch dequeue_sw;
-
-    spdlog::stopwatch queue_sw;
-
-    size_t enqueue_idle_count{0};
-    size_t dequeue_idle_count{0};
-#endif    
     queue_t(const string& name, atomic<bool>& is_cancel) 
-        : m_name(name), is_cancelled(is_cancel)
+        : m_name(name), is_cancelled(is_cancel), m_stats(pipeline_stats.queue(name, QUEUE_SIZE))
     {
-#ifdef PRINT_QUEUE_T_STATS    
-        queue_sw.reset();
-#endif        
-    }
-#ifdef PRINT_QUEUE_T_STATS
-    ~queue_t() {
-        //if (pipeline_cancelled == false && enqueue_count != dequeue_count)
-        //    throw fastq_error("Queue {} count mismatch {} != {}", m_name, enqueue_count, dequeue_count);
-        auto logger = spdlog::get("parser_logger");
-        if (logger) {
-            auto tm_count = queue_sw.elapsed().count();
-            logger->info("Queue {}, time: {:.2f}", m_name, queue_sw);
-            double v = enqueue_idle_time.count();
-            v = v/tm_count;
-            logger->info("enqueue_idle_time: {:.2f}, pct:{:.2f}, enqueue_idle_count: {:L}", enqueue_idle_time.count(), v, enqueue_idle_count);
-            v = dequeue_idle_time.count();
-            v = v/tm_count;
-            logger->info("dequeue_idle_time: {:.2f}, pct:{:.2f}, dequeue_idle_count: {:L}", dequeue_idle_time.count(), v, dequeue_idle_count);
-            logger->info("--------------------");
-        }
     }
-#endif    
 
     inline
     void enqueue(T&& item) {
-
-#ifdef PRINT_QUEUE_T_STATS    
-        auto i = enqueue_idle_count;    
-        enqueue_sw.reset();
-#endif        
+        if (queue.try_enqueue(std::move(item))) {
+            ++enqueue_count;
+            m_stats.on_enqueue();
+            return;
+        }
+        auto blocked_since = std::chrono::steady_clock::now();
         do {
+            std::this_thread::yield();
             if (queue.try_enqueue(std::move(item))) {
-#ifdef PRINT_QUEUE_T_STATS    
-                if (enqueue_idle_count > i) {
-                    enqueue_idle_time += enqueue_sw.elapsed();
-                }
-#endif                
                 ++enqueue_count;
+                m_stats.on_enqueue();
                 break;
             }
-#ifdef PRINT_QUEUE_T_STATS    
-            ++enqueue_idle_count;
-#endif            
-            std::this_thread::yield();
         } while (is_cancelled == false);
+        queue_stats_t::add_wait(m_stats.producer_blocked_ns, blocked_since);
     }
     inline
     bool dequeue(T& item) {
         if (finished)
             return false;
-#ifdef PRINT_QUEUE_T_STATS    
-        auto i = dequeue_idle_count;    
-        dequeue_sw.reset();
-#endif        
+        if (queue.try_dequeue(item)) {
+            ++dequeue_count;
+            m_stats.on_dequeue();
+            return true;
+        }
+        auto starved_since = std::chrono::steady_clock::now();
         do {
             if (queue.wait_dequeue_timed(item, std::chrono::milliseconds(100))) {
             //if (queue.try_dequeue(item)) {
-#ifdef PRINT_QUEUE_T_STATS    
-                if (dequeue_idle_count > i) {
-                    dequeue_idle_time += dequeue_sw.elapsed();
-                }
-#endif                
+                queue_stats_t::add_wait(m_stats.consumer_starved_ns, starved_since);
                 ++dequeue_count;
+                m_stats.on_dequeue();
                 return true;
             }
-#ifdef PRINT_QUEUE_T_STATS    
-            ++dequeue_idle_count;
-#endif            
             if (is_done == true && queue.peek() == nullptr) {
                 finished = true;
                 break;
@@ -387,6 +350,8 @@ public:
      *
      */
     bool is_compressed() const {
+        if (dynamic_cast<gz_istream*>(&*m_stream))
+            return true;
         auto fstream = dynamic_cast<bxz::ifstream*>(&*m_stream);
         return fstream ? fstream->compression() != bxz::plaintext : false;
     }
@@ -397,6 +362,8 @@ public:
      * @return size_t
      */
     size_t tellg() const {
+        if (auto gzstream = dynamic_cast<gz_istream*>(&*m_stream))
+            return gzstream->compressed_tellg();
         auto fstream = dynamic_cast<bxz::ifstream*>(&*m_stream);
         return fstream ? fstream->compressed_tellg() : m_stream->tellg();
     }
@@ -414,6 +381,9 @@ public:
     template<typename ScoreValidator>
     void num_qual_validator(CFastqRead& read);   ///< Numeric quality score validatot
 
+    template<typename ScoreValidator>
+    void num_qual_finalize(CFastqRead& read);    ///< Numeric quality score length adjustment and counts
+
     template<typename ScoreValidator>
     void char_qual_validator(CFastqRead& read);  ///< Character (PHRED) quality score validator
 
@@ -464,9 +434,21 @@ private:
 
 //  ----------------------------------------------------------------------------
 static
-shared_ptr<istream> s_OpenStream(const string& filename, size_t buffer_size)
+/**
+ * @brief opens input stream
+ *
+ * gzip files are inflated by gz_istream when inflate_threads > 0,
+ * other inputs go through bxzstr
+ */
+shared_ptr<istream> s_OpenStream(const string& filename, size_t buffer_size, unsigned inflate_threads = 0)
 {
-    shared_ptr<istream> is = (filename != "-") ? shared_ptr<istream>(new bxz::ifstream(filename, ios::in, buffer_size)) : shared_ptr<istream>(new bxz::istream(std::cin));
+    shared_ptr<istream> is;
+    if (filename == "-")
+        is.reset(new bxz::istream(std::cin));
+    else if (inflate_threads > 0 && gz_inflate_buf::is_gzip(filename))
+        is.reset(new gz_istream(filename, inflate_threads));
+    else
+        is.reset(new bxz::ifstream(filename, ios::in, buffer_size));
     if (!is->good())
         throw runtime_error("Failure to open '" + filename + "'");
     return is;
@@ -526,6 +508,22 @@ public:
      */
     void set_allow_early_end(bool allow_early_end = true) { m_allow_early_end = allow_early_end; }
 
+    /**
+     * @brief Set number of inflate threads per gzip input
+     *
+     * 0 - gzip inputs are read through bxzstr
+     *
+     * @param[in]  threads
+     */
+    void set_inflate_threads(unsigned threads) { m_inflate_threads = threads; }
+
+    /**
+     * @brief Set number of threads for the collation check
+     *
+     * @param[in]  threads
+     */
+    void set_threads(unsigned threads) { m_threads = max(1u, threads); }
+
     /**
      * @brief Set the spot_file name
      *
@@ -559,6 +557,13 @@ public:
     template<typename ScoreValidator, typename ErrorChecker, typename T>
     void for_each_read(ErrorChecker&& error_checker, T&& func);
 
+    /**
+     * @brief replay reads saved by the first pass and apply func for each read
+     * row ids match the ones assigned by for_each_read in the first pass
+    */
+    template<typename T>
+    void for_each_cached_read(T&& func);
+
     /**
      * @brief get spots from a group of readers and apply func for each spot
     */
@@ -647,12 +652,13 @@ public:
         string spot_name;
         size_t line_no;
         size_t reader_idx;
+        size_t index;       ///< index of the name in m_spot_names
     } search_term_t;
 
     /**
      * @brief Collation check
      *
-     * Check if more than one name exists in the collected m_spot_names dictionary
+     * Reports the terms whose names occur earlier in the collected m_spot_names dictionary
      *
      */
 
@@ -681,6 +687,37 @@ public:
         m_spot_assembly.m_hot_reads_threshold = threshold; 
     }
 
+    /**
+     * @brief Set memory budget for cold reads storage
+     * cold reads exceeding the budget are spilled to compressed segment files in spill_dir
+     * default: 0 (no limit)
+    */
+    void set_cold_memory_limit(size_t budget, const string& spill_dir) { 
+        m_spot_assembly.m_cold_memory_budget = budget; 
+        m_spot_assembly.m_spill_dir = spill_dir; 
+    }
+
+    /**
+     * @brief Keep first pass reads in a cache file in cache_dir
+     * second pass replays the cache instead of parsing the input files again
+     * empty cache_dir disables the cache (default)
+    */
+    void set_first_pass_cache(const string& cache_dir) { m_first_pass_cache_dir = cache_dir; }
+
+    /**
+     * @brief true if the first pass reads are cached for the second pass
+    */
+    bool has_first_pass_cache() const { return m_first_pass_cache.is_open(); }
+
+    /**
+     * @brief Keep the first pass readers for the second pass
+     * used when the second pass replays the first pass cache,
+     * the readers already collected the input metrics
+     *
+     * @param[in]  group
+     */
+    void reuse_readers(const json& group) { set_telemetry(group); }
+
 private:
 
     /**
@@ -705,6 +742,7 @@ private:
 
     struct spot_assembly_metrics_t {
         size_t number_of_far_reads = 0;
+        size_t spilled_bytes = 0; // cold storage bytes spilled to disk
         map<uint32_t, size_t> reads_stats; // number of reads, number of spots
     };
 
@@ -744,7 +782,11 @@ private:
     bool                 m_IsIllumina10x{false};       ///< Parsing Illumina 10x data
     str_sv_type          m_spot_names;                 ///< Run-time collected spot name dictionary
     bool                 m_allow_early_end{false};     ///< Allow early file end flag
+    unsigned             m_inflate_threads{0};         ///< Inflate threads per gzip input, 0 - use bxzstr
+    unsigned             m_threads{1};                 ///< Collation check threads
     string               m_spot_file;                  ///< Optional file name for spot_name dictionary
+    string               m_first_pass_cache_dir;       ///< Directory for the first pass cache, empty - no cache
+    spill_segment_t      m_first_pass_cache;           ///< Reads parsed by the first pass
     bool                 m_sort_by_readnum{false};          ///< sort reads based on number of readers and existence of read numbers
     str_sv_type::back_insert_iterator m_spot_names_bi; ///< Internal back_inserter for spot_names collection
     vector<char>         m_read_types;                 ///< ReadTypes 
@@ -890,7 +932,9 @@ void fastq_reader::validate_read(CFastqRead& read)
     if (read.Quality().empty() && !eof())
         throw fastq_error(111, "Read {}: no quality scores", read.Spot());
     // check isalpha
-    if (std::any_of(read.Sequence().begin(), read.Sequence().end(), [](const char& c) { return !isalpha(c);}))
+    const auto& sequence = read.Sequence();
+    if (!sharq::simd::all_alpha(sequence.data(), sequence.size()) &&
+        std::any_of(sequence.begin(), sequence.end(), [](const char& c) { return !isalpha(c);}))
         throw fastq_error(160, "Read {}: invalid sequence characters", read.Spot());
 
     if constexpr (ScoreValidator::type() == eNumeric) {
@@ -899,8 +943,7 @@ void fastq_reader::validate_read(CFastqRead& read)
         char_qual_validator<ScoreValidator>(read);
     }
 
-    for (const auto& c : read.Sequence()) 
-        ++m_input_metrics.base_counts[c];
+    sharq::simd::count_bytes(sequence.data(), sequence.size(), m_input_metrics.base_counts);
 
 }
 
@@ -1040,6 +1083,13 @@ template<typename ScoreValidator>
 void fastq_reader::num_qual_validator(CFastqRead& read)
 {
     m_tmp_str.clear();
+    // common case: short integer tokens all within the range
+    if (sharq::simd::parse_scores(read.mQuality.data(), read.mQuality.size(), read.mQualScores)) {
+        uint8_t lo = 255, hi = 0;
+        sharq::simd::minmax((const char*)read.mQualScores.data(), read.mQualScores.size(), lo, hi);
+        if (read.mQualScores.empty() || (lo >= ScoreValidator::min_score() && hi <= ScoreValidator::max_score()))
+            return num_qual_finalize<ScoreValidator>(read);
+    }
     read.mQualScores.clear();
     uint8_t score;
     for (auto c : read.mQuality) {
@@ -1071,6 +1121,12 @@ void fastq_reader::num_qual_validator(CFastqRead& read)
                     read.Spot(), score, ScoreValidator::min_score(), ScoreValidator::max_score());
         read.mQualScores.push_back(score);
     }
+    num_qual_finalize<ScoreValidator>(read);
+}
+
+template<typename ScoreValidator>
+void fastq_reader::num_qual_finalize(CFastqRead& read)
+{
     int qual_size = read.mQualScores.size();
     int sz = read.mSequence.size();
     if (qual_size > sz) {
@@ -1093,8 +1149,7 @@ void fastq_reader::num_qual_validator(CFastqRead& read)
     if (m_curr_platform != m_defline_parser.GetPlatform())
         throw fastq_error(70, "Input file has data from multiple platforms ({} != {})", m_curr_platform, m_defline_parser.GetPlatform());
 
-    for (const auto& it : read.mQualScores)
-        ++m_input_metrics.quality_counts[it];
+    sharq::simd::count_bytes(read.mQualScores.data(), read.mQualScores.size(), m_input_metrics.quality_counts);
 }
 
 
@@ -1115,11 +1170,13 @@ void fastq_reader::char_qual_validator(CFastqRead& read)
         read.mQuality.resize( sz );
     }
 
-    for (auto c : read.mQuality) {
-        int score = int(c);
-        if (!(score >= ScoreValidator::min_score() && score <= ScoreValidator::max_score()))
-            throw fastq_error(120, "Read {}: unexpected quality score value '{}' ( valid range: [{}..{}] )",
-                    read.Spot(), score, ScoreValidator::min_score(), ScoreValidator::max_score());
+    if (!sharq::simd::in_range<ScoreValidator::min_score(), ScoreValidator::max_score()>(read.mQuality.data(), read.mQuality.size())) {
+        for (auto c : read.mQuality) {
+            int score = int(c);
+            if (!(score >= ScoreValidator::min_score() && score <= ScoreValidator::max_score()))
+                throw fastq_error(120, "Read {}: unexpected quality score value '{}' ( valid range: [{}..{}] )",
+                        read.Spot(), score, ScoreValidator::min_score(), ScoreValidator::max_score());
+        }
     }
     if (qual_size < sz) {
         if (qual_size == 0 && !eof())
@@ -1130,8 +1187,7 @@ void fastq_reader::char_qual_validator(CFastqRead& read)
     if (m_curr_platform != m_defline_parser.GetPlatform())
         throw fastq_error(70, "Input file has data from multiple platforms ({} != {})", m_curr_platform, m_defline_parser.GetPlatform());
 
-    for (const auto& c : read.mQuality)
-        ++m_input_metrics.quality_counts[c];
+    sharq::simd::count_bytes(read.mQuality.data(), read.mQuality.size(), m_input_metrics.quality_counts);
 }
 
 
@@ -1144,6 +1200,7 @@ void fastq_reader::start_reading()
     //m_validate_future = executor.async([&]() {
     m_read_future = std::async(std::launch::async, [&]() {
         CFastqRead read;
+        auto& stage = pipeline_stats.stage("reader");
         BEGIN_MT_EXCEPTION
         
         while (pipeline_cancelled == false) {
@@ -1155,6 +1212,7 @@ void fastq_reader::start_reading()
 
                 //m_validate_queue->enqueue(std::move(read));
                 m_read_queue->enqueue(std::move(read));
+                stage.add();
 
             } catch (fastq_error& e) {
                 e.set_file(m_file_name, read.LineNumber());
@@ -1239,40 +1297,102 @@ void serialize_vec(const string& file_name, str_sv_type& vec)
 }
 
 
-/*!
- *  This function searches list of terms in vec using sparse_vector_scanner.
- *
- *  @param[in] vec  string vector to search in
- *
- *  @param[in] scanner  sparse_vector_scanner to use for the search
- *
- *  @param[in] term  list of terms to search
- *
- *  @return index of found term or -1
+static constexpr size_t DUPLICATE_CHECK_BATCH = 1000000;
+
+/**
+ * @brief Exact check of spot_name_check hits
  *
+ * spot_name_check only tells that a name was probably seen before.
+ * The hits are resolved in batches with a single pass over the names collected so far,
+ * the pass is split into index ranges scanned in parallel against a hash set of the hit names.
+ * A hit is a duplicate if its name occurs at a smaller index.
  */
-
-template<typename ErrorChecker>
-int s_find_duplicates(str_sv_type& vec, bm::sparse_vector_scanner<str_sv_type>& scanner, const vector<string>& terms, ErrorChecker&& error_checker)
+class duplicate_name_finder
 {
-    auto sz = terms.size();
-    if (sz == 0)
-        return -1;
-    bm::sparse_vector_scanner<str_sv_type>::pipeline<bm::agg_opt_only_counts> pipe(vec);
-    pipe.options().batch_size = 0;
-    for (const auto& term : terms)
-        pipe.add(term.c_str());
-    pipe.complete();
-    scanner.find_eq_str(pipe); // run the search pipeline
-    auto& cnt_vect = pipe.get_bv_count_vector();
-    for (size_t i = 0; i < sz; ++i) {
-        if (cnt_vect[i] > 1) {
-            fastq_error e(170, "SRAE-75: Collation check. Duplicate spot '{}' at index {}", terms[i], i);
-            error_checker(e);
+public:
+    /**
+     * @brief Add a hit
+     *
+     * @param[in] name   spot name
+     * @param[in] index  index of the name in the names vector
+     */
+    void add(const string& name, size_t index) {
+        m_hits.push_back({name, index});
+    }
+
+    size_t size() const { return m_hits.size(); }
+
+    bool empty() const { return m_hits.empty(); }
+
+    /**
+     * @brief Resolve the hits collected so far
+     *
+     * @param[in] names    names vector, hit indices refer to it
+     * @param[in] threads  number of scanning threads
+     *
+     * @return positions (in order of add) of the hits that are duplicates, the hits are cleared
+     */
+    vector<size_t> resolve(const str_sv_type& names, unsigned threads) {
+        vector<size_t> dups;
+        if (m_hits.empty())
+            return dups;
+
+        unordered_map<string_view, size_t> slots;
+        slots.reserve(m_hits.size());
+        size_t end = 0;
+        for (const auto& hit : m_hits) {
+            slots.emplace(hit.name, slots.size());
+            end = max(end, hit.index + 1);
+        }
+        end = min<size_t>(end, names.size());
+
+        // first index of each hit name in each range, ranges are in index order
+        threads = max(1u, min<unsigned>(threads, end / 100000 + 1));
+        vector<vector<size_t>> first(threads);
+        auto scan = [&](unsigned t) {
+            auto& range_first = first[t];
+            range_first.assign(slots.size(), numeric_limits<size_t>::max());
+            size_t from = end * t / threads;
+            size_t to = end * (t + 1) / threads;
+            if (from == to)
+                return;
+            str_sv_type::const_iterator it(&names, from);
+            for (size_t i = from; i < to && it.valid(); ++i, it.advance()) {
+                auto slot = slots.find(string_view(it.value()));
+                if (slot != slots.end() && range_first[slot->second] == numeric_limits<size_t>::max())
+                    range_first[slot->second] = i;
+            }
+        };
+        vector<future<void>> futures;
+        for (unsigned t = 1; t < threads; ++t)
+            futures.push_back(std::async(std::launch::async, scan, t));
+        scan(0);
+        for (auto& f : futures)
+            f.get();
+
+        for (size_t i = 0; i < m_hits.size(); ++i) {
+            auto slot = slots[m_hits[i].name];
+            size_t first_index = numeric_limits<size_t>::max();
+            for (const auto& range_first : first) {
+                if (range_first[slot] != numeric_limits<size_t>::max()) {
+                    first_index = range_first[slot];
+                    break;
+                }
+            }
+            if (first_index < m_hits[i].index)
+                dups.push_back(i);
         }
+        m_hits.clear();
+        return dups;
     }
-    return -1;
-}
+
+private:
+    struct hit_t {
+        string name;
+        size_t index;
+    };
+    vector<hit_t> m_hits;
+};
 
 
 template<typename TWriter>
@@ -1282,20 +1402,13 @@ void fastq_parser<TWriter>::check_duplicate_spot_names(const vector<search_term_
     auto sz = terms.size();
     if (sz == 0)
         return;
-    static thread_local bm::sparse_vector_scanner<str_sv_type> scanner;
     spdlog::stopwatch sw;
-    bm::sparse_vector_scanner<str_sv_type>::pipeline<bm::agg_opt_only_counts> pipe(m_spot_names);
-    pipe.options().batch_size = 0;
+    duplicate_name_finder finder;
     for (const auto& term : terms)
-        pipe.add(term.spot_name.c_str());
-    pipe.complete();
-    scanner.find_eq_str(pipe); // run the search pipeline
-    auto& cnt_vect = pipe.get_bv_count_vector();
-    for (size_t i = 0; i < sz; ++i) {
-        if (cnt_vect[i] > 1) {
-            fastq_error e(170, "SRAE-75: Collation check. Duplicate spot '{}' at file {}, line {}", terms[i].spot_name, m_readers[terms[i].reader_idx].file_name(), terms[i].line_no);
-            error_checker(e);
-        }
+        finder.add(term.spot_name, term.index);
+    for (auto i : finder.resolve(m_spot_names, m_threads)) {
+        fastq_error e(170, "SRAE-75: Collation check. Duplicate spot '{}' at file {}, line {}", terms[i].spot_name, m_readers[terms[i].reader_idx].file_name(), terms[i].line_no);
+        error_checker(e);
     }
     spdlog::info("check_duplicate_spot_names time: {} size: {}", sw, sz);
 }
@@ -1328,6 +1441,7 @@ void fastq_parser<TWriter>::parse(spot_name_check& name_checker, ErrorChecker&&
     search_terms.reserve(10000);
 
     string spot_name;
+    size_t spot_index = m_spot_names.size();
     for_each_spot<ScoreValidator>(error_checker, [&](vector<fastq_read>& assembled_spot) {
         assert(assembled_spot.empty() == false);
         spot_name = assembled_spot.front().Spot();
@@ -1336,14 +1450,14 @@ void fastq_parser<TWriter>::parse(spot_name_check& name_checker, ErrorChecker&&
         assemble_spot_queue->enqueue(std::move(assembled_spot));
         spot_names_bi = spot_name; 
         if (name_checker.seen_before(spot_name.c_str(), spot_name.size())) {
-            search_terms.emplace_back() = { std::move(spot_name), line_no, reader_idx };
-            if (search_terms.size() == 10000) {
+            search_terms.emplace_back() = { std::move(spot_name), line_no, reader_idx, spot_index };
+            if (search_terms.size() == DUPLICATE_CHECK_BATCH) {
                 spot_names_bi.flush();
                 check_duplicate_spot_names(search_terms, error_checker);
                 search_terms.clear();
             }
         }
-
+        ++spot_index;
     });
     assemble_spot_queue->close();
 
@@ -1423,28 +1537,20 @@ void fastq_parser<TWriter>::update_telemetry(const spot_t& reads)
     
     m_telemetry.output_metrics.read_count += reads.size();
     ++m_telemetry.output_metrics.spot_count;
-    vector<uint8_t> qual_scores;
     for (const auto& r : reads) {
         auto sz = r.Sequence().size();
         m_telemetry.output_metrics.sequence_len += sz;
         if (r.mReadType != SRA_READ_TYPE_TECHNICAL) {
             m_telemetry.output_metrics.sequence_len_bio += sz;
-            for (const auto& c : r.Sequence()) {
-                ++m_telemetry.output_metrics.base_counts[c];
-            }
+            sharq::simd::count_bytes(r.Sequence().data(), sz, m_telemetry.output_metrics.base_counts);
         } else {
-            for (const auto& c : r.Sequence()) {
-                ++m_telemetry.output_metrics.tech_base_counts[c];
-            }
-        }
-        qual_scores.clear();
-        r.GetQualScores(qual_scores);
-        for (const auto& c : qual_scores) {
-            ++m_telemetry.output_metrics.quality_counts[c];
+            sharq::simd::count_bytes(r.Sequence().data(), sz, m_telemetry.output_metrics.tech_base_counts);
         }
+        const auto& qual_scores = r.GetQualScores();
+        sharq::simd::count_bytes(qual_scores.data(), qual_scores.size(), m_telemetry.output_metrics.quality_counts);
         telemetry.max_sequence_size = max<int>(sz, telemetry.max_sequence_size);
         telemetry.min_sequence_size = min<size_t>(sz, telemetry.min_sequence_size);
-        m_telemetry.output_metrics.quality_len += r.GetQualScores().size();
+        m_telemetry.output_metrics.quality_len += qual_scores.size();
     }
     
     if ((int)reads.size() < telemetry.reads_per_spot)
@@ -1520,6 +1626,10 @@ void s_check_qual_score(const CFastqRead& read, qual_score_params& params)
         }
         set_score(str);
     } else {
+        uint8_t lo = 255, hi = 0;
+        sharq::simd::minmax(quality.data(), quality.size(), lo, hi);
+        if (!quality.empty() && params.set_score(lo) && params.set_score(hi))
+            return;
         for (auto c : quality) {
             if (!params.set_score(int(c)))
                 throw fastq_error(140, "Read {}: quality score contains unexpected character '{}'", read.Spot(), int(c));
@@ -1618,16 +1728,25 @@ void check_hash_file(const string& hash_file)
     }
     spdlog::stopwatch sw;
 
-    bm::sparse_vector_scanner<str_sv_type> str_scan;
     spot_name_check name_check(vec.size());
 
     size_t index = 0, hits = 0, sz = 0, last_hits = 0;
     const char* value;
     bool hit;
     auto it = vec.begin();
-    vector<string> search_terms;
+    vector<size_t> search_terms;
     search_terms.reserve(10000);
+    duplicate_name_finder finder;
     auto err_checker = [](fastq_error& e) -> void { throw e;};
+    auto find_duplicates = [&]() {
+        bm::chrono_taker<> tt1(std::cout, "scan", search_terms.size(), &timing_map);
+        for (auto i : finder.resolve(vec, std::thread::hardware_concurrency())) {
+            str_sv_type::const_iterator dup(&vec, search_terms[i]);
+            fastq_error e(170, "SRAE-75: Collation check. Duplicate spot '{}' at index {}", dup.value(), search_terms[i]);
+            err_checker(e);
+        }
+        search_terms.clear();
+    };
 
     while (it.valid()) {
         value = it.value();
@@ -1638,12 +1757,10 @@ void check_hash_file(const string& hash_file)
         }
         if (hit) {
             ++hits;
-            search_terms.push_back(value);
-            if (search_terms.size() == 10000) {
-                bm::chrono_taker<> tt1(std::cout, "scan", search_terms.size(), &timing_map);
-                s_find_duplicates(vec, str_scan, search_terms, err_checker);
-                search_terms.clear();
-             }
+            search_terms.push_back(index);
+            finder.add(value, index);
+            if (search_terms.size() == DUPLICATE_CHECK_BATCH)
+                find_duplicates();
         }
         it.advance();
         if (++index % 100000000 == 0) {
@@ -1653,10 +1770,8 @@ void check_hash_file(const string& hash_file)
             timing_map.clear();
         }
     }
-    if (!search_terms.empty()) {
-        bm::chrono_taker<> tt1(std::cout, "scan", search_terms.size(), &timing_map);
-        s_find_duplicates(vec, str_scan, search_terms, err_checker);
-    }
+    if (!search_terms.empty())
+        find_duplicates();
 
     {
         spdlog::debug("index:{:L}, elapsed:{:.2f}, hits:{}, total_hits:{}, memory_used:{:L}", index, sw, hits - last_hits, hits, name_check.memory_used());
@@ -1888,7 +2003,7 @@ void fastq_parser<TWriter>::set_readers(json& group, bool update_telemetry)
             read_types = data["readType"];
         else
             read_types.clear();  
-        m_readers.emplace_back(name, s_OpenStream(name, (1024 * 1024) * 10), read_types, data["platform_code"].front());
+        m_readers.emplace_back(name, s_OpenStream(name, (1024 * 1024) * 10, m_inflate_threads), read_types, data["platform_code"].front());
         if (!data["readNums"].empty())
             ++files_with_read_numbers;
     }
@@ -1950,6 +2065,8 @@ void fastq_parser<TWriter>::report_telemetry(json& j)
 
         if (j.contains("is_spot_assembly")) {
             im["far_reads"] = m_telemetry.assembly_metrics.number_of_far_reads;
+            if (m_telemetry.assembly_metrics.spilled_bytes)
+                im["spilled_bytes"] = m_telemetry.assembly_metrics.spilled_bytes;
         }
 
         auto& om = j["o"];
@@ -2193,6 +2310,23 @@ void fastq_parser<TWriter>::for_each_spot(ErrorChecker&& error_checker, T&& func
 }
 
 
+template<typename TWriter>
+template<typename T>
+void fastq_parser<TWriter>::for_each_cached_read(T&& func)
+{
+    CFastqRead read;
+    string tmp;
+    size_t row_id = 0;
+    m_first_pass_cache.for_each_record([&](const string& record) {
+        if (pipeline_cancelled)
+            return;
+        read_cache_decode(record, read, tmp);
+        func(row_id, read);
+        ++row_id;
+    });
+    m_first_pass_cache.close();
+}
+
 /**
  * gets top spot spot name for each reader
  * and retrieves next reads belonging to the same spot from other readers
@@ -2217,11 +2351,23 @@ void fastq_parser<TWriter>::first_pass(str_sv_type& read_names, ErrorChecker&& e
     spdlog::info("Parsing from {} files", m_readers.size());
 
     auto read_names_bi = read_names.get_back_inserter();
-    for_each_read<ScoreValidator, ErrorChecker>(error_checker, [&](size_t row_id, CFastqRead& read) {
-        read_names_bi = read.Spot();
-    });
+    if (!m_first_pass_cache_dir.empty()) {
+        m_first_pass_cache.open(fmt::format("{}/sharq.{}.first_pass", m_first_pass_cache_dir, getpid()));
+        string record;
+        for_each_read<ScoreValidator, ErrorChecker>(error_checker, [&](size_t row_id, CFastqRead& read) {
+            read_names_bi = read.Spot();
+            read_cache_encode(read, record);
+            m_first_pass_cache.append(record);
+        });
+    } else {
+        for_each_read<ScoreValidator, ErrorChecker>(error_checker, [&](size_t row_id, CFastqRead& read) {
+            read_names_bi = read.Spot();
+        });
+    }
     read_names_bi.flush();
     spdlog::info("reading took: {}, {:L} reads", sw, read_names.size());
+    if (m_first_pass_cache.is_open())
+        spdlog::info("first pass cache: {:L} bytes", m_first_pass_cache.bytes_written());
     sw.reset();
     read_names.remap();
     str_sv_type::statistics stats;
@@ -2271,8 +2417,10 @@ void fastq_parser<TWriter>::save_spot_thread()
     vector<int> read_ids;
     size_t spot_id = 0;
     string spot_name;
+    auto& stage = pipeline_stats.stage("save_spot");
     //vector<uint8_t> qs1, qs2;
     while (save_spot_queue->dequeue(spot_read)) {
+        stage.add();
         auto& read = spot_read.read;
         assert(read.m_SpotId != 0);
         if (spot_read.is_last) {
@@ -2434,7 +2582,9 @@ void fastq_parser<TWriter>::assemble_spot_thread()
     vector<fastq_read> assembled_spot;
     vector<int> read_ids;
     size_t readCount = 0, spotCount = 0, currCount = 0;
+    auto& stage = pipeline_stats.stage("assemble");
     while (assemble_spot_queue->dequeue(assembled_spot)) {
+        stage.add();
         m_writer->write_messages();
         m_writer->write_spot(assembled_spot.front().Spot(), assembled_spot);
         ++spotCount;
@@ -2462,7 +2612,9 @@ void fastq_parser<TWriter>::clear_spot_thread()
     // get spot_id from clear_spot_queue
     // and clear it from memory
     size_t spot_id;
+    auto& stage = pipeline_stats.stage("clear");
     while (clear_spot_queue->dequeue(spot_id)) {
+        stage.add();
         assert(spot_id != 0);
         m_spot_assembly. template clear_spot_mt<is_nanopore>(spot_id);
     }
@@ -2472,7 +2624,9 @@ template<typename TWriter>
 void fastq_parser<TWriter>::update_telemetry_thread()
 {
     spot_t spot;
+    auto& stage = pipeline_stats.stage("telemetry");
     while (update_telemetry_queue->dequeue(spot)) {
+        stage.add();
         update_telemetry(spot); 
     }
 
@@ -2484,7 +2638,9 @@ void fastq_parser<TWriter>::write_spot_thread()
     size_t spotCount = 0, readCount = 0, currCount = 0;
     
     vector<fastq_read> assembled_spot;
+    auto& stage = pipeline_stats.stage("write");
     while (assemble_spot_queue->dequeue(assembled_spot)) {
+        stage.add();
         assert(assembled_spot.empty() == false);
         auto spot_size = assembled_spot.size();
         auto& spot = assembled_spot.front().Spot();
@@ -2530,7 +2686,7 @@ void fastq_parser<TWriter>::second_pass(ErrorChecker&& error_checker, const vect
     futures[0] = std::async(std::launch::async, [this](){ BEGIN_MT_EXCEPTION this->update_telemetry_thread(); END_MT_EXCEPTION }); 
 
     spot_read_t spot_read;
-    for_each_read<ScoreValidator, ErrorChecker>(error_checker, [&](size_t row_id, CFastqRead& read) {
+    auto process_read = [&](size_t row_id, CFastqRead& read) {
         try {
             read.m_SpotId = read_index[row_id];
             spot_read.read = std::move(read);
@@ -2545,7 +2701,11 @@ void fastq_parser<TWriter>::second_pass(ErrorChecker&& error_checker, const vect
         } catch (fastq_error& e) {
             error_checker(e);
         }
-    });
+    };
+    if (has_first_pass_cache())
+        for_each_cached_read(process_read);
+    else
+        for_each_read<ScoreValidator, ErrorChecker>(error_checker, process_read);
     save_spot_queue->close();
 
     for (auto& ft : futures) {
@@ -2560,6 +2720,7 @@ void fastq_parser<TWriter>::second_pass(ErrorChecker&& error_checker, const vect
         throw fastq_error("Invalid assembly: Spot counts do not match {} != {}", m_spot_assembly.m_total_spots, spotCount);
     if (read_index.size() != readCount)
         throw fastq_error("Invalid assembly: Read counts do not match {} != {}", read_index.size(), readCount);        
+    m_telemetry.assembly_metrics.spilled_bytes += m_spot_assembly.spilled_bytes();
 
     if (m_telemetry.groups.back().rejected_spots > 0)
         spdlog::info("rejected spots: {:L}", m_telemetry.groups.back().rejected_spots);
@@ -2577,7 +2738,7 @@ void fastq_parser<TWriter>::second_pass(ErrorChecker&& error_checker, const vect
     spdlog::stopwatch sw;
     spdlog::info("Parsing from {} files", m_readers.size());
 
-    for_each_read<ScoreValidator, ErrorChecker>(error_checker, [&](size_t row_id, CFastqRead& read) {
+    auto process_read = [&](size_t row_id, CFastqRead& read) {
         try {
             auto spot_id = read_index[row_id];
             if (m_spot_assembly.is_last_spot(row_id)) {
@@ -2599,7 +2760,11 @@ void fastq_parser<TWriter>::second_pass(ErrorChecker&& error_checker, const vect
         } catch (fastq_error& e) {
             error_checker(e);
         }
-    });
+    };
+    if (has_first_pass_cache())
+        for_each_cached_read(process_read);
+    else
+        for_each_read<ScoreValidator, ErrorChecker>(error_checker, process_read);
 
     // Second pass stats should match the first pass
     assert(m_spot_assembly.m_total_spots == spotCount && read_index.size() == readCount);
@@ -2607,6 +2772,7 @@ void fastq_parser<TWriter>::second_pass(ErrorChecker&& error_checker, const vect
         throw fastq_error("Invalid assembly: Spot counts do not match {} != {}", m_spot_assembly.m_total_spots, spotCount);
     if (read_index.size() != readCount)
         throw fastq_error("Invalid assembly: Read counts do not match {} != {}", read_index.size(), readCount);        
+    m_telemetry.assembly_metrics.spilled_bytes += m_spot_assembly.spilled_bytes();
 
     if (m_telemetry.groups.back().rejected_spots > 0)
         spdlog::info("rejected spots: {:L}", m_telemetry.groups.back().rejected_spots);
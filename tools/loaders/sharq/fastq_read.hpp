@@ -79,7 +79,9 @@ public:
     void SetNanoporeReadNo(const re2::StringPiece& readNo) { readNo.CopyToString(&mNanoporeReadNo); }
 
     void SetSequence(string sequence) { mSequence = std::move(sequence); }
+    void SetQuality(string quality) { mQuality = std::move(quality); }
     void SetQualScores(vector<uint8_t> qual_scores) { mQualScores = std::move(qual_scores); }
+    bool HasQualScores() const { return !mQualScores.empty(); } ///< true if numeric scores were set
 
     size_t m_SpotId = 0;     ///< Assigned spot_id  
     uint8_t m_ReaderIdx = 0; /// Reader's index
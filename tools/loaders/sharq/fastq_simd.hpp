@@ -0,0 +1,214 @@
+#ifndef __CFASTQ_SIMD_HPP__
+#define __CFASTQ_SIMD_HPP__
+
+/**
+ * @file fastq_simd.hpp
+ * @brief Byte scanning kernels for sequence and quality validation
+ *
+ * AVX2 or SSE4.2 versions are compiled in when the compiler targets them
+ * (-mavx2, -msse4.2), scalar code is used otherwise and for the tails.
+ * The kernels only answer the common case quickly, callers keep their
+ * byte by byte code to report errors.
+ */
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+using namespace std;
+
+namespace sharq {
+
+namespace simd {
+
+/// C locale isspace
+inline bool is_space(uint8_t c)
+{
+    return c == ' ' || uint8_t(c - '\t') <= '\r' - '\t';
+}
+
+/// ASCII letter
+inline bool is_alpha(uint8_t c)
+{
+    return uint8_t((c | 0x20) - 'a') <= 'z' - 'a';
+}
+
+#if defined(__AVX2__)
+
+typedef __m256i vec_t;
+constexpr size_t VEC_SIZE = 32;
+
+inline vec_t v_load(const char* p) { return _mm256_loadu_si256((const __m256i*)p); }
+inline vec_t v_set1(char c) { return _mm256_set1_epi8(c); }
+inline vec_t v_min(vec_t a, vec_t b) { return _mm256_min_epu8(a, b); }
+inline vec_t v_max(vec_t a, vec_t b) { return _mm256_max_epu8(a, b); }
+inline vec_t v_or(vec_t a, vec_t b) { return _mm256_or_si256(a, b); }
+inline vec_t v_sub(vec_t a, vec_t b) { return _mm256_sub_epi8(a, b); }
+inline vec_t v_eq(vec_t a, vec_t b) { return _mm256_cmpeq_epi8(a, b); }
+inline bool v_all(vec_t mask) { return _mm256_movemask_epi8(mask) == -1; }
+inline void v_store(uint8_t* p, vec_t v) { _mm256_storeu_si256((__m256i*)p, v); }
+
+#elif defined(__SSE4_2__)
+
+typedef __m128i vec_t;
+constexpr size_t VEC_SIZE = 16;
+
+inline vec_t v_load(const char* p) { return _mm_loadu_si128((const __m128i*)p); }
+inline vec_t v_set1(char c) { return _mm_set1_epi8(c); }
+inline vec_t v_min(vec_t a, vec_t b) { return _mm_min_epu8(a, b); }
+inline vec_t v_max(vec_t a, vec_t b) { return _mm_max_epu8(a, b); }
+inline vec_t v_or(vec_t a, vec_t b) { return _mm_or_si128(a, b); }
+inline vec_t v_sub(vec_t a, vec_t b) { return _mm_sub_epi8(a, b); }
+inline vec_t v_eq(vec_t a, vec_t b) { return _mm_cmpeq_epi8(a, b); }
+inline bool v_all(vec_t mask) { return _mm_movemask_epi8(mask) == 0xffff; }
+inline void v_store(uint8_t* p, vec_t v) { _mm_storeu_si128((__m128i*)p, v); }
+
+#else
+
+constexpr size_t VEC_SIZE = 0;
+
+#endif
+
+/**
+ * @brief Smallest and largest byte value (unsigned)
+ *
+ * lo and hi are updated, not reset
+ */
+inline void minmax(const char* p, size_t n, uint8_t& lo, uint8_t& hi)
+{
+    size_t i = 0;
+#if defined(__AVX2__) || defined(__SSE4_2__)
+    if (n >= VEC_SIZE) {
+        vec_t vlo = v_set1(char(lo));
+        vec_t vhi = v_set1(char(hi));
+        for (; i + VEC_SIZE <= n; i += VEC_SIZE) {
+            vec_t v = v_load(p + i);
+            vlo = v_min(vlo, v);
+            vhi = v_max(vhi, v);
+        }
+        uint8_t buf[VEC_SIZE];
+        v_store(buf, vlo);
+        for (auto c : buf)
+            lo = min(lo, c);
+        v_store(buf, vhi);
+        for (auto c : buf)
+            hi = max(hi, c);
+    }
+#endif
+    for (; i < n; ++i) {
+        lo = min(lo, uint8_t(p[i]));
+        hi = max(hi, uint8_t(p[i]));
+    }
+}
+
+/**
+ * @brief All bytes are within [min_value..max_value]
+ */
+template<int min_value, int max_value>
+bool in_range(const char* p, size_t n)
+{
+    static_assert(min_value >= 0 && max_value <= 255, "byte range expected");
+    uint8_t lo = 255;
+    uint8_t hi = 0;
+    minmax(p, n, lo, hi);
+    return n == 0 || (lo >= min_value && hi <= max_value);
+}
+
+/**
+ * @brief All bytes are ASCII letters
+ */
+inline bool all_alpha(const char* p, size_t n)
+{
+    size_t i = 0;
+#if defined(__AVX2__) || defined(__SSE4_2__)
+    const vec_t lower = v_set1(0x20);
+    const vec_t a = v_set1('a');
+    const vec_t range = v_set1('z' - 'a');
+    for (; i + VEC_SIZE <= n; i += VEC_SIZE) {
+        // (c | 0x20) - 'a' <= 25
+        vec_t d = v_sub(v_or(v_load(p + i), lower), a);
+        if (!v_all(v_eq(v_min(d, range), d)))
+            return false;
+    }
+#endif
+    for (; i < n; ++i) {
+        if (!is_alpha(p[i]))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Add byte value counts to counts
+ *
+ * Long inputs are counted into four tables
+ * so that runs of the same value do not serialize on one counter
+ */
+template<typename T>
+void count_bytes(const T* p, size_t n, array<size_t, 256>& counts)
+{
+    static_assert(sizeof(T) == 1, "byte input expected");
+    const uint8_t* s = (const uint8_t*)p;
+    if (n < 256) {
+        for (size_t i = 0; i < n; ++i)
+            ++counts[s[i]];
+        return;
+    }
+    uint32_t tables[4][256];
+    memset(tables, 0, sizeof(tables));
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        ++tables[0][s[i]];
+        ++tables[1][s[i + 1]];
+        ++tables[2][s[i + 2]];
+        ++tables[3][s[i + 3]];
+    }
+    for (; i < n; ++i)
+        ++tables[0][s[i]];
+    for (size_t c = 0; c < 256; ++c)
+        counts[c] += size_t(tables[0][c]) + tables[1][c] + tables[2][c] + tables[3][c];
+}
+
+/**
+ * @brief Parse space delimited numeric quality scores
+ *
+ * Only tokens of the form -?\d{1,3} are accepted, the values are stored as uint8_t
+ * the same way stoi results are.
+ *
+ * @return false on anything else, scores are undefined then
+ */
+inline bool parse_scores(const char* p, size_t n, vector<uint8_t>& scores)
+{
+    scores.clear();
+    size_t i = 0;
+    while (i < n) {
+        if (is_space(p[i])) {
+            ++i;
+            continue;
+        }
+        bool negative = p[i] == '-';
+        if (negative)
+            ++i;
+        size_t start = i;
+        int value = 0;
+        while (i < n && p[i] >= '0' && p[i] <= '9' && i - start < 3)
+            value = value * 10 + (p[i++] - '0');
+        if (i == start || (i < n && !is_space(p[i])))
+            return false;
+        scores.push_back(uint8_t(negative ? -value : value));
+    }
+    return true;
+}
+
+} // namespace simd
+
+} // namespace sharq
+
+#endif
@@ -382,6 +382,11 @@ void fastq_writer_vdb::open()
     if (!platform.empty())
         m_platform = stoi(platform);
 
+    string shm_ring;
+    get_attr("shm_ring", shm_ring);
+    if (!shm_ring.empty() && !m_writer->useSharedRing(shm_ring))
+        spdlog::warn("Shared-memory ring in '{}' is not available, writing to the pipe", shm_ring);
+
     string destination{"sra.out"};
     get_attr("destination", destination);
     m_writer->destination(destination);
@@ -0,0 +1,537 @@
+#ifndef __GZ_INFLATE_HPP__
+#define __GZ_INFLATE_HPP__
+
+/**
+ * @file gz_inflate.hpp
+ * @brief Multi-threaded gzip input stream
+ *
+ * Files made of several gzip members (BGZF, concatenated gzip) are inflated
+ * block-parallel: compressed ranges consisting of whole members are inflated
+ * on a fixed pool of worker threads and the results are delivered in file order.
+ * Single-stream gzip is inflated on a dedicated read-ahead thread.
+ * The consumer reads decompressed chunks from a bounded queue.
+ */
+
+/*
+* ===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <istream>
+#include <streambuf>
+#include <string>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <stdexcept>
+#include <cstring>
+#include <zlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <spdlog/fmt/fmt.h>
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+// gz_inflate_buf - streambuf over a gzip file inflated by background threads
+//
+// The driver thread reads the compressed file and decides how it is inflated:
+//   - the first member is inflated sequentially by the driver thread itself,
+//     a single-stream file never leaves this step
+//   - BGZF blocks are grouped into jobs of JOB_SIZE compressed bytes
+//   - other members are split at candidate member headers, a job is accepted
+//     only if its range inflates to a sequence of complete members;
+//     on failure (a false candidate) the member is inflated sequentially
+
+class gz_inflate_buf : public std::streambuf {
+public:
+    static constexpr size_t READ_SIZE = 4 * 1024 * 1024;   ///< file read size
+    static constexpr size_t JOB_SIZE = 1024 * 1024;        ///< min compressed size of a parallel job
+    static constexpr size_t CHUNK_SIZE = 1024 * 1024;      ///< sequential inflate output chunk
+    static constexpr size_t MAX_SCAN_SIZE = 64 * 1024 * 1024; ///< candidate search limit before falling back to sequential inflate
+    static constexpr size_t QUEUE_SIZE = 16;               ///< decompressed chunks kept ahead of the consumer
+
+    gz_inflate_buf(const string& file_name, unsigned threads);
+    ~gz_inflate_buf();
+    gz_inflate_buf(const gz_inflate_buf&) = delete;
+    gz_inflate_buf& operator=(const gz_inflate_buf&) = delete;
+
+    /// true if the file starts with the gzip magic
+    static bool is_gzip(const string& file_name);
+
+    /// compressed bytes consumed by the inflater
+    size_t compressed_pos() const { return m_compressed_pos; }
+
+protected:
+    int_type underflow() override;
+
+private:
+    struct job_t {
+        size_t end = 0;      ///< file offset past the range
+        string out;          ///< decompressed data
+        bool ok = false;     ///< range is a sequence of complete members
+    };
+
+    void x_run();
+    bool x_fill(size_t until);
+    const char* x_in(size_t pos) const { return m_in.data() + (pos - m_in_base); }
+    size_t x_in_end() const { return m_in_base + m_in.size(); }
+    bool x_at_member(size_t pos);
+    size_t x_bgzf_block_size(size_t pos);
+    bool x_is_candidate(size_t pos) const;
+    size_t x_next_range(size_t pos, bool bgzf);
+    bool x_inflate_member();
+    void x_run_parallel(bool bgzf);
+    void x_run_jobs(bool bgzf);
+    static void x_inflate_job(job_t& job, string data);
+    bool x_push(string&& chunk);
+    void x_start_workers();
+    void x_stop_workers();
+    future<job_t> x_submit(size_t end, string data);
+
+    string m_file_name;
+    unsigned m_threads;
+    int m_fd = -1;
+
+    // compressed input, owned by the driver thread
+    string m_in;                  ///< buffered file data starting at m_in_base
+    size_t m_in_base = 0;         ///< file offset of m_in[0]
+    size_t m_in_pos = 0;          ///< file offset of the next member to deliver
+    bool m_in_eof = false;
+    atomic<size_t> m_compressed_pos{0};
+
+    // decompressed output
+    mutex m_mutex;
+    condition_variable m_cv;
+    deque<string> m_queue;
+    bool m_done = false;          ///< driver finished
+    bool m_stop = false;          ///< consumer is gone
+    exception_ptr m_error;
+    string m_chunk;               ///< chunk being consumed
+
+    // inflate workers, started by the driver once the file turns out to have several members
+    mutex m_pool_mutex;
+    condition_variable m_pool_cv;
+    deque<packaged_task<job_t()>> m_tasks; ///< jobs waiting for a worker
+    bool m_pool_stop = false;
+    vector<thread> m_workers;
+
+    thread m_driver;
+};
+
+bool gz_inflate_buf::is_gzip(const string& file_name)
+{
+    int fd = ::open(file_name.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    unsigned char magic[2] = {0, 0};
+    bool res = ::read(fd, magic, 2) == 2 && magic[0] == 0x1f && magic[1] == 0x8b;
+    ::close(fd);
+    return res;
+}
+
+gz_inflate_buf::gz_inflate_buf(const string& file_name, unsigned threads)
+    : m_file_name(file_name)
+    , m_threads(max(1u, threads))
+{
+    m_fd = ::open(file_name.c_str(), O_RDONLY);
+    if (m_fd < 0)
+        throw runtime_error(fmt::format("Failure to open '{}': {}", file_name, strerror(errno)));
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    setg(nullptr, nullptr, nullptr);
+    m_driver = thread([this]() { x_run(); });
+}
+
+gz_inflate_buf::~gz_inflate_buf()
+{
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    if (m_driver.joinable())
+        m_driver.join();
+    if (m_fd >= 0)
+        ::close(m_fd);
+}
+
+gz_inflate_buf::int_type gz_inflate_buf::underflow()
+{
+    if (gptr() < egptr())
+        return traits_type::to_int_type(*gptr());
+    {
+        unique_lock<mutex> lock(m_mutex);
+        m_cv.wait(lock, [this]() { return !m_queue.empty() || m_done; });
+        if (m_queue.empty()) {
+            if (m_error)
+                rethrow_exception(m_error);
+            return traits_type::eof();
+        }
+        m_chunk = std::move(m_queue.front());
+        m_queue.pop_front();
+    }
+    m_cv.notify_all();
+    char* p = &m_chunk[0];
+    setg(p, p, p + m_chunk.size());
+    return traits_type::to_int_type(*gptr());
+}
+
+bool gz_inflate_buf::x_push(string&& chunk)
+{
+    if (chunk.empty())
+        return true;
+    unique_lock<mutex> lock(m_mutex);
+    m_cv.wait(lock, [this]() { return m_queue.size() < QUEUE_SIZE || m_stop; });
+    if (m_stop)
+        return false;
+    m_queue.push_back(std::move(chunk));
+    lock.unlock();
+    m_cv.notify_all();
+    return true;
+}
+
+// reads the file until it is buffered up to file offset until, returns false at the end of file
+bool gz_inflate_buf::x_fill(size_t until)
+{
+    // drop delivered data
+    if (m_in_pos > m_in_base) {
+        m_in.erase(0, m_in_pos - m_in_base);
+        m_in_base = m_in_pos;
+    }
+    while (!m_in_eof && x_in_end() < until) {
+        size_t sz = m_in.size();
+        m_in.resize(sz + READ_SIZE);
+        ssize_t n;
+        do {
+            n = ::read(m_fd, &m_in[sz], READ_SIZE);
+        } while (n < 0 && errno == EINTR);
+        if (n < 0)
+            throw runtime_error(fmt::format("Failed to read '{}': {}", m_file_name, strerror(errno)));
+        m_in.resize(sz + n);
+        m_in_eof = n == 0;
+    }
+    return x_in_end() >= until;
+}
+
+bool gz_inflate_buf::x_at_member(size_t pos)
+{
+    if (!x_fill(pos + 2))
+        return false;
+    auto p = (const unsigned char*)x_in(pos);
+    return p[0] == 0x1f && p[1] == 0x8b;
+}
+
+// returns the size of the BGZF block at pos, 0 if the member is not a BGZF block
+size_t gz_inflate_buf::x_bgzf_block_size(size_t pos)
+{
+    // ID1 ID2 CM FLG MTIME(4) XFL OS XLEN(2) 'B' 'C' SLEN(2) BSIZE(2)
+    static constexpr size_t HEADER_SIZE = 18;
+    if (!x_fill(pos + HEADER_SIZE))
+        return 0;
+    auto p = (const unsigned char*)x_in(pos);
+    if (p[0] != 0x1f || p[1] != 0x8b || p[2] != 8 || (p[3] & 4) == 0)
+        return 0;
+    if (p[10] < 6 || p[11] != 0 || p[12] != 'B' || p[13] != 'C' || p[14] != 2 || p[15] != 0)
+        return 0;
+    return (p[16] | (p[17] << 8)) + 1;
+}
+
+// candidate member header: magic, deflate, no reserved flags, known XFL
+bool gz_inflate_buf::x_is_candidate(size_t pos) const
+{
+    auto p = (const unsigned char*)x_in(pos);
+    return p[0] == 0x1f && p[1] == 0x8b && p[2] == 8 && (p[3] & 0xe0) == 0 &&
+        (p[8] == 0 || p[8] == 2 || p[8] == 4);
+}
+
+// returns the end of the next job range starting at pos, 0 if no range can be formed
+size_t gz_inflate_buf::x_next_range(size_t pos, bool bgzf)
+{
+    static constexpr size_t GZ_HEADER_SIZE = 10;
+    size_t end = pos;
+    if (bgzf) {
+        while (end - pos < JOB_SIZE) {
+            size_t sz = x_bgzf_block_size(end);
+            if (sz == 0 || !x_fill(end + sz))
+                break;
+            end += sz;
+        }
+        return end > pos ? end : 0;
+    }
+
+    end = pos + JOB_SIZE;
+    while (true) {
+        if (end + GZ_HEADER_SIZE > x_in_end()) {
+            if (end - pos > MAX_SCAN_SIZE)
+                return 0;
+            // the last range runs to the end of the file
+            if (!x_fill(end + GZ_HEADER_SIZE + READ_SIZE) && end + GZ_HEADER_SIZE > x_in_end())
+                return x_in_end() > pos ? x_in_end() : 0;
+        }
+        auto p = (const char*)memchr(x_in(end), 0x1f, x_in_end() - GZ_HEADER_SIZE - end + 1);
+        if (p == nullptr) {
+            end = x_in_end() - GZ_HEADER_SIZE + 1;
+            continue;
+        }
+        end = m_in_base + (p - m_in.data());
+        if (x_is_candidate(end))
+            return end;
+        ++end;
+    }
+}
+
+// inflates the member at m_in_pos and delivers its data
+// returns false if the consumer is gone
+bool gz_inflate_buf::x_inflate_member()
+{
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (inflateInit2(&zs, 15 + 16) != Z_OK)
+        throw runtime_error("Failed to initialize zlib");
+    string out(CHUNK_SIZE, '\0');
+    zs.next_out = (Bytef*)&out[0];
+    zs.avail_out = CHUNK_SIZE;
+    int ret = Z_OK;
+    bool res = true;
+    while (ret != Z_STREAM_END) {
+        if (m_in_pos == x_in_end() && !x_fill(m_in_pos + 1))
+            break; // truncated file, deliver what was inflated
+        zs.next_in = (Bytef*)x_in(m_in_pos);
+        zs.avail_in = (uInt)min<size_t>(x_in_end() - m_in_pos, READ_SIZE);
+        auto avail_in = zs.avail_in;
+        ret = inflate(&zs, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+            inflateEnd(&zs);
+            throw runtime_error(fmt::format("Corrupted gzip file '{}' at offset {}", m_file_name, m_in_pos));
+        }
+        m_in_pos += avail_in - zs.avail_in;
+        m_compressed_pos = m_in_pos;
+        if (zs.avail_out == 0 || ret == Z_STREAM_END) {
+            out.resize(CHUNK_SIZE - zs.avail_out);
+            if (!x_push(std::move(out))) {
+                res = false;
+                break;
+            }
+            out.assign(CHUNK_SIZE, '\0');
+            zs.next_out = (Bytef*)&out[0];
+            zs.avail_out = CHUNK_SIZE;
+        }
+    }
+    inflateEnd(&zs);
+    if (res && ret != Z_STREAM_END) {
+        out.resize(CHUNK_SIZE - zs.avail_out);
+        res = x_push(std::move(out));
+    }
+    return res;
+}
+
+// inflates data as a sequence of complete gzip members
+void gz_inflate_buf::x_inflate_job(job_t& job, string data)
+{
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (inflateInit2(&zs, 15 + 16) != Z_OK)
+        throw runtime_error("Failed to initialize zlib");
+    zs.next_in = (Bytef*)&data[0];
+    zs.avail_in = data.size();
+    auto& out = job.out;
+    out.resize(max(data.size() * 4, CHUNK_SIZE));
+    size_t have = 0;
+    job.ok = false;
+    while (true) {
+        if (have == out.size())
+            out.resize(out.size() * 2);
+        zs.next_out = (Bytef*)&out[have];
+        zs.avail_out = out.size() - have;
+        int ret = inflate(&zs, Z_NO_FLUSH);
+        have = out.size() - zs.avail_out;
+        if (ret == Z_STREAM_END) {
+            if (zs.avail_in == 0) {
+                job.ok = true;
+                break;
+            }
+            if (inflateReset(&zs) != Z_OK)
+                break;
+        } else if (ret != Z_OK || zs.avail_out != 0) {
+            // error or the range ended inside a member
+            break;
+        }
+    }
+    inflateEnd(&zs);
+    out.resize(have);
+}
+
+void gz_inflate_buf::x_start_workers()
+{
+    m_pool_stop = false;
+    for (unsigned i = 0; i < m_threads; ++i) {
+        m_workers.emplace_back([this]() {
+            while (true) {
+                packaged_task<job_t()> task;
+                {
+                    unique_lock<mutex> lock(m_pool_mutex);
+                    m_pool_cv.wait(lock, [this]() { return !m_tasks.empty() || m_pool_stop; });
+                    if (m_pool_stop)
+                        return;
+                    task = std::move(m_tasks.front());
+                    m_tasks.pop_front();
+                }
+                task();
+            }
+        });
+    }
+}
+
+// jobs not taken by a worker yet are dropped, their futures are never waited on
+void gz_inflate_buf::x_stop_workers()
+{
+    {
+        lock_guard<mutex> lock(m_pool_mutex);
+        m_pool_stop = true;
+        m_tasks.clear();
+    }
+    m_pool_cv.notify_all();
+    for (auto& w : m_workers)
+        w.join();
+    m_workers.clear();
+}
+
+future<gz_inflate_buf::job_t> gz_inflate_buf::x_submit(size_t end, string data)
+{
+    packaged_task<job_t()> task([end, data = std::move(data)]() mutable {
+        job_t job;
+        job.end = end;
+        x_inflate_job(job, std::move(data));
+        return job;
+    });
+    auto res = task.get_future();
+    {
+        lock_guard<mutex> lock(m_pool_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_pool_cv.notify_one();
+    return res;
+}
+
+void gz_inflate_buf::x_run_parallel(bool bgzf)
+{
+    x_start_workers();
+    try {
+        x_run_jobs(bgzf);
+    } catch (...) {
+        x_stop_workers();
+        throw;
+    }
+    x_stop_workers();
+}
+
+void gz_inflate_buf::x_run_jobs(bool bgzf)
+{
+    // at most m_threads jobs are in flight, one per worker
+    deque<future<job_t>> in_flight;
+    size_t next = m_in_pos;
+    while (true) {
+        while (in_flight.size() < m_threads && x_at_member(next)) {
+            size_t end = x_next_range(next, bgzf);
+            if (end == 0)
+                break;
+            in_flight.push_back(x_submit(end, string(x_in(next), end - next)));
+            next = end;
+        }
+
+        if (in_flight.empty()) {
+            if (!x_at_member(m_in_pos))
+                break; // end of file, trailing garbage is ignored
+            // no range could be formed: a large member or not a BGZF block
+            if (!x_inflate_member())
+                break;
+            next = m_in_pos;
+            continue;
+        }
+
+        job_t job = in_flight.front().get();
+        in_flight.pop_front();
+        if (job.ok) {
+            m_in_pos = job.end;
+            m_compressed_pos = m_in_pos;
+            if (!x_push(std::move(job.out)))
+                break;
+            continue;
+        }
+        // false candidate or a damaged member: inflate the member sequentially
+        for (auto& f : in_flight)
+            f.wait();
+        in_flight.clear();
+        if (!x_inflate_member())
+            break;
+        next = m_in_pos;
+    }
+}
+
+void gz_inflate_buf::x_run()
+{
+    try {
+        // single-stream files are inflated by this thread in x_inflate_member
+        bool bgzf = x_bgzf_block_size(0) > 0;
+        if (bgzf || x_inflate_member())
+            x_run_parallel(bgzf);
+    } catch (...) {
+        lock_guard<mutex> lock(m_mutex);
+        m_error = current_exception();
+    }
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_done = true;
+    }
+    m_cv.notify_all();
+}
+
+// --------------------------------------------------------------------------
+// gz_istream - input stream over gz_inflate_buf
+
+class gz_istream : public std::istream {
+public:
+    gz_istream(const string& file_name, unsigned threads)
+        : std::istream(nullptr)
+        , m_buf(file_name, threads)
+    {
+        rdbuf(&m_buf);
+        exceptions(std::ios_base::badbit);
+    }
+
+    /// compressed bytes consumed so far
+    size_t compressed_tellg() const { return m_buf.compressed_pos(); }
+
+private:
+    gz_inflate_buf m_buf;
+};
+
+#endif
@@ -0,0 +1,232 @@
+#ifndef __PIPELINE_STATS_HPP__
+#define __PIPELINE_STATS_HPP__
+
+/**
+ * @file pipeline_stats.hpp
+ * @brief Runtime statistics of the parser pipeline queues and stages
+ *
+ * Queues report their depth, the time producers spent waiting for a free slot
+ * and the time consumers spent waiting for an item. Stages count the items they
+ * processed. All counters are relaxed atomics updated by the pipeline threads,
+ * clocks are read only when a queue operation has to wait.
+ * A reporting thread can periodically dump a JSON snapshot to a file.
+ */
+
+/*
+* ===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <json.hpp>
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+/**
+ * @brief Counters of one queue
+ *
+ * Queues with the same name (one read queue per reader) share the counters,
+ * depth is then the total number of items in these queues
+ */
+struct queue_stats_t
+{
+    size_t capacity = 0;
+    atomic<size_t> enqueued{0};
+    atomic<size_t> dequeued{0};
+    atomic<size_t> max_depth{0};
+    atomic<uint64_t> producer_blocked_ns{0};   ///< time spent waiting for a free slot
+    atomic<uint64_t> consumer_starved_ns{0};   ///< time spent waiting for an item
+
+    size_t depth() const {
+        size_t out = dequeued.load(memory_order_relaxed);
+        size_t in = enqueued.load(memory_order_relaxed);
+        return in > out ? in - out : 0;
+    }
+
+    void on_enqueue() {
+        enqueued.fetch_add(1, memory_order_relaxed);
+        size_t d = depth();
+        size_t m = max_depth.load(memory_order_relaxed);
+        while (d > m && !max_depth.compare_exchange_weak(m, d, memory_order_relaxed))
+            ;
+    }
+
+    void on_dequeue() {
+        dequeued.fetch_add(1, memory_order_relaxed);
+    }
+
+    static void add_wait(atomic<uint64_t>& counter, chrono::steady_clock::time_point since) {
+        auto ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - since).count();
+        counter.fetch_add(ns, memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief Counters of one pipeline stage
+ */
+struct stage_stats_t
+{
+    atomic<size_t> items{0};
+
+    void add(size_t count = 1) { items.fetch_add(count, memory_order_relaxed); }
+};
+
+// --------------------------------------------------------------------------
+/**
+ * @brief Registry of queue and stage counters
+ *
+ * Counters are created on first use and live as long as the registry,
+ * references to them stay valid.
+ */
+class pipeline_stats_t
+{
+public:
+    ~pipeline_stats_t() { stop_reporting(); }
+
+    queue_stats_t& queue(const string& name, size_t capacity) {
+        lock_guard<mutex> lock(m_mutex);
+        auto& q = m_queues[name];
+        if (!q)
+            q.reset(new queue_stats_t);
+        q->capacity = capacity;
+        return *q;
+    }
+
+    stage_stats_t& stage(const string& name) {
+        lock_guard<mutex> lock(m_mutex);
+        auto& s = m_stages[name];
+        if (!s)
+            s.reset(new stage_stats_t);
+        return *s;
+    }
+
+    /**
+     * @brief Current state of the pipeline
+     *
+     * Stage rates are reported for the whole run and since the previous snapshot
+     */
+    void snapshot(nlohmann::json& j) {
+        lock_guard<mutex> lock(m_mutex);
+        auto now = chrono::steady_clock::now();
+        double elapsed = chrono::duration<double>(now - m_start).count();
+        double interval = chrono::duration<double>(now - m_last_snapshot).count();
+        m_last_snapshot = now;
+        auto round2 = [](double v) { return ceil(v * 100.0) / 100.0; };
+
+        j["elapsed"] = round2(elapsed);
+        for (const auto& it : m_queues) {
+            const auto& q = *it.second;
+            auto& jq = j["queues"][it.first];
+            jq["capacity"] = q.capacity;
+            jq["depth"] = q.depth();
+            jq["max_depth"] = q.max_depth.load(memory_order_relaxed);
+            jq["enqueued"] = q.enqueued.load(memory_order_relaxed);
+            jq["dequeued"] = q.dequeued.load(memory_order_relaxed);
+            jq["producer_blocked"] = round2(q.producer_blocked_ns.load(memory_order_relaxed) / 1e9);
+            jq["consumer_starved"] = round2(q.consumer_starved_ns.load(memory_order_relaxed) / 1e9);
+        }
+        for (const auto& it : m_stages) {
+            size_t items = it.second->items.load(memory_order_relaxed);
+            size_t& last = m_last_items[it.first];
+            auto& js = j["stages"][it.first];
+            js["items"] = items;
+            js["items_per_sec"] = round2(elapsed > 0 ? items / elapsed : 0);
+            js["items_per_sec_last"] = round2(interval > 0 ? (items - last) / interval : 0);
+            last = items;
+        }
+    }
+
+    /**
+     * @brief Start writing snapshots to file_name every interval seconds
+     *
+     * The file is replaced with each snapshot
+     */
+    void start_reporting(const string& file_name, unsigned interval) {
+        stop_reporting();
+        if (file_name.empty() || interval == 0)
+            return;
+        m_stop = false;
+        m_thread = thread([this, file_name, interval]() {
+            unique_lock<mutex> lock(m_report_mutex);
+            while (!m_cv.wait_for(lock, chrono::seconds(interval), [this] { return m_stop; }))
+                write_snapshot(file_name);
+        });
+    }
+
+    /**
+     * @brief Stop the reporting thread
+     */
+    void stop_reporting() {
+        if (!m_thread.joinable())
+            return;
+        {
+            lock_guard<mutex> lock(m_report_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        m_thread.join();
+    }
+
+private:
+    void write_snapshot(const string& file_name) {
+        nlohmann::json j;
+        snapshot(j);
+        string tmp_name = file_name + ".tmp";
+        {
+            ofstream f(tmp_name, ios::out);
+            f << j.dump(4, ' ', true) << endl;
+            if (!f)
+                return;
+        }
+        rename(tmp_name.c_str(), file_name.c_str());
+    }
+
+    mutex m_mutex;
+    map<string, unique_ptr<queue_stats_t>> m_queues;
+    map<string, unique_ptr<stage_stats_t>> m_stages;
+    map<string, size_t> m_last_items;
+    chrono::steady_clock::time_point m_start{chrono::steady_clock::now()};
+    chrono::steady_clock::time_point m_last_snapshot{m_start};
+
+    mutex m_report_mutex;
+    condition_variable m_cv;
+    bool m_stop{false};
+    thread m_thread;
+};
+
+inline pipeline_stats_t pipeline_stats;
+
+#endif
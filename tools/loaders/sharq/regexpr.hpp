@@ -58,7 +58,7 @@ public:
 */        
     bool Matches(const re2::StringPiece& input)
     {
-        mLastInput = input.as_string();
+        mLastInput.assign(input.data(), input.size());
         return re2::RE2::PartialMatchN(input, *re, args.empty() ? nullptr : &args[0], (int)args.size());
     }
 
@@ -69,6 +69,13 @@ public:
      */
     const std::string& GetLastInput() const { return mLastInput; }
 
+    /**
+     * @brief set last input line when the match was done without RE2
+     *
+     * @param[in] input
+     */
+    void SetLastInput(const re2::StringPiece& input) { mLastInput.assign(input.data(), input.size()); }
+
     /**
      * @brief return array of matched groups
      *
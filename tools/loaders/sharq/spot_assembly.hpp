@@ -7,8 +7,11 @@
  */
 #include "data_frame.hpp"
 #include "fastq_read.hpp"
+#include "spot_spill.hpp"
 #include <string>
 #include <map>
+#include <array>
+#include <mutex>
 #include <spdlog/spdlog.h>
 #include <spdlog/stopwatch.h>
 #include <spdlog/fmt/fmt.h>
@@ -24,6 +27,8 @@ using namespace std;
 
 static constexpr int MAX_ROW_TO_CLEAR = 5000000;
 static constexpr int MAX_ROWS_TO_OPTIMIZE = 10000000; 
+static constexpr int SPOT_SHARD_BITS = 4;
+static constexpr int NUM_SPOT_SHARDS = 1 << SPOT_SHARD_BITS;
 
 static_assert(bm::id_max == bm::id_max48, "BitMagic should be compiled in 64-bit mode");
 
@@ -118,6 +123,142 @@ static thread_local string tmp_str;
 static thread_local vector<uint8_t> tmp_qual_scores;
 static thread_local vector<svector_int::value_type> tmp_qual_buffer;
 static thread_local fastq_read tmp_read;
+static thread_local string tmp_spill_record;
+
+// --------------------------------------------------------------------------
+// spot_shard_t - hot and cold storage for a subset of spot ids
+// Spots are distributed across shards by the low bits of the spot id, so the spots
+// the pipeline works on at the same time, which are close to each other, go to different shards.
+// Cold storage is indexed by the rest of the spot id (shard row) to keep it dense.
+
+struct spot_shard_t {
+    mutex m_mutex; ///< lock for access hot and cold storage of this shard
+
+    // hot storage
+    typedef size_t spot_id_t;
+    unordered_map<spot_id_t, vector<fastq_read>> m_hot_spots; ///< hot spots storage
+
+    // cold storage 
+    svector_u8 m_spot_index;             ///< spot index - num reads per spot 
+    vector<metadata_t> m_reads_metadata; ///< reads metadata from defline - readNum,  spotGroup, sequence and quality offset 
+    vector<svector_u32> m_sequences;     ///< sequence data
+    vector<size_t> m_seq_offset;         ///< last sequence offset per read
+
+    vector<svector_int> m_qualities;     ///< quality data
+    vector<size_t> m_qual_offset;        ///< last quality offset per read
+
+    // spilled cold storage
+    spill_segment_t m_spill;             ///< segment file with spilled reads
+    svector_u8 m_spill_index;            ///< num spilled reads per spot
+    vector<svector_u64> m_spill_locs;    ///< location of the spilled reads in m_spill
+
+    size_t m_cold_mem = 0;               ///< cold storage memory as of the last optimize
+    size_t m_cold_added = 0;             ///< approximate cold storage bytes added since the last optimize
+
+    bvector_type m_rows_to_clear;  ///< bitvector, 1 if row should be cleared
+    uint32_t m_num_rows_to_clear = 0; ///< counter, number of rows to clear
+
+    void init();
+    void resize(int max_reads);
+    size_t optimize(size_t& seq_mem, size_t& qual_mem);
+    // saves read to the spill file
+    void spill_read(const string& spill_path, size_t row_id, const fastq_read& read);
+    // appends spilled reads of the spot to reads
+    void get_spilled_reads(size_t row_id, vector<fastq_read>& reads);
+    // returns true if some reads of the spot were spilled
+    bool has_spilled_reads(size_t row_id) const {
+        return row_id < m_spill_index.size() && m_spill_index.get_no_check(row_id) > 0;
+    }
+};
+
+void spot_shard_t::init()
+{
+    m_hot_spots.clear();
+    m_spot_index.clear();
+    m_reads_metadata.clear();
+    m_sequences.clear();
+    m_seq_offset.clear();
+    m_qualities.clear();
+    m_qual_offset.clear();
+    m_spill.close();
+    m_spill_index.clear();
+    m_spill_locs.clear();
+    m_cold_mem = 0;
+    m_cold_added = 0;
+    m_rows_to_clear = bvector_type();
+    m_rows_to_clear.init();
+    m_num_rows_to_clear = 0;
+}
+
+void spot_shard_t::resize(int max_reads)
+{
+    m_reads_metadata.resize(max_reads);
+
+    m_sequences.resize(max_reads);
+    m_seq_offset.resize(max_reads);
+    fill(m_seq_offset.begin(), m_seq_offset.end(), 0);
+
+    m_qualities.resize(max_reads);
+    m_qual_offset.resize(max_reads);
+    fill(m_qual_offset.begin(), m_qual_offset.end(), 0);
+}
+
+// returns metadata memory, adds sequence and quality memory to seq_mem and qual_mem
+size_t spot_shard_t::optimize(size_t& seq_mem, size_t& qual_mem)
+{
+    BM_DECLARE_TEMP_BLOCK(TB) // BitMagic Temporary block
+    size_t md_mem = 0, shard_seq_mem = 0, shard_qual_mem = 0;
+    lock_guard<mutex> lock(m_mutex);
+    for (auto& metadata : m_reads_metadata) {
+        md_mem += metadata.Optimize();
+    }
+    svector_u64::statistics st0;
+    for (auto& locs : m_spill_locs) {
+        locs.optimize(TB, bm::bvector<>::opt_compress, &st0);
+        md_mem += st0.memory_used;
+    }
+    svector_u32::statistics st1;
+    for (auto& seq : m_sequences) {
+        seq.optimize(TB, bm::bvector<>::opt_compress, &st1);
+        shard_seq_mem += st1.memory_used;
+    }
+    svector_int::statistics st2;
+    for (auto& qual : m_qualities) {
+        qual.optimize(TB, bm::bvector<>::opt_compress, &st2);
+        shard_qual_mem += st2.memory_used;
+    }
+    m_cold_mem = md_mem + shard_seq_mem + shard_qual_mem;
+    m_cold_added = 0;
+    seq_mem += shard_seq_mem;
+    qual_mem += shard_qual_mem;
+    return md_mem;
+}
+
+void spot_shard_t::spill_read(const string& spill_path, size_t row_id, const fastq_read& read)
+{
+    if (!m_spill.is_open())
+        m_spill.open(spill_path);
+    spill_encode_read(read, tmp_spill_record);
+    uint64_t loc = m_spill.append(tmp_spill_record);
+    uint8_t k = row_id < m_spill_index.size() ? m_spill_index.get_no_check(row_id) : 0;
+    if (k >= m_spill_locs.size())
+        m_spill_locs.resize(k + 1);
+    m_spill_locs[k].set(row_id, loc);
+    m_spill_index.inc(row_id);
+}
+
+void spot_shard_t::get_spilled_reads(size_t row_id, vector<fastq_read>& reads)
+{
+    if (row_id >= m_spill_index.size())
+        return;
+    uint8_t num_spilled = m_spill_index.get_no_check(row_id);
+    for (uint8_t k = 0; k < num_spilled; ++k) {
+        m_spill.read(m_spill_locs[k].get(row_id), tmp_spill_record);
+        tmp_read.Reset();
+        spill_decode_read(tmp_spill_record, tmp_read, tmp_str);
+        reads.push_back(std::move(tmp_read));
+    }
+}
 
 // --------------------------------------------------------------------------
 // spot_assembly_t - class to assemble reads into spots
@@ -163,34 +304,45 @@ struct spot_assembly_t {
     // multi-threaded version of clear_spot
     template<bool is_nanopore>
     void clear_spot_mt(size_t row_id);
-    bvector_type m_last_index;     ///< bitvector of num_reads size, 1 if read is last in the spot
 
-    bvector_type m_rows_to_clear;  ///< bitvector, 1 if row should be cleared
-    uint32_t m_num_rows_to_clear = 0; ///< counter, number of rows to clear
+    // returns the shard holding the spot
+    spot_shard_t& shard(size_t spot_id) { 
+        return m_shards[spot_id & (NUM_SPOT_SHARDS - 1)]; 
+    }
+    // returns the row of the spot in its shard's cold storage
+    static size_t shard_row(size_t spot_id) {
+        return spot_id >> SPOT_SHARD_BITS;
+    }
+
+    bvector_type m_last_index;     ///< bitvector of num_reads size, 1 if read is last in the spot
 
     atomic<int> m_num_rows_to_optimize = 0; ///< number of rows to optimize, once it reaches MAX_ROWS_TO_OPTIMIZE, optimization is performed
 
     size_t m_total_spots = 0; ///< total number of spots
     map<uint32_t, size_t> m_reads_counts; ///< number of reads in each spot
 
-    mutex m_mutex; ///< lock for access hot and cold storage 
+    mutex m_mutex; ///< lock for merging spot assignment results
 
-    // classes for hot storage
-    bvector_type m_hot_spot_ids; ///< bitvector, 1 if spot is hot (i.e. saved in m_hot_spots)
-    typedef size_t spot_id_t;
-    unordered_map<spot_id_t, vector<fastq_read>> m_hot_spots; ///< hot spots storage
+    bvector_type m_hot_spot_ids; ///< bitvector, 1 if spot is hot (i.e. saved in shard's m_hot_spots)
 
+    array<spot_shard_t, NUM_SPOT_SHARDS> m_shards; ///< hot and cold storage sharded by spot id
 
-    // classes for cold storage 
-    svector_u8 m_spot_index;             ///< spot index - num reads per spot 
-    vector<metadata_t> m_reads_metadata; ///< reads metadata from defline - readNum,  spotGroup, sequence and quality offset 
-    vector<svector_u32> m_sequences;     ///< sequence data
-    vector<size_t> m_seq_offset;         ///< last sequence offset per read
+    size_t m_hot_reads_threshold = 10000000;  ///< threshold for hot reads, if read is far from the last read in the spot, it is saved in cold storage
 
-    vector<svector_int> m_qualities;     ///< quality data
-    vector<size_t> m_qual_offset;        ///< last quality offset per read
+    size_t m_cold_memory_budget = 0;  ///< cold storage memory budget in bytes, once a shard exceeds its share cold reads are spilled to disk (0 - no limit)
+    string m_spill_dir;               ///< directory for the spill files
 
-    size_t m_hot_reads_threshold = 10000000;  ///< threshold for hot reads, if read is far from the last read in the spot, it is saved in cold storage
+    // returns the spill file path for the shard
+    string spill_path(const spot_shard_t& sh) const {
+        return fmt::format("{}/sharq.{}.{}.spill", m_spill_dir.empty() ? "." : m_spill_dir, getpid(), &sh - &m_shards[0]);
+    }
+    // returns total size of the spill files
+    size_t spilled_bytes() const {
+        size_t total = 0;
+        for (const auto& sh : m_shards)
+            total += sh.m_spill.bytes_written();
+        return total;
+    }
 
 };
 
@@ -200,22 +352,13 @@ void spot_assembly_t::init(size_t num_rows)
     m_last_index = bvector_type();
     m_last_index.init();
 
-    m_rows_to_clear = bvector_type();
-    m_rows_to_clear.init();
-
     m_hot_spot_ids = bvector_type();
     m_hot_spot_ids.init();
-    m_hot_spots.clear();
 
-    m_reads_metadata.clear();
     m_reads_counts.clear();
 
-    m_spot_index.clear();
-    m_sequences.clear();
-    m_seq_offset.clear();
-
-    m_qualities.clear();
-    m_qual_offset.clear();
+    for (auto& shard : m_shards)
+        shard.init();
 
     m_total_spots = 0;
 } 
@@ -503,15 +646,8 @@ void spot_assembly_t::assign_spot_id(str_sv_type& read_names, vector<T>& read_in
     for (auto& it : m_reads_counts) 
         max_reads = max(max_reads, (int)it.first);
 
-    m_reads_metadata.resize(max_reads);
-
-    m_sequences.resize(max_reads);
-    m_seq_offset.resize(max_reads);
-    fill(m_seq_offset.begin(), m_seq_offset.end(), 0);
-
-    m_qualities.resize(max_reads);
-    m_qual_offset.resize(max_reads);
-    fill(m_qual_offset.begin(), m_qual_offset.end(), 0);
+    for (auto& shard : m_shards)
+        shard.resize(max_reads);
 }
 
 // saves read to hot or cold storage
@@ -578,10 +714,11 @@ void spot_assembly_t::save_read(size_t row_id, fastq_read& read) {
 template<typename ScoreValidator, bool is_nanopore>
 void spot_assembly_t::get_spot(size_t row_id, vector<fastq_read>& reads) 
 {
-
+    auto& sh = shard(row_id);
+    auto const sh_row = shard_row(row_id);
     if (m_hot_spot_ids.test(row_id)) {
-        auto it = m_hot_spots.find(row_id);
-        if (it != m_hot_spots.end()) {
+        auto it = sh.m_hot_spots.find(row_id);
+        if (it != sh.m_hot_spots.end()) {
             reads = std::move(it->second);
         } else {
             reads.clear();
@@ -589,59 +726,59 @@ void spot_assembly_t::get_spot(size_t row_id, vector<fastq_read>& reads)
         return;
     } 
 
-    auto num_reads = m_spot_index.get_no_check(row_id);
+    auto num_reads = sh.m_spot_index.get_no_check(sh_row);
     reads.resize(num_reads);
     for (int read_idx = 0; read_idx < num_reads; ++read_idx) {
         tmp_read.Reset();
-        auto& metadata = m_reads_metadata[read_idx];
-        tmp_read.m_ReaderIdx = metadata.get<u16_t>(metadata_t::e_ReaderId).get(row_id);
+        auto& metadata = sh.m_reads_metadata[read_idx];
+        tmp_read.m_ReaderIdx = metadata.get<u16_t>(metadata_t::e_ReaderId).get(sh_row);
 
         tmp_str.clear();
-        metadata.get<str_t>(metadata_t::e_ReadNumId).get(row_id, tmp_str);
+        metadata.get<str_t>(metadata_t::e_ReadNumId).get(sh_row, tmp_str);
         if (!tmp_str.empty()) {
             tmp_read.SetReadNum(tmp_str);
             tmp_str.clear();
         }
-        metadata.get<str_t>(metadata_t::e_SpotGroupId).get(row_id, tmp_str);
+        metadata.get<str_t>(metadata_t::e_SpotGroupId).get(sh_row, tmp_str);
         if (!tmp_str.empty()) {
             tmp_read.SetSpotGroup(tmp_str);
             tmp_str.clear();
         }
-        metadata.get<str_t>(metadata_t::e_SuffixId).get(row_id, tmp_str);
+        metadata.get<str_t>(metadata_t::e_SuffixId).get(sh_row, tmp_str);
         if (!tmp_str.empty()) {
             tmp_read.SetSuffix(tmp_str);
             tmp_str.clear();
         }
         if constexpr(is_nanopore) {           
 
-            metadata.get<str_t>(metadata_t::e_ChannelId).get(row_id, tmp_str);   
+            metadata.get<str_t>(metadata_t::e_ChannelId).get(sh_row, tmp_str);   
             if (!tmp_str.empty()) {
                 tmp_read.SetChannel(tmp_str);
                 tmp_str.clear();
             }
-            metadata.get<str_t>(metadata_t::e_NanoporeReadNoId).get(row_id, tmp_str);
+            metadata.get<str_t>(metadata_t::e_NanoporeReadNoId).get(sh_row, tmp_str);
             if (!tmp_str.empty()) {
                 tmp_read.SetNanoporeReadNo(tmp_str);
                 tmp_str.clear();
             }
         }    
-        if (metadata.get<bit_t>(metadata_t::e_ReadFilterId).test(row_id))        
+        if (metadata.get<bit_t>(metadata_t::e_ReadFilterId).test(sh_row))        
             tmp_read.SetReadFilter(1);
-        size_t offset = metadata.get<u64_t>(metadata_t::e_SeqOffsetId).get(row_id);
+        size_t offset = metadata.get<u64_t>(metadata_t::e_SeqOffsetId).get(sh_row);
         size_t len = offset >> 48;
         offset &= 0x0000FFFFFFFFFFFF;
         tmp_buffer.resize(len);
-        m_sequences[read_idx].decode(&tmp_buffer[0], offset, len);
+        sh.m_sequences[read_idx].decode(&tmp_buffer[0], offset, len);
         tmp_str.resize(len);
         for (size_t j = 0; j < len; ++j)
             tmp_str[j] = Int2DNA(tmp_buffer[j]);
         tmp_read.SetSequence(tmp_str);
 
-        size_t qual_offset = metadata.get<u64_t>(metadata_t::e_QualOffsetId).get(row_id);
+        size_t qual_offset = metadata.get<u64_t>(metadata_t::e_QualOffsetId).get(sh_row);
         len = qual_offset >> 48;
         qual_offset &= 0x0000FFFFFFFFFFFF;
         tmp_qual_buffer.resize(len);
-        m_qualities[read_idx].decode(&tmp_qual_buffer[0], qual_offset, len);
+        sh.m_qualities[read_idx].decode(&tmp_qual_buffer[0], qual_offset, len);
         int mid_score = ScoreValidator::min_score() + 30;
         tmp_qual_scores.resize(len);
         tmp_qual_scores[0] = tmp_qual_buffer[0] + mid_score;
@@ -651,6 +788,7 @@ void spot_assembly_t::get_spot(size_t row_id, vector<fastq_read>& reads)
         tmp_read.SetQualScores(tmp_qual_scores);
         reads[read_idx] = std::move(tmp_read);
     }
+    sh.get_spilled_reads(sh_row, reads);
 }
 
 
@@ -721,33 +859,12 @@ void spot_assembly_t::optimize()
         return;
     m_num_rows_to_optimize = 0;
     spdlog::stopwatch sw;
-    size_t md_mem = 0;
-    {
-        lock_guard<mutex> lock(m_mutex);
-        for (auto& metadata : m_reads_metadata) {
-            md_mem += metadata.Optimize();
-        }
-    }
-    svector_u32::statistics st1;
-    size_t seq_mem = 0;
-    {
-        lock_guard<mutex> lock(m_mutex);
-        for (auto& seq : m_sequences) {
-            seq.optimize(TB1, bm::bvector<>::opt_compress, &st1);
-            seq_mem += st1.memory_used;
-        }
-    }
-    svector_int::statistics st2;
-    size_t qual_mem = 0;
-    lock_guard<mutex> lock(m_mutex);
-    {
-        for (auto& qual : m_qualities) {
-            qual.optimize(TB1, bm::bvector<>::opt_compress, &st2);
-            qual_mem += st2.memory_used;
-        }
-    }
+    size_t md_mem = 0, seq_mem = 0, qual_mem = 0;
+    // one shard at a time, the pipeline keeps working on the others
+    for (auto& shard : m_shards) 
+        md_mem += shard.optimize(seq_mem, qual_mem);
     auto logger = spdlog::get("parser_logger"); // send log to stderr        
-    if (logger) logger->info("optimize took: {}, seq_mem: {:L}, qual_mem: {:L}, md_mem: {:L}", sw, seq_mem, qual_mem, md_mem);
+    if (logger) logger->info("optimize took: {}, seq_mem: {:L}, qual_mem: {:L}, md_mem: {:L}, spilled: {:L}", sw, seq_mem, qual_mem, md_mem, spilled_bytes());
 }
 
 // returns true if spot is last in the file
@@ -758,12 +875,24 @@ bool spot_assembly_t::is_last_spot(size_t row_id) {
 template<typename ScoreValidator, bool is_nanopore>
 void spot_assembly_t::save_read_mt(size_t row_id, fastq_read& read) {
 
+    auto& sh = shard(row_id);
+    auto const sh_row = shard_row(row_id);
     if (m_hot_spot_ids.test(row_id)) {
-        lock_guard<mutex> lock(m_mutex);
-        m_hot_spots[row_id].push_back(std::move(read));
+        lock_guard<mutex> lock(sh.m_mutex);
+        sh.m_hot_spots[row_id].push_back(std::move(read));
         return;
     }
 
+    if (m_cold_memory_budget > 0) {
+        lock_guard<mutex> lock(sh.m_mutex);
+        // spilled reads are retrieved after the cold ones,
+        // so once a spot has spilled reads the rest of them is spilled too to keep the reads in order
+        if (sh.m_cold_mem + sh.m_cold_added > m_cold_memory_budget / NUM_SPOT_SHARDS || sh.has_spilled_reads(sh_row)) {
+            sh.spill_read(spill_path(sh), sh_row, read);
+            return;
+        }
+    }
+
     const auto& seq = read.Sequence();
     size_t seq_sz = seq.size();
     assert(seq_sz > 0);
@@ -788,42 +917,43 @@ void spot_assembly_t::save_read_mt(size_t row_id, fastq_read& read) {
     }
 
     {
-        lock_guard<mutex> lock(m_mutex);
-        uint8_t read_idx = m_spot_index.get_no_check(row_id);
-        auto& metadata = m_reads_metadata[read_idx];
+        lock_guard<mutex> lock(sh.m_mutex);
+        uint8_t read_idx = sh.m_spot_index.get_no_check(sh_row);
+        auto& metadata = sh.m_reads_metadata[read_idx];
 
-        metadata.get<u16_t>(metadata_t::e_ReaderId).set(row_id, read.m_ReaderIdx);
+        metadata.get<u16_t>(metadata_t::e_ReaderId).set(sh_row, read.m_ReaderIdx);
 
         if (!read.ReadNum().empty())
-            metadata.get<str_t>(metadata_t::e_ReadNumId).set(row_id, read.ReadNum().c_str());
+            metadata.get<str_t>(metadata_t::e_ReadNumId).set(sh_row, read.ReadNum().c_str());
         if (!read.SpotGroup().empty())
-            metadata.get<str_t>(metadata_t::e_SpotGroupId).set(row_id, read.SpotGroup().c_str());
+            metadata.get<str_t>(metadata_t::e_SpotGroupId).set(sh_row, read.SpotGroup().c_str());
         if (!read.Suffix().empty())        
-            metadata.get<str_t>(metadata_t::e_SuffixId).set(row_id, read.Suffix().c_str());
+            metadata.get<str_t>(metadata_t::e_SuffixId).set(sh_row, read.Suffix().c_str());
         if constexpr(is_nanopore) {            
             if (!read.Channel().empty())    
-                metadata.get<str_t>(metadata_t::e_ChannelId).set(row_id, read.Channel().c_str());   
+                metadata.get<str_t>(metadata_t::e_ChannelId).set(sh_row, read.Channel().c_str());   
             if (!read.NanoporeReadNo().empty())   
-                metadata.get<str_t>(metadata_t::e_NanoporeReadNoId).set(row_id, read.NanoporeReadNo().c_str());
+                metadata.get<str_t>(metadata_t::e_NanoporeReadNoId).set(sh_row, read.NanoporeReadNo().c_str());
         }
         if (read.ReadFilter())
-            metadata.get<bit_t>(metadata_t::e_ReadFilterId).set(row_id);
+            metadata.get<bit_t>(metadata_t::e_ReadFilterId).set(sh_row);
 
-        size_t offset = m_seq_offset[read_idx];
+        size_t offset = sh.m_seq_offset[read_idx];
         if (offset + seq_sz >= bm::id_max) 
             throw runtime_error("This FASTQ cannot be processed due to far read buffer overflow");
         
-        m_sequences[read_idx].import(&tmp_buffer[0], seq_sz, offset);
-        m_seq_offset[read_idx] = offset + seq_sz;
+        sh.m_sequences[read_idx].import(&tmp_buffer[0], seq_sz, offset);
+        sh.m_seq_offset[read_idx] = offset + seq_sz;
         offset |= seq_sz << 48;
-        metadata.get<u64_t>(metadata_t::e_SeqOffsetId).set(row_id, offset);
+        metadata.get<u64_t>(metadata_t::e_SeqOffsetId).set(sh_row, offset);
 
-        size_t qual_offset = m_qual_offset[read_idx];
-        m_qualities[read_idx].import(&tmp_qual_buffer[0], qual_sz, qual_offset);
-        m_qual_offset[read_idx] = qual_offset + qual_sz;
+        size_t qual_offset = sh.m_qual_offset[read_idx];
+        sh.m_qualities[read_idx].import(&tmp_qual_buffer[0], qual_sz, qual_offset);
+        sh.m_qual_offset[read_idx] = qual_offset + qual_sz;
         qual_offset |= qual_sz << 48;
-        metadata.get<u64_t>(metadata_t::e_QualOffsetId).set(row_id, qual_offset);
-        m_spot_index.inc(row_id);
+        metadata.get<u64_t>(metadata_t::e_QualOffsetId).set(sh_row, qual_offset);
+        sh.m_spot_index.inc(sh_row);
+        sh.m_cold_added += seq_sz + qual_sz; // rough estimate of the compressed size
         ++m_num_rows_to_optimize;
     }
 
@@ -834,69 +964,71 @@ void spot_assembly_t::get_spot_mt(const string& spot_name, size_t row_id, vector
 {
 
     reads.clear();
+    auto& sh = shard(row_id);
+    auto const sh_row = shard_row(row_id);
     if (m_hot_spot_ids.test(row_id)) {
-        lock_guard<mutex> lock(m_mutex);
-        auto it = m_hot_spots.find(row_id);
-        if (it != m_hot_spots.end()) {
+        lock_guard<mutex> lock(sh.m_mutex);
+        auto it = sh.m_hot_spots.find(row_id);
+        if (it != sh.m_hot_spots.end()) {
             reads = std::move(it->second);
         }
         return;
     } 
 
-    lock_guard<mutex> lock(m_mutex);
-    auto num_reads = m_spot_index.get_no_check(row_id);
+    lock_guard<mutex> lock(sh.m_mutex);
+    auto num_reads = sh.m_spot_index.get_no_check(sh_row);
     reads.resize(num_reads);
     for (int read_idx = 0; read_idx < num_reads; ++read_idx) {
         tmp_read.Reset();
-        auto& metadata = m_reads_metadata[read_idx];
-        tmp_read.m_ReaderIdx = metadata.get<u16_t>(metadata_t::e_ReaderId).get(row_id);
+        auto& metadata = sh.m_reads_metadata[read_idx];
+        tmp_read.m_ReaderIdx = metadata.get<u16_t>(metadata_t::e_ReaderId).get(sh_row);
 
         tmp_str.clear();
-        metadata.get<str_t>(metadata_t::e_ReadNumId).get(row_id, tmp_str);
+        metadata.get<str_t>(metadata_t::e_ReadNumId).get(sh_row, tmp_str);
         if (!tmp_str.empty()) {
             tmp_read.SetReadNum(tmp_str);
             tmp_str.clear();
         }
-        metadata.get<str_t>(metadata_t::e_SpotGroupId).get(row_id, tmp_str);
+        metadata.get<str_t>(metadata_t::e_SpotGroupId).get(sh_row, tmp_str);
         if (!tmp_str.empty()) {
             tmp_read.SetSpotGroup(tmp_str);
             tmp_str.clear();
         }
-        metadata.get<str_t>(metadata_t::e_SuffixId).get(row_id, tmp_str);
+        metadata.get<str_t>(metadata_t::e_SuffixId).get(sh_row, tmp_str);
         if (!tmp_str.empty()) {
             tmp_read.SetSuffix(tmp_str);
             tmp_str.clear();
         }
         if constexpr(is_nanopore) {
-            metadata.get<str_t>(metadata_t::e_ChannelId).get(row_id, tmp_str);   
+            metadata.get<str_t>(metadata_t::e_ChannelId).get(sh_row, tmp_str);   
             if (!tmp_str.empty()) {
                 tmp_read.SetChannel(tmp_str);
                 tmp_str.clear();
             }
-            metadata.get<str_t>(metadata_t::e_NanoporeReadNoId).get(row_id, tmp_str);
+            metadata.get<str_t>(metadata_t::e_NanoporeReadNoId).get(sh_row, tmp_str);
             if (!tmp_str.empty()) {
                 tmp_read.SetNanoporeReadNo(tmp_str);
                 tmp_str.clear();
             }
         }
-        if (metadata.get<bit_t>(metadata_t::e_ReadFilterId).test(row_id))        
+        if (metadata.get<bit_t>(metadata_t::e_ReadFilterId).test(sh_row))        
             tmp_read.SetReadFilter(1);
-        size_t offset = metadata.get<u64_t>(metadata_t::e_SeqOffsetId).get(row_id);
+        size_t offset = metadata.get<u64_t>(metadata_t::e_SeqOffsetId).get(sh_row);
         size_t len = offset >> 48;
         offset &= 0x0000FFFFFFFFFFFF;
         tmp_buffer.resize(len);
-        m_sequences[read_idx].decode(&tmp_buffer[0], offset, len);
+        sh.m_sequences[read_idx].decode(&tmp_buffer[0], offset, len);
         tmp_str.resize(len);
         for (size_t j = 0; j < len; ++j)
             tmp_str[j] = Int2DNA(tmp_buffer[j]);
         tmp_read.SetSequence(tmp_str);
 
-        size_t qual_offset = metadata.get<u64_t>(metadata_t::e_QualOffsetId).get(row_id);
+        size_t qual_offset = metadata.get<u64_t>(metadata_t::e_QualOffsetId).get(sh_row);
         len = qual_offset >> 48;
         qual_offset &= 0x0000FFFFFFFFFFFF;
         tmp_qual_buffer.resize(len);
 
-        m_qualities[read_idx].decode(&tmp_qual_buffer[0], qual_offset, len);
+        sh.m_qualities[read_idx].decode(&tmp_qual_buffer[0], qual_offset, len);
         int mid_score = ScoreValidator::min_score() + 30;
         tmp_qual_scores.resize(len);
         tmp_qual_scores[0] = tmp_qual_buffer[0] + mid_score;
@@ -907,57 +1039,60 @@ void spot_assembly_t::get_spot_mt(const string& spot_name, size_t row_id, vector
 
         reads[read_idx] = std::move(tmp_read);
     }
+    sh.get_spilled_reads(sh_row, reads);
 }
 
 template<bool is_nanopore>
 void spot_assembly_t::clear_spot_mt(size_t row_id) 
 {
+    auto& sh = shard(row_id);
+    auto const sh_row = shard_row(row_id);
     if (m_hot_spot_ids.test(row_id)) {
-        lock_guard<mutex> lock(m_mutex);
-        m_hot_spots.erase(row_id);
+        lock_guard<mutex> lock(sh.m_mutex);
+        sh.m_hot_spots.erase(row_id);
         return;
     }
 
-    m_rows_to_clear.set_bit_no_check(row_id);
-    ++m_num_rows_to_clear;
-    if (m_num_rows_to_clear >= MAX_ROW_TO_CLEAR) {
+    sh.m_rows_to_clear.set_bit_no_check(sh_row);
+    ++sh.m_num_rows_to_clear;
+    if (sh.m_num_rows_to_clear >= MAX_ROW_TO_CLEAR / NUM_SPOT_SHARDS) {
 
         spdlog::stopwatch sw;
-        vector<svector_u64::size_type> row_ids(m_num_rows_to_clear);
+        vector<svector_u64::size_type> row_ids(sh.m_num_rows_to_clear);
         size_t c = 0;
-        for (auto en = m_rows_to_clear.first(); en.valid(); ++en) {
+        for (auto en = sh.m_rows_to_clear.first(); en.valid(); ++en) {
             row_ids[c] = *en;
             ++c;
         }                
         vector<svector_u64::value_type> offsets(row_ids.size());
         bvector_type clear_bv;
 
-        assert(c == m_num_rows_to_clear);
+        assert(c == sh.m_num_rows_to_clear);
         {
-            lock_guard<mutex> lock(m_mutex);
-            uint8_t num_reads = m_spot_index.get_no_check(row_id);
+            lock_guard<mutex> lock(sh.m_mutex);
+            uint8_t num_reads = sh.m_spot_index.get_no_check(sh_row);
             for (int read_idx = 0; read_idx < num_reads; ++read_idx) {
-                auto& metadata = m_reads_metadata[read_idx];
+                auto& metadata = sh.m_reads_metadata[read_idx];
     
-                metadata.get<u16_t>(metadata_t::e_ReaderId).clear(m_rows_to_clear);
+                metadata.get<u16_t>(metadata_t::e_ReaderId).clear(sh.m_rows_to_clear);
 
                 {
                     auto& v = metadata.get<str_t>(metadata_t::e_ReadNumId);
-                    if (!v.empty()) v.clear(m_rows_to_clear);
+                    if (!v.empty()) v.clear(sh.m_rows_to_clear);
                 }
                 {
                     auto & v = metadata.get<str_t>(metadata_t::e_SpotGroupId);
-                    if (!v.empty()) v.clear(m_rows_to_clear);
+                    if (!v.empty()) v.clear(sh.m_rows_to_clear);
                 }
                 {
                     auto & v = metadata.get<str_t>(metadata_t::e_SuffixId);
-                    if (!v.empty()) v.clear(m_rows_to_clear);
+                    if (!v.empty()) v.clear(sh.m_rows_to_clear);
                 }
                 if constexpr(is_nanopore) {
-                    metadata.get<str_t>(metadata_t::e_ChannelId).clear(m_rows_to_clear);   
-                    metadata.get<str_t>(metadata_t::e_NanoporeReadNoId).clear(m_rows_to_clear);
+                    metadata.get<str_t>(metadata_t::e_ChannelId).clear(sh.m_rows_to_clear);   
+                    metadata.get<str_t>(metadata_t::e_NanoporeReadNoId).clear(sh.m_rows_to_clear);
                 }
-                metadata.get<bit_t>(metadata_t::e_ReadFilterId).bit_sub(m_rows_to_clear);
+                metadata.get<bit_t>(metadata_t::e_ReadFilterId).bit_sub(sh.m_rows_to_clear);
 
                 clear_bv.clear();
                 auto sz = metadata.get<u64_t>(metadata_t::e_SeqOffsetId).gather(offsets.data(), row_ids.data(), offsets.size(), bm::BM_UNSORTED);
@@ -969,8 +1104,8 @@ void spot_assembly_t::clear_spot_mt(size_t row_id)
                         clear_bv.set_range(offset, offset + (len - 1));
                     }
                 }
-                m_sequences[read_idx].clear(clear_bv);
-                metadata.get<u64_t>(metadata_t::e_SeqOffsetId).clear(m_rows_to_clear);
+                sh.m_sequences[read_idx].clear(clear_bv);
+                metadata.get<u64_t>(metadata_t::e_SeqOffsetId).clear(sh.m_rows_to_clear);
 
                 clear_bv.clear();
                 sz = metadata.get<u64_t>(metadata_t::e_QualOffsetId).gather(offsets.data(), row_ids.data(), offsets.size(), bm::BM_UNSORTED);
@@ -982,12 +1117,16 @@ void spot_assembly_t::clear_spot_mt(size_t row_id)
                         clear_bv.set_range(offset, offset + (len - 1));
                     }
                 }
-                m_qualities[read_idx].clear(clear_bv);
-                metadata.get<u64_t>(metadata_t::e_QualOffsetId).clear(m_rows_to_clear);
+                sh.m_qualities[read_idx].clear(clear_bv);
+                metadata.get<u64_t>(metadata_t::e_QualOffsetId).clear(sh.m_rows_to_clear);
             }
-            m_rows_to_clear.clear();
-            m_num_rows_to_optimize += m_num_rows_to_clear;
-            m_num_rows_to_clear = 0;
+            for (auto& locs : sh.m_spill_locs) 
+                locs.clear(sh.m_rows_to_clear);
+            if (!sh.m_spill_locs.empty())
+                sh.m_spill_index.clear(sh.m_rows_to_clear);
+            sh.m_rows_to_clear.clear();
+            m_num_rows_to_optimize += sh.m_num_rows_to_clear;
+            sh.m_num_rows_to_clear = 0;
         } 
         auto logger = spdlog::get("parser_logger"); // send log to stderr        
         if (logger) logger->info("cleanup took: {}", sw);
@@ -0,0 +1,412 @@
+#ifndef __SPOT_SPILL_HPP__
+#define __SPOT_SPILL_HPP__
+
+/**
+ * @file spot_spill.hpp
+ * @brief Disk tier for spot assembly cold storage
+ *
+ * Cold reads that do not fit into the memory budget are serialized into
+ * zlib compressed blocks appended to a segment file. Blocks are read back
+ * through a read-only mapping of the file, the next block is advised to
+ * the kernel for read-ahead since spots are retrieved roughly in the
+ * order their reads were spilled.
+ */
+
+#include "fastq_read.hpp"
+#include <string>
+#include <vector>
+#include <array>
+#include <stdexcept>
+#include <limits>
+#include <cstring>
+#include <zlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <spdlog/fmt/fmt.h>
+
+using namespace std;
+
+// --------------------------------------------------------------------------
+// spill_segment_t - append-only file of compressed record blocks
+//
+// Record location: (block number << SPILL_BLOCK_BITS) | offset in block
+
+class spill_segment_t {
+public:
+    static constexpr unsigned SPILL_BLOCK_BITS = 20;
+    static constexpr size_t SPILL_BLOCK_SIZE = size_t(1) << SPILL_BLOCK_BITS;  ///< max uncompressed block size
+
+    spill_segment_t() = default;
+    spill_segment_t(const spill_segment_t&) = delete;
+    spill_segment_t& operator=(const spill_segment_t&) = delete;
+    ~spill_segment_t() { close(); }
+
+    bool is_open() const { return m_fd >= 0; }
+
+    // creates the segment file, the file is unlinked right away so it does not outlive the process
+    void open(const string& path);
+    void close();
+
+    // appends a record and returns its location
+    uint64_t append(const string& record);
+    // copies the record at location loc into record
+    void read(uint64_t loc, string& record);
+    // streams all records in the order they were appended
+    template<typename F>
+    void for_each_record(F&& func);
+
+    // returns the size of the flushed blocks and the block being filled
+    size_t bytes_written() const { return m_file_size + m_block.size(); }
+
+private:
+    void x_flush_block();
+    const string& x_get_block(size_t block_no);
+    void x_map();
+
+    struct block_t {
+        uint64_t offset;   ///< offset in the file
+        uint32_t size;     ///< compressed size
+        uint32_t raw_size; ///< uncompressed size
+    };
+
+    struct cached_block_t {
+        size_t block_no = numeric_limits<size_t>::max();
+        string data;
+    };
+
+    int m_fd = -1;
+    string m_path;
+    string m_block;                   ///< block being filled
+    vector<block_t> m_blocks;         ///< flushed blocks
+    uint64_t m_file_size = 0;
+    string m_zbuf;                    ///< compression buffer
+
+    const char* m_map = nullptr;      ///< read-only mapping of flushed blocks
+    size_t m_map_size = 0;
+
+    array<cached_block_t, 4> m_cache; ///< recently decompressed blocks
+    size_t m_cache_next = 0;
+};
+
+void spill_segment_t::open(const string& path)
+{
+    close();
+    m_path = path;
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (m_fd < 0)
+        throw runtime_error(fmt::format("Failed to create spill file '{}': {}", path, strerror(errno)));
+    unlink(path.c_str());
+    m_block.reserve(SPILL_BLOCK_SIZE);
+}
+
+void spill_segment_t::close()
+{
+    if (m_map)
+        munmap((void*)m_map, m_map_size);
+    m_map = nullptr;
+    m_map_size = 0;
+    if (m_fd >= 0)
+        ::close(m_fd);
+    m_fd = -1;
+    m_block.clear();
+    m_blocks.clear();
+    m_file_size = 0;
+    for (auto& c : m_cache) {
+        c.block_no = numeric_limits<size_t>::max();
+        c.data.clear();
+    }
+}
+
+uint64_t spill_segment_t::append(const string& record)
+{
+    uint32_t sz = record.size();
+    if (sz + sizeof(sz) > SPILL_BLOCK_SIZE)
+        throw runtime_error("Spilled read is too large");
+    if (m_block.size() + sizeof(sz) + sz > SPILL_BLOCK_SIZE)
+        x_flush_block();
+    uint64_t loc = (uint64_t(m_blocks.size()) << SPILL_BLOCK_BITS) | m_block.size();
+    m_block.append((const char*)&sz, sizeof(sz));
+    m_block.append(record);
+    return loc;
+}
+
+void spill_segment_t::x_flush_block()
+{
+    if (m_block.empty())
+        return;
+    uLongf zsize = compressBound(m_block.size());
+    m_zbuf.resize(zsize);
+    if (compress2((Bytef*)m_zbuf.data(), &zsize, (const Bytef*)m_block.data(), m_block.size(), 1) != Z_OK)
+        throw runtime_error("Failed to compress spill block");
+    size_t done = 0;
+    while (done < zsize) {
+        auto n = pwrite(m_fd, m_zbuf.data() + done, zsize - done, m_file_size + done);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            throw runtime_error(fmt::format("Failed to write spill file '{}': {}", m_path, strerror(errno)));
+        }
+        done += n;
+    }
+    m_blocks.push_back({m_file_size, (uint32_t)zsize, (uint32_t)m_block.size()});
+    m_file_size += zsize;
+    m_block.clear();
+}
+
+void spill_segment_t::x_map()
+{
+    if (m_map)
+        munmap((void*)m_map, m_map_size);
+    m_map = (const char*)mmap(nullptr, m_file_size, PROT_READ, MAP_SHARED, m_fd, 0);
+    if (m_map == MAP_FAILED) {
+        m_map = nullptr;
+        m_map_size = 0;
+        throw runtime_error(fmt::format("Failed to map spill file '{}': {}", m_path, strerror(errno)));
+    }
+    m_map_size = m_file_size;
+}
+
+const string& spill_segment_t::x_get_block(size_t block_no)
+{
+    for (auto& c : m_cache) {
+        if (c.block_no == block_no)
+            return c.data;
+    }
+    const auto& b = m_blocks[block_no];
+    if (b.offset + b.size > m_map_size)
+        x_map();
+
+    auto& c = m_cache[m_cache_next];
+    m_cache_next = (m_cache_next + 1) % m_cache.size();
+    c.data.resize(b.raw_size);
+    uLongf raw_size = b.raw_size;
+    if (uncompress((Bytef*)c.data.data(), &raw_size, (const Bytef*)m_map + b.offset, b.size) != Z_OK || raw_size != b.raw_size)
+        throw runtime_error(fmt::format("Corrupted spill file '{}'", m_path));
+    c.block_no = block_no;
+
+    // read-ahead: the next block is likely to be requested soon
+    if (block_no + 1 < m_blocks.size()) {
+        const auto& next = m_blocks[block_no + 1];
+        if (next.offset + next.size <= m_map_size) {
+            static const size_t page_size = sysconf(_SC_PAGESIZE);
+            size_t start = next.offset & ~(page_size - 1);
+            madvise((void*)(m_map + start), next.offset + next.size - start, MADV_WILLNEED);
+        }
+    }
+    return c.data;
+}
+
+void spill_segment_t::read(uint64_t loc, string& record)
+{
+    size_t block_no = loc >> SPILL_BLOCK_BITS;
+    size_t offset = loc & (SPILL_BLOCK_SIZE - 1);
+    const string& block = block_no == m_blocks.size() ? m_block : x_get_block(block_no);
+    uint32_t sz;
+    if (offset + sizeof(sz) > block.size())
+        throw runtime_error(fmt::format("Invalid spill location {}", loc));
+    memcpy(&sz, block.data() + offset, sizeof(sz));
+    record.assign(block.data() + offset + sizeof(sz), sz);
+}
+
+template<typename F>
+void spill_segment_t::for_each_record(F&& func)
+{
+    x_flush_block();
+    string record;
+    for (size_t block_no = 0; block_no < m_blocks.size(); ++block_no) {
+        const string& block = x_get_block(block_no);
+        size_t offset = 0;
+        uint32_t sz;
+        while (offset + sizeof(sz) <= block.size()) {
+            memcpy(&sz, block.data() + offset, sizeof(sz));
+            offset += sizeof(sz);
+            if (offset + sz > block.size())
+                throw runtime_error(fmt::format("Corrupted spill file '{}'", m_path));
+            record.assign(block.data() + offset, sz);
+            offset += sz;
+            func(record);
+        }
+    }
+}
+
+// --------------------------------------------------------------------------
+// serialization of cold reads
+//
+// u16 reader idx, u8 read filter, 5 x (u16 len, chars) - readNum, spotGroup,
+// suffix, channel, nanopore read no, u32 sequence length,
+// sequence packed two bases per byte, quality scores
+
+inline void x_spill_put_str(string& out, const string& s)
+{
+    uint16_t len = s.size();
+    out.append((const char*)&len, sizeof(len));
+    out.append(s.data(), len);
+}
+
+inline const char* x_spill_get_str(const char* p, string& s)
+{
+    uint16_t len;
+    memcpy(&len, p, sizeof(len));
+    p += sizeof(len);
+    s.assign(p, len);
+    return p + len;
+}
+
+inline uint8_t x_spill_base_code(char c)
+{
+    switch (c) {
+    case 'A': return 0;
+    case 'T': return 1;
+    case 'G': return 2;
+    case 'C': return 3;
+    case 'N': return 4;
+    default:
+        throw runtime_error(fmt::format("Invalid DNA base: {}", c));
+    }
+}
+
+inline void spill_encode_read(const fastq_read& read, string& out)
+{
+    out.clear();
+    uint16_t reader_idx = read.m_ReaderIdx;
+    out.append((const char*)&reader_idx, sizeof(reader_idx));
+    out.push_back((char)read.ReadFilter());
+    x_spill_put_str(out, read.ReadNum());
+    x_spill_put_str(out, read.SpotGroup());
+    x_spill_put_str(out, read.Suffix());
+    x_spill_put_str(out, read.Channel());
+    x_spill_put_str(out, read.NanoporeReadNo());
+
+    const auto& seq = read.Sequence();
+    uint32_t len = seq.size();
+    out.append((const char*)&len, sizeof(len));
+    for (uint32_t i = 0; i < len; i += 2) {
+        uint8_t b = x_spill_base_code(seq[i]);
+        if (i + 1 < len)
+            b |= x_spill_base_code(seq[i + 1]) << 4;
+        out.push_back((char)b);
+    }
+    const auto& qual = read.GetQualScores();
+    if (qual.size() != len)
+        throw runtime_error("Quality scores size does not match sequence size");
+    out.append((const char*)qual.data(), len);
+}
+
+inline void spill_decode_read(const string& in, fastq_read& read, string& tmp)
+{
+    static const char bases[] = "ATGCN";
+    const char* p = in.data();
+    uint16_t reader_idx;
+    memcpy(&reader_idx, p, sizeof(reader_idx));
+    p += sizeof(reader_idx);
+    read.m_ReaderIdx = reader_idx;
+    if (*p++)
+        read.SetReadFilter(1);
+    p = x_spill_get_str(p, tmp);
+    if (!tmp.empty()) read.SetReadNum(tmp);
+    p = x_spill_get_str(p, tmp);
+    if (!tmp.empty()) read.SetSpotGroup(tmp);
+    p = x_spill_get_str(p, tmp);
+    if (!tmp.empty()) read.SetSuffix(tmp);
+    p = x_spill_get_str(p, tmp);
+    if (!tmp.empty()) read.SetChannel(re2::StringPiece(tmp));
+    p = x_spill_get_str(p, tmp);
+    if (!tmp.empty()) read.SetNanoporeReadNo(re2::StringPiece(tmp));
+
+    uint32_t len;
+    memcpy(&len, p, sizeof(len));
+    p += sizeof(len);
+    tmp.resize(len);
+    for (uint32_t i = 0; i < len; i += 2) {
+        uint8_t b = (uint8_t)*p++;
+        tmp[i] = bases[b & 0xF];
+        if (i + 1 < len)
+            tmp[i + 1] = bases[b >> 4];
+    }
+    read.SetSequence(tmp);
+    read.SetQualScores(vector<uint8_t>((const uint8_t*)p, (const uint8_t*)p + len));
+}
+
+// --------------------------------------------------------------------------
+// serialization of first pass reads
+//
+// Reads are kept as parsed so the second pass sees exactly what the readers produced:
+// u16 reader idx, u64 line number, u8 read filter, 6 x (u16 len, chars) - spot,
+// readNum, spotGroup, suffix, channel, nanopore read no,
+// 3 x (u32 len, bytes) - sequence, quality, quality scores
+
+inline void x_cache_put_data(string& out, const char* data, uint32_t len)
+{
+    out.append((const char*)&len, sizeof(len));
+    out.append(data, len);
+}
+
+inline const char* x_cache_get_data(const char* p, string& s)
+{
+    uint32_t len;
+    memcpy(&len, p, sizeof(len));
+    p += sizeof(len);
+    s.assign(p, len);
+    return p + len;
+}
+
+inline void read_cache_encode(const fastq_read& read, string& out)
+{
+    out.clear();
+    uint16_t reader_idx = read.m_ReaderIdx;
+    out.append((const char*)&reader_idx, sizeof(reader_idx));
+    uint64_t line_number = read.LineNumber();
+    out.append((const char*)&line_number, sizeof(line_number));
+    out.push_back((char)read.ReadFilter());
+    x_spill_put_str(out, read.Spot());
+    x_spill_put_str(out, read.ReadNum());
+    x_spill_put_str(out, read.SpotGroup());
+    x_spill_put_str(out, read.Suffix());
+    x_spill_put_str(out, read.Channel());
+    x_spill_put_str(out, read.NanoporeReadNo());
+    x_cache_put_data(out, read.Sequence().data(), read.Sequence().size());
+    x_cache_put_data(out, read.Quality().data(), read.Quality().size());
+    // scores are only kept when the validator produced them, otherwise they follow the quality string
+    if (read.HasQualScores())
+        x_cache_put_data(out, (const char*)read.GetQualScores().data(), read.GetQualScores().size());
+    else
+        x_cache_put_data(out, nullptr, 0);
+}
+
+inline void read_cache_decode(const string& in, fastq_read& read, string& tmp)
+{
+    const char* p = in.data();
+    uint16_t reader_idx;
+    memcpy(&reader_idx, p, sizeof(reader_idx));
+    p += sizeof(reader_idx);
+    uint64_t line_number;
+    memcpy(&line_number, p, sizeof(line_number));
+    p += sizeof(line_number);
+    read.Reset();
+    read.m_ReaderIdx = reader_idx;
+    read.SetLineNumber(line_number);
+    read.SetReadFilter((uint8_t)*p++);
+    p = x_spill_get_str(p, tmp);
+    read.SetSpot(tmp);
+    p = x_spill_get_str(p, tmp);
+    read.SetReadNum(tmp);
+    p = x_spill_get_str(p, tmp);
+    read.SetSpotGroup(tmp);
+    p = x_spill_get_str(p, tmp);
+    read.SetSuffix(tmp);
+    p = x_spill_get_str(p, tmp);
+    read.SetChannel(re2::StringPiece(tmp));
+    p = x_spill_get_str(p, tmp);
+    read.SetNanoporeReadNo(re2::StringPiece(tmp));
+    p = x_cache_get_data(p, tmp);
+    read.SetSequence(tmp);
+    p = x_cache_get_data(p, tmp);
+    read.SetQuality(tmp);
+    p = x_cache_get_data(p, tmp);
+    if (!tmp.empty())
+        read.SetQualScores(vector<uint8_t>(tmp.begin(), tmp.end()));
+}
+
+#endif
@@ -33,6 +33,9 @@
 #include <cstdint>
 #include <algorithm>
 #include <cstdio>
+#include <memory>
+
+#include <general-writer/gw-ring.hpp>
 
 namespace VDB {
     class Writer {
@@ -73,11 +76,63 @@ namespace VDB {
             addMbrTbl, // ???
 
             logMesg,
-            progressMesg
+            progressMesg,
+
+            cellBatch,
+            nextRows,
+
+            useRing
         };
         ostream& stream;
         ///FILE *stream;
 
+        // routes the output stream into a shared-memory ring once useSharedRing succeeds;
+        // the small writes that make up an event are gathered in buffer, not copied into the ring one by one
+        class RingBuf : public std::streambuf {
+            ncbi::GWRing &ring;
+            char buffer[64 * 1024];
+
+            void drain() {
+                if (pptr() != pbase())
+                    ring.write(pbase(), (size_t)(pptr() - pbase()));
+                setp(buffer, buffer + sizeof(buffer));
+            }
+        protected:
+            int_type overflow(int_type ch) override {
+                drain();
+                if (ch != traits_type::eof()) {
+                    *pptr() = traits_type::to_char_type(ch);
+                    pbump(1);
+                }
+                return traits_type::not_eof(ch);
+            }
+            std::streamsize xsputn(char const *s, std::streamsize n) override {
+                if (n > epptr() - pptr()) {
+                    drain();
+                    if (n >= (std::streamsize)sizeof(buffer) / 2) {
+                        // large values go straight into the ring
+                        ring.write(s, (size_t)n);
+                        return n;
+                    }
+                }
+                std::copy(s, s + n, pptr());
+                pbump((int)n);
+                return n;
+            }
+            int sync() override {
+                drain();
+                ring.publish();
+                return 0;
+            }
+        public:
+            explicit RingBuf(ncbi::GWRing &ring_) : ring(ring_) {
+                setp(buffer, buffer + sizeof(buffer));
+            }
+        };
+        std::unique_ptr<ncbi::GWRing> ring;
+        std::unique_ptr<RingBuf> ringBuf;
+        std::streambuf *pipeBuf = nullptr;
+
         class StreamHeader {
             friend Writer;
             bool write(ostream& stream) const
@@ -336,7 +391,32 @@ namespace VDB {
         void flush() const {
             stream.flush();
         }
-        virtual ~Writer() = default;
+
+        /// Switch the rest of the output to a shared-memory ring in dir.
+        /// Only meaningful when the output is a pipe into general-loader;
+        /// returns false, leaving the stream untouched, if the ring cannot be set up.
+        bool useSharedRing(std::string const &dir = "/dev/shm", size_t size = 64 * 1024 * 1024)
+        {
+            if (ring)
+                return false;
+            std::unique_ptr<ncbi::GWRing> r(ncbi::GWRing::create(dir, size));
+            if (!r)
+                return false;
+            String1Event(useRing, 0, r->path()).write(stream);
+            stream.flush();
+            ring = std::move(r);
+            ringBuf.reset(new RingBuf(*ring));
+            pipeBuf = stream.rdbuf(ringBuf.get());
+            return true;
+        }
+
+        virtual ~Writer() {
+            if (ring) {
+                stream.flush();
+                stream.rdbuf(pipeBuf);
+                ring->close();
+            }
+        }
     };
 }
 
@@ -360,6 +440,7 @@ public:
     using VDB::Writer::setMetadata;
     using VDB::Writer::endWriting;
     using VDB::Writer::flush;
+    using VDB::Writer::useSharedRing;
     using VDB::Writer::errorMessage;
     using VDB::Writer::logMessage;
     using VDB::Writer::progressMessage;
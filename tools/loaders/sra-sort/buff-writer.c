@@ -98,6 +98,9 @@ struct BufferedPairColWriter
     /* for non-mapping writers - new=>old ord */
     uint32_t *ord;
 
+    /* for non-mapping writers - size of ids when owned rather than borrowed from table */
+    size_t own_ids;
+
     size_t num_items;   /* total number of items              */
     size_t cur_item;    /* index of currently available item  */
     size_t num_immed;   /* number of immediate items written  */
@@ -107,11 +110,28 @@ struct BufferedPairColWriter
     uint32_t max_row_len;
 };
 
+static
+void BufferedPairColWriterForgetIds ( BufferedPairColWriter *self, const ctx_t *ctx )
+{
+    FUNC_ENTRY ( ctx );
+
+    if ( self -> own_ids != 0 )
+    {
+        MemFree ( ctx, self -> u . ids, sizeof self -> u . ids [ 0 ] * self -> own_ids );
+        self -> own_ids = 0;
+    }
+
+    self -> u . ids = NULL;
+    self -> ord = NULL;
+}
+
 static
 void BufferedPairColWriterWhack ( BufferedPairColWriter *self, const ctx_t *ctx )
 {
     FUNC_ENTRY ( ctx );
 
+    if ( self -> own_ids != 0 )
+        BufferedPairColWriterForgetIds ( self, ctx );
     MapFileRelease ( self -> idx, ctx );
     MemBankRelease ( self -> mbank, ctx );
     if(self -> vocab_key2id) KBTreeRelease  ( self -> vocab_key2id );
@@ -458,6 +478,18 @@ void BufferedPairColWriterWriteUnmapped ( BufferedPairColWriter *self, const ctx
             return;
         }
 
+        /* the source ids are overwritten with column data below,
+           unless other columns are reading them at the same time */
+        if ( self -> tbl -> dad . copy_threads > 1 )
+        {
+            ON_FAIL ( self -> u . ids = MemAlloc ( ctx, sizeof self -> u . ids [ 0 ] * self -> num_items, false ) )
+            {
+                ANNOTATE ( "failed to allocate buffer for column '%s'", ColumnWriterFullSpec ( self -> cw, ctx ) );
+                return;
+            }
+            self -> own_ids = self -> num_items;
+        }
+
         /* require elem_bits to be constant for column */
         self -> elem_bits = elem_bits;
 
@@ -524,8 +556,7 @@ void BufferedPairColWriterWriteUnmapped ( BufferedPairColWriter *self, const ctx
             }
 
             /* forget about map */
-            self -> u . ids = NULL;
-            self -> ord = NULL;
+            BufferedPairColWriterForgetIds ( self, ctx );
             self -> cur_item = self -> num_items = self -> num_immed = 0;
             self -> elem_bits = 0;
 
@@ -655,8 +686,7 @@ void BufferedPairColWriterWriteUnmapped ( BufferedPairColWriter *self, const ctx
             self -> mbank = NULL;
 
             /* forget about map */
-            self -> u . ids = NULL;
-            self -> ord = NULL;
+            BufferedPairColWriterForgetIds ( self, ctx );
             self -> cur_item = self -> num_items = self -> num_immed = 0;
             self -> elem_bits = 0;
 
@@ -26,9 +26,16 @@
 
 #include "idx-mapping.h"
 #include "ctx.h"
+#include "caps.h"
+#include "mem.h"
+#include "except.h"
+#include "sra-sort.h"
 
+#include <kproc/thread.h>
 #include <klib/sort.h>
 
+#include <string.h>
+
 FILE_ENTRY ( idx-mapping );
 
 
@@ -57,6 +64,317 @@ int64_t CC IdxMappingCmpNew ( const void *a, const void *b, void *data )
 
 #else /* USE_OLD_KSORT */
 
+/* RadixSort
+ *  id maps are large and their ids dense, so given the memory for
+ *  a second copy, an LSD radix sort on 8-bit digits beats KSORT.
+ *  digits common to all keys are skipped, which for row-ids leaves
+ *  only a few passes. each pass is split among threads owning a
+ *  contiguous slice of the source, scattering it stably into the
+ *  destination at offsets computed from all of their histograms.
+ *  the second copy is capped at RADIX_SORT_MAX_SCRATCH, larger maps
+ *  are first split into buckets in place.
+ */
+#define RADIX_SORT_MIN_COUNT ( 64 * 1024 )
+#define RADIX_SORT_MIN_THREAD_COUNT ( 1024 * 1024 )
+#define RADIX_SORT_MAX_SCRATCH ( ( size_t ) 256 * 1024 * 1024 )
+
+/* keys are signed, flip sign bit to compare unsigned digits */
+#define RADIX_KEY( m, by_new ) \
+    ( ( uint64_t ) ( ( by_new ) ? ( m ) -> new_id : ( m ) -> old_id ) ^ ( ( uint64_t ) 1 << 63 ) )
+
+typedef struct IdxMappingRadix IdxMappingRadix;
+struct IdxMappingRadix
+{
+    const IdxMapping *src;
+    IdxMapping *dst;
+    size_t start, end;
+    uint32_t digit;
+    bool by_new;
+
+    /* per digit counts, then destination offsets */
+    size_t hist [ 8 ] [ 256 ];
+};
+
+/* counts all digits of the slice when "digit" is 8,
+   otherwise recounts just the one digit after a previous pass */
+static
+rc_t CC IdxMappingRadixCount ( const KThread *t, void *data )
+{
+    IdxMappingRadix *self = data;
+
+    size_t i;
+    uint32_t d;
+    if ( self -> digit == 8 )
+    {
+        for ( i = self -> start; i < self -> end; ++ i )
+        {
+            uint64_t key = RADIX_KEY ( & self -> src [ i ], self -> by_new );
+            for ( d = 0; d < 8; ++ d )
+                ++ self -> hist [ d ] [ ( key >> ( d * 8 ) ) & 0xFF ];
+        }
+    }
+    else
+    {
+        uint32_t shift = self -> digit * 8;
+        size_t *hist = self -> hist [ self -> digit ];
+        memset ( hist, 0, sizeof self -> hist [ 0 ] );
+        for ( i = self -> start; i < self -> end; ++ i )
+        {
+            uint64_t key = RADIX_KEY ( & self -> src [ i ], self -> by_new );
+            ++ hist [ ( key >> shift ) & 0xFF ];
+        }
+    }
+
+    return 0;
+}
+
+static
+rc_t CC IdxMappingRadixScatter ( const KThread *t, void *data )
+{
+    IdxMappingRadix *self = data;
+
+    size_t i;
+    uint32_t shift = self -> digit * 8;
+    size_t *pos = self -> hist [ self -> digit ];
+    for ( i = self -> start; i < self -> end; ++ i )
+    {
+        uint64_t key = RADIX_KEY ( & self -> src [ i ], self -> by_new );
+        self -> dst [ pos [ ( key >> shift ) & 0xFF ] ++ ] = self -> src [ i ];
+    }
+
+    return 0;
+}
+
+/* run "f" on all slices, the first on the calling thread
+   a slice is run inline if its thread cannot be created */
+static
+void IdxMappingRadixRun ( IdxMappingRadix *r, uint32_t threads,
+    rc_t ( CC * f ) ( const KThread*, void* ) )
+{
+    uint32_t i;
+    KThread *t [ 64 ];
+
+    for ( i = 1; i < threads; ++ i )
+    {
+        if ( KThreadMake ( & t [ i ], f, & r [ i ] ) != 0 )
+        {
+            t [ i ] = NULL;
+            ( * f ) ( NULL, & r [ i ] );
+        }
+    }
+
+    ( * f ) ( NULL, & r [ 0 ] );
+
+    for ( i = 1; i < threads; ++ i )
+    {
+        if ( t [ i ] != NULL )
+        {
+            rc_t status;
+            KThreadWait ( t [ i ], & status );
+            KThreadRelease ( t [ i ] );
+        }
+    }
+}
+
+/* LSD passes over the low "digits" digits of "count" entries,
+   "tmp" holds "count" entries and "r" at least "max_threads" slices */
+static
+void IdxMappingRadixLSD ( IdxMapping *self, size_t count, bool by_new, uint32_t digits,
+    IdxMapping *tmp, IdxMappingRadix *r, uint32_t max_threads )
+{
+    uint32_t i, d, threads = max_threads;
+    IdxMapping *src, *dst;
+    uint64_t key0 = RADIX_KEY ( & self [ 0 ], by_new );
+    bool scattered;
+
+    if ( threads > count / RADIX_SORT_MIN_THREAD_COUNT )
+        threads = ( uint32_t ) ( count / RADIX_SORT_MIN_THREAD_COUNT );
+    if ( threads == 0 )
+        threads = 1;
+
+    for ( i = 0; i < threads; ++ i )
+    {
+        r [ i ] . src = self;
+        r [ i ] . start = count * i / threads;
+        r [ i ] . end = count * ( i + 1 ) / threads;
+        r [ i ] . digit = 8;
+        r [ i ] . by_new = by_new;
+        memset ( r [ i ] . hist, 0, sizeof r [ i ] . hist );
+    }
+
+    IdxMappingRadixRun ( r, threads, IdxMappingRadixCount );
+
+    src = self;
+    dst = tmp;
+    scattered = false;
+    for ( d = 0; d < digits; ++ d )
+    {
+        size_t b, off;
+
+        /* skip digit when all keys share it */
+        for ( b = ( key0 >> ( d * 8 ) ) & 0xFF, off = 0, i = 0; i < threads; ++ i )
+            off += r [ i ] . hist [ d ] [ b ];
+        if ( off == count )
+            continue;
+
+        /* slices hold other entries after a previous pass */
+        for ( i = 0; i < threads; ++ i )
+        {
+            r [ i ] . src = src;
+            r [ i ] . dst = dst;
+            r [ i ] . digit = d;
+        }
+        if ( scattered )
+            IdxMappingRadixRun ( r, threads, IdxMappingRadixCount );
+
+        /* turn counts into offsets, slices in order for stability */
+        for ( off = 0, b = 0; b < 256; ++ b )
+        {
+            for ( i = 0; i < threads; ++ i )
+            {
+                size_t n = r [ i ] . hist [ d ] [ b ];
+                r [ i ] . hist [ d ] [ b ] = off;
+                off += n;
+            }
+        }
+
+        IdxMappingRadixRun ( r, threads, IdxMappingRadixScatter );
+        scattered = true;
+
+        src = dst;
+        dst = ( src == self ) ? tmp : self;
+    }
+
+    if ( src != self )
+        memmove ( self, src, sizeof self [ 0 ] * count );
+}
+
+/* sorts a map of any size with "tmp" holding "tmp_count" entries:
+   a map that does not fit is partitioned in place on its top digit,
+   American flag style, and each bucket is sorted the same way */
+static
+void IdxMappingRadixSortBuckets ( IdxMapping *self, size_t count, bool by_new, uint32_t digits,
+    IdxMapping *tmp, size_t tmp_count, IdxMappingRadix *r, uint32_t max_threads )
+{
+    while ( count > tmp_count && digits != 0 )
+    {
+        size_t b, i, start [ 257 ], next [ 256 ];
+        uint32_t shift = ( digits - 1 ) * 8;
+
+        memset ( start, 0, sizeof start );
+        for ( i = 0; i < count; ++ i )
+            ++ start [ ( ( RADIX_KEY ( & self [ i ], by_new ) >> shift ) & 0xFF ) + 1 ];
+        for ( b = 0; b < 256; ++ b )
+            start [ b + 1 ] += start [ b ];
+
+        -- digits;
+        for ( b = 0; b < 256; ++ b )
+        {
+            if ( start [ b + 1 ] - start [ b ] == count )
+                break;
+        }
+        if ( b < 256 )
+        {
+            /* all keys share the digit */
+            continue;
+        }
+
+        memmove ( next, start, sizeof next );
+        for ( b = 0; b < 256; ++ b )
+        {
+            while ( next [ b ] < start [ b + 1 ] )
+            {
+                IdxMapping e = self [ next [ b ] ];
+                size_t eb = ( RADIX_KEY ( & e, by_new ) >> shift ) & 0xFF;
+                while ( eb != b )
+                {
+                    IdxMapping t = self [ next [ eb ] ];
+                    self [ next [ eb ] ++ ] = e;
+                    e = t;
+                    eb = ( RADIX_KEY ( & e, by_new ) >> shift ) & 0xFF;
+                }
+                self [ next [ b ] ++ ] = e;
+            }
+        }
+
+        for ( b = 0; b < 256; ++ b )
+        {
+            if ( start [ b + 1 ] - start [ b ] > 1 )
+            {
+                IdxMappingRadixSortBuckets ( self + start [ b ], start [ b + 1 ] - start [ b ],
+                    by_new, digits, tmp, tmp_count, r, max_threads );
+            }
+        }
+        return;
+    }
+
+    if ( count > 1 && digits != 0 )
+        IdxMappingRadixLSD ( self, count, by_new, digits, tmp, r, max_threads );
+}
+
+/* returns false if the map was left to be sorted in place */
+static
+bool IdxMappingRadixSort ( IdxMapping *self, const ctx_t *ctx, size_t count, bool by_new )
+{
+    FUNC_ENTRY ( ctx );
+
+    size_t quota, in_use, r_bytes;
+    size_t bytes = sizeof self [ 0 ] * count;
+    uint32_t threads = ctx -> caps -> tool -> max_copy_threads;
+    IdxMapping *tmp;
+    IdxMappingRadix *r;
+
+    if ( count < RADIX_SORT_MIN_COUNT )
+        return false;
+
+    if ( threads > 64 )
+        threads = 64;
+    if ( threads == 0 )
+        threads = 1;
+    r_bytes = sizeof r [ 0 ] * threads;
+
+    /* the scratch copy is capped and, with the slices, never exceeds
+       the quota, larger maps are sorted in buckets */
+    if ( bytes > RADIX_SORT_MAX_SCRATCH )
+        bytes = RADIX_SORT_MAX_SCRATCH;
+    in_use = MemInUse ( ctx, & quota );
+    if ( ( quota + 1 ) != 0 )
+    {
+        if ( in_use > quota || quota - in_use < r_bytes )
+            return false;
+        if ( quota - in_use - r_bytes < bytes )
+            bytes = quota - in_use - r_bytes;
+    }
+    bytes -= bytes % sizeof self [ 0 ];
+    if ( bytes < sizeof self [ 0 ] * RADIX_SORT_MIN_COUNT )
+        return false;
+
+    TRY ( tmp = MemAlloc ( ctx, bytes, false ) )
+    {
+        TRY ( r = MemAlloc ( ctx, r_bytes, true ) )
+        {
+            IdxMappingRadixSortBuckets ( self, count, by_new, 8,
+                tmp, bytes / sizeof self [ 0 ], r, threads );
+
+            MemFree ( ctx, r, r_bytes );
+        }
+
+        MemFree ( ctx, tmp, bytes );
+    }
+
+    if ( FAILED () )
+    {
+        /* sort in place instead */
+        CLEAR ();
+        return false;
+    }
+
+    return true;
+}
+
+#undef RADIX_KEY
+
+
 #define T( x ) ( ( const IdxMapping* ) ( x ) )
 
 #define SWAP( a, b, off, size ) KSORT_TSWAP ( IdxMapping, a, b )
@@ -67,7 +385,10 @@ void IdxMappingSortOld ( IdxMapping *self, const ctx_t *ctx, size_t count )
 #define CMP( a, b ) \
     ( ( T ( a ) -> old_id < T ( b ) -> old_id ) ? -1 : ( T ( a ) -> old_id > T ( b ) -> old_id ) )
 
-    KSORT ( self, count, sizeof * self, 0, sizeof * self );
+    if ( ! IdxMappingRadixSort ( self, ctx, count, false ) )
+    {
+        KSORT ( self, count, sizeof * self, 0, sizeof * self );
+    }
 
 #undef CMP
 }
@@ -77,7 +398,10 @@ void IdxMappingSortNew ( IdxMapping *self, const ctx_t *ctx, size_t count )
 #define CMP( a, b ) \
     ( ( T ( a ) -> new_id < T ( b ) -> new_id ) ? -1 : ( T ( a ) -> new_id > T ( b ) -> new_id ) )
 
-    KSORT ( self, count, sizeof * self, 0, sizeof * self );
+    if ( ! IdxMappingRadixSort ( self, ctx, count, true ) )
+    {
+        KSORT ( self, count, sizeof * self, 0, sizeof * self );
+    }
 
 #undef CMP
 }
@@ -146,18 +146,28 @@ size_t MappingRowSetNextPhys ( MappingRowSet *self, const ctx_t *ctx,
 static
 void MappingRowSetReset ( MappingRowSet *self, const ctx_t *ctx, bool for_static );
 
+/* mapping writers share the IdxMapping of the iterator */
+static
+RowSet *MappingRowSetClone ( MappingRowSet *self, const ctx_t *ctx, size_t *col_bytes )
+{
+    * col_bytes = 0;
+    return NULL;
+}
+
 static RowSet_vt MappingRowSetPhys_vt =
 {
     MappingRowSetWhack,
     MappingRowSetNextPhys,
-    MappingRowSetReset
+    MappingRowSetReset,
+    MappingRowSetClone
 };
 
 static RowSet_vt MappingRowSetStat_vt =
 {
     MappingRowSetWhack,
     MappingRowSetNextStat,
-    MappingRowSetReset
+    MappingRowSetReset,
+    MappingRowSetClone
 };
 
 static
@@ -202,14 +212,16 @@ static RowSet_vt MapFileMappingRowSetPhys_vt =
 {
     MappingRowSetWhack,
     MappingRowSetNextPhys,
-    MapFileMappingRowSetReset
+    MapFileMappingRowSetReset,
+    MappingRowSetClone
 };
 
 static RowSet_vt MapFileMappingRowSetStat_vt =
 {
     MappingRowSetWhack,
     MappingRowSetNextStat,
-    MapFileMappingRowSetReset
+    MapFileMappingRowSetReset,
+    MappingRowSetClone
 };
 
 static
@@ -74,6 +74,10 @@ struct RowSet_vt
     /* reset iterator to initial state */
     void ( * reset ) ( ROWSET_IMPL *self, const ctx_t *ctx,
         bool for_static );
+
+    /* make an independent iterator over the ids selected by last reset */
+    RowSet* ( * clone ) ( ROWSET_IMPL *self, const ctx_t *ctx,
+        size_t *col_bytes );
 };
 
 
@@ -102,6 +106,18 @@ RowSet *RowSetDuplicate ( const RowSet *self, const ctx_t *ctx );
     POLY_DISPATCH_VOID ( reset, self, ROWSET_IMPL, ctx, for_static )
 
 
+/* Clone
+ *  create an iterator over the row-ids selected by the last
+ *  non-static Reset that can be walked on another thread
+ *  returns NULL if columns of this row-set cannot be copied concurrently
+ *
+ *  "col_bytes" [ OUT ] - additional memory needed by a column
+ *  while it is copied concurrently with others
+ */
+#define RowSetClone( self, ctx, col_bytes ) \
+    POLY_DISPATCH_PTR ( clone, self, ROWSET_IMPL, ctx, col_bytes )
+
+
 /* Init
  */
 void RowSetInit ( RowSet *self, const ctx_t *ctx, const RowSet_vt *vt );
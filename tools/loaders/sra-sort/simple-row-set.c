@@ -87,11 +87,15 @@ void SimpleRowSetReset ( SimpleRowSet *self, const ctx_t *ctx, bool for_static )
     self -> row_id = self -> first;
 }
 
+static
+RowSet *SimpleRowSetClone ( SimpleRowSet *self, const ctx_t *ctx, size_t *col_bytes );
+
 static RowSet_vt SimpleRowSet_vt =
 {
     SimpleRowSetWhack,
     SimpleRowSetNext,
-    SimpleRowSetReset
+    SimpleRowSetReset,
+    SimpleRowSetClone
 };
 
 
@@ -114,6 +118,16 @@ RowSet *SimpleRowSetMake ( const ctx_t *ctx, int64_t first, int64_t last_excl )
     return NULL;
 }
 
+static
+RowSet *SimpleRowSetClone ( SimpleRowSet *self, const ctx_t *ctx, size_t *col_bytes )
+{
+    FUNC_ENTRY ( ctx );
+
+    /* ids are generated, nothing is shared */
+    * col_bytes = 0;
+    return SimpleRowSetMake ( ctx, self -> first, self -> last_excl );
+}
+
 
 /*--------------------------------------------------------------------------
  * SimpleRowSetIterator
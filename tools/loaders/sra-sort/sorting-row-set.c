@@ -151,18 +151,44 @@ size_t SortingRowSetNextPhys ( SortingRowSet *self, const ctx_t *ctx,
 static
 void SortingRowSetReset ( SortingRowSet *self, const ctx_t *ctx, bool for_static );
 
+static
+void SortingRowSetCloneReset ( SortingRowSet *self, const ctx_t *ctx, bool for_static );
+
+static
+RowSet *SortingRowSetClone ( SortingRowSet *self, const ctx_t *ctx, size_t *col_bytes );
+
 static RowSet_vt SortingRowSetPhys_vt =
 {
     SortingRowSetWhack,
     SortingRowSetNextPhys,
-    SortingRowSetReset
+    SortingRowSetReset,
+    SortingRowSetClone
 };
 
 static RowSet_vt SortingRowSetStat_vt =
 {
     SortingRowSetWhack,
     SortingRowSetNextStat,
-    SortingRowSetReset
+    SortingRowSetReset,
+    SortingRowSetClone
+};
+
+/* clones walk the ids selected by the original row-set
+   and never read them again from the MapFile */
+static RowSet_vt SortingRowSetClonePhys_vt =
+{
+    SortingRowSetWhack,
+    SortingRowSetNextPhys,
+    SortingRowSetCloneReset,
+    SortingRowSetClone
+};
+
+static RowSet_vt SortingRowSetCloneStat_vt =
+{
+    SortingRowSetWhack,
+    SortingRowSetNextStat,
+    SortingRowSetCloneReset,
+    SortingRowSetClone
 };
 
 static
@@ -213,6 +239,37 @@ void SortingRowSetReset ( SortingRowSet *self, const ctx_t *ctx, bool for_static
     self -> cur_elem = 0;
 }
 
+static
+void SortingRowSetCloneReset ( SortingRowSet *self, const ctx_t *ctx, bool for_static )
+{
+    self -> dad . vt = for_static ? & SortingRowSetCloneStat_vt : & SortingRowSetClonePhys_vt;
+    self -> cur_elem = 0;
+}
+
+static
+RowSet *SortingRowSetIteratorMakeTheRowSet ( SortingRowSetIterator *self, const ctx_t *ctx, const RowSet_vt *vt );
+
+static
+RowSet *SortingRowSetClone ( SortingRowSet *self, const ctx_t *ctx, size_t *col_bytes )
+{
+    FUNC_ENTRY ( ctx );
+
+    RowSet *rs;
+
+    /* ids must have been selected by a non-static reset */
+    * col_bytes = 0;
+    if ( ! self -> iter -> new_ord_valid )
+        return NULL;
+
+    TRY ( rs = SortingRowSetIteratorMakeTheRowSet ( self -> iter, ctx, & SortingRowSetClonePhys_vt ) )
+    {
+        /* buffered writers can no longer keep column data in src_ids */
+        * col_bytes = sizeof self -> src_ids [ 0 ] * self -> num_elems;
+    }
+
+    return rs;
+}
+
 
 /*--------------------------------------------------------------------------
  * SortingRowSetIterator
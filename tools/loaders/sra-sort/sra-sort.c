@@ -81,6 +81,7 @@ rc_t CC UsageSummary ( const char *prog_name )
 #define OPT_TEMP_DIR "tempdir"
 #define OPT_MMAP_DIR "mmapdir"
 #define OPT_UNSORTED_OLD_NEW "unsorted-old-new"
+#define OPT_THREADS "threads"
 
 #define OPT_COLUMN_MD5 "column-md5"
 #define OPT_NO_COLUMN_CHECKSUM "no-column-checksum"
@@ -103,6 +104,9 @@ static const char *hlp_max_large_idx_ids [] = { "sets number of rows to process
 static const char *hlp_temp_dir [] = { "sets a specific directory to use for temporary files", NULL };
 static const char *hlp_mmap_dir [] = { "sets a specific directory to use for memory-mapped buffers", NULL };
 static const char *hlp_unsorted_old_new [] = { "write old=>new index in unsorted order", NULL };
+static const char *hlp_threads [] = { "sets number of columns to copy concurrently",
+                                      "and of threads sorting id maps ( default 1 )",
+                                      "limited by available memory when a mem-limit is set", NULL };
 
 static const char *hlp_column_md5 [] = { "generate md5sum compatible checksum files for each column [default]", NULL };
 static const char *hlp_no_column_checksum [] = { "disable generation of column checksums", NULL };
@@ -136,6 +140,7 @@ static OptDef options [] =
   , { OPT_TEMP_DIR, NULL, NULL, hlp_temp_dir, 1, true, false }
   , { OPT_MMAP_DIR, NULL, NULL, hlp_mmap_dir, 1, true, false }
   , { OPT_UNSORTED_OLD_NEW, NULL, NULL, hlp_unsorted_old_new, 1, false, false }
+  , { OPT_THREADS, NULL, NULL, hlp_threads, 1, true, false }
 
   , { OPT_COLUMN_MD5, NULL, NULL, hlp_column_md5, 1, false, false }
   , { OPT_NO_COLUMN_CHECKSUM, NULL, NULL, hlp_no_column_checksum, 1, false, false }
@@ -339,6 +344,9 @@ void initialize_params ( const ctx_t *ctx, Caps *caps, Tool *tp, Selection *sel,
     tp -> min_idx_ids =  64 * 1024 * 1024;
     tp -> max_missing_ids = tp -> max_idx_ids;
 
+    /* columns copied concurrently, opt-in */
+    tp -> max_copy_threads = 1;
+
 #if 0
     /* refpos cache size */
     tp -> refpos_cache_capacity = 100 * 1024 * 1024;
@@ -401,6 +409,11 @@ tp->write_new_to_old=true;
     if ( found )
         tp -> max_ref_idx_ids = ( size_t ) val;
 
+    ON_FAIL ( val = KConfigGetNodeU64 ( ctx, "sra-sort/threads", & found ) )
+        return;
+    if ( found )
+        tp -> max_copy_threads = ( uint32_t ) val;
+
     /* finally look in args */
     ON_FAIL ( str = ArgsGetOptStr ( args, ctx, OPT_TEMP_DIR, & count ) )
         return;
@@ -432,6 +445,13 @@ tp->write_new_to_old=true;
     if ( count != 0 )
         tp -> max_large_idx_ids = ( size_t ) val;
 
+    ON_FAIL ( val = ArgsGetOptU64 ( args, ctx, OPT_THREADS, & count ) )
+        return;
+    if ( count != 0 )
+        tp -> max_copy_threads = ( uint32_t ) val;
+    if ( tp -> max_copy_threads == 0 )
+        tp -> max_copy_threads = 1;
+
     ON_FAIL ( found = ArgsGetOptBool ( args, ctx, OPT_IGNORE_FAILURE, & count ) )
         return;
     if ( count != 0 )
@@ -95,6 +95,10 @@ struct Tool
     /* the number of missing SEQUENCE ids to gather at a time */
     size_t max_missing_ids;
 
+    /* the number of columns to copy concurrently,
+       and of threads sorting an id map */
+    uint32_t max_copy_threads;
+
     /* pid of tool */
     int pid;
 
@@ -48,6 +48,7 @@ typedef struct TablePair StdTblPair;
 #include <klib/namelist.h>
 #include <klib/rc.h>
 #include <kproc/thread.h> /* KThreadWait */
+#include <kproc/lock.h>
 
 #include <string.h>
 
@@ -216,6 +217,244 @@ void CC TablePairReleaseColumnPair ( void *item, void *data )
 }
 
 
+/* CopyColumns
+ *  once the row-set has selected its ids, copying of one column
+ *  does not depend upon the others. when the row-set can be cloned,
+ *  columns are handed out to a bounded set of threads, each walking
+ *  its own clone of the row-set. a VCursor is not thread-safe: columns
+ *  copied here must not share cursors, every reader and writer opens
+ *  its own. mapped columns share their MapFile and are not copied here.
+ *
+ *  "rs" [ IN, NULL OKAY ] - NULL to copy static columns
+ */
+typedef struct TablePairCopyJob TablePairCopyJob;
+struct TablePairCopyJob
+{
+    const Vector *cols;
+    KLock *lock;
+
+    /* static column range */
+    int64_t first_id;
+    uint64_t count;
+
+    /* next column to be copied */
+    uint32_t next;
+    bool failed;
+};
+
+typedef struct TablePairCopyWorker TablePairCopyWorker;
+struct TablePairCopyWorker
+{
+    Caps caps;
+    TablePairCopyJob *job;
+    RowSet *rs;
+    KThread *t;
+};
+
+static
+ColumnPair *TablePairCopyJobNext ( TablePairCopyJob *self, bool failed )
+{
+    ColumnPair *col = NULL;
+
+    KLockAcquire ( self -> lock );
+    if ( failed )
+        self -> failed = true;
+    else if ( ! self -> failed && self -> next < VectorLength ( self -> cols ) )
+        col = VectorGet ( self -> cols, self -> next ++ );
+    KLockUnlock ( self -> lock );
+
+    return col;
+}
+
+static
+rc_t CC TablePairCopyWorkerRun ( const KThread *t, void *data )
+{
+    TablePairCopyWorker *w = data;
+    TablePairCopyJob *job = w -> job;
+
+    DECLARE_CTX_INFO ();
+    ctx_t thread_ctx = { & w -> caps, NULL, & ctx_info };
+    const ctx_t *ctx = & thread_ctx;
+
+    ColumnPair *col;
+    while ( ( col = TablePairCopyJobNext ( job, false ) ) != NULL )
+    {
+        if ( w -> rs == NULL )
+            ColumnPairCopyStatic ( col, ctx, job -> first_id, job -> count );
+        else
+            ColumnPairCopy ( col, ctx, w -> rs );
+
+        if ( FAILED () )
+        {
+            TablePairCopyJobNext ( job, true );
+            break;
+        }
+    }
+
+    return ctx -> rc;
+}
+
+/* the number of threads is limited by quota,
+   with each thread buffering one column at a time */
+static
+uint32_t TablePairCopyThreads ( TablePair *self, const ctx_t *ctx, uint32_t count, size_t col_bytes )
+{
+    uint32_t threads = ctx -> caps -> tool -> max_copy_threads;
+    if ( threads > count )
+        threads = count;
+
+    if ( threads > 1 && col_bytes != 0 )
+    {
+        size_t quota, in_use = MemInUse ( ctx, & quota );
+        if ( ( quota + 1 ) != 0 )
+        {
+            size_t avail = ( in_use < quota ) ? quota - in_use : 0;
+            if ( ( uint64_t ) threads * col_bytes > ( uint64_t ) avail )
+                threads = ( uint32_t ) ( avail / col_bytes );
+        }
+    }
+
+    return threads;
+}
+
+static
+void TablePairCopyColumnsSerial ( TablePair *self, const ctx_t *ctx, const Vector *cols, RowSet *rs )
+{
+    FUNC_ENTRY ( ctx );
+
+    uint32_t i, count = VectorLength ( cols );
+    for ( i = 0; i < count; ++ i )
+    {
+        ColumnPair *col = VectorGet ( cols, i );
+        assert ( col != NULL );
+        if ( rs == NULL )
+        {
+            ON_FAIL ( ColumnPairCopyStatic ( col, ctx, self -> first_id, self -> last_excl - self -> first_id ) )
+                break;
+        }
+        else
+        {
+            ON_FAIL ( ColumnPairCopy ( col, ctx, rs ) )
+                break;
+        }
+    }
+}
+
+static
+void TablePairCopyColumns ( TablePair *self, const ctx_t *ctx, const Vector *cols, RowSet *rs )
+{
+    FUNC_ENTRY ( ctx );
+
+    rc_t rc;
+    uint32_t i, threads;
+    size_t col_bytes = 0;
+    RowSet *clone = NULL;
+    TablePairCopyJob job;
+    TablePairCopyWorker *workers;
+
+    threads = TablePairCopyThreads ( self, ctx, VectorLength ( cols ), 0 );
+    if ( threads > 1 && rs != NULL )
+    {
+        /* select ids once for all of the clones */
+        ON_FAIL ( RowSetReset ( rs, ctx, false ) )
+            return;
+        ON_FAIL ( clone = RowSetClone ( rs, ctx, & col_bytes ) )
+            return;
+        if ( clone == NULL )
+            threads = 1;
+        else
+            threads = TablePairCopyThreads ( self, ctx, threads, col_bytes );
+    }
+
+    if ( threads <= 1 )
+    {
+        RowSetRelease ( clone, ctx );
+        TablePairCopyColumnsSerial ( self, ctx, cols, rs );
+        return;
+    }
+
+    memset ( & job, 0, sizeof job );
+    job . cols = cols;
+    job . first_id = self -> first_id;
+    job . count = self -> last_excl - self -> first_id;
+
+    rc = KLockMake ( & job . lock );
+    if ( rc != 0 )
+    {
+        SYSTEM_ERROR ( rc, "failed to create lock" );
+        RowSetRelease ( clone, ctx );
+        return;
+    }
+
+    TRY ( workers = MemAlloc ( ctx, sizeof workers [ 0 ] * threads, true ) )
+    {
+        STATUS ( 3, "copying %u columns on %u threads", VectorLength ( cols ), threads );
+
+        /* buffered writers must not keep data in ids of the row-set */
+        self -> copy_threads = threads;
+
+        for ( i = 0; i < threads; ++ i )
+        {
+            TablePairCopyWorker *w = & workers [ i ];
+            w -> job = & job;
+
+            ON_FAIL ( CapsInit ( & w -> caps, ctx ) )
+                break;
+
+            if ( rs != NULL )
+            {
+                if ( i == 0 )
+                {
+                    w -> rs = clone;
+                    clone = NULL;
+                }
+                else
+                {
+                    ON_FAIL ( w -> rs = RowSetClone ( rs, ctx, & col_bytes ) )
+                        break;
+                }
+            }
+
+            rc = KThreadMake ( & w -> t, TablePairCopyWorkerRun, w );
+            if ( rc != 0 )
+            {
+                SYSTEM_ERROR ( rc, "failed to create column copy thread" );
+                break;
+            }
+        }
+
+        /* stop handing out columns if not all threads started */
+        if ( FAILED () )
+            TablePairCopyJobNext ( & job, true );
+
+        for ( i = 0; i < threads; ++ i )
+        {
+            TablePairCopyWorker *w = & workers [ i ];
+            if ( w -> t != NULL )
+            {
+                rc_t status = 0;
+                rc = KThreadWait ( w -> t, & status );
+                if ( rc == 0 )
+                    rc = status;
+                if ( rc != 0 && ! FAILED () )
+                    ERROR ( rc, "failed to copy '%s' columns on thread 0x%p", self -> full_spec, w -> t );
+                KThreadRelease ( w -> t );
+            }
+
+            RowSetRelease ( w -> rs, ctx );
+            CapsWhack ( & w -> caps, ctx );
+        }
+
+        self -> copy_threads = 0;
+
+        MemFree ( ctx, workers, sizeof workers [ 0 ] * threads );
+    }
+
+    RowSetRelease ( clone, ctx );
+    KLockRelease ( job . lock );
+}
+
+
 /* Copy
  *  the table has to obtain a RowSetIterator
  *  which it walks vertically
@@ -241,27 +480,25 @@ void TablePairCopyStaticColumns ( TablePair *self, const ctx_t *ctx )
 
             while ( ! FAILED () )
             {
-                uint32_t i;
-
 #if OLD_STATIC_WRITE
+                uint32_t i;
                 RowSet *rs;
                 ON_FAIL ( rs = RowSetIteratorNext ( rsi, ctx ) )
                     break;
                 if ( rs == NULL )
                     break;
 #endif
+#if OLD_STATIC_WRITE
                 for ( i = 0; i < count; ++ i )
                 {
                     ColumnPair *col = VectorGet ( & self -> static_cols, i );
                     assert ( col != NULL );
-#if OLD_STATIC_WRITE
                     ON_FAIL ( ColumnPairCopy ( col, ctx, rs ) )
                         break;
+                }
 #else
-                    ON_FAIL ( ColumnPairCopyStatic ( col, ctx, self -> first_id, self -> last_excl - self -> first_id ) )
-                        break;
+                TablePairCopyColumns ( self, ctx, & self -> static_cols, NULL );
 #endif
-                }
 
 #if OLD_STATIC_WRITE
                 RowSetRelease ( rs, ctx );
@@ -304,21 +541,13 @@ void TablePairCopyPresortColumns ( TablePair *self, const ctx_t *ctx )
 
             while ( ! FAILED () )
             {
-                uint32_t i;
-
                 RowSet *rs;
                 ON_FAIL ( rs = RowSetIteratorNext ( rsi, ctx ) )
                     break;
                 if ( rs == NULL )
                     break;
 
-                for ( i = 0; i < count; ++ i )
-                {
-                    ColumnPair *col = VectorGet ( & self -> presort_cols, i );
-                    assert ( col != NULL );
-                    ON_FAIL ( ColumnPairCopy ( col, ctx, rs ) )
-                        break;
-                }
+                TablePairCopyColumns ( self, ctx, & self -> presort_cols, rs );
 
                 RowSetRelease ( rs, ctx );
             }
@@ -410,21 +639,13 @@ void TablePairCopyLargeColumns ( TablePair *self, const ctx_t *ctx )
 
             while ( ! FAILED () )
             {
-                uint32_t i;
-
                 RowSet *rs;
                 ON_FAIL ( rs = RowSetIteratorNext ( rsi, ctx ) )
                     break;
                 if ( rs == NULL )
                     break;
 
-                for ( i = 0; i < count; ++ i )
-                {
-                    ColumnPair *col = VectorGet ( & self -> large_cols, i );
-                    assert ( col != NULL );
-                    ON_FAIL ( ColumnPairCopy ( col, ctx, rs ) )
-                        break;
-                }
+                TablePairCopyColumns ( self, ctx, & self -> large_cols, rs );
 
                 RowSetRelease ( rs, ctx );
             }
@@ -516,21 +737,13 @@ void TablePairCopyNormalColumns ( TablePair *self, const ctx_t *ctx )
 
             while ( ! FAILED () )
             {
-                uint32_t i;
-
                 RowSet *rs;
                 ON_FAIL ( rs = RowSetIteratorNext ( rsi, ctx ) )
                     break;
                 if ( rs == NULL )
                     break;
 
-                for ( i = 0; i < count; ++ i )
-                {
-                    ColumnPair *col = VectorGet ( & self -> normal_cols, i );
-                    assert ( col != NULL );
-                    ON_FAIL ( ColumnPairCopy ( col, ctx, rs ) )
-                        break;
-                }
+                TablePairCopyColumns ( self, ctx, & self -> normal_cols, rs );
 
                 RowSetRelease ( rs, ctx );
             }
@@ -701,8 +914,10 @@ ColumnPair *TablePairMatchColumnPair ( TablePair *self, const ctx_t *ctx, const
                             rc = VCursorAddColumn ( scurs, & idx, "%s", colspec );
                             if ( rc == 0 )
                             {
+                                /* "scurs" only probes the datatype: the reader gets a cursor
+                                   of its own, columns may be copied on different threads */
                                 ColumnReader *reader;
-                                TRY ( reader = TablePairMakeColumnReader ( self, ctx, scurs, colspec, true ) )
+                                TRY ( reader = TablePairMakeColumnReader ( self, ctx, NULL, colspec, true ) )
                                 {
                                     ColumnWriter *writer;
                                     TRY ( writer = TablePairMakeColumnWriter ( self, ctx, NULL, colspec ) )
@@ -94,6 +94,9 @@ struct TablePair
     size_t max_idx_ids;
     size_t min_idx_ids;
 
+    /* number of columns being copied concurrently */
+    uint32_t copy_threads;
+
     /* simple table name */
     const char *name;
 
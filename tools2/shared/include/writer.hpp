@@ -36,6 +36,8 @@
 #include <ctime>
 #include <unistd.h>
 
+#include <general-writer/gw-ring.hpp>
+
 namespace VDB {
     class Writer {
         enum EventCode {
@@ -75,9 +77,35 @@ namespace VDB {
             addMbrTbl, // ???
 
             logMesg,
-            progressMesg
+            progressMesg,
+
+            cellBatch,
+            nextRows,
+
+            useRing
         };
         FILE *stream;
+        ncbi::GWRing *ring = nullptr; ///< owned by stream while the shared ring is in use
+
+#if defined(__GLIBC__)
+        static ssize_t ringWrite(void *const cookie, char const *const buf, size_t const size)
+        {
+            try {
+                static_cast<ncbi::GWRing *>(cookie)->write(buf, size);
+                return size;
+            }
+            catch (...) {
+                return -1;
+            }
+        }
+        static int ringClose(void *const cookie)
+        {
+            auto const ring = static_cast<ncbi::GWRing *>(cookie);
+            ring->close();
+            delete ring;
+            return 0;
+        }
+#endif
 
         class Version {
             int major = 0;
@@ -287,6 +315,13 @@ namespace VDB {
         {
             StreamHeader().write(stream);
         }
+#if defined(__GLIBC__)
+        ~Writer()
+        {
+            if (ring)
+                fclose(stream); // deletes the ring
+        }
+#endif
 
         bool logMessage(std::string const &message) const
         {
@@ -388,12 +423,47 @@ namespace VDB {
         
         bool endWriting() const
         {
-            return SimpleEvent(endStream, 0).write(stream);
+            auto const result = SimpleEvent(endStream, 0).write(stream);
+            if (ring) {
+                // publishes the tail and marks the ring closed
+                fflush(stream);
+                ring->close();
+            }
+            return result;
         }
         
         auto flush() const -> decltype(fflush(stream)) {
             return fflush(stream);
         }
+
+        /// Switch the rest of the output to a shared-memory ring in dir,
+        /// for when the stream is a pipe into general-loader.
+        /// Returns false, leaving the stream untouched, if no ring can be set up.
+        bool useSharedRing(std::string const &dir = "/dev/shm", size_t const size = 64 * 1024 * 1024)
+        {
+#if defined(__GLIBC__)
+            if (ring)
+                return false;
+            auto const newRing = ncbi::GWRing::create(dir, size);
+            if (newRing == nullptr)
+                return false;
+            cookie_io_functions_t const funcs = { nullptr, ringWrite, nullptr, ringClose };
+            auto const ringStream = fopencookie(newRing, "w", funcs);
+            if (ringStream == nullptr) {
+                delete newRing;
+                return false;
+            }
+            String1Event(useRing, 0, newRing->path()).write(stream);
+            fflush(stream);
+            setvbuf(ringStream, nullptr, _IOFBF, 1024 * 1024);
+            ring = newRing;
+            stream = ringStream;
+            return true;
+#else
+            (void)dir; (void)size;
+            return false;
+#endif
+        }
     };
 }
 
@@ -417,6 +487,7 @@ public:
     using VDB::Writer::setMetadata;
     using VDB::Writer::endWriting;
     using VDB::Writer::flush;
+    using VDB::Writer::useSharedRing;
     using VDB::Writer::errorMessage;
     using VDB::Writer::logMessage;
     using VDB::Writer::progressMessage;